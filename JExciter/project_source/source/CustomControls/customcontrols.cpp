@@ -667,6 +667,17 @@ CVuMeterEx::~CVuMeterEx(void)
 {
 }
 
+void CVuMeterEx::pushDataValue(double data)
+{
+	setValue((float)data);
+}
+
+void CVuMeterEx::updateView()
+{
+	// --- repaint; the detector ballistics run in draw()
+	invalid();
+}
+
 void CVuMeterEx::setViewSize(const CRect& newSize, bool invalid)
 {
 	CControl::setViewSize (newSize, invalid);
@@ -22,6 +22,7 @@
 #include "vstgui/vstgui.h"
 #include "vstgui/lib/vstguibase.h"
 #include "guiconstants.h"
+#include "../PluginKernel/pluginstructures.h"
 
 namespace VSTGUI {
 
@@ -485,14 +486,17 @@ protected:
 \ingroup Custom-Controls
 \brief
 The CVuMeterEx object extends the VSTGUI CVuMeter object with extra functionality.\n
-It is used in the PluginGUI object for creating custom views.
+It is used in the PluginGUI object for creating custom views.\n
+When the plugin accepts it as a custom view (registered under its meter parameter's name), the plugin sets
+the highest level since the last timer update on each timer ping, instead of the meter being polled from the
+parameter.
 
 \author Will Pirkle http://www.willpirkle.com
 \remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
 \version Revision : 1.0
 \date Date : 2018 / 09 / 7
 */
-class CVuMeterEx : public CVuMeter
+class CVuMeterEx : public CVuMeter, public ICustomView
 {
 public:
 	CVuMeterEx(const CRect& size, CBitmap* onBitmap, CBitmap* offBitmap, int32_t nbLed, bool bInverted, bool bAnalogVU, int32_t style = kVertical);
@@ -514,12 +518,23 @@ public:
 	void setImageCount(double d){subPixMaps = d;}
 	void setZero_dB_Frame(double d){zero_dB_Frame = d;}
 
+	/** ICustomView method: repaint with the value set since the last update */
+	virtual void updateView() override;
+
+	/** ICustomView method: set the meter value; called on the GUI timer ping, so no queue is needed */
+	virtual void pushDataValue(double data) override;
+
+	/** true once the plugin feeds the meter from its timer ping; PluginGUI then does not poll it */
+	void setPluginFed(bool b){pluginFed = b;}
+	bool isPluginFed(){return pluginFed;}
+
 protected:
 	bool isInverted;
 	bool isAnalogVU;
 	double zero_dB_Frame;
 	double heightOfOneImage;
 	double subPixMaps;
+	bool pluginFed = false;
 
 	CMeterDetector detector;
 };
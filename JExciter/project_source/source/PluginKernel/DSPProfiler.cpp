@@ -0,0 +1,151 @@
+//
+//  DSPProfiler.cpp
+//
+//  DSP load meter for development builds, see DSPProfiler.h.
+
+#include "DSPProfiler.h"
+
+#if DSP_PROFILING
+
+#include <algorithm>
+#include <math.h>
+
+// --- the TSC rate is first measured over kMinCalibrationTime at construction (offline renders may not last long
+//     enough to measure it later), then refined every kCalibrationInterval by the buffers until kCalibrationTime
+static constexpr double kMinCalibrationTime = 0.002;
+static constexpr double kCalibrationTime = 1.0;
+static constexpr double kCalibrationInterval = 0.1;
+
+const char* getDSPStageName(DSPStage stage) {
+    static const char* const names[kNumDSPStages] = { "Crossover", "Saturation", "Mix", "Parameters", "MIDI" };
+    return stage < kNumDSPStages ? names[stage] : "";
+}
+
+template <uint32_t kSeries>
+void DSPProfiler::LoadWindow<kSeries>::reset() {
+    count.store(0, std::memory_order_release);
+    position = 0;
+    numBuffers = 0;
+}
+
+template <uint32_t kSeries>
+void DSPProfiler::LoadWindow<kSeries>::add(const float* values) {
+    for (uint32_t series = 0; series < kSeries; series++)
+        loads[series][position].store(values[series], std::memory_order_relaxed);
+    if (numBuffers < kWindowBuffers)
+        numBuffers++;
+    if (++position == kWindowBuffers)
+        position = 0;
+    count.store(numBuffers, std::memory_order_release);
+}
+
+template <uint32_t kSeries>
+void DSPProfiler::LoadWindow<kSeries>::getStatistics(uint32_t series, uint32_t numLoads,
+    DSPLoadStatistics& statistics) const {
+    if (numLoads == 0) {
+        statistics.min = statistics.mean = statistics.p99 = 0.0;
+        return;
+    }
+
+    // --- the audio thread may be storing the next buffer meanwhile; one buffer more or less does not matter
+    float sorted[kWindowBuffers];
+    double sum = 0.0;
+    for (uint32_t i = 0; i < numLoads; i++) {
+        sorted[i] = loads[series][i].load(std::memory_order_relaxed);
+        sum += sorted[i];
+    }
+    std::sort(sorted, sorted + numLoads);
+
+    // --- nearest rank
+    uint32_t p99Rank = (uint32_t)ceil(0.99 * numLoads);
+    statistics.min = sorted[0];
+    statistics.mean = sum / numLoads;
+    statistics.p99 = sorted[p99Rank - 1];
+}
+
+DSPProfiler::DSPProfiler() {
+    total.reset();
+    stages.reset();
+
+    calibrationStartTime = std::chrono::steady_clock::now();
+    calibrationStartTimestamp = readTimestamp();
+#if defined(SIMD_X86)
+    ticksPerSecond.store(0.0, std::memory_order_relaxed);
+    uint64_t timestamp;
+    do {
+        timestamp = readTimestamp();
+        calibrate(timestamp);
+    } while (ticksPerSecond.load(std::memory_order_relaxed) == 0.0);
+#elif defined(__aarch64__)
+    uint64_t frequency;
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(frequency));
+    ticksPerSecond.store((double)frequency, std::memory_order_relaxed);
+    calibrated = true;
+#else
+    ticksPerSecond.store(1.0e9, std::memory_order_relaxed);
+    calibrated = true;
+#endif
+}
+
+DSPProfiler::~DSPProfiler() {
+}
+
+void DSPProfiler::reset() {
+    total.reset();
+    stages.reset();
+    totalLoadSum = 0.0;
+    unlappedFrames = 0;
+}
+
+void DSPProfiler::calibrate(uint64_t timestamp) {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - calibrationStartTime).count();
+    if (seconds < kMinCalibrationTime)
+        return;
+
+    double rate = (timestamp - calibrationStartTimestamp) / seconds;
+    ticksPerSecond.store(rate, std::memory_order_relaxed);
+    nextCalibrationTimestamp = timestamp + (uint64_t)(kCalibrationInterval * rate);
+    calibrated = seconds >= kCalibrationTime;
+}
+
+void DSPProfiler::endBuffer(uint32_t numFrames, double sampleRate) {
+    uint64_t now = readTimestamp();
+    if (!calibrated && now >= nextCalibrationTimestamp)
+        calibrate(now);
+    if (numFrames == 0 || sampleRate <= 0.0)
+        return;
+
+    // --- ticks to % of the ticks the buffer's frames last in real time
+    double toLoad = 100.0 * sampleRate / (numFrames * ticksPerSecond.load(std::memory_order_relaxed));
+    float load = (float)((now - bufferStart) * toLoad);
+    if (total.numBuffers == kWindowBuffers)
+        totalLoadSum -= total.loads[0][total.position].load(std::memory_order_relaxed);
+    total.add(&load);
+    totalLoadSum += load;
+
+    // --- the running sum is summed again once per window so rounding can't build up
+    if (total.position == 0) {
+        totalLoadSum = 0.0;
+        for (uint32_t i = 0; i < total.numBuffers; i++)
+            totalLoadSum += total.loads[0][i].load(std::memory_order_relaxed);
+    }
+
+    if (lapping) {
+        float stageLoads[kNumDSPStages];
+        for (int stage = 0; stage < kNumDSPStages; stage++)
+            stageLoads[stage] = (float)(stageTicks[stage] * toLoad);
+        stages.add(stageLoads);
+    }
+}
+
+void DSPProfiler::getLoadInfo(DSPLoadInfo& info) const {
+    info.numBuffers = total.count.load(std::memory_order_acquire);
+    info.numLappedBuffers = stages.count.load(std::memory_order_acquire);
+    info.ticksPerSecond = ticksPerSecond.load(std::memory_order_relaxed);
+
+    total.getStatistics(0, info.numBuffers, info.total);
+    for (uint32_t stage = 0; stage < kNumDSPStages; stage++)
+        stages.getStatistics(stage, info.numLappedBuffers, info.stage[stage]);
+}
+
+#endif
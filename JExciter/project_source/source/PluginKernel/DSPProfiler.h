@@ -0,0 +1,173 @@
+//
+//  DSPProfiler.h
+//
+//  DSP load meter for development builds: timestamp counters around the processing stages, aggregated per buffer
+//  against the real-time budget of the buffer (its frames at the sample rate) over a rolling window.
+
+// Notes: nothing here is compiled unless DSP_PROFILING is set (-DDSP_PROFILING=1, the DSP_PROFILING option in the
+//        project CMakeLists.txt); otherwise the DSP_PROFILER_ macros expand to nothing and the class does not exist.
+//        The counters are the TSC on x86 (invariant on every CPU the SIMD kernels target), the virtual counter on
+//        AArch64 and steady_clock elsewhere; the TSC rate is calibrated against steady_clock, 2 ms at construction
+//        and refined until a second has passed.
+//        lap() charges the time since the previous lap (or beginBuffer) to a stage, so consecutive stages share one
+//        counter read. A read costs 7-25 ns: every buffer is timed (two reads, well under 0.1 % of a 64 frame
+//        buffer), but lapping every one would cost a few % of the DSP, so buffers are lapped on average kLapFrames
+//        apart. The gap is drawn from an LCG between kLapFrames / 2 and 3 * kLapFrames / 2, so the lapped buffers
+//        cannot lock to a period of the DSP (the linear phase crossover's FFT partition runs every 256 frames, in
+//        one buffer of four at 64 frames). The audio thread only stores the loads into the windows; getLoadInfo()
+//        sorts a copy on the reading (GUI) thread for min/mean/p99.
+
+#ifndef __DSPProfiler_h__
+#define __DSPProfiler_h__
+
+#ifndef DSP_PROFILING
+#define DSP_PROFILING 0
+#endif
+
+#if DSP_PROFILING
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include "SIMDSupport.h"
+#if defined(SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(SIMD_X86)
+#include <x86intrin.h>
+#endif
+
+enum DSPStage {
+    kCrossoverStage,    // silence checks, the band split
+    kSaturationStage,   // the waveshapers, oversampling and dry/wet delays
+    kMixStage,          // mix, meters, band sum, master volume, the output writes and skipped silent chunks
+    kParameterStage,    // snapshot sync, smoothing, cooking, outbound parameters and meters
+    kMidiStage,         // firing MIDI events and splitting chunks for them
+    kNumDSPStages
+};
+
+const char* getDSPStageName(DSPStage stage);
+
+// --- percentages of the real-time budget, over the buffers in the window
+struct DSPLoadStatistics {
+    double min;
+    double mean;
+    double p99;
+};
+
+// --- reply of PLUGIN_QUERY_DSPLOAD (outMessageData); the stages are all 0 on the frame path, which is not split
+struct DSPLoadInfo {
+    DSPLoadStatistics total;                    ///< the whole process call
+    DSPLoadStatistics stage[kNumDSPStages];
+    uint32_t numBuffers;                        ///< buffers in the window
+    uint32_t numLappedBuffers;                  ///< lapped buffers in the stage window
+    double ticksPerSecond;
+};
+
+class DSPProfiler {
+public:
+    enum { kWindowBuffers = 512, kLapFrames = 2048 };
+
+    DSPProfiler();
+    ~DSPProfiler();
+
+    // --- forget the window (reset()); the calibration carries on
+    void reset();
+
+    void beginBuffer(uint32_t numFrames) {
+        unlappedFrames += numFrames;
+        lapping = unlappedFrames >= lapFrames;
+        bufferStart = readTimestamp();
+        if (lapping) {
+            unlappedFrames = 0;
+            lapFrames = getNextLapFrames();
+            lastLap = bufferStart;
+            for (int stage = 0; stage < kNumDSPStages; stage++)
+                stageTicks[stage] = 0;
+        }
+    }
+
+    void lap(DSPStage stage) {
+        if (!lapping)
+            return;
+        uint64_t now = readTimestamp();
+        stageTicks[stage] += now - lastLap;
+        lastLap = now;
+    }
+
+    // --- a buffer's loads into the windows; numFrames / sampleRate is the budget
+    void endBuffer(uint32_t numFrames, double sampleRate);
+
+    // --- mean total load of the window, 0-100+ %; audio thread only
+    double getMeanLoad() const { return total.numBuffers > 0 ? totalLoadSum / total.numBuffers : 0.0; }
+
+    // --- any thread
+    void getLoadInfo(DSPLoadInfo& info) const;
+
+    static uint64_t readTimestamp() {
+#if defined(SIMD_X86)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t timestamp;
+        __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(timestamp));
+        return timestamp;
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+protected:
+    // --- per buffer loads, %; written by the audio thread, the order does not matter to the statistics
+    template <uint32_t kSeries>
+    struct LoadWindow {
+        std::atomic<float> loads[kSeries][kWindowBuffers];
+        std::atomic<uint32_t> count;
+        uint32_t position;
+        uint32_t numBuffers;
+
+        void reset();
+        void add(const float* values);
+        void getStatistics(uint32_t series, uint32_t numLoads, DSPLoadStatistics& statistics) const;
+    };
+
+    void calibrate(uint64_t timestamp);
+
+    // --- frames until the next lapped buffer, kLapFrames / 2 to 3 * kLapFrames / 2 (Numerical Recipes LCG)
+    uint32_t getNextLapFrames() {
+        lapRandom = lapRandom * 1664525u + 1013904223u;
+        return kLapFrames / 2 + (lapRandom >> 16) % kLapFrames;
+    }
+
+    uint64_t bufferStart = 0;
+    uint64_t lastLap = 0;
+    uint64_t stageTicks[kNumDSPStages] = {};
+    uint32_t unlappedFrames = 0;
+    uint32_t lapFrames = kLapFrames;
+    uint32_t lapRandom = 1;
+    bool lapping = false;
+
+    // --- counter rate; refined every kCalibrationInterval until calibrated
+    std::chrono::steady_clock::time_point calibrationStartTime;
+    uint64_t calibrationStartTimestamp = 0;
+    uint64_t nextCalibrationTimestamp = 0;
+    bool calibrated = false;
+    std::atomic<double> ticksPerSecond;
+
+    LoadWindow<1> total;
+    LoadWindow<kNumDSPStages> stages;
+    double totalLoadSum = 0.0;
+};
+
+#define DSP_PROFILER_BEGIN(profiler, numFrames) (profiler).beginBuffer(numFrames)
+#define DSP_PROFILER_LAP(profiler, stage) (profiler).lap(stage)
+#define DSP_PROFILER_END(profiler, numFrames, sampleRate) (profiler).endBuffer(numFrames, sampleRate)
+
+#else
+
+#define DSP_PROFILER_BEGIN(profiler, numFrames) ((void)0)
+#define DSP_PROFILER_LAP(profiler, stage) ((void)0)
+#define DSP_PROFILER_END(profiler, numFrames, sampleRate) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+//
+//  DenormalGuard.cpp
+//
+//  Scoped flush-to-zero for the process call, plus a software flush for CPUs where the mode can't be set.
+
+#include "DenormalGuard.h"
+#include "SIMDSupport.h"
+#include <string.h>
+
+// --- only checkFloatUnderflow is used; the rest of the header (and the filters.h tables) is not
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+#include "../../../fxobjects/fxobjects.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#ifdef SIMD_X86
+
+static const uint32_t kFlushToZero = 0x8000;        ///< MXCSR FTZ
+static const uint32_t kDenormalsAreZero = 0x0040;   ///< MXCSR DAZ
+
+SIMD_TARGET_SSE2 static uint64_t enableFlushToZero() {
+    uint32_t mode = _mm_getcsr();
+    _mm_setcsr(mode | kFlushToZero | kDenormalsAreZero);
+    return mode;
+}
+
+SIMD_TARGET_SSE2 static void restoreMode(uint64_t mode) {
+    _mm_setcsr((uint32_t)mode);
+}
+
+#elif defined(__aarch64__) && defined(__GNUC__)
+
+static const uint64_t kFlushToZero = 1ull << 24;    ///< FPCR FZ
+
+static uint64_t enableFlushToZero() {
+    uint64_t mode;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(mode));
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(mode | kFlushToZero));
+    return mode;
+}
+
+static void restoreMode(uint64_t mode) {
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(mode));
+}
+
+#define DENORMAL_GUARD_ARM64 1
+
+#endif
+
+DenormalGuard::DenormalGuard() {
+    savedMode = 0;
+#if defined(SIMD_X86) || defined(DENORMAL_GUARD_ARM64)
+    savedMode = enableFlushToZero();
+#endif
+}
+
+DenormalGuard::~DenormalGuard() {
+#if defined(SIMD_X86) || defined(DENORMAL_GUARD_ARM64)
+    restoreMode(savedMode);
+#endif
+}
+
+bool DenormalGuard::hasHardwareFlush() {
+#if defined(SIMD_X86) || defined(DENORMAL_GUARD_ARM64)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool flushDenormals(double* values, uint32_t count) {
+    bool flushed = false;
+    for (uint32_t i = 0; i < count; i++) {
+        if (checkFloatUnderflow(values[i]))
+            flushed = true;
+    }
+    return flushed;
+}
@@ -0,0 +1,32 @@
+//
+//  DenormalGuard.h
+//
+//  Scoped flush-to-zero for the process call, so decaying filter states never reach the slow denormal range,
+//  plus a software flush of those states for CPUs where the mode can't be set.
+
+// Notes: x86 sets FTZ and DAZ in MXCSR (all SSE/AVX arithmetic, float and double), AArch64 sets FZ in FPCR.
+//        The destructor restores the previous mode, so the host's own setting is left as it was.
+//        Elsewhere hasHardwareFlush() is false and the owners of recursive state call flushDenormals() on it
+//        once per block instead.
+
+#ifndef __DenormalGuard_h__
+#define __DenormalGuard_h__
+
+#include <stdint.h>
+
+class DenormalGuard {
+public:
+    DenormalGuard();
+    ~DenormalGuard();
+
+    static bool hasHardwareFlush();
+
+protected:
+    uint64_t savedMode;
+};
+
+// --- zeroes every value checkFloatUnderflow (fxobjects.h) would, i.e. anything smaller than the smallest
+//     normal float; returns true if any was flushed
+bool flushDenormals(double* values, uint32_t count);
+
+#endif
@@ -0,0 +1,255 @@
+//
+//  LevelMeter.cpp
+//
+//  Block rate peak and RMS measurement for the meters, run over whole band and output buffers.
+
+// Notes: the vector kernels run eight frames a step, two AVX2 or four SSE2 vectors of partial sums so the adds
+//        do not wait on each other; the frames past the last multiple of eight go through the scalar step with the
+//        same partial sums.
+
+#include "LevelMeter.h"
+
+// --- one frame into partial sum k; peaks are max |x|, which does not depend on the order
+static inline void measureStep(double x, int k, double& peak, double* acc) {
+    double magnitude = fabs(x);
+    if (magnitude > peak)
+        peak = magnitude;
+    acc[k] += x * x;
+}
+
+static inline void measureBandStep(double dry, double output, int k, double* peaks, double (*acc)[8]) {
+    measureStep(dry, k, peaks[0], acc[0]);
+    measureStep(output, k, peaks[1], acc[1]);
+    double difference = output - dry;
+    acc[2][k] += difference * difference;
+}
+
+static inline double reduce(const double* acc) {
+    return ((acc[0] + acc[4]) + (acc[1] + acc[5])) + ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+}
+
+static void measureScalar(const double* input, uint32_t numFrames, double& peak, double& sumOfSquares) {
+    double acc[8] = {};
+    for (uint32_t i = 0; i < numFrames; i++)
+        measureStep(input[i], i % 8, peak, acc);
+    sumOfSquares += reduce(acc);
+}
+
+static void measureBandScalar(const double* dry, const double* output, uint32_t numFrames, double* peaks,
+    double* sumsOfSquares) {
+    double acc[3][8] = {};
+    for (uint32_t i = 0; i < numFrames; i++)
+        measureBandStep(dry[i], output[i], i % 8, peaks, acc);
+    for (int m = 0; m < 3; m++)
+        sumsOfSquares[m] += reduce(acc[m]);
+}
+
+#ifdef SIMD_X86
+
+SIMD_TARGET_SSE2 static inline __m128d absSSE2(__m128d x) {
+    return _mm_andnot_pd(_mm_set1_pd(-0.0), x);
+}
+
+SIMD_TARGET_SSE2 static inline double maxSSE2(__m128d x) {
+    double s[2];
+    _mm_storeu_pd(s, x);
+    return s[0] > s[1] ? s[0] : s[1];
+}
+
+SIMD_TARGET_SSE2 static void measureSSE2(const double* input, uint32_t numFrames, double& peak, double& sumOfSquares) {
+    __m128d peaks[4];
+    __m128d acc[4];
+    for (int h = 0; h < 4; h++) {
+        peaks[h] = _mm_set1_pd(peak);
+        acc[h] = _mm_setzero_pd();
+    }
+
+    uint32_t i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        for (int h = 0; h < 4; h++) {
+            __m128d x = _mm_loadu_pd(&input[i + 2 * h]);
+            peaks[h] = _mm_max_pd(peaks[h], absSSE2(x));
+            acc[h] = _mm_add_pd(acc[h], _mm_mul_pd(x, x));
+        }
+    }
+
+    double sums[8];
+    for (int h = 0; h < 4; h++)
+        _mm_storeu_pd(&sums[2 * h], acc[h]);
+    peak = maxSSE2(_mm_max_pd(_mm_max_pd(peaks[0], peaks[1]), _mm_max_pd(peaks[2], peaks[3])));
+    for (; i < numFrames; i++)
+        measureStep(input[i], i % 8, peak, sums);
+    sumOfSquares += reduce(sums);
+}
+
+SIMD_TARGET_SSE2 static void measureBandSSE2(const double* dry, const double* output, uint32_t numFrames,
+    double* peaks, double* sumsOfSquares) {
+    __m128d dryPeak[4];
+    __m128d outputPeak[4];
+    __m128d acc[3][4];
+    for (int h = 0; h < 4; h++) {
+        dryPeak[h] = _mm_set1_pd(peaks[0]);
+        outputPeak[h] = _mm_set1_pd(peaks[1]);
+        for (int m = 0; m < 3; m++)
+            acc[m][h] = _mm_setzero_pd();
+    }
+
+    uint32_t i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        for (int h = 0; h < 4; h++) {
+            __m128d d = _mm_loadu_pd(&dry[i + 2 * h]);
+            __m128d o = _mm_loadu_pd(&output[i + 2 * h]);
+            __m128d difference = _mm_sub_pd(o, d);
+            dryPeak[h] = _mm_max_pd(dryPeak[h], absSSE2(d));
+            outputPeak[h] = _mm_max_pd(outputPeak[h], absSSE2(o));
+            acc[0][h] = _mm_add_pd(acc[0][h], _mm_mul_pd(d, d));
+            acc[1][h] = _mm_add_pd(acc[1][h], _mm_mul_pd(o, o));
+            acc[2][h] = _mm_add_pd(acc[2][h], _mm_mul_pd(difference, difference));
+        }
+    }
+
+    double sums[3][8];
+    for (int m = 0; m < 3; m++) {
+        for (int h = 0; h < 4; h++)
+            _mm_storeu_pd(&sums[m][2 * h], acc[m][h]);
+    }
+    peaks[0] = maxSSE2(_mm_max_pd(_mm_max_pd(dryPeak[0], dryPeak[1]), _mm_max_pd(dryPeak[2], dryPeak[3])));
+    peaks[1] = maxSSE2(_mm_max_pd(_mm_max_pd(outputPeak[0], outputPeak[1]), _mm_max_pd(outputPeak[2], outputPeak[3])));
+    for (; i < numFrames; i++)
+        measureBandStep(dry[i], output[i], i % 8, peaks, sums);
+    for (int m = 0; m < 3; m++)
+        sumsOfSquares[m] += reduce(sums[m]);
+}
+
+SIMD_TARGET_AVX2 static inline __m256d absAVX2(__m256d x) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+}
+
+SIMD_TARGET_AVX2 static inline double maxAVX2(__m256d x) {
+    double s[4];
+    _mm256_storeu_pd(s, x);
+    double a = s[0] > s[1] ? s[0] : s[1];
+    double b = s[2] > s[3] ? s[2] : s[3];
+    return a > b ? a : b;
+}
+
+SIMD_TARGET_AVX2 static void measureAVX2(const double* input, uint32_t numFrames, double& peak, double& sumOfSquares) {
+    __m256d peak0 = _mm256_set1_pd(peak);
+    __m256d peak1 = peak0;
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+
+    uint32_t i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        __m256d x0 = _mm256_loadu_pd(&input[i]);
+        __m256d x1 = _mm256_loadu_pd(&input[i + 4]);
+        peak0 = _mm256_max_pd(peak0, absAVX2(x0));
+        peak1 = _mm256_max_pd(peak1, absAVX2(x1));
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(x0, x0));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(x1, x1));
+    }
+
+    double sums[8];
+    _mm256_storeu_pd(&sums[0], acc0);
+    _mm256_storeu_pd(&sums[4], acc1);
+    peak = maxAVX2(_mm256_max_pd(peak0, peak1));
+    for (; i < numFrames; i++)
+        measureStep(input[i], i % 8, peak, sums);
+    sumOfSquares += reduce(sums);
+}
+
+SIMD_TARGET_AVX2 static void measureBandAVX2(const double* dry, const double* output, uint32_t numFrames,
+    double* peaks, double* sumsOfSquares) {
+    __m256d dryPeak[2];
+    __m256d outputPeak[2];
+    __m256d acc[3][2];
+    for (int h = 0; h < 2; h++) {
+        dryPeak[h] = _mm256_set1_pd(peaks[0]);
+        outputPeak[h] = _mm256_set1_pd(peaks[1]);
+        for (int m = 0; m < 3; m++)
+            acc[m][h] = _mm256_setzero_pd();
+    }
+
+    uint32_t i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        for (int h = 0; h < 2; h++) {
+            __m256d d = _mm256_loadu_pd(&dry[i + 4 * h]);
+            __m256d o = _mm256_loadu_pd(&output[i + 4 * h]);
+            __m256d difference = _mm256_sub_pd(o, d);
+            dryPeak[h] = _mm256_max_pd(dryPeak[h], absAVX2(d));
+            outputPeak[h] = _mm256_max_pd(outputPeak[h], absAVX2(o));
+            acc[0][h] = _mm256_add_pd(acc[0][h], _mm256_mul_pd(d, d));
+            acc[1][h] = _mm256_add_pd(acc[1][h], _mm256_mul_pd(o, o));
+            acc[2][h] = _mm256_add_pd(acc[2][h], _mm256_mul_pd(difference, difference));
+        }
+    }
+
+    double sums[3][8];
+    for (int m = 0; m < 3; m++) {
+        _mm256_storeu_pd(&sums[m][0], acc[m][0]);
+        _mm256_storeu_pd(&sums[m][4], acc[m][1]);
+    }
+    peaks[0] = maxAVX2(_mm256_max_pd(dryPeak[0], dryPeak[1]));
+    peaks[1] = maxAVX2(_mm256_max_pd(outputPeak[0], outputPeak[1]));
+    for (; i < numFrames; i++)
+        measureBandStep(dry[i], output[i], i % 8, peaks, sums);
+    for (int m = 0; m < 3; m++)
+        sumsOfSquares[m] += reduce(sums[m]);
+}
+
+#endif
+
+LevelMeter::LevelMeter() {
+    kernel = kScalarKernel;
+    measureFunction = measureScalar;
+    bandFunction = measureBandScalar;
+    setKernel(getBestSIMDKernel());
+}
+
+LevelMeter::~LevelMeter() {
+}
+
+void LevelMeter::measure(const double* input, uint32_t numFrames, LevelMeasurement& level) const {
+    measureFunction(input, numFrames, level.peak, level.sumOfSquares);
+    level.numSamples += numFrames;
+}
+
+void LevelMeter::measureBand(const double* dry, const double* output, uint32_t numFrames, LevelMeasurement& dryLevel,
+    LevelMeasurement& outputLevel, LevelMeasurement& differenceLevel) const {
+    double peaks[2] = { dryLevel.peak, outputLevel.peak };
+    double sumsOfSquares[3] = { dryLevel.sumOfSquares, outputLevel.sumOfSquares, differenceLevel.sumOfSquares };
+    bandFunction(dry, output, numFrames, peaks, sumsOfSquares);
+
+    dryLevel.peak = peaks[0];
+    outputLevel.peak = peaks[1];
+    dryLevel.sumOfSquares = sumsOfSquares[0];
+    outputLevel.sumOfSquares = sumsOfSquares[1];
+    differenceLevel.sumOfSquares = sumsOfSquares[2];
+    dryLevel.numSamples += numFrames;
+    outputLevel.numSamples += numFrames;
+    differenceLevel.numSamples += numFrames;
+}
+
+bool LevelMeter::setKernel(SIMDKernel kernel) {
+    if (!isSIMDKernelSupported(kernel))
+        return false;
+
+    this->kernel = kernel;
+    switch (kernel) {
+#ifdef SIMD_X86
+    case kSSE2Kernel:
+        measureFunction = measureSSE2;
+        bandFunction = measureBandSSE2;
+        break;
+    case kAVX2Kernel:
+        measureFunction = measureAVX2;
+        bandFunction = measureBandAVX2;
+        break;
+#endif
+    default:
+        measureFunction = measureScalar;
+        bandFunction = measureBandScalar;
+        break;
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+//
+//  LevelMeter.h
+//
+//  Block rate peak and RMS measurement for the meters, run over whole band and output buffers.
+
+// Notes: a LevelMeasurement collects from its last reset() until it is read, normally once per host buffer;
+//        buffers of several channels measured into one are power averaged. Sums of squares keep 8 partial sums,
+//        acc[i % 8], reduced in the same pairs on every kernel, so the scalar, SSE2 and AVX2 kernels agree bit
+//        for bit; measureSample() (the frame path) adds in order, a few ulps away. The audio is only read.
+//        The kernel is picked at construction, see SIMDSupport.h.
+
+#ifndef __LevelMeter_h__
+#define __LevelMeter_h__
+
+#include <stdint.h>
+#include <math.h>
+#include "SIMDSupport.h"
+
+struct LevelMeasurement {
+    double peak;            ///< max |x|
+    double sumOfSquares;
+    uint64_t numSamples;
+
+    void reset() { peak = 0.0; sumOfSquares = 0.0; numSamples = 0; }
+
+    // --- frames that were not measured (skipped as silence, a muted band) count as zeros
+    void addSilence(uint32_t numFrames) { numSamples += numFrames; }
+
+    // --- the frame path, one sample at a time
+    void measureSample(double x) {
+        double magnitude = fabs(x);
+        if (magnitude > peak)
+            peak = magnitude;
+        sumOfSquares += x * x;
+        numSamples++;
+    }
+
+    double getPeak() const { return peak; }
+    double getRMS() const { return numSamples > 0 ? sqrt(sumOfSquares / numSamples) : 0.0; }
+};
+
+class LevelMeter {
+public:
+    LevelMeter();
+    ~LevelMeter();
+
+    // --- peak and sum of squares of one buffer, added to level
+    void measure(const double* input, uint32_t numFrames, LevelMeasurement& level) const;
+
+    // --- one pass over a band: the dry input, the output, and output - dry (what the band added; its peak is not
+    //     measured)
+    void measureBand(const double* dry, const double* output, uint32_t numFrames, LevelMeasurement& dryLevel,
+        LevelMeasurement& outputLevel, LevelMeasurement& differenceLevel) const;
+
+    bool setKernel(SIMDKernel kernel);
+    SIMDKernel getKernel() const { return kernel; }
+
+protected:
+    typedef void (*MeasureFunction)(const double* input, uint32_t numFrames, double& peak, double& sumOfSquares);
+    typedef void (*BandFunction)(const double* dry, const double* output, uint32_t numFrames, double* peaks,
+        double* sumsOfSquares);
+
+    SIMDKernel kernel;
+    MeasureFunction measureFunction;
+    BandFunction bandFunction;
+};
+
+#endif
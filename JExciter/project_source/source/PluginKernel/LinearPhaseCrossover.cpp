@@ -0,0 +1,620 @@
+//
+//  LinearPhaseCrossover.cpp
+//
+//  4 band linear phase FIR crossover run as a uniformly partitioned FFT convolution (overlap-save).
+
+// Notes: partition p of each band FIR is zero padded to 2 * partitionFrames and transformed once per design.
+//        Each partition the newest 2 * partitionFrames inputs are transformed once per channel, and a band is the
+//        inverse FFT of the sum over p of (input spectrum p partitions ago) * (FIR partition p); its last
+//        partitionFrames samples are the linear convolution. The sums run p = 0, 1, ... on every kernel and
+//        each bin is (x.re * h.re - x.im * h.im, x.re * h.im + x.im * h.re) with no fma, so they agree bit for bit.
+
+#include "LinearPhaseCrossover.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <string.h>
+
+// --- only calculateBrickwallMagArray is used; the rest of the header (and the filters.h tables) is not
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+#include "../../../fxobjects/fxobjects.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+RealFFT::RealFFT() {
+    size = 0;
+}
+
+RealFFT::~RealFFT() {
+}
+
+bool RealFFT::setSize(uint32_t size) {
+    if (size < 4 || (size & (size - 1)) != 0)
+        return false;
+    if (size == this->size)
+        return true;
+
+    this->size = size;
+    uint32_t half = size / 2;
+
+    // --- the twiddles of each stage in a row: a stage with span s starts at s - 1
+    twiddleCos.resize(half);
+    twiddleSin.resize(half);
+    for (uint32_t span = 1; span < half; span <<= 1) {
+        for (uint32_t j = 0; j < span; j++) {
+            twiddleCos[span - 1 + j] = cos(kPi * j / span);
+            twiddleSin[span - 1 + j] = sin(kPi * j / span);
+        }
+    }
+
+    splitCos.resize(half + 1);
+    splitSin.resize(half + 1);
+    for (uint32_t k = 0; k <= half; k++) {
+        splitCos[k] = cos(2.0 * kPi * k / size);
+        splitSin[k] = sin(2.0 * kPi * k / size);
+    }
+
+    uint32_t bits = 0;
+    while ((1u << bits) < half)
+        bits++;
+    bitReverse.resize(half);
+    for (uint32_t i = 0; i < half; i++) {
+        uint32_t reversed = 0;
+        for (uint32_t bit = 0; bit < bits; bit++)
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        bitReverse[i] = reversed;
+    }
+
+    workRe.resize(half);
+    workIm.resize(half);
+    return true;
+}
+
+// --- in place radix-2 decimation in time over size / 2 points; forward is e^-i, inverse e^+i and unscaled
+template <bool kInverse>
+void RealFFT::transform(double* re, double* im) {
+    uint32_t half = size / 2;
+    for (uint32_t i = 0; i < half; i++) {
+        uint32_t j = bitReverse[i];
+        if (j > i) {
+            double t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+
+    for (uint32_t span = 1; span < half; span <<= 1) {
+        const double* stageCos = &twiddleCos[span - 1];
+        const double* stageSin = &twiddleSin[span - 1];
+        for (uint32_t start = 0; start < half; start += 2 * span) {
+            for (uint32_t j = 0; j < span; j++) {
+                double wr = stageCos[j];
+                double wi = kInverse ? stageSin[j] : -stageSin[j];
+                uint32_t a = start + j;
+                uint32_t b = a + span;
+                double tr = re[b] * wr - im[b] * wi;
+                double ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+// --- z[n] = x[2n] + i x[2n + 1]; X[k] = E[k] + W^k O[k] with E, O the even and odd spectra taken apart from Z
+void RealFFT::forward(const double* input, double* re, double* im) {
+    uint32_t half = size / 2;
+    for (uint32_t n = 0; n < half; n++) {
+        workRe[n] = input[2 * n];
+        workIm[n] = input[2 * n + 1];
+    }
+    transform<false>(workRe.data(), workIm.data());
+
+    for (uint32_t k = 0; k <= half; k++) {
+        uint32_t a = k == half ? 0 : k;
+        uint32_t b = k == 0 ? 0 : half - k;
+        double evenRe = 0.5 * (workRe[a] + workRe[b]);
+        double evenIm = 0.5 * (workIm[a] - workIm[b]);
+        double oddRe = 0.5 * (workIm[a] + workIm[b]);
+        double oddIm = -0.5 * (workRe[a] - workRe[b]);
+        re[k] = evenRe + splitCos[k] * oddRe + splitSin[k] * oddIm;
+        im[k] = evenIm + splitCos[k] * oddIm - splitSin[k] * oddRe;
+    }
+}
+
+void RealFFT::inverse(const double* re, const double* im, double* output) {
+    uint32_t half = size / 2;
+    for (uint32_t k = 0; k < half; k++) {
+        double evenRe = 0.5 * (re[k] + re[half - k]);
+        double evenIm = 0.5 * (im[k] - im[half - k]);
+        double diffRe = 0.5 * (re[k] - re[half - k]);
+        double diffIm = 0.5 * (im[k] + im[half - k]);
+        double oddRe = diffRe * splitCos[k] - diffIm * splitSin[k];
+        double oddIm = diffRe * splitSin[k] + diffIm * splitCos[k];
+        workRe[k] = evenRe - oddIm;
+        workIm[k] = evenIm + oddRe;
+    }
+    transform<true>(workRe.data(), workIm.data());
+
+    double scale = 1.0 / half;
+    for (uint32_t n = 0; n < half; n++) {
+        output[2 * n] = workRe[n] * scale;
+        output[2 * n + 1] = workIm[n] * scale;
+    }
+}
+
+static void multiplyAccumulateScalar(const double* xRe, const double* xIm, const double* hRe, const double* hIm,
+                                     double* yRe, double* yIm, uint32_t numBins) {
+    for (uint32_t k = 0; k < numBins; k++) {
+        yRe[k] += xRe[k] * hRe[k] - xIm[k] * hIm[k];
+        yIm[k] += xRe[k] * hIm[k] + xIm[k] * hRe[k];
+    }
+}
+
+#ifdef SIMD_X86
+
+SIMD_TARGET_SSE2 static void multiplyAccumulateSSE2(const double* xRe, const double* xIm, const double* hRe,
+                                                    const double* hIm, double* yRe, double* yIm, uint32_t numBins) {
+    uint32_t k = 0;
+    for (; k + 2 <= numBins; k += 2) {
+        __m128d xr = _mm_loadu_pd(&xRe[k]);
+        __m128d xi = _mm_loadu_pd(&xIm[k]);
+        __m128d hr = _mm_loadu_pd(&hRe[k]);
+        __m128d hi = _mm_loadu_pd(&hIm[k]);
+        __m128d re = _mm_sub_pd(_mm_mul_pd(xr, hr), _mm_mul_pd(xi, hi));
+        __m128d im = _mm_add_pd(_mm_mul_pd(xr, hi), _mm_mul_pd(xi, hr));
+        _mm_storeu_pd(&yRe[k], _mm_add_pd(_mm_loadu_pd(&yRe[k]), re));
+        _mm_storeu_pd(&yIm[k], _mm_add_pd(_mm_loadu_pd(&yIm[k]), im));
+    }
+    multiplyAccumulateScalar(&xRe[k], &xIm[k], &hRe[k], &hIm[k], &yRe[k], &yIm[k], numBins - k);
+}
+
+SIMD_TARGET_AVX2 static void multiplyAccumulateAVX2(const double* xRe, const double* xIm, const double* hRe,
+                                                    const double* hIm, double* yRe, double* yIm, uint32_t numBins) {
+    uint32_t k = 0;
+    for (; k + 4 <= numBins; k += 4) {
+        __m256d xr = _mm256_loadu_pd(&xRe[k]);
+        __m256d xi = _mm256_loadu_pd(&xIm[k]);
+        __m256d hr = _mm256_loadu_pd(&hRe[k]);
+        __m256d hi = _mm256_loadu_pd(&hIm[k]);
+        __m256d re = _mm256_sub_pd(_mm256_mul_pd(xr, hr), _mm256_mul_pd(xi, hi));
+        __m256d im = _mm256_add_pd(_mm256_mul_pd(xr, hi), _mm256_mul_pd(xi, hr));
+        _mm256_storeu_pd(&yRe[k], _mm256_add_pd(_mm256_loadu_pd(&yRe[k]), re));
+        _mm256_storeu_pd(&yIm[k], _mm256_add_pd(_mm256_loadu_pd(&yIm[k]), im));
+    }
+    multiplyAccumulateScalar(&xRe[k], &xIm[k], &hRe[k], &hIm[k], &yRe[k], &yIm[k], numBins - k);
+}
+
+#endif
+
+LinearPhaseCrossover::LinearPhaseCrossover() {
+    sampleRate = 0.0;
+    designSize = 0;
+    numTaps = 0;
+    partitionFrames = 0;
+    numBins = 0;
+    numChannels = 0;
+    crossoverFc[0] = 100.0;
+    crossoverFc[1] = 1000.0;
+    crossoverFc[2] = 10000.0;
+    crossoverChanged = false;
+    activeSet = 0;
+    spareSet = 1;
+    designPosted = false;
+    partitionCount = 0;
+    handoverPartition = 0;
+    for (uint32_t crossover = 0; crossover < kNumFIRBands; crossover++)
+        postedFc[crossover].store(crossoverFc[crossover], std::memory_order_relaxed);
+    designsPosted.store(0, std::memory_order_relaxed);
+    designsDone.store(0, std::memory_order_relaxed);
+    stopDesign = false;
+    backgroundDesign = false;
+    spectrumIndex = 0;
+    historyIndex = 0;
+    fill = 0;
+    kernel = kScalarKernel;
+    multiplyAccumulate = multiplyAccumulateScalar;
+    setKernel(getBestSIMDKernel());
+    setSampleRate(44100.0);
+}
+
+LinearPhaseCrossover::~LinearPhaseCrossover() {
+    stopDesignThread();
+}
+
+// --- about 11 Hz of resolution at any rate: 4096 at 44.1/48k, 8192 at 88.2/96k, 16384 above
+uint32_t LinearPhaseCrossover::getDesignSize(double sampleRate) {
+    if (sampleRate <= 50000.0)
+        return 4096;
+    if (sampleRate <= 100000.0)
+        return 8192;
+    return 16384;
+}
+
+uint32_t LinearPhaseCrossover::getLatency(double sampleRate) {
+    uint32_t size = getDesignSize(sampleRate);
+    return size / kNumPartitions + (size - 2) / 2;
+}
+
+bool LinearPhaseCrossover::setSampleRate(double sampleRate) {
+    if (sampleRate <= 0.0)
+        return false;
+
+    stopDesignThread();
+    this->sampleRate = sampleRate;
+    designSize = getDesignSize(sampleRate);
+    numTaps = designSize - 1;
+    partitionFrames = designSize / kNumPartitions;
+    numBins = partitionFrames + 1;
+
+    designFFT.setSize(designSize);
+    designPartitionFFT.setSize(2 * partitionFrames);
+    partitionFFT.setSize(2 * partitionFrames);
+
+    filterSpectra.assign(kNumSets * kNumFIRBands * kNumPartitions * 2 * numBins, 0.0);
+    lowpass.assign(kNumFIRBands * numTaps, 0.0);
+    impulse.assign(designSize, 0.0);
+    designRe.assign(designSize / 2 + 1, 0.0);
+    designIm.assign(designSize / 2 + 1, 0.0);
+    partitionTaps.assign(2 * partitionFrames, 0.0);
+    sumRe.assign(numBins, 0.0);
+    sumIm.assign(numBins, 0.0);
+    convolved.assign(2 * partitionFrames, 0.0);
+    fadeOutput.assign(partitionFrames, 0.0);
+
+    // --- Blackman; the centre tap is exactly 1
+    window.resize(numTaps);
+    for (uint32_t n = 0; n < numTaps; n++) {
+        double phase = 2.0 * kPi * n / (numTaps - 1);
+        window[n] = 0.42 - 0.5 * cos(phase) + 0.08 * cos(2.0 * phase);
+    }
+
+    uint32_t channels = numChannels;
+    numChannels = 0;
+    setChannels(channels);
+
+    // --- the sets start over: a design in flight was for the old rate
+    activeSet = 0;
+    spareSet = 1;
+    designPosted = false;
+    designsDone.store(designsPosted.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    partitionCount = 0;
+    design(activeSet, crossoverFc);
+    crossoverChanged = false;
+    if (backgroundDesign)
+        startDesignThread();
+    return true;
+}
+
+void LinearPhaseCrossover::setBackgroundDesign(bool enable) {
+    backgroundDesign = enable;
+    if (enable && !designThread.joinable())
+        startDesignThread();
+    else if (!enable)
+        stopDesignThread();
+}
+
+bool LinearPhaseCrossover::setChannels(uint32_t numChannels) {
+    if (numChannels != this->numChannels) {
+        this->numChannels = numChannels;
+        inputBlock.resize(numChannels * 2 * partitionFrames);
+        inputSpectra.resize(numChannels * kNumPartitions * 2 * numBins);
+        history.resize(numChannels * designSize);
+        bandOutput.resize(numChannels * kNumBands * partitionFrames);
+    }
+    clear();
+    return true;
+}
+
+uint32_t LinearPhaseCrossover::getAllocatedChannels() const {
+    if (partitionFrames == 0)
+        return numChannels;
+    size_t channels = std::min(std::min(inputBlock.capacity() / (2 * partitionFrames),
+        inputSpectra.capacity() / (kNumPartitions * 2 * numBins)),
+        std::min(history.capacity() / designSize, bandOutput.capacity() / (kNumBands * partitionFrames)));
+    return (uint32_t)channels;
+}
+
+void LinearPhaseCrossover::setCrossover(double lowMidFc, double midHighFc, double highTrebleFc, bool crossfade) {
+    bool changed = lowMidFc != crossoverFc[0] || midHighFc != crossoverFc[1] || highTrebleFc != crossoverFc[2];
+    if (!changed && (crossfade || (!crossoverChanged && !designPosted)))
+        return;
+
+    crossoverFc[0] = lowMidFc;
+    crossoverFc[1] = midHighFc;
+    crossoverFc[2] = highTrebleFc;
+    crossoverChanged = true;
+    if (crossfade)
+        return;
+
+    // --- a design still on its way is older than this one, so it is dropped
+    if (designPosted) {
+        finishDesign();
+        designPosted = false;
+    }
+    design(activeSet, crossoverFc);
+    crossoverChanged = false;
+}
+
+void LinearPhaseCrossover::startDesignThread() {
+    stopDesign = false;
+    designThread = std::thread(&LinearPhaseCrossover::runDesignThread, this);
+}
+
+void LinearPhaseCrossover::stopDesignThread() {
+    if (!designThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(designMutex);
+        stopDesign = true;
+    }
+    designWake.notify_one();
+    designThread.join();
+}
+
+/**
+\brief the design thread: sleeps on designWake until a design is posted, designs it into the spare set and
+       raises designsDone
+*/
+void LinearPhaseCrossover::runDesignThread() {
+    std::unique_lock<std::mutex> lock(designMutex);
+    while (!stopDesign) {
+        uint32_t posted = designsPosted.load(std::memory_order_acquire);
+        if (posted == designsDone.load(std::memory_order_relaxed)) {
+            designWake.wait(lock);
+            continue;
+        }
+
+        double fc[kNumFIRBands];
+        for (uint32_t crossover = 0; crossover < kNumFIRBands; crossover++)
+            fc[crossover] = postedFc[crossover].load(std::memory_order_relaxed);
+        design(spareSet, fc);
+        designsDone.store(posted, std::memory_order_release);
+    }
+}
+
+/**
+\brief audio thread: post the newest frequencies as a design into the spare set, to take over kHandoverPartitions
+       partitions from now. notify_one does not block; it is not made under the mutex, so a wake can be missed
+       while the thread is about to sleep, and finishDesign wakes it again if so
+*/
+void LinearPhaseCrossover::postDesign() {
+    for (uint32_t crossover = 0; crossover < kNumFIRBands; crossover++)
+        postedFc[crossover].store(crossoverFc[crossover], std::memory_order_relaxed);
+    designsPosted.fetch_add(1, std::memory_order_release);
+    if (designThread.joinable())
+        designWake.notify_one();
+
+    designPosted = true;
+    handoverPartition = partitionCount + kHandoverPartitions;
+    crossoverChanged = false;
+}
+
+/**
+\brief the posted design is needed now: wait for the design thread to finish it, or design it here without one
+*/
+void LinearPhaseCrossover::finishDesign() {
+    uint32_t posted = designsPosted.load(std::memory_order_relaxed);
+    if (designsDone.load(std::memory_order_acquire) == posted)
+        return;
+
+    if (designThread.joinable()) {
+        while (designsDone.load(std::memory_order_acquire) != posted) {
+            designWake.notify_one();
+            std::this_thread::yield();
+        }
+        return;
+    }
+
+    double fc[kNumFIRBands];
+    for (uint32_t crossover = 0; crossover < kNumFIRBands; crossover++)
+        fc[crossover] = postedFc[crossover].load(std::memory_order_relaxed);
+    design(spareSet, fc);
+    designsDone.store(posted, std::memory_order_relaxed);
+}
+
+void LinearPhaseCrossover::clear() {
+    std::fill(inputBlock.begin(), inputBlock.end(), 0.0);
+    std::fill(inputSpectra.begin(), inputSpectra.end(), 0.0);
+    std::fill(history.begin(), history.end(), 0.0);
+    std::fill(bandOutput.begin(), bandOutput.end(), 0.0);
+    spectrumIndex = 0;
+    historyIndex = 0;
+    fill = 0;
+}
+
+/**
+\brief design the three band FIRs for fc into filter set 'set' and transform their partitions; the design thread
+       uses the design buffers while a design is posted, everyone else only while none is
+
+\param set 0 or 1
+\param fc the three crossover frequencies
+*/
+void LinearPhaseCrossover::design(uint32_t set, const double* fc) {
+    uint32_t half = designSize / 2;
+    uint32_t centre = (numTaps - 1) / 2;
+    double bin1 = sampleRate / designSize;
+    double nyquist = 0.5 * sampleRate;
+
+    BrickwallMagData magData;
+    magData.filterType = brickwallFilter::kBrickLPF;
+    magData.magArray = designRe.data();
+    magData.dftArrayLen = half;
+    magData.sampleRate = sampleRate;
+    magData.mirrorMag = false;
+
+    for (uint32_t crossover = 0; crossover < kNumFIRBands; crossover++) {
+        // --- a linear transition from fc / 2 to 3 fc / 2 (narrower near Nyquist), at least two bins
+        double edge = fmin(fmax(fc[crossover], bin1), nyquist - 2.0 * bin1);
+        double width = fmin(edge, 2.0 * (nyquist - edge));
+        uint32_t relaxationBins = (uint32_t)(width / bin1 + 0.5);
+        if (relaxationBins < 2)
+            relaxationBins = 2;
+        magData.fc = fmax(edge - 0.5 * relaxationBins * bin1, 0.0);
+        magData.relaxationBins = relaxationBins;
+        calculateBrickwallMagArray(magData);
+        designRe[half] = 0.0;
+        std::fill(designIm.begin(), designIm.end(), 0.0);
+
+        // --- zero phase impulse, rotated to the centre tap and windowed
+        designFFT.inverse(designRe.data(), designIm.data(), impulse.data());
+        double* taps = &lowpass[crossover * numTaps];
+        for (uint32_t n = 0; n < numTaps; n++)
+            taps[n] = impulse[(n + designSize - centre) & (designSize - 1)] * window[n];
+    }
+
+    for (uint32_t band = 0; band < kNumFIRBands; band++) {
+        const double* upper = &lowpass[band * numTaps];
+        const double* lower = band > 0 ? &lowpass[(band - 1) * numTaps] : nullptr;
+        for (uint32_t partition = 0; partition < kNumPartitions; partition++) {
+            std::fill(partitionTaps.begin(), partitionTaps.end(), 0.0);
+            for (uint32_t i = 0; i < partitionFrames; i++) {
+                uint32_t n = partition * partitionFrames + i;
+                if (n < numTaps)
+                    partitionTaps[i] = lower ? upper[n] - lower[n] : upper[n];
+            }
+            designPartitionFFT.forward(partitionTaps.data(), spectrum(set, band, partition, 0),
+                                       spectrum(set, band, partition, 1));
+        }
+    }
+}
+
+/**
+\brief one band of one channel for the newest partition: sum the partition products and transform back
+
+\param channel channel index
+\param set filter set
+\param band 0 - 2
+\param output partitionFrames samples
+*/
+void LinearPhaseCrossover::convolveBand(uint32_t channel, uint32_t set, uint32_t band, double* output) {
+    std::fill(sumRe.begin(), sumRe.end(), 0.0);
+    std::fill(sumIm.begin(), sumIm.end(), 0.0);
+
+    for (uint32_t partition = 0; partition < kNumPartitions; partition++) {
+        uint32_t slot = (spectrumIndex + kNumPartitions - partition) % kNumPartitions;
+        const double* input = &inputSpectra[(channel * kNumPartitions + slot) * 2 * numBins];
+        multiplyAccumulate(input, input + numBins, spectrum(set, band, partition, 0),
+                           spectrum(set, band, partition, 1), sumRe.data(), sumIm.data(), numBins);
+    }
+
+    partitionFFT.inverse(sumRe.data(), sumIm.data(), convolved.data());
+    memcpy(output, &convolved[partitionFrames], partitionFrames * sizeof(double));
+}
+
+// --- a full partition of input is in: transform it, convolve the bands and take the treble from the delayed input
+void LinearPhaseCrossover::processPartition() {
+    // --- the posted design's handover partition: fade to its set over this partition
+    bool fading = designPosted && partitionCount == handoverPartition;
+    if (fading)
+        finishDesign();
+
+    uint32_t centre = (numTaps - 1) / 2;
+    uint32_t historyMask = designSize - 1;
+
+    for (uint32_t channel = 0; channel < numChannels; channel++) {
+        double* block = &inputBlock[channel * 2 * partitionFrames];
+        double* spectra = &inputSpectra[(channel * kNumPartitions + spectrumIndex) * 2 * numBins];
+        partitionFFT.forward(block, spectra, spectra + numBins);
+
+        double* channelHistory = &history[channel * designSize];
+        for (uint32_t i = 0; i < partitionFrames; i++)
+            channelHistory[(historyIndex + i) & historyMask] = block[partitionFrames + i];
+        memcpy(block, block + partitionFrames, partitionFrames * sizeof(double));
+
+        double* output = &bandOutput[channel * kNumBands * partitionFrames];
+        for (uint32_t band = 0; band < kNumFIRBands; band++) {
+            double* bandData = output + band * partitionFrames;
+            convolveBand(channel, activeSet, band, bandData);
+            if (fading) {
+                convolveBand(channel, spareSet, band, fadeOutput.data());
+                for (uint32_t i = 0; i < partitionFrames; i++)
+                    bandData[i] += (fadeOutput[i] - bandData[i]) * (double)(i + 1) / partitionFrames;
+            }
+        }
+
+        double* treble = output + kNumFIRBands * partitionFrames;
+        for (uint32_t i = 0; i < partitionFrames; i++) {
+            double delayed = channelHistory[(historyIndex + i - centre) & historyMask];
+            treble[i] = delayed - output[i] - output[partitionFrames + i] - output[2 * partitionFrames + i];
+        }
+    }
+
+    historyIndex = (historyIndex + partitionFrames) & historyMask;
+    spectrumIndex = (spectrumIndex + 1) % kNumPartitions;
+    partitionCount++;
+    if (fading) {
+        std::swap(activeSet, spareSet);
+        designPosted = false;
+    }
+
+    if (crossoverChanged && !designPosted)
+        postDesign();
+}
+
+/**
+\brief split numFrames of every channel; each band lags the input by getLatency() samples
+
+\param inputs numChannels input buffers
+\param bands bands[channel][band] output buffers
+\param numFrames any number of frames
+*/
+template <typename SampleType>
+void LinearPhaseCrossover::processBlock(const SampleType* const* inputs, double* const* const* bands, uint32_t numFrames) {
+    for (uint32_t done = 0, n = 0; done < numFrames; done += n) {
+        n = partitionFrames - fill;
+        if (n > numFrames - done)
+            n = numFrames - done;
+
+        for (uint32_t channel = 0; channel < numChannels; channel++) {
+            double* block = &inputBlock[(channel * 2 + 1) * partitionFrames + fill];
+            const SampleType* input = inputs[channel] + done;
+            for (uint32_t i = 0; i < n; i++)
+                block[i] = input[i];
+
+            const double* output = &bandOutput[channel * kNumBands * partitionFrames + fill];
+            for (uint32_t band = 0; band < kNumBands; band++)
+                memcpy(bands[channel][band] + done, output + band * partitionFrames, n * sizeof(double));
+        }
+
+        fill += n;
+        if (fill == partitionFrames) {
+            processPartition();
+            fill = 0;
+        }
+    }
+}
+
+template void LinearPhaseCrossover::processBlock<float>(const float* const* inputs, double* const* const* bands, uint32_t numFrames);
+template void LinearPhaseCrossover::processBlock<double>(const double* const* inputs, double* const* const* bands, uint32_t numFrames);
+
+bool LinearPhaseCrossover::setKernel(SIMDKernel kernel) {
+    if (!isSIMDKernelSupported(kernel))
+        return false;
+
+    this->kernel = kernel;
+    switch (kernel) {
+#ifdef SIMD_X86
+    case kSSE2Kernel:
+        multiplyAccumulate = multiplyAccumulateSSE2;
+        break;
+    case kAVX2Kernel:
+        multiplyAccumulate = multiplyAccumulateAVX2;
+        break;
+#endif
+    default:
+        multiplyAccumulate = multiplyAccumulateScalar;
+        break;
+    }
+    return true;
+}
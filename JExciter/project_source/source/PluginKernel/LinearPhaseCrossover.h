@@ -0,0 +1,182 @@
+//
+//  LinearPhaseCrossover.h
+//
+//  4 band linear phase FIR crossover run as a uniformly partitioned FFT convolution (overlap-save).
+//  The bands share each channel's forward FFT and sum back to the input delayed by getLatency() samples.
+
+// Notes: the three lowpass FIRs are frequency sampled from calculateBrickwallMagArray (fxobjects.h) with a
+//        transition about one octave wide centred on each crossover (the same design as freqSample, but through
+//        the FFT; freqSample is O(N^2)) and Blackman windowed. Low = LP1, LowMid = LP2 - LP1,
+//        HighMid = LP3 - LP2, and Treble is the delayed input minus the other three, so the bands are exactly
+//        complementary and only three spectral multiplies and inverse FFTs are needed per partition.
+//        The FIRs are 4095 taps at 44.1/48k, doubling per rate octave, cut into 16 partitions of 1/16 of the
+//        design size (256 samples at 48k). Latency = one partition + (taps - 1) / 2, about 48 ms at every rate.
+//        The FFT is a plain radix-2 real transform, so nothing depends on FFTW (fxobjects' FastConvolver does).
+//        A crossfaded setCrossover on the audio thread only marks the frequencies as changed. At the end of a
+//        partition, with no design under way, the newest frequencies are posted as a design into the spare filter
+//        set, and that set takes over kHandoverPartitions partitions later, whatever the wall clock did meanwhile:
+//        the first partition of the new set crossfades the old and new band outputs, and the partitions of past
+//        input spectra are kept, so the new filters have a full history. A sweep is followed in steps of
+//        kHandoverPartitions, always ending on its last value, and renders the same every time.
+//        The designs run on a design thread, started by setBackgroundDesign (linear phase mode only) and woken
+//        through designWake when a design is posted; it sleeps otherwise. If a design is not finished at its
+//        handover partition the audio thread waits for it (kHandoverPartitions leaves it ample time), and without
+//        the thread the audio thread designs it itself at that partition.
+//        The spectral multiply-accumulate kernel (scalar, SSE2, AVX2) is picked at construction, see SIMDSupport.h.
+//        Everything is allocated by setSampleRate and setChannels; processBlock does not allocate.
+
+#ifndef __LinearPhaseCrossover_h__
+#define __LinearPhaseCrossover_h__
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SIMDSupport.h"
+
+// --- radix-2 FFT of real signals, computed as a complex FFT of half the size; spectra are size / 2 + 1 bins
+//     held as separate real and imaginary arrays
+class RealFFT {
+public:
+    RealFFT();
+    ~RealFFT();
+
+    // --- power of two >= 4; allocates the tables
+    bool setSize(uint32_t size);
+    uint32_t getSize() const { return size; }
+
+    void forward(const double* input, double* re, double* im);
+    // --- the exact inverse of forward (scaled by 1 / size)
+    void inverse(const double* re, const double* im, double* output);
+
+protected:
+    template <bool kInverse>
+    void transform(double* re, double* im);
+
+    uint32_t size;
+    std::vector<double> twiddleCos;     ///< every stage of the half size complex transform
+    std::vector<double> twiddleSin;
+    std::vector<double> splitCos;       ///< size / 2 + 1 points for the real split
+    std::vector<double> splitSin;
+    std::vector<uint32_t> bitReverse;
+    std::vector<double> workRe;
+    std::vector<double> workIm;
+};
+
+class LinearPhaseCrossover {
+public:
+    enum { kNumBands = 4, kNumFIRBands = 3, kNumPartitions = 16 };
+
+    LinearPhaseCrossover();
+    ~LinearPhaseCrossover();
+
+    // --- sizes the FIRs for the rate and redesigns them for the last crossover; clears the state.
+    //     Not on the audio thread: stops and restarts the design thread
+    bool setSampleRate(double sampleRate);
+    // --- run the designs on a design thread (linear phase mode) or not; not on the audio thread
+    void setBackgroundDesign(bool enable);
+    bool setChannels(uint32_t numChannels);
+    uint32_t getChannels() const { return numChannels; }
+    // --- the most channels setChannels can take at this rate without allocating
+    uint32_t getAllocatedChannels() const;
+
+    // --- with crossfade (audio thread) the new FIRs take over, crossfaded, at a fixed partition after the request;
+    //     without, they are designed now, on the calling thread
+    void setCrossover(double lowMidFc, double midHighFc, double highTrebleFc, bool crossfade);
+
+    uint32_t getLatency() const { return partitionFrames + (numTaps - 1) / 2; }
+    // --- the latency at a rate before setSampleRate, for sizing delays
+    static uint32_t getLatency(double sampleRate);
+    void clear();
+
+    // --- bands[channel][band] receive Low, LowMid, HighMid, Treble, all in phase (not inverted like the IIR)
+    template <typename SampleType>
+    void processBlock(const SampleType* const* inputs, double* const* const* bands, uint32_t numFrames);
+
+    bool setKernel(SIMDKernel kernel);
+    SIMDKernel getKernel() const { return kernel; }
+
+protected:
+    typedef void (*MultiplyAccumulateFunction)(const double* xRe, const double* xIm, const double* hRe,
+                                               const double* hIm, double* yRe, double* yIm, uint32_t numBins);
+
+    enum { kNumSets = 2, kHandoverPartitions = 4 };
+
+    static uint32_t getDesignSize(double sampleRate);
+    void design(uint32_t set, const double* fc);
+    void startDesignThread();
+    void stopDesignThread();
+    void runDesignThread();
+    void postDesign();
+    void finishDesign();
+    void processPartition();
+    void convolveBand(uint32_t channel, uint32_t set, uint32_t band, double* output);
+
+    double* spectrum(uint32_t set, uint32_t band, uint32_t partition, uint32_t part) {
+        return &filterSpectra[(((set * kNumFIRBands + band) * kNumPartitions + partition) * 2 + part) * numBins];
+    }
+
+    double sampleRate;
+    uint32_t designSize;
+    uint32_t numTaps;
+    uint32_t partitionFrames;
+    uint32_t numBins;
+    uint32_t numChannels;
+
+    // --- audio thread: the newest frequencies, the filter sets and the design under way, counted in partitions
+    double crossoverFc[kNumFIRBands];
+    bool crossoverChanged;
+    uint32_t activeSet;
+    uint32_t spareSet;
+    bool designPosted;
+    uint64_t partitionCount;
+    uint64_t handoverPartition;
+
+    // --- [set][band][partition][re, im][bin]; the spare set belongs to the design while one is posted
+    std::vector<double> filterSpectra;
+
+    // --- the posted design: the frequencies are stored, then designsPosted is raised; designsDone follows it
+    std::atomic<double> postedFc[kNumFIRBands];
+    std::atomic<uint32_t> designsPosted;
+    std::atomic<uint32_t> designsDone;
+
+    // --- design thread (or whoever designs while it is stopped)
+    std::thread designThread;
+    std::mutex designMutex;
+    std::condition_variable designWake;
+    bool stopDesign;
+    bool backgroundDesign;
+    RealFFT designFFT;
+    RealFFT designPartitionFFT;
+    std::vector<double> window;
+    std::vector<double> lowpass;        ///< [crossover][tap]
+    std::vector<double> impulse;
+    std::vector<double> designRe;
+    std::vector<double> designIm;
+    std::vector<double> partitionTaps;
+
+    RealFFT partitionFFT;
+
+    // --- per channel: overlap-save input (previous and current partition), input spectra for the last
+    //     kNumPartitions partitions, an input history for the treble delay and the bands of the last partition
+    std::vector<double> inputBlock;     ///< [channel][2 * partitionFrames]
+    std::vector<double> inputSpectra;   ///< [channel][partition][re, im][bin]
+    std::vector<double> history;        ///< [channel][designSize]
+    std::vector<double> bandOutput;     ///< [channel][band][partitionFrames]
+    uint32_t spectrumIndex;
+    uint32_t historyIndex;
+    uint32_t fill;
+
+    // --- one channel's scratch
+    std::vector<double> sumRe;
+    std::vector<double> sumIm;
+    std::vector<double> convolved;
+    std::vector<double> fadeOutput;
+
+    SIMDKernel kernel;
+    MultiplyAccumulateFunction multiplyAccumulate;
+};
+
+#endif
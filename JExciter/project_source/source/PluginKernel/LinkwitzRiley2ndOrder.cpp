@@ -74,4 +74,25 @@ void LinkwitzRiley2ndOrder::calcFilter(void) {
     }
 
     return;
-}
\ No newline at end of file
+}
+
+void LinkwitzRiley2ndOrder::calcWarpedCoefficients(int type, double warp, double& a0, double& a1, double& a2, double& b1, double& b2) {
+    // --- calcFilter divided through by omega^2 / warp^2
+    double warp2 = warp * warp;
+    double norm = 1.0 / (1.0 + 2 * warp + warp2);
+    switch (type) {
+    case 0:
+        a0 = warp2 * norm;
+        a1 = 2 * a0;
+        a2 = a0;
+        break;
+
+    case 1:
+        a0 = norm;
+        a1 = -2 * norm;
+        a2 = norm;
+        break;
+    }
+    b1 = 2 * (warp2 - 1.0) * norm;
+    b2 = (1.0 - 2 * warp + warp2) * norm;
+}
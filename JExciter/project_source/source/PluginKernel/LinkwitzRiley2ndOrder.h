@@ -6,6 +6,11 @@
 //  2nd Order Linkwitz-Riley filters for use in cross over networks. Adapted from earlevel engineerings biquad object.
 
 // Notes: type 0 = LPF, type 1 = HPF
+//        process() is templated on the sample type: the coefficients and state are always double, the output is
+//        rounded to SampleType, so a float cascade rounds between sections and a double cascade never does.
+
+#ifndef __LinkwitzRiley2ndOrder_h__
+#define __LinkwitzRiley2ndOrder_h__
 
 #include <math.h>
 
@@ -17,7 +22,12 @@ public:
     void setType(int type);
     void setFc(double Fc);
     void setFilter(int type, double Fc, double Fs);
-    float process(float in);
+    template <typename SampleType>
+    SampleType process(SampleType in);
+    void getCoefficients(double& a0, double& a1, double& a2, double& b1, double& b2) const;
+
+    // --- same response as calcFilter from a prewarped warp = tan(pi * Fc / Fs), so callers can cache the tan()
+    static void calcWarpedCoefficients(int type, double warp, double& a0, double& a1, double& a2, double& b1, double& b2);
 
     double pi = 3.14159265358979323846;
 
@@ -30,9 +40,20 @@ protected:
     double z1, z2;
 };
 
-inline float LinkwitzRiley2ndOrder::process(float in) {
+template <typename SampleType>
+inline SampleType LinkwitzRiley2ndOrder::process(SampleType in) {
     double out = in * a0 + z1;
     z1 = in * a1 + z2 - b1 * out;
     z2 = in * a2 - b2 * out;
-    return out;
+    return (SampleType)out;
 }
+
+inline void LinkwitzRiley2ndOrder::getCoefficients(double& a0, double& a1, double& a2, double& b1, double& b2) const {
+    a0 = this->a0;
+    a1 = this->a1;
+    a2 = this->a2;
+    b1 = this->b1;
+    b2 = this->b2;
+}
+
+#endif
@@ -0,0 +1,696 @@
+//
+//  LinkwitzRileyCrossover.cpp
+//
+//  4 band Linkwitz-Riley crossover built from the six LinkwitzRiley2ndOrder sections (LFLP/LFHP/MFLP/MFHP/HFLP/HFHP).
+//  All six filter states live in one SoA set of 4 lanes so every band is produced by a single SIMD pass per sample.
+//  LinkwitzRileyStereoCrossover interleaves the L/R lanes in pairs so a stereo frame is one 8 lane pass.
+
+// Notes: every kernel computes out = in * a0 + z1; z1 = in * a1 + z2 - b1 * out; z2 = in * a2 - b2 * out
+//        in double and rounds to the input sample type between the stages (float only; double is already there),
+//        in exactly that order, so they all agree bit for bit for either sample type.
+
+#include "LinkwitzRileyCrossover.h"
+#include "DenormalGuard.h"
+#include <math.h>
+#include <string.h>
+
+// --- stage 0 runs all four sections on the input, stage 1 only the LowMid and HighMid lanes
+template <int kChannels>
+static void initState(LinkwitzRileyCrossoverState<kChannels>& s, double lowFc, double midFc, double highFc, double Fs) {
+    const LinkwitzRiley2ndOrder sections[2][4] = {
+        { LinkwitzRiley2ndOrder(0, lowFc, Fs), LinkwitzRiley2ndOrder(1, lowFc, Fs),
+          LinkwitzRiley2ndOrder(1, midFc, Fs), LinkwitzRiley2ndOrder(1, highFc, Fs) },
+        { LinkwitzRiley2ndOrder(), LinkwitzRiley2ndOrder(0, midFc, Fs),
+          LinkwitzRiley2ndOrder(0, highFc, Fs), LinkwitzRiley2ndOrder() } };
+
+    for (int stage = 0; stage < 2; stage++) {
+        for (int lane = 0; lane < 4; lane++) {
+            for (int channel = 0; channel < kChannels; channel++) {
+                int i = lane * kChannels + channel;
+                sections[stage][lane].getCoefficients(s.a0[stage][i], s.a1[stage][i], s.a2[stage][i], s.b1[stage][i], s.b2[stage][i]);
+                s.a1PerA0[stage][i] = s.a1[stage][i] / s.a0[stage][i];
+                s.a2PerA0[stage][i] = s.a2[stage][i] / s.a0[stage][i];
+            }
+        }
+    }
+    s.rampFrames = 0;
+}
+
+// --- the same lanes as initState from prewarped frequencies, set now or reached by a ramp over numFrames;
+//     the pass lanes keep their unity coefficients
+template <int kChannels>
+static void initStateWarped(LinkwitzRileyCrossoverState<kChannels>& s, double lowWarp, double midWarp, double highWarp, uint32_t numFrames) {
+    const int type[2][4] = { { 0, 1, 1, 1 }, { -1, 0, 0, -1 } };
+    const double warp[2][4] = { { lowWarp, lowWarp, midWarp, highWarp }, { 0.0, midWarp, highWarp, 0.0 } };
+    const double step = numFrames > 0 ? 1.0 / numFrames : 0.0;
+
+    for (int stage = 0; stage < 2; stage++) {
+        for (int lane = 0; lane < 4; lane++) {
+            if (type[stage][lane] < 0)
+                continue;
+
+            double a0, a1, a2, b1, b2;
+            LinkwitzRiley2ndOrder::calcWarpedCoefficients(type[stage][lane], warp[stage][lane], a0, a1, a2, b1, b2);
+
+            // --- every channel of a lane has the same coefficients
+            int i = lane * kChannels;
+            double da0 = (a0 - s.a0[stage][i]) * step;
+            double da1 = (a1 - s.a1[stage][i]) * step;
+            double da2 = (a2 - s.a2[stage][i]) * step;
+            double db1 = (b1 - s.b1[stage][i]) * step;
+            double db2 = (b2 - s.b2[stage][i]) * step;
+            for (int channel = 0; channel < kChannels; channel++, i++) {
+                if (numFrames == 0) {
+                    s.a0[stage][i] = a0;
+                    s.a1[stage][i] = a1;
+                    s.a2[stage][i] = a2;
+                    s.b1[stage][i] = b1;
+                    s.b2[stage][i] = b2;
+                }
+                else {
+                    s.da0[stage][i] = da0;
+                    s.da1[stage][i] = da1;
+                    s.da2[stage][i] = da2;
+                    s.db1[stage][i] = db1;
+                    s.db2[stage][i] = db2;
+                }
+            }
+        }
+    }
+    s.rampFrames = numFrames;
+}
+
+// --- one ramp step on every lane, once per frame after all channels ran
+template <int kChannels>
+static inline void stepScalarRamp(LinkwitzRileyCrossoverState<kChannels>& s) {
+    for (int stage = 0; stage < 2; stage++) {
+        for (int i = 0; i < 4 * kChannels; i++) {
+            s.a0[stage][i] += s.da0[stage][i];
+            s.a1[stage][i] += s.da1[stage][i];
+            s.a2[stage][i] += s.da2[stage][i];
+            s.b1[stage][i] += s.db1[stage][i];
+            s.b2[stage][i] += s.db2[stage][i];
+        }
+    }
+}
+
+// --- one sample of one channel through all four lanes; returns the band values in bands[0..3]
+template <typename SampleType, int kChannels>
+SIMD_SCALAR_NO_SLP static inline void processScalarFrame(LinkwitzRileyCrossoverState<kChannels>& s, int channel, SampleType in, double* bands) {
+    SampleType stageOut[4];
+
+    double x = in;
+    for (int lane = 0; lane < 4; lane++) {
+        int i = lane * kChannels + channel;
+        double out = x * s.a0[0][i] + s.z1[0][i];
+        s.z1[0][i] = x * s.a1[0][i] + s.z2[0][i] - s.b1[0][i] * out;
+        s.z2[0][i] = x * s.a2[0][i] - s.b2[0][i] * out;
+        stageOut[lane] = (SampleType)out;
+    }
+
+    for (int lane = 1; lane < 3; lane++) {
+        int i = lane * kChannels + channel;
+        double y = stageOut[lane];
+        double out = y * s.a0[1][i] + s.z1[1][i];
+        s.z1[1][i] = y * s.a1[1][i] + s.z2[1][i] - s.b1[1][i] * out;
+        s.z2[1][i] = y * s.a2[1][i] - s.b2[1][i] * out;
+        stageOut[lane] = (SampleType)out;
+    }
+
+    bands[0] = stageOut[0];
+    bands[1] = -1 * (double)stageOut[1];
+    bands[2] = stageOut[2];
+    bands[3] = -1 * (double)stageOut[3];
+}
+
+template <typename SampleType, bool kRamp>
+SIMD_SCALAR_NO_SLP static void processScalarBlock(LinkwitzRileyCrossover::State& s, const SampleType* input, double* const* bands, uint32_t numFrames) {
+    double frame[4];
+    for (uint32_t i = 0; i < numFrames; i++) {
+        processScalarFrame(s, 0, input[i], frame);
+        if (kRamp)
+            stepScalarRamp(s);
+        for (int band = 0; band < 4; band++)
+            bands[band][i] = frame[band];
+    }
+}
+
+template <typename SampleType, bool kRamp>
+SIMD_SCALAR_NO_SLP static void processScalarStereoBlock(LinkwitzRileyStereoCrossover::State& s, const SampleType* inputL, const SampleType* inputR,
+    double* const* bandsL, double* const* bandsR, uint32_t numFrames) {
+    double frameL[4], frameR[4];
+    for (uint32_t i = 0; i < numFrames; i++) {
+        processScalarFrame(s, 0, inputL[i], frameL);
+        processScalarFrame(s, 1, inputR[i], frameR);
+        if (kRamp)
+            stepScalarRamp(s);
+        for (int band = 0; band < 4; band++) {
+            bandsL[band][i] = frameL[band];
+            bandsR[band][i] = frameR[band];
+        }
+    }
+}
+
+#ifdef SIMD_X86
+
+// --- SSE2 helpers: one register holds 2 lanes of a stage
+struct SectionSSE2 {
+    __m128d a0, a1, a2, b1, b2, z1, z2;
+    __m128d da0, db1, db2;
+};
+
+template <bool kRamp, int kChannels>
+SIMD_TARGET_SSE2 static inline void loadSSE2(SectionSSE2& c, const LinkwitzRileyCrossoverState<kChannels>& s, int stage, int offset) {
+    c.a0 = _mm_loadu_pd(&s.a0[stage][offset]);
+    c.a1 = _mm_loadu_pd(&s.a1[stage][offset]);
+    c.a2 = _mm_loadu_pd(&s.a2[stage][offset]);
+    c.b1 = _mm_loadu_pd(&s.b1[stage][offset]);
+    c.b2 = _mm_loadu_pd(&s.b2[stage][offset]);
+    c.z1 = _mm_loadu_pd(&s.z1[stage][offset]);
+    c.z2 = _mm_loadu_pd(&s.z2[stage][offset]);
+    if (kRamp) {
+        c.a1 = _mm_loadu_pd(&s.a1PerA0[stage][offset]);
+        c.a2 = _mm_loadu_pd(&s.a2PerA0[stage][offset]);
+        c.da0 = _mm_loadu_pd(&s.da0[stage][offset]);
+        c.db1 = _mm_loadu_pd(&s.db1[stage][offset]);
+        c.db2 = _mm_loadu_pd(&s.db2[stage][offset]);
+    }
+}
+
+template <bool kRamp, int kChannels>
+SIMD_TARGET_SSE2 static inline void storeSSE2(const SectionSSE2& c, LinkwitzRileyCrossoverState<kChannels>& s, int stage, int offset) {
+    _mm_storeu_pd(&s.z1[stage][offset], c.z1);
+    _mm_storeu_pd(&s.z2[stage][offset], c.z2);
+    if (kRamp) {
+        _mm_storeu_pd(&s.a0[stage][offset], c.a0);
+        _mm_storeu_pd(&s.a1[stage][offset], _mm_mul_pd(c.a1, c.a0));
+        _mm_storeu_pd(&s.a2[stage][offset], _mm_mul_pd(c.a2, c.a0));
+        _mm_storeu_pd(&s.b1[stage][offset], c.b1);
+        _mm_storeu_pd(&s.b2[stage][offset], c.b2);
+    }
+}
+
+// --- stage outputs round to the input sample type, like LinkwitzRiley2ndOrder::process<SampleType>
+template <typename SampleType>
+SIMD_TARGET_SSE2 static inline __m128d roundSSE2(__m128d x) {
+    return sizeof(SampleType) == sizeof(float) ? _mm_cvtps_pd(_mm_cvtpd_ps(x)) : x;
+}
+
+// --- each section runs once per frame, so a ramp steps its coefficients right after the sample. While ramping,
+//     c.a1/c.a2 hold a1 / a0 and a2 / a0 (2, -2, 1 or 0): in * a1 == (in * a0) * (a1 / a0) exactly, so only a0, b1
+//     and b2 need stepping and the result matches the scalar ramp bit for bit
+template <typename SampleType, bool kRamp>
+SIMD_TARGET_SSE2 static inline __m128d processSSE2(SectionSSE2& c, __m128d in) {
+    if (kRamp) {
+        __m128d x = _mm_mul_pd(in, c.a0);
+        __m128d out = _mm_add_pd(x, c.z1);
+        c.z1 = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(x, c.a1), c.z2), _mm_mul_pd(c.b1, out));
+        c.z2 = _mm_sub_pd(_mm_mul_pd(x, c.a2), _mm_mul_pd(c.b2, out));
+        c.a0 = _mm_add_pd(c.a0, c.da0);
+        c.b1 = _mm_add_pd(c.b1, c.db1);
+        c.b2 = _mm_add_pd(c.b2, c.db2);
+        return roundSSE2<SampleType>(out);
+    }
+
+    __m128d out = _mm_add_pd(_mm_mul_pd(in, c.a0), c.z1);
+    c.z1 = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(in, c.a1), c.z2), _mm_mul_pd(c.b1, out));
+    c.z2 = _mm_sub_pd(_mm_mul_pd(in, c.a2), _mm_mul_pd(c.b2, out));
+    return roundSSE2<SampleType>(out);
+}
+
+// --- AVX2 helpers: one register holds 4 lanes of a stage
+struct SectionAVX2 {
+    __m256d a0, a1, a2, b1, b2, z1, z2;
+    __m256d da0, db1, db2;
+};
+
+template <bool kRamp, int kChannels>
+SIMD_TARGET_AVX2 static inline void loadAVX2(SectionAVX2& c, const LinkwitzRileyCrossoverState<kChannels>& s, int stage, int offset) {
+    c.a0 = _mm256_loadu_pd(&s.a0[stage][offset]);
+    c.a1 = _mm256_loadu_pd(&s.a1[stage][offset]);
+    c.a2 = _mm256_loadu_pd(&s.a2[stage][offset]);
+    c.b1 = _mm256_loadu_pd(&s.b1[stage][offset]);
+    c.b2 = _mm256_loadu_pd(&s.b2[stage][offset]);
+    c.z1 = _mm256_loadu_pd(&s.z1[stage][offset]);
+    c.z2 = _mm256_loadu_pd(&s.z2[stage][offset]);
+    if (kRamp) {
+        c.a1 = _mm256_loadu_pd(&s.a1PerA0[stage][offset]);
+        c.a2 = _mm256_loadu_pd(&s.a2PerA0[stage][offset]);
+        c.da0 = _mm256_loadu_pd(&s.da0[stage][offset]);
+        c.db1 = _mm256_loadu_pd(&s.db1[stage][offset]);
+        c.db2 = _mm256_loadu_pd(&s.db2[stage][offset]);
+    }
+}
+
+template <bool kRamp, int kChannels>
+SIMD_TARGET_AVX2 static inline void storeAVX2(const SectionAVX2& c, LinkwitzRileyCrossoverState<kChannels>& s, int stage, int offset) {
+    _mm256_storeu_pd(&s.z1[stage][offset], c.z1);
+    _mm256_storeu_pd(&s.z2[stage][offset], c.z2);
+    if (kRamp) {
+        _mm256_storeu_pd(&s.a0[stage][offset], c.a0);
+        _mm256_storeu_pd(&s.a1[stage][offset], _mm256_mul_pd(c.a1, c.a0));
+        _mm256_storeu_pd(&s.a2[stage][offset], _mm256_mul_pd(c.a2, c.a0));
+        _mm256_storeu_pd(&s.b1[stage][offset], c.b1);
+        _mm256_storeu_pd(&s.b2[stage][offset], c.b2);
+    }
+}
+
+template <typename SampleType>
+SIMD_TARGET_AVX2 static inline __m256d roundAVX2(__m256d x) {
+    return sizeof(SampleType) == sizeof(float) ? _mm256_cvtps_pd(_mm256_cvtpd_ps(x)) : x;
+}
+
+template <typename SampleType, bool kRamp>
+SIMD_TARGET_AVX2 static inline __m256d processAVX2(SectionAVX2& c, __m256d in) {
+    if (kRamp) {
+        __m256d x = _mm256_mul_pd(in, c.a0);
+        __m256d out = _mm256_add_pd(x, c.z1);
+        c.z1 = _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(x, c.a1), c.z2), _mm256_mul_pd(c.b1, out));
+        c.z2 = _mm256_sub_pd(_mm256_mul_pd(x, c.a2), _mm256_mul_pd(c.b2, out));
+        c.a0 = _mm256_add_pd(c.a0, c.da0);
+        c.b1 = _mm256_add_pd(c.b1, c.db1);
+        c.b2 = _mm256_add_pd(c.b2, c.db2);
+        return roundAVX2<SampleType>(out);
+    }
+
+    __m256d out = _mm256_add_pd(_mm256_mul_pd(in, c.a0), c.z1);
+    c.z1 = _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(in, c.a1), c.z2), _mm256_mul_pd(c.b1, out));
+    c.z2 = _mm256_sub_pd(_mm256_mul_pd(in, c.a2), _mm256_mul_pd(c.b2, out));
+    return roundAVX2<SampleType>(out);
+}
+
+// --- rows[k] holds lanes 0..3 of sample k; writes lane j of samples 0..3 to out[j]
+SIMD_TARGET_AVX2 static inline void storeTransposedAVX2(const __m256d* rows, double* out0, double* out1, double* out2, double* out3) {
+    __m256d t0 = _mm256_unpacklo_pd(rows[0], rows[1]);
+    __m256d t1 = _mm256_unpackhi_pd(rows[0], rows[1]);
+    __m256d t2 = _mm256_unpacklo_pd(rows[2], rows[3]);
+    __m256d t3 = _mm256_unpackhi_pd(rows[2], rows[3]);
+    _mm256_storeu_pd(out0, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(out1, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(out2, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(out3, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+// --- mono SSE2: lanes 0-1 and 2-3 in two registers, two samples per transpose
+template <typename SampleType, bool kRamp>
+SIMD_TARGET_SSE2 static void processSSE2Block(LinkwitzRileyCrossover::State& s, const SampleType* input, double* const* bands, uint32_t numFrames) {
+    SectionSSE2 section[2][2];
+    for (int stage = 0; stage < 2; stage++) {
+        for (int half = 0; half < 2; half++)
+            loadSSE2<kRamp>(section[stage][half], s, stage, 2 * half);
+    }
+
+    // --- lane 0 and lane 3 bypass stage 1; lanes 1 and 3 are phase inverted
+    const __m128d passLo = _mm_castsi128_pd(_mm_set_epi32(0, 0, -1, -1));
+    const __m128d passHi = _mm_castsi128_pd(_mm_set_epi32(-1, -1, 0, 0));
+    const __m128d invert = _mm_set_pd(-0.0, 0.0);
+
+    __m128d frame[2][2];
+    uint32_t i = 0;
+    while (i < numFrames) {
+        uint32_t count = numFrames - i >= 2 ? 2 : 1;
+        for (uint32_t k = 0; k < count; k++) {
+            __m128d x = _mm_set1_pd((double)input[i + k]);
+            for (int half = 0; half < 2; half++) {
+                __m128d y = processSSE2<SampleType, kRamp>(section[0][half], x);
+                __m128d out = processSSE2<SampleType, kRamp>(section[1][half], y);
+                __m128d pass = half == 0 ? passLo : passHi;
+                frame[k][half] = _mm_xor_pd(_mm_or_pd(_mm_and_pd(pass, y), _mm_andnot_pd(pass, out)), invert);
+            }
+        }
+
+        if (count == 2) {
+            _mm_storeu_pd(&bands[0][i], _mm_unpacklo_pd(frame[0][0], frame[1][0]));
+            _mm_storeu_pd(&bands[1][i], _mm_unpackhi_pd(frame[0][0], frame[1][0]));
+            _mm_storeu_pd(&bands[2][i], _mm_unpacklo_pd(frame[0][1], frame[1][1]));
+            _mm_storeu_pd(&bands[3][i], _mm_unpackhi_pd(frame[0][1], frame[1][1]));
+        }
+        else {
+            _mm_storel_pd(&bands[0][i], frame[0][0]);
+            _mm_storeh_pd(&bands[1][i], frame[0][0]);
+            _mm_storel_pd(&bands[2][i], frame[0][1]);
+            _mm_storeh_pd(&bands[3][i], frame[0][1]);
+        }
+        i += count;
+    }
+
+    for (int stage = 0; stage < 2; stage++) {
+        for (int half = 0; half < 2; half++)
+            storeSSE2<kRamp>(section[stage][half], s, stage, 2 * half);
+    }
+}
+
+// --- mono AVX2: all four lanes in one register, four samples per transpose
+template <typename SampleType, bool kRamp>
+SIMD_TARGET_AVX2 static void processAVX2Block(LinkwitzRileyCrossover::State& s, const SampleType* input, double* const* bands, uint32_t numFrames) {
+    SectionAVX2 section[2];
+    for (int stage = 0; stage < 2; stage++)
+        loadAVX2<kRamp>(section[stage], s, stage, 0);
+
+    const __m256d invert = _mm256_set_pd(-0.0, 0.0, -0.0, 0.0);
+
+    __m256d frame[4];
+    uint32_t i = 0;
+    while (i < numFrames) {
+        uint32_t count = numFrames - i >= 4 ? 4 : 1;
+        for (uint32_t k = 0; k < count; k++) {
+            __m256d x = _mm256_set1_pd((double)input[i + k]);
+            __m256d y = processAVX2<SampleType, kRamp>(section[0], x);
+            __m256d out = processAVX2<SampleType, kRamp>(section[1], y);
+
+            // --- lane 0 and lane 3 bypass stage 1
+            frame[k] = _mm256_xor_pd(_mm256_blend_pd(out, y, 0x9), invert);
+        }
+
+        if (count == 4)
+            storeTransposedAVX2(frame, &bands[0][i], &bands[1][i], &bands[2][i], &bands[3][i]);
+        else {
+            double lanes[4];
+            _mm256_storeu_pd(lanes, frame[0]);
+            for (int band = 0; band < 4; band++)
+                bands[band][i] = lanes[band];
+        }
+        i += count;
+    }
+
+    for (int stage = 0; stage < 2; stage++)
+        storeAVX2<kRamp>(section[stage], s, stage, 0);
+}
+
+// --- stereo SSE2: register j holds the {L, R} pair of lane j, two samples per transpose
+template <typename SampleType, bool kRamp>
+SIMD_TARGET_SSE2 static void processSSE2StereoBlock(LinkwitzRileyStereoCrossover::State& s, const SampleType* inputL, const SampleType* inputR,
+    double* const* bandsL, double* const* bandsR, uint32_t numFrames) {
+    SectionSSE2 section[2][4];
+    for (int stage = 0; stage < 2; stage++) {
+        for (int lane = 0; lane < 4; lane++)
+            loadSSE2<kRamp>(section[stage][lane], s, stage, 2 * lane);
+    }
+
+    const __m128d invert = _mm_set1_pd(-0.0);
+
+    __m128d frame[2][4];
+    uint32_t i = 0;
+    while (i < numFrames) {
+        uint32_t count = numFrames - i >= 2 ? 2 : 1;
+        for (uint32_t k = 0; k < count; k++) {
+            __m128d x = _mm_set_pd((double)inputR[i + k], (double)inputL[i + k]);
+            frame[k][0] = processSSE2<SampleType, kRamp>(section[0][0], x);
+            frame[k][1] = _mm_xor_pd(processSSE2<SampleType, kRamp>(section[1][1], processSSE2<SampleType, kRamp>(section[0][1], x)), invert);
+            frame[k][2] = processSSE2<SampleType, kRamp>(section[1][2], processSSE2<SampleType, kRamp>(section[0][2], x));
+            frame[k][3] = _mm_xor_pd(processSSE2<SampleType, kRamp>(section[0][3], x), invert);
+        }
+
+        for (int band = 0; band < 4; band++) {
+            if (count == 2) {
+                _mm_storeu_pd(&bandsL[band][i], _mm_unpacklo_pd(frame[0][band], frame[1][band]));
+                _mm_storeu_pd(&bandsR[band][i], _mm_unpackhi_pd(frame[0][band], frame[1][band]));
+            }
+            else {
+                _mm_storel_pd(&bandsL[band][i], frame[0][band]);
+                _mm_storeh_pd(&bandsR[band][i], frame[0][band]);
+            }
+        }
+        i += count;
+    }
+
+    for (int stage = 0; stage < 2; stage++) {
+        for (int lane = 0; lane < 4; lane++)
+            storeSSE2<kRamp>(section[stage][lane], s, stage, 2 * lane);
+    }
+}
+
+// --- stereo AVX2: 8 lanes in two registers {L0, R0, L1, R1} and {L2, R2, L3, R3}, four samples per transpose
+template <typename SampleType, bool kRamp>
+SIMD_TARGET_AVX2 static void processAVX2StereoBlock(LinkwitzRileyStereoCrossover::State& s, const SampleType* inputL, const SampleType* inputR,
+    double* const* bandsL, double* const* bandsR, uint32_t numFrames) {
+    SectionAVX2 section[2][2];
+    for (int stage = 0; stage < 2; stage++) {
+        for (int half = 0; half < 2; half++)
+            loadAVX2<kRamp>(section[stage][half], s, stage, 4 * half);
+    }
+
+    const __m256d invert = _mm256_set_pd(-0.0, -0.0, 0.0, 0.0);
+
+    __m256d frame[2][4];
+    uint32_t i = 0;
+    while (i < numFrames) {
+        uint32_t count = numFrames - i >= 4 ? 4 : 1;
+        for (uint32_t k = 0; k < count; k++) {
+            __m256d x = _mm256_set_pd((double)inputR[i + k], (double)inputL[i + k], (double)inputR[i + k], (double)inputL[i + k]);
+            for (int half = 0; half < 2; half++) {
+                __m256d y = processAVX2<SampleType, kRamp>(section[0][half], x);
+                __m256d out = processAVX2<SampleType, kRamp>(section[1][half], y);
+
+                // --- lane 0 (first pair) and lane 3 (last pair) bypass stage 1
+                __m256d bands = half == 0 ? _mm256_blend_pd(out, y, 0x3) : _mm256_blend_pd(out, y, 0xC);
+                frame[half][k] = _mm256_xor_pd(bands, invert);
+            }
+        }
+
+        if (count == 4) {
+            storeTransposedAVX2(frame[0], &bandsL[0][i], &bandsR[0][i], &bandsL[1][i], &bandsR[1][i]);
+            storeTransposedAVX2(frame[1], &bandsL[2][i], &bandsR[2][i], &bandsL[3][i], &bandsR[3][i]);
+        }
+        else {
+            double lanes[8];
+            _mm256_storeu_pd(&lanes[0], frame[0][0]);
+            _mm256_storeu_pd(&lanes[4], frame[1][0]);
+            for (int band = 0; band < 4; band++) {
+                bandsL[band][i] = lanes[2 * band];
+                bandsR[band][i] = lanes[2 * band + 1];
+            }
+        }
+        i += count;
+    }
+
+    for (int stage = 0; stage < 2; stage++) {
+        for (int half = 0; half < 2; half++)
+            storeAVX2<kRamp>(section[stage][half], s, stage, 4 * half);
+    }
+}
+
+#endif
+
+LinkwitzRileyWarpTable::LinkwitzRileyWarpTable() {
+    setRange(20.0, 20000.0, 44100.0);
+}
+
+LinkwitzRileyWarpTable::~LinkwitzRileyWarpTable() {
+}
+
+void LinkwitzRileyWarpTable::setRange(double minFc, double maxFc, double Fs) {
+    log2MinFc = log2(minFc);
+    pointsPerOctave = kTableSize / (log2(maxFc) - log2MinFc);
+    for (int i = 0; i <= kTableSize; i++)
+        warp[i] = tan(3.14159265358979323846 * exp2(log2MinFc + i / pointsPerOctave) / Fs);
+}
+
+double LinkwitzRileyWarpTable::getWarp(double log2Fc) const {
+    double x = (log2Fc - log2MinFc) * pointsPerOctave;
+    if (x <= 0.0)
+        return warp[0];
+    if (x >= kTableSize)
+        return warp[kTableSize];
+
+    int i = (int)x;
+    double frac = x - i;
+    return warp[i] + (warp[i + 1] - warp[i]) * frac;
+}
+
+LinkwitzRileyCrossover::LinkwitzRileyCrossover() {
+    memset(&state, 0, sizeof(state));
+    initState(state, 100.0, 1000.0, 10000.0, 44100.0);
+    setKernel(kScalarKernel);
+    setKernel(getBestSIMDKernel());
+}
+
+LinkwitzRileyCrossover::~LinkwitzRileyCrossover() {
+}
+
+void LinkwitzRileyCrossover::setCrossover(double lowFc, double midFc, double highFc, double Fs) {
+    initState(state, lowFc, midFc, highFc, Fs);
+}
+
+void LinkwitzRileyCrossover::setWarpedCrossover(double lowWarp, double midWarp, double highWarp, uint32_t numFrames) {
+    initStateWarped(state, lowWarp, midWarp, highWarp, numFrames);
+}
+
+void LinkwitzRileyCrossover::clear() {
+    memset(state.z1, 0, sizeof(state.z1));
+    memset(state.z2, 0, sizeof(state.z2));
+}
+
+void LinkwitzRileyCrossover::flushDenormals() {
+    ::flushDenormals(&state.z1[0][0], sizeof(state.z1) / sizeof(double));
+    ::flushDenormals(&state.z2[0][0], sizeof(state.z2) / sizeof(double));
+}
+
+SIMD_SCALAR_NO_SLP void LinkwitzRileyCrossover::processFrame(float in, double* bands) {
+    processScalarFrame(state, 0, in, bands);
+    if (state.rampFrames > 0) {
+        stepScalarRamp(state);
+        state.rampFrames--;
+    }
+}
+
+SIMD_SCALAR_NO_SLP void LinkwitzRileyCrossover::processFrame(double in, double* bands) {
+    processScalarFrame(state, 0, in, bands);
+    if (state.rampFrames > 0) {
+        stepScalarRamp(state);
+        state.rampFrames--;
+    }
+}
+
+void LinkwitzRileyCrossover::processBlock(const float* input, double* const* bands, uint32_t numFrames) {
+    runBlock(blockFunction, rampFunction, input, bands, numFrames);
+}
+
+void LinkwitzRileyCrossover::processBlock(const double* input, double* const* bands, uint32_t numFrames) {
+    runBlock(blockFunction64, rampFunction64, input, bands, numFrames);
+}
+
+template <typename SampleType, typename Function>
+void LinkwitzRileyCrossover::runBlock(Function block, Function ramp, const SampleType* input, double* const* bands, uint32_t numFrames) {
+    // --- the ramped frames first, then the rest on the fixed kernel
+    uint32_t numRamped = numFrames < state.rampFrames ? numFrames : state.rampFrames;
+    if (numRamped > 0) {
+        ramp(state, input, bands, numRamped);
+        state.rampFrames -= numRamped;
+        if (numRamped == numFrames)
+            return;
+    }
+
+    double* const rest[kNumBands] = { bands[0] + numRamped, bands[1] + numRamped, bands[2] + numRamped, bands[3] + numRamped };
+    block(state, input + numRamped, rest, numFrames - numRamped);
+}
+
+bool LinkwitzRileyCrossover::setKernel(SIMDKernel kernel) {
+    if (!isSIMDKernelSupported(kernel))
+        return false;
+
+    this->kernel = kernel;
+    switch (kernel) {
+#ifdef SIMD_X86
+    case kSSE2Kernel:
+        blockFunction = processSSE2Block<float, false>;
+        rampFunction = processSSE2Block<float, true>;
+        blockFunction64 = processSSE2Block<double, false>;
+        rampFunction64 = processSSE2Block<double, true>;
+        break;
+    case kAVX2Kernel:
+        blockFunction = processAVX2Block<float, false>;
+        rampFunction = processAVX2Block<float, true>;
+        blockFunction64 = processAVX2Block<double, false>;
+        rampFunction64 = processAVX2Block<double, true>;
+        break;
+#endif
+    default:
+        blockFunction = processScalarBlock<float, false>;
+        rampFunction = processScalarBlock<float, true>;
+        blockFunction64 = processScalarBlock<double, false>;
+        rampFunction64 = processScalarBlock<double, true>;
+        break;
+    }
+    return true;
+}
+
+LinkwitzRileyStereoCrossover::LinkwitzRileyStereoCrossover() {
+    memset(&state, 0, sizeof(state));
+    initState(state, 100.0, 1000.0, 10000.0, 44100.0);
+    setKernel(kScalarKernel);
+    setKernel(getBestSIMDKernel());
+}
+
+LinkwitzRileyStereoCrossover::~LinkwitzRileyStereoCrossover() {
+}
+
+void LinkwitzRileyStereoCrossover::setCrossover(double lowFc, double midFc, double highFc, double Fs) {
+    initState(state, lowFc, midFc, highFc, Fs);
+}
+
+void LinkwitzRileyStereoCrossover::setWarpedCrossover(double lowWarp, double midWarp, double highWarp, uint32_t numFrames) {
+    initStateWarped(state, lowWarp, midWarp, highWarp, numFrames);
+}
+
+void LinkwitzRileyStereoCrossover::clear() {
+    memset(state.z1, 0, sizeof(state.z1));
+    memset(state.z2, 0, sizeof(state.z2));
+}
+
+void LinkwitzRileyStereoCrossover::flushDenormals() {
+    ::flushDenormals(&state.z1[0][0], sizeof(state.z1) / sizeof(double));
+    ::flushDenormals(&state.z2[0][0], sizeof(state.z2) / sizeof(double));
+}
+
+SIMD_SCALAR_NO_SLP void LinkwitzRileyStereoCrossover::processFrame(float inL, float inR, double* bandsL, double* bandsR) {
+    processScalarFrame(state, 0, inL, bandsL);
+    processScalarFrame(state, 1, inR, bandsR);
+    if (state.rampFrames > 0) {
+        stepScalarRamp(state);
+        state.rampFrames--;
+    }
+}
+
+SIMD_SCALAR_NO_SLP void LinkwitzRileyStereoCrossover::processFrame(double inL, double inR, double* bandsL, double* bandsR) {
+    processScalarFrame(state, 0, inL, bandsL);
+    processScalarFrame(state, 1, inR, bandsR);
+    if (state.rampFrames > 0) {
+        stepScalarRamp(state);
+        state.rampFrames--;
+    }
+}
+
+void LinkwitzRileyStereoCrossover::processBlock(const float* inputL, const float* inputR, double* const* bandsL, double* const* bandsR, uint32_t numFrames) {
+    runBlock(blockFunction, rampFunction, inputL, inputR, bandsL, bandsR, numFrames);
+}
+
+void LinkwitzRileyStereoCrossover::processBlock(const double* inputL, const double* inputR, double* const* bandsL, double* const* bandsR, uint32_t numFrames) {
+    runBlock(blockFunction64, rampFunction64, inputL, inputR, bandsL, bandsR, numFrames);
+}
+
+template <typename SampleType, typename Function>
+void LinkwitzRileyStereoCrossover::runBlock(Function block, Function ramp, const SampleType* inputL, const SampleType* inputR,
+    double* const* bandsL, double* const* bandsR, uint32_t numFrames) {
+    uint32_t numRamped = numFrames < state.rampFrames ? numFrames : state.rampFrames;
+    if (numRamped > 0) {
+        ramp(state, inputL, inputR, bandsL, bandsR, numRamped);
+        state.rampFrames -= numRamped;
+        if (numRamped == numFrames)
+            return;
+    }
+
+    double* const restL[4] = { bandsL[0] + numRamped, bandsL[1] + numRamped, bandsL[2] + numRamped, bandsL[3] + numRamped };
+    double* const restR[4] = { bandsR[0] + numRamped, bandsR[1] + numRamped, bandsR[2] + numRamped, bandsR[3] + numRamped };
+    block(state, inputL + numRamped, inputR + numRamped, restL, restR, numFrames - numRamped);
+}
+
+bool LinkwitzRileyStereoCrossover::setKernel(SIMDKernel kernel) {
+    if (!isSIMDKernelSupported(kernel))
+        return false;
+
+    this->kernel = kernel;
+    switch (kernel) {
+#ifdef SIMD_X86
+    case kSSE2Kernel:
+        blockFunction = processSSE2StereoBlock<float, false>;
+        rampFunction = processSSE2StereoBlock<float, true>;
+        blockFunction64 = processSSE2StereoBlock<double, false>;
+        rampFunction64 = processSSE2StereoBlock<double, true>;
+        break;
+    case kAVX2Kernel:
+        blockFunction = processAVX2StereoBlock<float, false>;
+        rampFunction = processAVX2StereoBlock<float, true>;
+        blockFunction64 = processAVX2StereoBlock<double, false>;
+        rampFunction64 = processAVX2StereoBlock<double, true>;
+        break;
+#endif
+    default:
+        blockFunction = processScalarStereoBlock<float, false>;
+        rampFunction = processScalarStereoBlock<float, true>;
+        blockFunction64 = processScalarStereoBlock<double, false>;
+        rampFunction64 = processScalarStereoBlock<double, true>;
+        break;
+    }
+    return true;
+}
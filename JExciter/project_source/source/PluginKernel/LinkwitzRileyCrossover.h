@@ -0,0 +1,146 @@
+//
+//  LinkwitzRileyCrossover.h
+//
+//  4 band Linkwitz-Riley crossover built from the six LinkwitzRiley2ndOrder sections (LFLP/LFHP/MFLP/MFHP/HFLP/HFHP).
+//  All six filter states live in one SoA set of 4 lanes so every band is produced by a single SIMD pass per sample.
+//  LinkwitzRileyStereoCrossover interleaves the L/R lanes in pairs so a stereo frame is one 8 lane pass.
+
+// Notes: stage 0 lanes = LFLP, LFHP, MFHP, HFHP (all fed by the input)
+//        stage 1 lanes = pass, MFLP, HFLP, pass (fed by stage 0, rounded to the input sample type like
+//                        LinkwitzRiley2ndOrder::process<SampleType>: float inputs round between the stages, double
+//                        inputs do not, so a 64-bit host gets the sections at full precision with no conversions)
+//        bands out     = Low, -LowMid, HighMid, -Treble; the arithmetic matches the scalar sections bit for bit.
+//        The block kernel (scalar, SSE2, AVX2) is picked at construction from the CPU features, see SIMDSupport.h.
+//        setWarpedCrossover takes tan(pi * Fc / Fs) from a LinkwitzRileyWarpTable so a moving crossover can be
+//        updated every few frames without a tan() per section; with numFrames > 0 the coefficients ramp linearly
+//        to the new values over the next numFrames samples (frame and block paths step them identically).
+//        The filter states are kept; setCrossover sets the exact coefficients and ends any ramp.
+//        The float and double overloads share the state, so a host may switch sample size without a glitch.
+
+#ifndef __LinkwitzRileyCrossover_h__
+#define __LinkwitzRileyCrossover_h__
+
+#include <stdint.h>
+#include "LinkwitzRiley2ndOrder.h"
+#include "SIMDSupport.h"
+
+// --- SoA coefficients and state, [stage][lane * kChannels + channel]
+template <int kChannels>
+struct LinkwitzRileyCrossoverState {
+    enum { kNumStages = 2, kNumLanes = 4 * kChannels };
+
+    double a0[kNumStages][kNumLanes];
+    double a1[kNumStages][kNumLanes];
+    double a2[kNumStages][kNumLanes];
+    double b1[kNumStages][kNumLanes];
+    double b2[kNumStages][kNumLanes];
+    double z1[kNumStages][kNumLanes];
+    double z2[kNumStages][kNumLanes];
+
+    // --- per sample coefficient steps while a ramp runs (zero in the pass lanes); a1 and a2 are always exactly
+    //     2 or -2 and 1 times a0 (0 in the pass lanes), which lets the SIMD ramps step a0 alone
+    double a1PerA0[kNumStages][kNumLanes];
+    double a2PerA0[kNumStages][kNumLanes];
+    double da0[kNumStages][kNumLanes];
+    double da1[kNumStages][kNumLanes];
+    double da2[kNumStages][kNumLanes];
+    double db1[kNumStages][kNumLanes];
+    double db2[kNumStages][kNumLanes];
+    uint32_t rampFrames;
+};
+
+// --- tan(pi * Fc / Fs) over a log2(Fc) grid, linearly interpolated; the relative error is under 2e-6 up to Fs / 8
+//     and 2.4e-4 at 0.45 Fs, where tan() bends fastest
+class LinkwitzRileyWarpTable {
+public:
+    enum { kTableSize = 2048 };
+
+    LinkwitzRileyWarpTable();
+    ~LinkwitzRileyWarpTable();
+
+    void setRange(double minFc, double maxFc, double Fs);
+    double getWarp(double log2Fc) const;
+
+protected:
+    double warp[kTableSize + 1];
+    double log2MinFc;
+    double pointsPerOctave;
+};
+
+class LinkwitzRileyCrossover {
+public:
+    enum { kNumBands = 4 };
+
+    typedef LinkwitzRileyCrossoverState<1> State;
+
+    LinkwitzRileyCrossover();
+    ~LinkwitzRileyCrossover();
+
+    void setCrossover(double lowFc, double midFc, double highFc, double Fs);
+    void setWarpedCrossover(double lowWarp, double midWarp, double highWarp, uint32_t numFrames = 0);
+    void clear();
+    // --- software flush to zero of the filter states, for when DenormalGuard can't set the CPU mode
+    void flushDenormals();
+
+    void processFrame(float in, double* bands);
+    void processFrame(double in, double* bands);
+    void processBlock(const float* input, double* const* bands, uint32_t numFrames);
+    void processBlock(const double* input, double* const* bands, uint32_t numFrames);
+
+    bool setKernel(SIMDKernel kernel);
+    SIMDKernel getKernel() const { return kernel; }
+
+protected:
+    typedef void (*BlockFunction)(State& state, const float* input, double* const* bands, uint32_t numFrames);
+    typedef void (*BlockFunction64)(State& state, const double* input, double* const* bands, uint32_t numFrames);
+
+    template <typename SampleType, typename Function>
+    void runBlock(Function block, Function ramp, const SampleType* input, double* const* bands, uint32_t numFrames);
+
+    State state;
+    SIMDKernel kernel;
+    BlockFunction blockFunction;
+    BlockFunction rampFunction;
+    BlockFunction64 blockFunction64;
+    BlockFunction64 rampFunction64;
+};
+
+class LinkwitzRileyStereoCrossover {
+public:
+    typedef LinkwitzRileyCrossoverState<2> State;
+
+    LinkwitzRileyStereoCrossover();
+    ~LinkwitzRileyStereoCrossover();
+
+    void setCrossover(double lowFc, double midFc, double highFc, double Fs);
+    void setWarpedCrossover(double lowWarp, double midWarp, double highWarp, uint32_t numFrames = 0);
+    void clear();
+    void flushDenormals();
+
+    void processFrame(float inL, float inR, double* bandsL, double* bandsR);
+    void processFrame(double inL, double inR, double* bandsL, double* bandsR);
+    void processBlock(const float* inputL, const float* inputR, double* const* bandsL, double* const* bandsR, uint32_t numFrames);
+    void processBlock(const double* inputL, const double* inputR, double* const* bandsL, double* const* bandsR, uint32_t numFrames);
+
+    bool setKernel(SIMDKernel kernel);
+    SIMDKernel getKernel() const { return kernel; }
+
+protected:
+    typedef void (*BlockFunction)(State& state, const float* inputL, const float* inputR,
+        double* const* bandsL, double* const* bandsR, uint32_t numFrames);
+    typedef void (*BlockFunction64)(State& state, const double* inputL, const double* inputR,
+        double* const* bandsL, double* const* bandsR, uint32_t numFrames);
+
+    template <typename SampleType, typename Function>
+    void runBlock(Function block, Function ramp, const SampleType* inputL, const SampleType* inputR,
+        double* const* bandsL, double* const* bandsR, uint32_t numFrames);
+
+    State state;
+    SIMDKernel kernel;
+    BlockFunction blockFunction;
+    BlockFunction rampFunction;
+    BlockFunction64 blockFunction64;
+    BlockFunction64 rampFunction64;
+};
+
+#endif
@@ -0,0 +1,245 @@
+//
+//  Oversampler.cpp
+//
+//  Polyphase FIR interpolator/decimator pair for running one band's waveshaper at 2x or 4x the base rate.
+
+// Notes: the filters.h tables are designed at 2x/4x of 44.1k and 48k with a 20k passband and 22k stopband edge;
+//        they are used at whatever multiple of those the host runs, so the edges scale with the rate.
+//        Dot products keep 16 partial sums, acc[i % 16], and reduce them in the same pairs on every kernel,
+//        so they all round the same way.
+
+#include "Oversampler.h"
+
+// --- the table header defines every size as a static array; only four are used here
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+#include "../../../fxobjects/filters.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#include <math.h>
+#include <string.h>
+
+static double dotScalar(const double* a, const double* b, uint32_t numTaps) {
+    double acc[16];
+    for (int k = 0; k < 16; k++)
+        acc[k] = 0.0;
+    for (uint32_t i = 0; i < numTaps; i += 16) {
+        for (int k = 0; k < 16; k++)
+            acc[k] += a[i + k] * b[i + k];
+    }
+
+    double s[4];
+    for (int k = 0; k < 4; k++)
+        s[k] = (acc[k] + acc[k + 8]) + (acc[k + 4] + acc[k + 12]);
+    return (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+#ifdef SIMD_X86
+
+SIMD_TARGET_SSE2 static double dotSSE2(const double* a, const double* b, uint32_t numTaps) {
+    __m128d acc[8];
+    for (int k = 0; k < 8; k++)
+        acc[k] = _mm_setzero_pd();
+    for (uint32_t i = 0; i < numTaps; i += 16) {
+        for (int k = 0; k < 8; k++)
+            acc[k] = _mm_add_pd(acc[k], _mm_mul_pd(_mm_loadu_pd(&a[i + 2 * k]), _mm_loadu_pd(&b[i + 2 * k])));
+    }
+
+    double s[4];
+    _mm_storeu_pd(&s[0], _mm_add_pd(_mm_add_pd(acc[0], acc[4]), _mm_add_pd(acc[2], acc[6])));
+    _mm_storeu_pd(&s[2], _mm_add_pd(_mm_add_pd(acc[1], acc[5]), _mm_add_pd(acc[3], acc[7])));
+    return (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+SIMD_TARGET_AVX2 static double dotAVX2(const double* a, const double* b, uint32_t numTaps) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+    for (uint32_t i = 0; i < numTaps; i += 16) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(&a[i]), _mm256_loadu_pd(&b[i])));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(&a[i + 4]), _mm256_loadu_pd(&b[i + 4])));
+        acc2 = _mm256_add_pd(acc2, _mm256_mul_pd(_mm256_loadu_pd(&a[i + 8]), _mm256_loadu_pd(&b[i + 8])));
+        acc3 = _mm256_add_pd(acc3, _mm256_mul_pd(_mm256_loadu_pd(&a[i + 12]), _mm256_loadu_pd(&b[i + 12])));
+    }
+
+    double s[4];
+    _mm256_storeu_pd(s, _mm256_add_pd(_mm256_add_pd(acc0, acc2), _mm256_add_pd(acc1, acc3)));
+    return (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+#endif
+
+Oversampler::Oversampler() {
+    factor = 1;
+    numTaps = 0;
+    memset(interpolatorCoeffs, 0, sizeof(interpolatorCoeffs));
+    memset(decimatorCoeffs, 0, sizeof(decimatorCoeffs));
+    clear();
+    kernel = kScalarKernel;
+    dotFunction = dotScalar;
+    setKernel(getBestSIMDKernel());
+}
+
+Oversampler::~Oversampler() {
+}
+
+bool Oversampler::setFactor(uint32_t factor, double sampleRate) {
+    const double* table = nullptr;
+    bool family441 = fmod(sampleRate, 11025.0) == 0.0;
+    if (factor == 2)
+        table = family441 ? LPF128_882 : LPF128_96;
+    else if (factor == 4)
+        table = family441 ? LPF256_1764 : LPF256_192;
+    else if (factor != 1)
+        return false;
+
+    this->factor = factor;
+    numTaps = factor * kPhaseTaps;
+    clear();
+    if (!table) {
+        numTaps = 0;
+        return true;
+    }
+
+    double sum = 0.0;
+    for (uint32_t i = 0; i < numTaps; i++)
+        sum += table[i];
+
+    // --- interpolator branch p makes output sample n * factor + p from the last kPhaseTaps inputs; the factor
+    //     makes up for the zeros stuffed between them
+    for (uint32_t phase = 0; phase < factor; phase++) {
+        for (uint32_t i = 0; i < kPhaseTaps; i++)
+            interpolatorCoeffs[phase][i] = factor * table[phase + factor * (kPhaseTaps - 1 - i)] / sum;
+    }
+    for (uint32_t i = 0; i < numTaps; i++)
+        decimatorCoeffs[i] = table[numTaps - 1 - i] / sum;
+
+    return true;
+}
+
+void Oversampler::clear() {
+    memset(interpolatorHistory, 0, sizeof(interpolatorHistory));
+    memset(decimatorHistory, 0, sizeof(decimatorHistory));
+    interpolatorIndex = 0;
+    decimatorIndex = 0;
+}
+
+void Oversampler::upsample(const double* input, double* output, uint32_t numFrames) {
+    if (factor == 1) {
+        if (output != input)
+            memcpy(output, input, numFrames * sizeof(double));
+        return;
+    }
+
+    for (uint32_t i = 0; i < numFrames; i++) {
+        interpolatorHistory[interpolatorIndex] = input[i];
+        interpolatorHistory[interpolatorIndex + kPhaseTaps] = input[i];
+        const double* window = &interpolatorHistory[interpolatorIndex + 1];
+        interpolatorIndex = (interpolatorIndex + 1) & (kPhaseTaps - 1);
+
+        for (uint32_t phase = 0; phase < factor; phase++)
+            output[i * factor + phase] = dotFunction(window, interpolatorCoeffs[phase], kPhaseTaps);
+    }
+}
+
+void Oversampler::downsample(const double* input, double* output, uint32_t numFrames) {
+    if (factor == 1) {
+        if (output != input)
+            memcpy(output, input, numFrames * sizeof(double));
+        return;
+    }
+
+    // --- only the last sample of each group is kept, so only that one is filtered
+    for (uint32_t i = 0; i < numFrames; i++) {
+        for (uint32_t phase = 0; phase < factor; phase++) {
+            decimatorHistory[decimatorIndex] = input[i * factor + phase];
+            decimatorHistory[decimatorIndex + numTaps] = input[i * factor + phase];
+            decimatorIndex = (decimatorIndex + 1) & (numTaps - 1);
+        }
+        output[i] = dotFunction(&decimatorHistory[decimatorIndex], decimatorCoeffs, numTaps);
+    }
+}
+
+bool Oversampler::setKernel(SIMDKernel kernel) {
+    if (!isSIMDKernelSupported(kernel))
+        return false;
+
+    this->kernel = kernel;
+    switch (kernel) {
+#ifdef SIMD_X86
+    case kSSE2Kernel:
+        dotFunction = dotSSE2;
+        break;
+    case kAVX2Kernel:
+        dotFunction = dotAVX2;
+        break;
+#endif
+    default:
+        dotFunction = dotScalar;
+        break;
+    }
+    return true;
+}
+
+SampleDelay::SampleDelay() {
+    delay = 0;
+    buffer.resize(kDefaultMaxDelay);
+    mask = kDefaultMaxDelay - 1;
+    clear();
+}
+
+SampleDelay::~SampleDelay() {
+}
+
+bool SampleDelay::setMaxDelay(uint32_t maxDelay) {
+    uint32_t size = kDefaultMaxDelay;
+    while (size < maxDelay)
+        size <<= 1;
+    if (size <= buffer.size())
+        return true;
+
+    buffer.resize(size);
+    mask = size - 1;
+    clear();
+    return true;
+}
+
+bool SampleDelay::setDelay(uint32_t delay) {
+    if (delay >= buffer.size())
+        return false;
+
+    this->delay = delay;
+    clear();
+    return true;
+}
+
+void SampleDelay::clear() {
+    memset(buffer.data(), 0, buffer.size() * sizeof(double));
+    writeIndex = 0;
+}
+
+void SampleDelay::process(const double* input, double* output, uint32_t numFrames) {
+    if (delay == 0) {
+        if (output != input)
+            memcpy(output, input, numFrames * sizeof(double));
+        return;
+    }
+
+    for (uint32_t i = 0; i < numFrames; i++)
+        output[i] = processSample(input[i]);
+}
+
+double SampleDelay::processSample(double input) {
+    if (delay == 0)
+        return input;
+
+    double output = buffer[(writeIndex - delay) & mask];
+    buffer[writeIndex] = input;
+    writeIndex = (writeIndex + 1) & mask;
+    return output;
+}
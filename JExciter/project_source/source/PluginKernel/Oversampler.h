@@ -0,0 +1,88 @@
+//
+//  Oversampler.h
+//
+//  Polyphase FIR interpolator/decimator pair for running one band's waveshaper at 2x or 4x the base rate.
+//  Uses the ASPiK filters.h lowpass tables: 128 taps for 2x, 256 taps for 4x, 44.1k or 48k family by rate.
+
+// Notes: every polyphase branch is 64 taps, so both factors have the same 63 sample latency at the base rate:
+//        the decimator keeps the last of each group of factor samples, which lands the 127 (255) sample FIR pair
+//        delay on a whole base sample. The tables are scaled to unity DC gain (they are 0.2-0.3 dB low as shipped).
+//        The dot products use 16 partial sums in a fixed order on every kernel (no fma), so scalar, SSE2 and AVX2
+//        agree bit for bit. Factor 1 is a pass through with no latency.
+
+#ifndef __Oversampler_h__
+#define __Oversampler_h__
+
+#include <stdint.h>
+#include <vector>
+#include "SIMDSupport.h"
+
+class Oversampler {
+public:
+    enum { kMaxFactor = 4, kMaxTaps = 256, kPhaseTaps = 64 };
+
+    Oversampler();
+    ~Oversampler();
+
+    // --- 1, 2 or 4; picks the table for the rate and clears the history
+    bool setFactor(uint32_t factor, double sampleRate);
+    uint32_t getFactor() const { return factor; }
+    uint32_t getLatency() const { return factor > 1 ? kPhaseTaps - 1 : 0; }
+    void clear();
+
+    // --- output holds numFrames * factor samples
+    void upsample(const double* input, double* output, uint32_t numFrames);
+    // --- input holds numFrames * factor samples
+    void downsample(const double* input, double* output, uint32_t numFrames);
+
+    bool setKernel(SIMDKernel kernel);
+    SIMDKernel getKernel() const { return kernel; }
+
+protected:
+    typedef double (*DotFunction)(const double* a, const double* b, uint32_t numTaps);
+
+    uint32_t factor;
+    uint32_t numTaps;
+
+    // --- [phase][tap] interpolator branches and the decimator FIR, reversed to run over oldest..newest
+    double interpolatorCoeffs[kMaxFactor][kPhaseTaps];
+    double decimatorCoeffs[kMaxTaps];
+
+    // --- histories are stored twice so the newest numTaps samples are always contiguous
+    double interpolatorHistory[2 * kPhaseTaps];
+    double decimatorHistory[2 * kMaxTaps];
+    uint32_t interpolatorIndex;
+    uint32_t decimatorIndex;
+
+    SIMDKernel kernel;
+    DotFunction dotFunction;
+};
+
+// --- integer sample delay for lining the dry and non-oversampled paths up with the oversampled ones
+class SampleDelay {
+public:
+    enum { kDefaultMaxDelay = 256 };
+
+    SampleDelay();
+    ~SampleDelay();
+
+    // --- delays up to maxDelay - 1; allocates (rounded up to a power of two) and clears, only when it grows
+    bool setMaxDelay(uint32_t maxDelay);
+    uint32_t getMaxDelay() const { return (uint32_t)buffer.size(); }
+
+    bool setDelay(uint32_t delay);
+    uint32_t getDelay() const { return delay; }
+    void clear();
+
+    // --- input and output may be the same buffer
+    void process(const double* input, double* output, uint32_t numFrames);
+    double processSample(double input);
+
+protected:
+    std::vector<double> buffer;
+    uint32_t mask;
+    uint32_t delay;
+    uint32_t writeIndex;
+};
+
+#endif
@@ -0,0 +1,148 @@
+//
+//  ParameterSnapshot.cpp
+//
+//  Lock-free parameter values for the audio thread: writers publish into one contiguous block of atomic values and
+//  the audio thread takes what changed into its own contiguous block once per buffer (see
+//  PluginBase::syncInBoundVariables).
+
+#include "ParameterSnapshot.h"
+
+// --- the snapshot whose audio thread writes are open on this thread, see beginAudioThreadWrites
+static thread_local ParameterSnapshot* audioThreadSnapshot = nullptr;
+
+ParameterSnapshot::ParameterSnapshot()
+    : numParameters(0)
+    , numFlagWords(0)
+    , groupsStarted(0)
+    , groupsEnded(0) {
+}
+
+void ParameterSnapshot::setSize(uint32_t _numParameters) {
+    numParameters = _numParameters;
+    numFlagWords = (numParameters + 63) / 64;
+
+    pendingValues.reset(new std::atomic<float>[numParameters]);
+    for (uint32_t i = 0; i < numParameters; i++)
+        pendingValues[i].store(0.f, std::memory_order_relaxed);
+    pendingJumpFlags.reset(new std::atomic<uint64_t>[numFlagWords]);
+    changedFlags.reset(new std::atomic<uint64_t>[numFlagWords]);
+    for (uint32_t i = 0; i < numFlagWords; i++) {
+        pendingJumpFlags[i].store(0, std::memory_order_relaxed);
+        changedFlags[i].store(0, std::memory_order_relaxed);
+    }
+
+    for (Slot* slot : { &front, &incoming, &local }) {
+        slot->values.assign(numParameters, 0.f);
+        slot->jumpFlags.assign(numFlagWords, 0);
+    }
+    taken.assign(numFlagWords, 0);
+    localChanged.assign(numFlagWords, 0);
+    readChanged.assign(numFlagWords, 0);
+}
+
+void ParameterSnapshot::write(uint32_t index, float value, bool jump) {
+    if (index >= numParameters)
+        return;
+
+    uint32_t word = index / 64;
+    uint64_t flag = 1ull << (index % 64);
+
+    // --- the audio thread's own writes are merged by its next read; nothing to publish
+    if (audioThreadSnapshot == this) {
+        if (!(localChanged[word] & flag) && front.values[index] == value &&
+            ((front.jumpFlags[word] & flag) != 0) == jump)
+            return;
+
+        local.values[index] = value;
+        local.jumpFlags[word] = jump ? local.jumpFlags[word] | flag : local.jumpFlags[word] & ~flag;
+        localChanged[word] |= flag;
+        return;
+    }
+
+    // --- the value first, then the bit that hands it over
+    pendingValues[index].store(value, std::memory_order_relaxed);
+    if (jump)
+        pendingJumpFlags[word].fetch_or(flag, std::memory_order_relaxed);
+    else
+        pendingJumpFlags[word].fetch_and(~flag, std::memory_order_relaxed);
+    changedFlags[word].fetch_or(flag, std::memory_order_release);
+}
+
+void ParameterSnapshot::beginWrite() {
+    groupsStarted.fetch_add(1);
+}
+
+void ParameterSnapshot::endWrite() {
+    groupsEnded.fetch_add(1);
+}
+
+void ParameterSnapshot::beginAudioThreadWrites() {
+    audioThreadSnapshot = this;
+}
+
+void ParameterSnapshot::endAudioThreadWrites() {
+    if (audioThreadSnapshot == this)
+        audioThreadSnapshot = nullptr;
+}
+
+void ParameterSnapshot::read() {
+    for (uint32_t i = 0; i < numFlagWords; i++)
+        readChanged[i] = 0;
+
+    // --- the writers' values, unless a group is open; a group that starts meanwhile undoes the read
+    uint32_t started = groupsStarted.load();
+    if (started == groupsEnded.load()) {
+        bool any = false;
+        for (uint32_t i = 0; i < numFlagWords; i++) {
+            taken[i] = changedFlags[i].exchange(0, std::memory_order_acquire);
+            if (!taken[i])
+                continue;
+
+            any = true;
+            uint64_t changed = taken[i];
+            for (uint32_t index = i * 64; changed; index++, changed >>= 1) {
+                if (changed & 1)
+                    incoming.values[index] = pendingValues[index].load(std::memory_order_relaxed);
+            }
+            incoming.jumpFlags[i] = pendingJumpFlags[i].load(std::memory_order_relaxed);
+        }
+
+        // --- the values above are loaded before the counter is checked again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (any && groupsStarted.load() != started) {
+            for (uint32_t i = 0; i < numFlagWords; i++) {
+                if (taken[i])
+                    changedFlags[i].fetch_or(taken[i], std::memory_order_relaxed);
+            }
+        }
+        else if (any) {
+            for (uint32_t i = 0; i < numFlagWords; i++) {
+                uint64_t changed = taken[i];
+                if (!changed)
+                    continue;
+
+                for (uint32_t index = i * 64; changed; index++, changed >>= 1) {
+                    if (changed & 1)
+                        front.values[index] = incoming.values[index];
+                }
+                front.jumpFlags[i] = (front.jumpFlags[i] & ~taken[i]) | (incoming.jumpFlags[i] & taken[i]);
+                readChanged[i] = taken[i];
+            }
+        }
+    }
+
+    // --- then the local writes, which are newer than anything the writers published before this read
+    for (uint32_t i = 0; i < numFlagWords; i++) {
+        uint64_t changed = localChanged[i];
+        if (!changed)
+            continue;
+
+        for (uint32_t index = i * 64; changed; index++, changed >>= 1) {
+            if (changed & 1)
+                front.values[index] = local.values[index];
+        }
+        front.jumpFlags[i] = (front.jumpFlags[i] & ~localChanged[i]) | (local.jumpFlags[i] & localChanged[i]);
+        readChanged[i] |= localChanged[i];
+        localChanged[i] = 0;
+    }
+}
@@ -0,0 +1,78 @@
+//
+//  ParameterSnapshot.h
+//
+//  Lock-free parameter values for the audio thread: writers publish into one contiguous block of atomic values and
+//  the audio thread takes what changed into its own contiguous block once per buffer (see
+//  PluginBase::syncInBoundVariables).
+
+// Notes: writers (GUI, host, preset and state loads) never lock: a write stores the value and its jump flag, then
+//        raises the parameter's bit in one atomic word per 64 parameters, so a change is never applied before its
+//        value can be seen. Writers on several threads at once are fine; the last value written wins.
+//        beginWrite/endWrite group several writes (a preset) into one publish with a pair of sequence counters:
+//        while a group is open the audio thread takes nothing, and a read that a group started during is undone
+//        (its bits are raised again) and retried next buffer, so a group is applied in one buffer, all or nothing.
+//        Writes from the audio thread itself (VST3 and AAX automation, the AU parameter sync) go between
+//        beginAudioThreadWrites and endAudioThreadWrites, which the wrappers set around them: they go to a local
+//        block that the next read merges in after the writers' values, and repeats of the last value are dropped.
+//        Each value carries a jump flag, set when it was written around the parameter's smoother (state loads).
+//        Everything is allocated by setSize; the writes and read do not allocate.
+
+#ifndef __ParameterSnapshot_h__
+#define __ParameterSnapshot_h__
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class ParameterSnapshot {
+public:
+    ParameterSnapshot();
+
+    // --- all values 0 and unchanged; not thread safe, call before the audio starts
+    void setSize(uint32_t numParameters);
+    uint32_t getSize() const { return numParameters; }
+    uint32_t getNumFlagWords() const { return numFlagWords; }
+
+    // --- writers, any thread; a write outside beginWrite/endWrite is published at once. Groups nest
+    void write(uint32_t index, float value, bool jump);
+    void beginWrite();
+    void endWrite();
+
+    // --- audio thread: its own writes on this thread between these calls are merged by the next read
+    void beginAudioThreadWrites();
+    void endAudioThreadWrites();
+
+    // --- audio thread, once per buffer: takes the newest values and the local writes; until the next read,
+    //     getChangedFlags() holds the parameters written since the last one and getValue/getJump their values
+    void read();
+    const uint64_t* getChangedFlags() const { return readChanged.data(); }
+    float getValue(uint32_t index) const { return front.values[index]; }
+    bool getJump(uint32_t index) const { return (front.jumpFlags[index / 64] >> (index % 64)) & 1; }
+
+protected:
+    struct Slot {
+        std::vector<float> values;
+        std::vector<uint64_t> jumpFlags;
+    };
+
+    uint32_t numParameters;
+    uint32_t numFlagWords;
+
+    // --- writers
+    std::unique_ptr<std::atomic<float>[]> pendingValues;
+    std::unique_ptr<std::atomic<uint64_t>[]> pendingJumpFlags;
+    std::unique_ptr<std::atomic<uint64_t>[]> changedFlags;
+    std::atomic<uint32_t> groupsStarted;
+    std::atomic<uint32_t> groupsEnded;
+
+    // --- audio thread
+    Slot front;
+    Slot incoming;
+    std::vector<uint64_t> taken;
+    Slot local;
+    std::vector<uint64_t> localChanged;
+    std::vector<uint64_t> readChanged;
+};
+
+#endif
@@ -0,0 +1,45 @@
+//
+//  SIMDSupport.cpp
+//
+//  Runtime CPU dispatch shared by the SIMD DSP kernels (crossover, waveshaper).
+
+#include "SIMDSupport.h"
+
+#if defined(SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+bool isSIMDKernelSupported(SIMDKernel kernel) {
+    if (kernel == kScalarKernel)
+        return true;
+
+#if defined(SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    if (kernel == kSSE2Kernel)
+        return (info[3] & (1 << 26)) != 0;
+
+    // --- AVX2 also needs the OS to save the ymm registers
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(SIMD_X86)
+    __builtin_cpu_init();
+    if (kernel == kSSE2Kernel)
+        return __builtin_cpu_supports("sse2") != 0;
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+SIMDKernel getBestSIMDKernel() {
+    if (isSIMDKernelSupported(kAVX2Kernel))
+        return kAVX2Kernel;
+    if (isSIMDKernelSupported(kSSE2Kernel))
+        return kSSE2Kernel;
+    return kScalarKernel;
+}
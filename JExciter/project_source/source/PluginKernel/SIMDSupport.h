@@ -0,0 +1,38 @@
+//
+//  SIMDSupport.h
+//
+//  Runtime CPU dispatch shared by the SIMD DSP kernels (crossover, waveshaper).
+
+// Notes: kernels are compiled with SIMD_TARGET_SSE2/SIMD_TARGET_AVX2 target attributes rather than global
+//        compiler flags, so one binary runs everywhere; only call one after isSIMDKernelSupported() says so.
+//        AVX2 kernels do not enable fma, which keeps them bit compatible with the SSE2 and scalar kernels.
+
+#ifndef __SIMDSupport_h__
+#define __SIMDSupport_h__
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define SIMD_TARGET_SSE2
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// --- scalar kernels that round to float between stages: GCC 12 -O3 SLP vectorization folds the rounding
+//     away in the mono crossover (wrong code, one float ulp off the other kernels), so they opt out of it
+#if defined(__GNUC__) && !defined(__clang__)
+#define SIMD_SCALAR_NO_SLP __attribute__((optimize("no-tree-slp-vectorize")))
+#else
+#define SIMD_SCALAR_NO_SLP
+#endif
+
+enum SIMDKernel { kScalarKernel, kSSE2Kernel, kAVX2Kernel };
+
+bool isSIMDKernelSupported(SIMDKernel kernel);
+SIMDKernel getBestSIMDKernel();
+
+#endif
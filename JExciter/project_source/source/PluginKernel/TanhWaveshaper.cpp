@@ -0,0 +1,631 @@
+//
+//  TanhWaveshaper.cpp
+//
+//  Harmonic exciter waveshaper, out = tanh(drive * in) / tanh(drive), run over whole band buffers.
+
+// Notes: vector tanh follows the cephes double tanh: x + x^3 P(x^2) / Q(x^2) for |x| < 0.625, otherwise
+//        1 - 2 / (exp(2|x|) + 1) with the sign put back. exp uses the cephes Pade form with the 2^n scale built
+//        directly in the exponent bits; |x| is clamped to 22 first, where tanh is already 1.0 in double.
+//        The approximate tiers use the same operations in the same order on every kernel (no fma), so scalar,
+//        SSE2 and AVX2 agree bit for bit.
+//        ADAA evaluates log cosh with the same cephes exp and log steps on every kernel; only the midpoint fallback
+//        differs (libm tanh in the scalar kernel, the vector tanh in SSE2/AVX2), by a few ulps.
+//        processSample() runs the selected kernel on one frame (the SIMD tails use the same vector tanh as the
+//        full vectors), so it matches processBlock() bit for bit in every tier: near zero, where the linear phase
+//        bands cancel, a few ulps of tanh show in the output.
+
+#include "TanhWaveshaper.h"
+#include <math.h>
+#include <string.h>
+
+static const double kTanhP0 = -9.64399179425052238628E-1;
+static const double kTanhP1 = -9.92877231001918586564E1;
+static const double kTanhP2 = -1.61468768441708447952E3;
+static const double kTanhQ0 = 1.12811678491632931402E2;
+static const double kTanhQ1 = 2.23548839060100448583E3;
+static const double kTanhQ2 = 4.84406305325125486048E3;
+
+static const double kExpP0 = 1.26177193074810590878E-4;
+static const double kExpP1 = 3.02994407707441961300E-2;
+static const double kExpP2 = 9.99999999999999999910E-1;
+static const double kExpQ0 = 3.00198505138664455042E-6;
+static const double kExpQ1 = 2.52448340349684104192E-3;
+static const double kExpQ2 = 2.27265548208155028766E-1;
+static const double kExpQ3 = 2.00000000000000000009E0;
+static const double kExpC1 = 6.93145751953125E-1;
+static const double kExpC2 = 1.42860682030941723212E-6;
+static const double kLog2e = 1.4426950408889634073599;
+
+static const double kTanhSmall = 0.625;
+static const double kTanhLarge = 22.0;
+
+// --- kRationalTanh: x (135135 + 17325x^2 + 378x^4 + x^6) / (135135 + 62370x^2 + 3150x^4 + 28x^6); the clamp is
+//     where the error just past it (1 - r(c)) equals the error below it
+static const double kRationalN0 = 135135.0;
+static const double kRationalN1 = 17325.0;
+static const double kRationalN2 = 378.0;
+static const double kRationalD0 = 135135.0;
+static const double kRationalD1 = 62370.0;
+static const double kRationalD2 = 3150.0;
+static const double kRationalD3 = 28.0;
+static const double kRationalLimit = 4.783;
+
+// --- kPolynomialTanh: 2^f = 1 + f P(f) on [-0.5, 0.5], minimax relative error 9.2e-8 with P(0) kept exact so
+//     tanh(0) = 0; tanh of the clamped |x| is already within 4.2e-9 of 1
+static const double kExp2C1 = 0.69314697759885746;
+static const double kExp2C2 = 0.24022242085173215;
+static const double kExp2C3 = 0.055507337436910074;
+static const double kExp2C4 = 0.0096715126489113051;
+static const double kExp2C5 = 0.0013264727065335584;
+static const double kPolynomialLimit = 10.0;
+
+// --- ADAA: log cosh(z) = |z| - ln 2 + log(1 + t) with t = exp(-2|z|) in (0, 1]. log(1 + t) is the cephes log
+//     core on x = t, or on x = (t - 1) / 2 plus ln 2 once 1 + t > sqrt(2), so 1 + t itself is never rounded
+static const double kLogP0 = 1.01875663804580931796E-4;
+static const double kLogP1 = 4.97494994976747001425E-1;
+static const double kLogP2 = 4.70579119878881725854E0;
+static const double kLogP3 = 1.44989225341610930846E1;
+static const double kLogP4 = 1.79368678507819816313E1;
+static const double kLogP5 = 7.70838733755885391666E0;
+static const double kLogQ0 = 1.12873587189167450590E1;
+static const double kLogQ1 = 4.52279145837532221105E1;
+static const double kLogQ2 = 8.29875266912776603211E1;
+static const double kLogQ3 = 7.11544750618563894466E1;
+static const double kLogQ4 = 2.31251620126765340583E1;
+static const double kLn2Hi = 0.693359375;
+static const double kLn2Lo = -2.121944400546905827679E-4;
+static const double kSqrt2Minus1 = 0.41421356237309504880;
+
+// --- past |z| = 22, log(1 + t) < 1e-19 no longer shows next to |z|; below the tolerance the divided difference
+//     loses more to cancellation (about 1e-15 / dz) than the midpoint rule does (about dz^2 / 24)
+static const double kLogCoshLarge = 22.0;
+static const double kADAATolerance = 1e-5;
+
+static inline double tanhRational(double x) {
+    double z = x < -kRationalLimit ? -kRationalLimit : (x > kRationalLimit ? kRationalLimit : x);
+    double z2 = z * z;
+    double n = ((z2 + kRationalN2) * z2 + kRationalN1) * z2 + kRationalN0;
+    double d = ((kRationalD3 * z2 + kRationalD2) * z2 + kRationalD1) * z2 + kRationalD0;
+    return z * n / d;
+}
+
+static inline double tanhPolynomial(double x) {
+    double z = fabs(x);
+    if (z > kPolynomialLimit)
+        z = kPolynomialLimit;
+
+    // --- exp(2z) = 2^n * 2^f with n = round(2z log2 e), |f| <= 0.5
+    double y = z * (2.0 * kLog2e);
+    int n = (int)(y + 0.5);
+    double f = y - n;
+    uint64_t bits = (uint64_t)(n + 1023) << 52;
+    double scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    double e = (((((kExp2C5 * f + kExp2C4) * f + kExp2C3) * f + kExp2C2) * f + kExp2C1) * f + 1.0) * scale;
+    double t = (e - 1.0) / (e + 1.0);
+    return copysign(t, x);
+}
+
+static void processScalarBlock(const double* input, double* output, uint32_t numFrames, double drive,
+    double normalizer, double /*normalizerInverse*/) {
+    for (uint32_t i = 0; i < numFrames; i++)
+        output[i] = tanh(drive * input[i]) / normalizer;
+}
+
+template <double (*Tanh)(double)>
+static void processApproximateScalarBlock(const double* input, double* output, uint32_t numFrames, double drive,
+    double /*normalizer*/, double normalizerInverse) {
+    for (uint32_t i = 0; i < numFrames; i++)
+        output[i] = Tanh(drive * input[i]) * normalizerInverse;
+}
+
+static inline double logCosh(double z) {
+    double a = fabs(z);
+
+    // --- t = exp(-2|z|), exp(y) = (1 + 2r P(r^2) / (Q(r^2) - r P(r^2))) * 2^n, n = round(y log2 e) for y <= 0
+    double y = -2.0 * (a < kLogCoshLarge ? a : kLogCoshLarge);
+    int n = (int)(y * kLog2e - 0.5);
+    double fn = n;
+    double r = (y - fn * kExpC1) - fn * kExpC2;
+    double r2 = r * r;
+    double px = r * ((kExpP0 * r2 + kExpP1) * r2 + kExpP2);
+    double qx = ((kExpQ0 * r2 + kExpQ1) * r2 + kExpQ2) * r2 + kExpQ3;
+    uint64_t bits = (uint64_t)(n + 1023) << 52;
+    double scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    double t = (1.0 + 2.0 * (px / (qx - px))) * scale;
+
+    bool upper = t > kSqrt2Minus1;
+    double x = upper ? (t - 1.0) * 0.5 : t;
+    double k = upper ? 0.0 : -1.0;
+    double x2 = x * x;
+    double p = ((((kLogP0 * x + kLogP1) * x + kLogP2) * x + kLogP3) * x + kLogP4) * x + kLogP5;
+    double q = ((((x + kLogQ0) * x + kLogQ1) * x + kLogQ2) * x + kLogQ3) * x + kLogQ4;
+    double l = x * (x2 * p / q);
+    l = l + k * kLn2Lo;
+    l = l - 0.5 * x2;
+    l = (x + l) + k * kLn2Hi;
+    return a + l;
+}
+
+static inline double antiderivativeStep(double z0, double z1, double g0, double g1) {
+    double dz = z1 - z0;
+    if (fabs(dz) < kADAATolerance)
+        return tanh(0.5 * (z0 + z1));
+    return (g1 - g0) / dz;
+}
+
+static void processADAAScalarBlock(const double* input, double* output, uint32_t numFrames, double drive,
+    double normalizerInverse, double& previousInput, double& previousLogCosh) {
+    if (numFrames == 0)
+        return;
+
+    double z0 = drive * previousInput;
+    double g0 = previousLogCosh;
+    double x = 0.0;
+    for (uint32_t i = 0; i < numFrames; i++) {
+        x = input[i];
+        double z1 = drive * x;
+        double g1 = logCosh(z1);
+        output[i] = antiderivativeStep(z0, z1, g0, g1) * normalizerInverse;
+        z0 = z1;
+        g0 = g1;
+    }
+    previousInput = x;
+    previousLogCosh = g0;
+}
+
+#ifdef SIMD_X86
+
+SIMD_TARGET_SSE2 static inline __m128d tanhSSE2(__m128d x) {
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    __m128d sign = _mm_and_pd(x, signMask);
+    __m128d z = _mm_min_pd(_mm_andnot_pd(signMask, x), _mm_set1_pd(kTanhLarge));
+
+    // --- |x| < 0.625: rational approximation
+    __m128d z2 = _mm_mul_pd(z, z);
+    __m128d p = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(kTanhP0), z2), _mm_set1_pd(kTanhP1)), z2), _mm_set1_pd(kTanhP2));
+    __m128d q = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(z2, _mm_set1_pd(kTanhQ0)), z2), _mm_set1_pd(kTanhQ1)), z2), _mm_set1_pd(kTanhQ2));
+    __m128d small = _mm_add_pd(z, _mm_div_pd(_mm_mul_pd(_mm_mul_pd(z, z2), p), q));
+
+    // --- otherwise: 1 - 2 / (exp(2|x|) + 1), exp(y) = (1 + 2r P(r^2) / (Q(r^2) - r P(r^2))) * 2^n
+    __m128d y = _mm_add_pd(z, z);
+    __m128i n = _mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(y, _mm_set1_pd(kLog2e)), _mm_set1_pd(0.5)));
+    __m128d fn = _mm_cvtepi32_pd(n);
+    __m128d r = _mm_sub_pd(_mm_sub_pd(y, _mm_mul_pd(fn, _mm_set1_pd(kExpC1))), _mm_mul_pd(fn, _mm_set1_pd(kExpC2)));
+    __m128d r2 = _mm_mul_pd(r, r);
+    __m128d px = _mm_mul_pd(r, _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(kExpP0), r2), _mm_set1_pd(kExpP1)), r2), _mm_set1_pd(kExpP2)));
+    __m128d qx = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(kExpQ0), r2), _mm_set1_pd(kExpQ1)), r2), _mm_set1_pd(kExpQ2)), r2), _mm_set1_pd(kExpQ3));
+    __m128d e = _mm_add_pd(_mm_set1_pd(1.0), _mm_mul_pd(_mm_set1_pd(2.0), _mm_div_pd(px, _mm_sub_pd(qx, px))));
+    __m128i exponent = _mm_slli_epi64(_mm_add_epi64(_mm_unpacklo_epi32(n, _mm_setzero_si128()), _mm_set1_epi64x(1023)), 52);
+    e = _mm_mul_pd(e, _mm_castsi128_pd(exponent));
+    __m128d large = _mm_sub_pd(_mm_set1_pd(1.0), _mm_div_pd(_mm_set1_pd(2.0), _mm_add_pd(e, _mm_set1_pd(1.0))));
+
+    __m128d useSmall = _mm_cmplt_pd(z, _mm_set1_pd(kTanhSmall));
+    __m128d t = _mm_or_pd(_mm_and_pd(useSmall, small), _mm_andnot_pd(useSmall, large));
+    return _mm_or_pd(t, sign);
+}
+
+SIMD_TARGET_AVX2 static inline __m256d tanhAVX2(__m256d x) {
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    __m256d sign = _mm256_and_pd(x, signMask);
+    __m256d z = _mm256_min_pd(_mm256_andnot_pd(signMask, x), _mm256_set1_pd(kTanhLarge));
+
+    // --- |x| < 0.625: rational approximation
+    __m256d z2 = _mm256_mul_pd(z, z);
+    __m256d p = _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(kTanhP0), z2), _mm256_set1_pd(kTanhP1)), z2), _mm256_set1_pd(kTanhP2));
+    __m256d q = _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(z2, _mm256_set1_pd(kTanhQ0)), z2), _mm256_set1_pd(kTanhQ1)), z2), _mm256_set1_pd(kTanhQ2));
+    __m256d small = _mm256_add_pd(z, _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(z, z2), p), q));
+
+    // --- otherwise: 1 - 2 / (exp(2|x|) + 1), exp(y) = (1 + 2r P(r^2) / (Q(r^2) - r P(r^2))) * 2^n
+    __m256d y = _mm256_add_pd(z, z);
+    __m128i n = _mm256_cvttpd_epi32(_mm256_add_pd(_mm256_mul_pd(y, _mm256_set1_pd(kLog2e)), _mm256_set1_pd(0.5)));
+    __m256d fn = _mm256_cvtepi32_pd(n);
+    __m256d r = _mm256_sub_pd(_mm256_sub_pd(y, _mm256_mul_pd(fn, _mm256_set1_pd(kExpC1))), _mm256_mul_pd(fn, _mm256_set1_pd(kExpC2)));
+    __m256d r2 = _mm256_mul_pd(r, r);
+    __m256d px = _mm256_mul_pd(r, _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(kExpP0), r2), _mm256_set1_pd(kExpP1)), r2), _mm256_set1_pd(kExpP2)));
+    __m256d qx = _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(kExpQ0), r2), _mm256_set1_pd(kExpQ1)), r2), _mm256_set1_pd(kExpQ2)), r2), _mm256_set1_pd(kExpQ3));
+    __m256d e = _mm256_add_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(_mm256_set1_pd(2.0), _mm256_div_pd(px, _mm256_sub_pd(qx, px))));
+    __m256i exponent = _mm256_slli_epi64(_mm256_add_epi64(_mm256_cvtepi32_epi64(n), _mm256_set1_epi64x(1023)), 52);
+    e = _mm256_mul_pd(e, _mm256_castsi256_pd(exponent));
+    __m256d large = _mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_div_pd(_mm256_set1_pd(2.0), _mm256_add_pd(e, _mm256_set1_pd(1.0))));
+
+    __m256d t = _mm256_blendv_pd(large, small, _mm256_cmp_pd(z, _mm256_set1_pd(kTanhSmall), _CMP_LT_OQ));
+    return _mm256_or_pd(t, sign);
+}
+
+SIMD_TARGET_SSE2 static inline __m128d tanhRationalSSE2(__m128d x) {
+    __m128d z = _mm_max_pd(_mm_min_pd(x, _mm_set1_pd(kRationalLimit)), _mm_set1_pd(-kRationalLimit));
+    __m128d z2 = _mm_mul_pd(z, z);
+    __m128d n = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(z2, _mm_set1_pd(kRationalN2)), z2), _mm_set1_pd(kRationalN1)), z2), _mm_set1_pd(kRationalN0));
+    __m128d d = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(kRationalD3), z2), _mm_set1_pd(kRationalD2)), z2), _mm_set1_pd(kRationalD1)), z2), _mm_set1_pd(kRationalD0));
+    return _mm_div_pd(_mm_mul_pd(z, n), d);
+}
+
+SIMD_TARGET_AVX2 static inline __m256d tanhRationalAVX2(__m256d x) {
+    __m256d z = _mm256_max_pd(_mm256_min_pd(x, _mm256_set1_pd(kRationalLimit)), _mm256_set1_pd(-kRationalLimit));
+    __m256d z2 = _mm256_mul_pd(z, z);
+    __m256d n = _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(z2, _mm256_set1_pd(kRationalN2)), z2), _mm256_set1_pd(kRationalN1)), z2), _mm256_set1_pd(kRationalN0));
+    __m256d d = _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(kRationalD3), z2), _mm256_set1_pd(kRationalD2)), z2), _mm256_set1_pd(kRationalD1)), z2), _mm256_set1_pd(kRationalD0));
+    return _mm256_div_pd(_mm256_mul_pd(z, n), d);
+}
+
+SIMD_TARGET_SSE2 static inline __m128d tanhPolynomialSSE2(__m128d x) {
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    __m128d sign = _mm_and_pd(x, signMask);
+    __m128d z = _mm_min_pd(_mm_andnot_pd(signMask, x), _mm_set1_pd(kPolynomialLimit));
+
+    __m128d y = _mm_mul_pd(z, _mm_set1_pd(2.0 * kLog2e));
+    __m128i n = _mm_cvttpd_epi32(_mm_add_pd(y, _mm_set1_pd(0.5)));
+    __m128d f = _mm_sub_pd(y, _mm_cvtepi32_pd(n));
+    __m128d p = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(kExp2C5), f), _mm_set1_pd(kExp2C4));
+    p = _mm_add_pd(_mm_mul_pd(p, f), _mm_set1_pd(kExp2C3));
+    p = _mm_add_pd(_mm_mul_pd(p, f), _mm_set1_pd(kExp2C2));
+    p = _mm_add_pd(_mm_mul_pd(p, f), _mm_set1_pd(kExp2C1));
+    p = _mm_add_pd(_mm_mul_pd(p, f), _mm_set1_pd(1.0));
+    __m128i exponent = _mm_slli_epi64(_mm_add_epi64(_mm_unpacklo_epi32(n, _mm_setzero_si128()), _mm_set1_epi64x(1023)), 52);
+    __m128d e = _mm_mul_pd(p, _mm_castsi128_pd(exponent));
+
+    __m128d t = _mm_div_pd(_mm_sub_pd(e, _mm_set1_pd(1.0)), _mm_add_pd(e, _mm_set1_pd(1.0)));
+    return _mm_or_pd(t, sign);
+}
+
+SIMD_TARGET_AVX2 static inline __m256d tanhPolynomialAVX2(__m256d x) {
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    __m256d sign = _mm256_and_pd(x, signMask);
+    __m256d z = _mm256_min_pd(_mm256_andnot_pd(signMask, x), _mm256_set1_pd(kPolynomialLimit));
+
+    __m256d y = _mm256_mul_pd(z, _mm256_set1_pd(2.0 * kLog2e));
+    __m128i n = _mm256_cvttpd_epi32(_mm256_add_pd(y, _mm256_set1_pd(0.5)));
+    __m256d f = _mm256_sub_pd(y, _mm256_cvtepi32_pd(n));
+    __m256d p = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(kExp2C5), f), _mm256_set1_pd(kExp2C4));
+    p = _mm256_add_pd(_mm256_mul_pd(p, f), _mm256_set1_pd(kExp2C3));
+    p = _mm256_add_pd(_mm256_mul_pd(p, f), _mm256_set1_pd(kExp2C2));
+    p = _mm256_add_pd(_mm256_mul_pd(p, f), _mm256_set1_pd(kExp2C1));
+    p = _mm256_add_pd(_mm256_mul_pd(p, f), _mm256_set1_pd(1.0));
+    __m256i exponent = _mm256_slli_epi64(_mm256_add_epi64(_mm256_cvtepi32_epi64(n), _mm256_set1_epi64x(1023)), 52);
+    __m256d e = _mm256_mul_pd(p, _mm256_castsi256_pd(exponent));
+
+    __m256d t = _mm256_div_pd(_mm256_sub_pd(e, _mm256_set1_pd(1.0)), _mm256_add_pd(e, _mm256_set1_pd(1.0)));
+    return _mm256_or_pd(t, sign);
+}
+
+SIMD_TARGET_SSE2 static void processSSE2Block(const double* input, double* output, uint32_t numFrames, double drive,
+    double normalizer, double /*normalizerInverse*/) {
+    const __m128d k = _mm_set1_pd(drive);
+    const __m128d norm = _mm_set1_pd(normalizer);
+
+    uint32_t i = 0;
+    for (; i + 2 <= numFrames; i += 2)
+        _mm_storeu_pd(&output[i], _mm_div_pd(tanhSSE2(_mm_mul_pd(k, _mm_loadu_pd(&input[i]))), norm));
+    for (; i < numFrames; i++)
+        _mm_store_sd(&output[i], _mm_div_sd(tanhSSE2(_mm_set1_pd(drive * input[i])), norm));
+}
+
+SIMD_TARGET_AVX2 static void processAVX2Block(const double* input, double* output, uint32_t numFrames, double drive,
+    double normalizer, double /*normalizerInverse*/) {
+    const __m256d k = _mm256_set1_pd(drive);
+    const __m256d norm = _mm256_set1_pd(normalizer);
+
+    uint32_t i = 0;
+    for (; i + 4 <= numFrames; i += 4)
+        _mm256_storeu_pd(&output[i], _mm256_div_pd(tanhAVX2(_mm256_mul_pd(k, _mm256_loadu_pd(&input[i]))), norm));
+    for (; i < numFrames; i++)
+        _mm_store_sd(&output[i], _mm_div_sd(tanhSSE2(_mm_set1_pd(drive * input[i])), _mm256_castpd256_pd128(norm)));
+}
+
+// --- approximate tiers; the tail frames use the scalar version, which is bit identical
+template <__m128d (*Tanh)(__m128d), double (*ScalarTanh)(double)>
+SIMD_TARGET_SSE2 static void processApproximateSSE2Block(const double* input, double* output, uint32_t numFrames, double drive,
+    double /*normalizer*/, double normalizerInverse) {
+    const __m128d k = _mm_set1_pd(drive);
+    const __m128d scale = _mm_set1_pd(normalizerInverse);
+
+    uint32_t i = 0;
+    for (; i + 2 <= numFrames; i += 2)
+        _mm_storeu_pd(&output[i], _mm_mul_pd(Tanh(_mm_mul_pd(k, _mm_loadu_pd(&input[i]))), scale));
+    for (; i < numFrames; i++)
+        output[i] = ScalarTanh(drive * input[i]) * normalizerInverse;
+}
+
+template <__m256d (*Tanh)(__m256d), double (*ScalarTanh)(double)>
+SIMD_TARGET_AVX2 static void processApproximateAVX2Block(const double* input, double* output, uint32_t numFrames, double drive,
+    double /*normalizer*/, double normalizerInverse) {
+    const __m256d k = _mm256_set1_pd(drive);
+    const __m256d scale = _mm256_set1_pd(normalizerInverse);
+
+    uint32_t i = 0;
+    for (; i + 4 <= numFrames; i += 4)
+        _mm256_storeu_pd(&output[i], _mm256_mul_pd(Tanh(_mm256_mul_pd(k, _mm256_loadu_pd(&input[i]))), scale));
+    for (; i < numFrames; i++)
+        output[i] = ScalarTanh(drive * input[i]) * normalizerInverse;
+}
+
+SIMD_TARGET_SSE2 static inline __m128d logCoshSSE2(__m128d z) {
+    __m128d a = _mm_andnot_pd(_mm_set1_pd(-0.0), z);
+
+    __m128d y = _mm_mul_pd(_mm_set1_pd(-2.0), _mm_min_pd(a, _mm_set1_pd(kLogCoshLarge)));
+    __m128i n = _mm_cvttpd_epi32(_mm_sub_pd(_mm_mul_pd(y, _mm_set1_pd(kLog2e)), _mm_set1_pd(0.5)));
+    __m128d fn = _mm_cvtepi32_pd(n);
+    __m128d r = _mm_sub_pd(_mm_sub_pd(y, _mm_mul_pd(fn, _mm_set1_pd(kExpC1))), _mm_mul_pd(fn, _mm_set1_pd(kExpC2)));
+    __m128d r2 = _mm_mul_pd(r, r);
+    __m128d px = _mm_mul_pd(r, _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(kExpP0), r2), _mm_set1_pd(kExpP1)), r2), _mm_set1_pd(kExpP2)));
+    __m128d qx = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(kExpQ0), r2), _mm_set1_pd(kExpQ1)), r2), _mm_set1_pd(kExpQ2)), r2), _mm_set1_pd(kExpQ3));
+    // --- n < 0 here; the zero extended n + 1023 still has the right low 11 bits, the shift drops the rest
+    __m128i exponent = _mm_slli_epi64(_mm_add_epi64(_mm_unpacklo_epi32(n, _mm_setzero_si128()), _mm_set1_epi64x(1023)), 52);
+    __m128d t = _mm_mul_pd(_mm_add_pd(_mm_set1_pd(1.0), _mm_mul_pd(_mm_set1_pd(2.0), _mm_div_pd(px, _mm_sub_pd(qx, px)))),
+        _mm_castsi128_pd(exponent));
+
+    __m128d upper = _mm_cmpgt_pd(t, _mm_set1_pd(kSqrt2Minus1));
+    __m128d x = _mm_or_pd(_mm_and_pd(upper, _mm_mul_pd(_mm_sub_pd(t, _mm_set1_pd(1.0)), _mm_set1_pd(0.5))), _mm_andnot_pd(upper, t));
+    __m128d k = _mm_andnot_pd(upper, _mm_set1_pd(-1.0));
+    __m128d x2 = _mm_mul_pd(x, x);
+    __m128d p = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(kLogP0), x), _mm_set1_pd(kLogP1));
+    p = _mm_add_pd(_mm_mul_pd(p, x), _mm_set1_pd(kLogP2));
+    p = _mm_add_pd(_mm_mul_pd(p, x), _mm_set1_pd(kLogP3));
+    p = _mm_add_pd(_mm_mul_pd(p, x), _mm_set1_pd(kLogP4));
+    p = _mm_add_pd(_mm_mul_pd(p, x), _mm_set1_pd(kLogP5));
+    __m128d q = _mm_add_pd(x, _mm_set1_pd(kLogQ0));
+    q = _mm_add_pd(_mm_mul_pd(q, x), _mm_set1_pd(kLogQ1));
+    q = _mm_add_pd(_mm_mul_pd(q, x), _mm_set1_pd(kLogQ2));
+    q = _mm_add_pd(_mm_mul_pd(q, x), _mm_set1_pd(kLogQ3));
+    q = _mm_add_pd(_mm_mul_pd(q, x), _mm_set1_pd(kLogQ4));
+    __m128d l = _mm_mul_pd(x, _mm_div_pd(_mm_mul_pd(x2, p), q));
+    l = _mm_add_pd(l, _mm_mul_pd(k, _mm_set1_pd(kLn2Lo)));
+    l = _mm_sub_pd(l, _mm_mul_pd(_mm_set1_pd(0.5), x2));
+    l = _mm_add_pd(_mm_add_pd(x, l), _mm_mul_pd(k, _mm_set1_pd(kLn2Hi)));
+    return _mm_add_pd(a, l);
+}
+
+SIMD_TARGET_AVX2 static inline __m256d logCoshAVX2(__m256d z) {
+    __m256d a = _mm256_andnot_pd(_mm256_set1_pd(-0.0), z);
+
+    __m256d y = _mm256_mul_pd(_mm256_set1_pd(-2.0), _mm256_min_pd(a, _mm256_set1_pd(kLogCoshLarge)));
+    __m128i n = _mm256_cvttpd_epi32(_mm256_sub_pd(_mm256_mul_pd(y, _mm256_set1_pd(kLog2e)), _mm256_set1_pd(0.5)));
+    __m256d fn = _mm256_cvtepi32_pd(n);
+    __m256d r = _mm256_sub_pd(_mm256_sub_pd(y, _mm256_mul_pd(fn, _mm256_set1_pd(kExpC1))), _mm256_mul_pd(fn, _mm256_set1_pd(kExpC2)));
+    __m256d r2 = _mm256_mul_pd(r, r);
+    __m256d px = _mm256_mul_pd(r, _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(kExpP0), r2), _mm256_set1_pd(kExpP1)), r2), _mm256_set1_pd(kExpP2)));
+    __m256d qx = _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(kExpQ0), r2), _mm256_set1_pd(kExpQ1)), r2), _mm256_set1_pd(kExpQ2)), r2), _mm256_set1_pd(kExpQ3));
+    __m256i exponent = _mm256_slli_epi64(_mm256_add_epi64(_mm256_cvtepi32_epi64(n), _mm256_set1_epi64x(1023)), 52);
+    __m256d t = _mm256_mul_pd(_mm256_add_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(_mm256_set1_pd(2.0), _mm256_div_pd(px, _mm256_sub_pd(qx, px)))),
+        _mm256_castsi256_pd(exponent));
+
+    __m256d upper = _mm256_cmp_pd(t, _mm256_set1_pd(kSqrt2Minus1), _CMP_GT_OQ);
+    __m256d x = _mm256_blendv_pd(t, _mm256_mul_pd(_mm256_sub_pd(t, _mm256_set1_pd(1.0)), _mm256_set1_pd(0.5)), upper);
+    __m256d k = _mm256_andnot_pd(upper, _mm256_set1_pd(-1.0));
+    __m256d x2 = _mm256_mul_pd(x, x);
+    __m256d p = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(kLogP0), x), _mm256_set1_pd(kLogP1));
+    p = _mm256_add_pd(_mm256_mul_pd(p, x), _mm256_set1_pd(kLogP2));
+    p = _mm256_add_pd(_mm256_mul_pd(p, x), _mm256_set1_pd(kLogP3));
+    p = _mm256_add_pd(_mm256_mul_pd(p, x), _mm256_set1_pd(kLogP4));
+    p = _mm256_add_pd(_mm256_mul_pd(p, x), _mm256_set1_pd(kLogP5));
+    __m256d q = _mm256_add_pd(x, _mm256_set1_pd(kLogQ0));
+    q = _mm256_add_pd(_mm256_mul_pd(q, x), _mm256_set1_pd(kLogQ1));
+    q = _mm256_add_pd(_mm256_mul_pd(q, x), _mm256_set1_pd(kLogQ2));
+    q = _mm256_add_pd(_mm256_mul_pd(q, x), _mm256_set1_pd(kLogQ3));
+    q = _mm256_add_pd(_mm256_mul_pd(q, x), _mm256_set1_pd(kLogQ4));
+    __m256d l = _mm256_mul_pd(x, _mm256_div_pd(_mm256_mul_pd(x2, p), q));
+    l = _mm256_add_pd(l, _mm256_mul_pd(k, _mm256_set1_pd(kLn2Lo)));
+    l = _mm256_sub_pd(l, _mm256_mul_pd(_mm256_set1_pd(0.5), x2));
+    l = _mm256_add_pd(_mm256_add_pd(x, l), _mm256_mul_pd(k, _mm256_set1_pd(kLn2Hi)));
+    return _mm256_add_pd(a, l);
+}
+
+// --- ADAA runs in chunks: z = drive * x and log cosh(z) for the chunk first (z[0], g[0] hold the previous sample),
+//     then the divided differences. Both arrays are padded with the last value so the vectors never need a tail.
+static const uint32_t kADAAChunkFrames = 64;
+
+SIMD_TARGET_SSE2 static void processADAASSE2Block(const double* input, double* output, uint32_t numFrames, double drive,
+    double normalizerInverse, double& previousInput, double& previousLogCosh) {
+    double z[kADAAChunkFrames + 4];
+    double g[kADAAChunkFrames + 4];
+    double y[kADAAChunkFrames + 4];
+    const __m128d tolerance = _mm_set1_pd(kADAATolerance);
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    const __m128d scale = _mm_set1_pd(normalizerInverse);
+
+    for (uint32_t offset = 0; offset < numFrames; offset += kADAAChunkFrames) {
+        uint32_t n = numFrames - offset < kADAAChunkFrames ? numFrames - offset : kADAAChunkFrames;
+        uint32_t padded = (n + 1) & ~1u;
+
+        z[0] = drive * previousInput;
+        g[0] = previousLogCosh;
+        for (uint32_t i = 0; i < n; i++)
+            z[i + 1] = drive * input[offset + i];
+        for (uint32_t i = n; i < padded; i++)
+            z[i + 1] = z[n];
+        double lastInput = input[offset + n - 1];
+
+        for (uint32_t i = 0; i < padded; i += 2)
+            _mm_storeu_pd(&g[i + 1], logCoshSSE2(_mm_loadu_pd(&z[i + 1])));
+
+        for (uint32_t i = 0; i < padded; i += 2) {
+            __m128d z0 = _mm_loadu_pd(&z[i]);
+            __m128d z1 = _mm_loadu_pd(&z[i + 1]);
+            __m128d dz = _mm_sub_pd(z1, z0);
+            __m128d out = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(&g[i + 1]), _mm_loadu_pd(&g[i])), dz);
+            __m128d ill = _mm_cmplt_pd(_mm_andnot_pd(signMask, dz), tolerance);
+            if (_mm_movemask_pd(ill)) {
+                __m128d mid = tanhSSE2(_mm_mul_pd(_mm_set1_pd(0.5), _mm_add_pd(z0, z1)));
+                out = _mm_or_pd(_mm_and_pd(ill, mid), _mm_andnot_pd(ill, out));
+            }
+            _mm_storeu_pd(&y[i], _mm_mul_pd(out, scale));
+        }
+        memcpy(&output[offset], y, n * sizeof(double));
+
+        previousInput = lastInput;
+        previousLogCosh = g[n];
+    }
+}
+
+SIMD_TARGET_AVX2 static void processADAAAVX2Block(const double* input, double* output, uint32_t numFrames, double drive,
+    double normalizerInverse, double& previousInput, double& previousLogCosh) {
+    double z[kADAAChunkFrames + 4];
+    double g[kADAAChunkFrames + 4];
+    double y[kADAAChunkFrames + 4];
+    const __m256d tolerance = _mm256_set1_pd(kADAATolerance);
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    const __m256d scale = _mm256_set1_pd(normalizerInverse);
+
+    for (uint32_t offset = 0; offset < numFrames; offset += kADAAChunkFrames) {
+        uint32_t n = numFrames - offset < kADAAChunkFrames ? numFrames - offset : kADAAChunkFrames;
+        uint32_t padded = (n + 3) & ~3u;
+
+        z[0] = drive * previousInput;
+        g[0] = previousLogCosh;
+        for (uint32_t i = 0; i < n; i++)
+            z[i + 1] = drive * input[offset + i];
+        for (uint32_t i = n; i < padded; i++)
+            z[i + 1] = z[n];
+        double lastInput = input[offset + n - 1];
+
+        for (uint32_t i = 0; i < padded; i += 4)
+            _mm256_storeu_pd(&g[i + 1], logCoshAVX2(_mm256_loadu_pd(&z[i + 1])));
+
+        for (uint32_t i = 0; i < padded; i += 4) {
+            __m256d z0 = _mm256_loadu_pd(&z[i]);
+            __m256d z1 = _mm256_loadu_pd(&z[i + 1]);
+            __m256d dz = _mm256_sub_pd(z1, z0);
+            __m256d out = _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(&g[i + 1]), _mm256_loadu_pd(&g[i])), dz);
+            __m256d ill = _mm256_cmp_pd(_mm256_andnot_pd(signMask, dz), tolerance, _CMP_LT_OQ);
+            if (_mm256_movemask_pd(ill)) {
+                __m256d mid = tanhAVX2(_mm256_mul_pd(_mm256_set1_pd(0.5), _mm256_add_pd(z0, z1)));
+                out = _mm256_blendv_pd(out, mid, ill);
+            }
+            _mm256_storeu_pd(&y[i], _mm256_mul_pd(out, scale));
+        }
+        memcpy(&output[offset], y, n * sizeof(double));
+
+        previousInput = lastInput;
+        previousLogCosh = g[n];
+    }
+}
+
+#endif
+
+TanhWaveshaper::TanhWaveshaper() {
+    drive = 1.0;
+    normalizer = tanh(drive);
+    normalizerInverse = 1.0 / normalizer;
+    previousInput = 0.0;
+    previousLogCosh = 0.0;
+    quality = kExactTanh;
+    antialiasing = kNoAntialiasing;
+    kernel = kScalarKernel;
+    blockFunction = processScalarBlock;
+    antiderivativeFunction = processADAAScalarBlock;
+    setKernel(getBestSIMDKernel());
+}
+
+TanhWaveshaper::~TanhWaveshaper() {
+}
+
+void TanhWaveshaper::setDrive(double drive) {
+    if (drive == this->drive)
+        return;
+
+    this->drive = drive;
+    normalizer = tanh(drive);
+    normalizerInverse = 1.0 / normalizer;
+    previousLogCosh = logCosh(drive * previousInput);
+}
+
+// --- one frame through the kernel's block function, so the frame path renders what processBlock() does
+double TanhWaveshaper::processSample(double input) {
+    double output;
+    processBlock(&input, &output, 1);
+    return output;
+}
+
+void TanhWaveshaper::processBlock(const double* input, double* output, uint32_t numFrames) {
+    if (antialiasing == kFirstOrderADAA)
+        antiderivativeFunction(input, output, numFrames, drive, normalizerInverse, previousInput, previousLogCosh);
+    else
+        blockFunction(input, output, numFrames, drive, normalizer, normalizerInverse);
+}
+
+void TanhWaveshaper::processBlock(const double* input, double* output, uint32_t numFrames, double targetDrive) {
+    if (targetDrive == drive) {
+        processBlock(input, output, numFrames);
+        return;
+    }
+
+    double startDrive = drive;
+    double driveStep = (targetDrive - startDrive) / numFrames;
+    for (uint32_t offset = 0; offset < numFrames; offset += kDriveRampFrames) {
+        uint32_t rampFrames = numFrames - offset < kDriveRampFrames ? numFrames - offset : kDriveRampFrames;
+        setDrive(offset + rampFrames == numFrames ? targetDrive : startDrive + driveStep * (offset + rampFrames));
+        processBlock(input + offset, output + offset, rampFrames);
+    }
+}
+
+bool TanhWaveshaper::setKernel(SIMDKernel kernel) {
+    if (!isSIMDKernelSupported(kernel))
+        return false;
+
+    this->kernel = kernel;
+    selectBlockFunction();
+    return true;
+}
+
+bool TanhWaveshaper::setQuality(TanhQuality quality) {
+    if (quality < kExactTanh || quality >= kNumTanhQualities)
+        return false;
+    if (quality == this->quality)
+        return true;
+
+    this->quality = quality;
+    selectBlockFunction();
+    return true;
+}
+
+bool TanhWaveshaper::setAntialiasing(TanhAntialiasing antialiasing) {
+    if (antialiasing < kNoAntialiasing || antialiasing >= kNumTanhAntialiasings)
+        return false;
+    if (antialiasing == this->antialiasing)
+        return true;
+
+    this->antialiasing = antialiasing;
+    clear();
+    return true;
+}
+
+void TanhWaveshaper::clear() {
+    previousInput = 0.0;
+    previousLogCosh = 0.0;
+}
+
+void TanhWaveshaper::selectBlockFunction() {
+    switch (kernel) {
+#ifdef SIMD_X86
+    case kSSE2Kernel:
+        antiderivativeFunction = processADAASSE2Block;
+        if (quality == kRationalTanh)
+            blockFunction = processApproximateSSE2Block<tanhRationalSSE2, tanhRational>;
+        else if (quality == kPolynomialTanh)
+            blockFunction = processApproximateSSE2Block<tanhPolynomialSSE2, tanhPolynomial>;
+        else
+            blockFunction = processSSE2Block;
+        break;
+    case kAVX2Kernel:
+        antiderivativeFunction = processADAAAVX2Block;
+        if (quality == kRationalTanh)
+            blockFunction = processApproximateAVX2Block<tanhRationalAVX2, tanhRational>;
+        else if (quality == kPolynomialTanh)
+            blockFunction = processApproximateAVX2Block<tanhPolynomialAVX2, tanhPolynomial>;
+        else
+            blockFunction = processAVX2Block;
+        break;
+#endif
+    default:
+        antiderivativeFunction = processADAAScalarBlock;
+        if (quality == kRationalTanh)
+            blockFunction = processApproximateScalarBlock<tanhRational>;
+        else if (quality == kPolynomialTanh)
+            blockFunction = processApproximateScalarBlock<tanhPolynomial>;
+        else
+            blockFunction = processScalarBlock;
+        break;
+    }
+}
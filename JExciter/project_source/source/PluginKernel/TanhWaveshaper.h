@@ -0,0 +1,92 @@
+//
+//  TanhWaveshaper.h
+//
+//  Harmonic exciter waveshaper, out = tanh(drive * in) / tanh(drive), run over whole band buffers.
+
+// Notes: the scalar kernel calls libm tanh and matches the per sample code exactly. The SSE2/AVX2 kernels use a
+//        vectorized tanh (rational for |x| < 0.625, exp based above) that is within a few double ulps of libm, far
+//        below the float resolution of the plugin outputs. The kernel is picked at construction, see SIMDSupport.h.
+//        The quality tier trades accuracy for speed; the bounds below are the max abs error of tanh against libm.
+//        The normalizer scales them by 1 / tanh(drive): 1.31 at drive 1, but 15.9 at the 0.063 drive a -24 dB
+//        surround/height Sat offset allows. The rational tier is exact to a few ulps near 0, so a low drive does
+//        not show; the polynomial tier's (e - 1) / (e + 1) cancels there and reaches 7.2e-7 (-123 dB) at 0.063.
+//        Approximate tiers give the same result on every kernel and multiply by the cached 1 / tanh(drive)
+//        instead of dividing. test_source/TanhWaveshaperTest.cpp checks all of this.
+//        First order ADAA replaces f(x) by (F(x[n]) - F(x[n-1])) / (x[n] - x[n-1]), F the antiderivative
+//        log cosh(drive x) / (drive tanh(drive)); it runs with full precision whatever the quality tier, costs about
+//        1.5x the exact tier, delays the wet signal by half a sample and droops the top octave like a 2 tap average.
+//        It keeps one sample of history, so an instance must not be shared between channels.
+//        A drive change can ramp across a block; the drive steps every kDriveRampFrames samples, since every step
+//        recomputes the tanh(drive) normalizer.
+
+#ifndef __TanhWaveshaper_h__
+#define __TanhWaveshaper_h__
+
+#include <stdint.h>
+#include "SIMDSupport.h"
+
+enum TanhQuality {
+    kExactTanh,         // libm, or the vectorized cephes tanh: a few double ulps
+    kRationalTanh,      // Lambert continued fraction [7/6], |x| clamped to 4.783: <= 7.1e-5 (about -83 dB)
+    kPolynomialTanh,    // (e - 1) / (e + 1), e = exp(2|x|) from a degree 5 minimax 2^f, |x| clamped to 10: <= 5e-8
+    kNumTanhQualities
+};
+
+enum TanhAntialiasing {
+    kNoAntialiasing,
+    kFirstOrderADAA,    // antiderivative anti-aliasing; falls back to f at the midpoint when |dx drive| < 1e-5
+    kNumTanhAntialiasings
+};
+
+class TanhWaveshaper {
+public:
+    static const uint32_t kDriveRampFrames = 16;
+
+    TanhWaveshaper();
+    ~TanhWaveshaper();
+
+    void setDrive(double drive);
+    double getDrive() const { return drive; }
+
+    double processSample(double input);
+    void processBlock(const double* input, double* output, uint32_t numFrames);
+    // --- ramps the drive linearly from the current one to targetDrive, which is reached by the last frame
+    void processBlock(const double* input, double* output, uint32_t numFrames, double targetDrive);
+
+    bool setKernel(SIMDKernel kernel);
+    SIMDKernel getKernel() const { return kernel; }
+
+    bool setQuality(TanhQuality quality);
+    TanhQuality getQuality() const { return quality; }
+
+    bool setAntialiasing(TanhAntialiasing antialiasing);
+    TanhAntialiasing getAntialiasing() const { return antialiasing; }
+
+    // --- forget the ADAA history (the previous input)
+    void clear();
+
+protected:
+    typedef void (*BlockFunction)(const double* input, double* output, uint32_t numFrames, double drive,
+        double normalizer, double normalizerInverse);
+    typedef void (*AntiderivativeFunction)(const double* input, double* output, uint32_t numFrames, double drive,
+        double normalizerInverse, double& previousInput, double& previousLogCosh);
+
+    void selectBlockFunction();
+
+    // --- recomputed only when the drive changes
+    double drive;
+    double normalizer;
+    double normalizerInverse;
+
+    // --- ADAA history; the log cosh is recomputed when the drive changes
+    double previousInput;
+    double previousLogCosh;
+
+    TanhQuality quality;
+    TanhAntialiasing antialiasing;
+    SIMDKernel kernel;
+    BlockFunction blockFunction;
+    AntiderivativeFunction antiderivativeFunction;
+};
+
+#endif
@@ -331,6 +331,7 @@ public:
 		// --- for LPF smoother
 		a = exp(-kTwoPi / (smoothingTimeInMSec * 0.001 * sampleRate));
 		b = 1.0 - a;
+		blockFrames = 0;
 
 		// --- for linear smoother
 		linInc = (maxVal - minVal) / (smoothingTimeInMSec * 0.001 * sampleRate);
@@ -404,6 +405,54 @@ public:
 		}
 	}
 
+	/**jump to a value: the smoother starts from here and has nothing left to smooth until the target changes
+	\param value the new value
+	*/
+	void setValue(T value)
+	{
+		z = value;
+		z2 = value;
+	}
+
+	/**perform the smoothing of numFrames samples at once, for smoothing once per block; the LPF smoother steps
+	   in closed form, in + (z - in) * a^numFrames, and snaps to the target once within 1e-6 of the control range
+	\param in input sample
+	\param numFrames number of samples to advance
+	\param out smoothed value at the last sample
+	\return true if smoothing occurred, false otherwise (the smoother has settled on the target)
+	*/
+	inline bool smoothParameterBlock(T in, uint32_t numFrames, T& out)
+	{
+		if (in == z)
+		{
+			out = in;
+			return false;
+		}
+
+		if (smootherType == smoothingMethod::kLPFSmoother)
+		{
+			if (numFrames != blockFrames)
+			{
+				blockFrames = numFrames;
+				blockA = pow(a, (T)numFrames);
+			}
+			z = in + (z - in) * blockA;
+			if (fabs(z - in) <= (maxVal - minVal) * 1e-6)
+				z = in;
+		}
+		else // if (smootherType == smoothingMethod::kLinearSmoother)
+		{
+			T inc = linInc * numFrames;
+			if (in > z)
+				z = z + inc > in ? in : z + inc;
+			else
+				z = z - inc < in ? in : z - inc;
+		}
+		z2 = z;
+		out = z;
+		return true;
+	}
+
 private:
 	T a = 0.0;		///< a coefficient for smoothing
 	T b = 0.0;		///< b coefficient for smoothing
@@ -412,6 +461,9 @@ private:
 
 	T linInc = 0.0;	///< linear stepping value
 
+	uint32_t blockFrames = 0;	///< block size blockA was computed for
+	T blockA = 0.0;				///< a^blockFrames for block smoothing
+
 	T minVal = 0.0;	///< min extrema
 	T maxVal = 1.0;	///< max exrema
 
@@ -54,10 +54,14 @@ PluginBase::~PluginBase()
         delete *it;
     }
     pluginParameters.clear();
-    pluginParameterMap.clear();
+    denseControlIDTable.clear();
+    sparseControlIDTable.clear();
 	delete [] pluginParameterArray;
 	delete [] smoothablePluginParameters;
 	delete [] outboundPluginParameters;
+	delete [] smoothableParameterFlags;
+	delete [] smoothingParameterFlags;
+	delete [] queuedParameterFlags;
 }
 
 /**
@@ -98,8 +102,13 @@ bool PluginBase::initialize(PluginInfo& _pluginInfo)
 \brief initialize object for a new run of audio; called just before audio streams
 
 Operation:
-- iterate through parameters and copy their values into the bound variables you set up
+- take the newest parameter snapshot, then iterate through the parameters written since the last call and copy
+  their snapshot values into the bound variables you set up; a preset written between beginParameterUpdates and
+  endParameterUpdates arrives in one buffer
 - then, call the postUpdatePluginParameter method to do any post-update cooking required to use the variable for processing
+- a changed parameter with smoothing joins smoothingParameterFlags, and with VST3 sample accurate automation the
+  parameters holding an update queue make up queuedParameterFlags; the smoothing and sample accurate functions
+  only visit those, so an idle instance skips the parameter lists entirely
 */
 void PluginBase::syncInBoundVariables()
 {
@@ -107,16 +116,87 @@ void PluginBase::syncInBoundVariables()
 	info.bufferProcUpdate = true;
 	info.boundVariableUpdate = true;
 
-	// --- rip through and synch em
-	for (unsigned int i = 0; i < numPluginParameters; i++)
+	parameterSnapshot.read();
+	const uint64_t* changedFlags = parameterSnapshot.getChangedFlags();
+	bool vstSAAEnabled = wantsVST3SampleAccurateAutomation();
+
+	for (uint32_t word = 0; word < numParameterFlagWords; word++)
 	{
-		if (pluginParameterArray[i] && pluginParameterArray[i]->updateInBoundVariable())
+		// --- the queues are replaced at the top of each VST3 buffer
+		queuedParameterFlags[word] = 0;
+		if (vstSAAEnabled)
+		{
+			uint32_t end = word * 64 + 64 < numPluginParameters ? word * 64 + 64 : numPluginParameters;
+			for (uint32_t i = word * 64; i < end; i++)
+			{
+				if (pluginParameterArray[i]->getParameterUpdateQueue())
+					queuedParameterFlags[word] |= 1ull << (i % 64);
+			}
+		}
+
+		// --- rip through the changed ones and synch em
+		uint64_t changed = changedFlags[word];
+		for (uint32_t i = word * 64; changed; i++, changed >>= 1)
 		{
-			postUpdatePluginParameter(pluginParameterArray[i]->getControlID(), pluginParameterArray[i]->getControlValue(), info);
+			if (!(changed & 1))
+				continue;
+
+			applyParameterValue(i, parameterSnapshot.getValue(i), parameterSnapshot.getJump(i), info);
 		}
 	}
 }
 
+/**
+\brief audio thread: one parameter takes a new value; with smoothing it becomes the smoother's target and the
+       parameter joins smoothingParameterFlags, otherwise the bound variable is updated and cooked at once
+
+\param index the parameter's index in pluginParameterArray
+\param value the new value
+\param jump set the value around the smoother
+\param info passed on to postUpdatePluginParameter
+*/
+void PluginBase::applyParameterValue(uint32_t index, double value, bool jump, ParameterUpdateInfo& info)
+{
+	PluginParameter* piParam = pluginParameterArray[index];
+	piParam->applySnapshotValue(value, jump);
+
+	uint32_t word = index / 64;
+	uint64_t flag = 1ull << (index % 64);
+	if ((smoothableParameterFlags[word] & flag) && piParam->getParameterSmoothing())
+		smoothingParameterFlags[word] |= flag;
+
+	if (piParam->updateInBoundVariable())
+		postUpdatePluginParameter(piParam->getControlID(), piParam->getControlValue(), info);
+}
+
+/**
+\brief audio thread: set a parameter in the middle of a buffer, e.g. from a MIDI CC in processMIDIEvent
+
+NOTE:
+- the value takes effect from the current frame: the frame path fires MIDI before each frame, and the block path
+  splits its chunks at the events (see beginMidiEvents); a smoothed parameter smooths to it from there
+- the value is not published: the host, the GUI and the snapshot keep theirs, and the next change from any of
+  them replaces this one
+
+\param controlID the parameter's control ID
+\param normalizedValue the new value, 0.0 to 1.0 (the control taper is applied)
+
+\return true if the parameter exists
+*/
+bool PluginBase::applyControlValueNormalized(int32_t controlID, double normalizedValue)
+{
+	PluginParameter* piParam = getPluginParameterByControlID(controlID);
+	if (!piParam || !parameterSnapshot.getSize())
+		return false;
+
+	ParameterUpdateInfo info;
+	info.bufferProcUpdate = true;
+	info.boundVariableUpdate = true;
+
+	applyParameterValue(piParam->getSnapshotIndex(), piParam->getControlValueWithNormalizedValue(normalizedValue), false, info);
+	return true;
+}
+
 /**
 \brief THE buffer processing function.
 
@@ -167,17 +247,27 @@ bool PluginBase::processAudioBuffers(ProcessBufferInfo& processBufferInfo)
 		// --- sync internal bound variables
 		preProcessAudioBuffers(processBufferInfo);
 
+		// --- MIDI is fired before the frame it is due on, see processAudioFrame
+		beginMidiEvents(processBufferInfo.midiEventQueue);
+
 		// --- build frames, one sample from each channel
 		for (uint32_t frame = 0; frame<processBufferInfo.numFramesToProcess; frame++)
 		{
+			// --- 64-bit buffers are converted here; frames are always float
 			for (uint32_t i = 0; i<processBufferInfo.numAudioInChannels; i++)
 			{
-				inputFrame[i] = processBufferInfo.inputs[i][frame];
+				if (processBufferInfo.inputs64)
+					inputFrame[i] = (float)processBufferInfo.inputs64[i][frame];
+				else
+					inputFrame[i] = processBufferInfo.inputs[i][frame];
 			}
 
 			for (uint32_t i = 0; i<processBufferInfo.numAuxAudioInChannels; i++)
 			{
-				auxInputFrame[i] = processBufferInfo.auxInputs[i][frame];
+				if (processBufferInfo.auxInputs64)
+					auxInputFrame[i] = (float)processBufferInfo.auxInputs64[i][frame];
+				else
+					auxInputFrame[i] = processBufferInfo.auxInputs[i][frame];
 			}
 
 			info.currentFrame = frame;
@@ -187,7 +277,10 @@ bool PluginBase::processAudioBuffers(ProcessBufferInfo& processBufferInfo)
 
 			for (uint32_t i = 0; i<processBufferInfo.numAudioOutChannels; i++)
 			{
-				processBufferInfo.outputs[i][frame] = outputFrame[i];
+				if (processBufferInfo.outputs64)
+					processBufferInfo.outputs64[i][frame] = outputFrame[i];
+				else
+					processBufferInfo.outputs[i][frame] = outputFrame[i];
 			}
 			for (uint32_t i = 0; i<processBufferInfo.numAuxAudioOutChannels; i++)
 			{
@@ -199,6 +292,9 @@ bool PluginBase::processAudioBuffers(ProcessBufferInfo& processBufferInfo)
 			info.hostInfo->dAbsoluteFrameBufferTime += sampleInterval;
 		}
 
+		// --- events timed at or past the last frame
+		endMidiEvents();
+
 		// --- generally not used
 		postProcessAudioBuffers(processBufferInfo);
 
@@ -208,6 +304,28 @@ bool PluginBase::processAudioBuffers(ProcessBufferInfo& processBufferInfo)
 	return false; /// processed
 }
 
+/**
+\brief the soft bypass of the API wrappers: output = input on the channels both have
+
+\param processBufferInfo the buffer the wrapper would otherwise have sent to processAudioBuffers
+
+\return true if operation succeeds, false otherwise
+*/
+bool PluginBase::processBypassedAudioBuffers(ProcessBufferInfo& processBufferInfo)
+{
+	uint32_t numChannels = processBufferInfo.numAudioInChannels < processBufferInfo.numAudioOutChannels ?
+		processBufferInfo.numAudioInChannels : processBufferInfo.numAudioOutChannels;
+	for (uint32_t i = 0; i < numChannels; i++)
+	{
+		if (processBufferInfo.outputs64)
+			memmove(processBufferInfo.outputs64[i], processBufferInfo.inputs64[i], processBufferInfo.numFramesToProcess * sizeof(double));
+		else
+			memmove(processBufferInfo.outputs[i], processBufferInfo.inputs[i], processBufferInfo.numFramesToProcess * sizeof(float));
+	}
+	processBufferInfo.outputSilenceFlags = processBufferInfo.inputSilenceFlags;
+	return true;
+}
+
 /**
 \brief copy newly updated metering variables into GUI parameters for display
 
@@ -242,16 +360,13 @@ NOTE:
 - beware: this function can eat a lot of CPU if the sample accurate updates trigger complex cooking functions
 - to combat CPU usage, you can set the VST3 sample granularity in initPluginDescriptors() apiSpecificInfo.vst3SampleAccurateGranularity
 - you can also change the parameter smoothing granularity
-- but in either case, the list MUST be iterated; this function is the reason for the old-fashioned C-array of pointers\n
-  as it was found to be faster than any other list method for entire-list iteration (if you have a faster way, let me knmow!)
+- only the smoothable parameters that are still smoothing or hold a VST3 update queue are visited (see
+  syncInBoundVariables); a settled smoother leaves the list until its target changes again
 - the parameter is updated with the smoothed value
 - the post-parameter update function is then called (complex cooking functions here will eat the CPU as well)
 */
 void PluginBase::doSampleAccurateParameterUpdates()
 {
-	if (numSmoothablePluginParameters == 0)
-		return;
-
 	// --- do updates
 	double value = 0;
 	bool vstSAAEnabled = wantsVST3SampleAccurateAutomation();
@@ -261,18 +376,23 @@ void PluginBase::doSampleAccurateParameterUpdates()
 	ParameterUpdateInfo paramSmoothUpdate(true, false); /// true = this is called from smoothing operation, false = NOT VST sample accurate update
 	paramSmoothUpdate.isSmoothing = true;
 
-	// --- rip through the array
-	for (unsigned int i = 0; i < numSmoothablePluginParameters; i++)
+	// --- rip through the smoothable parameters that are moving or queued
+	for (uint32_t word = 0; word < numParameterFlagWords; word++)
 	{
-		PluginParameter* piParam = smoothablePluginParameters[i];
-		if (piParam)
+		uint64_t active = smoothingParameterFlags[word] | (queuedParameterFlags[word] & smoothableParameterFlags[word]);
+		for (uint32_t i = word * 64; active; i++, active >>= 1)
 		{
+			if (!(active & 1))
+				continue;
+
+			PluginParameter* piParam = pluginParameterArray[i];
+
 			// --- do smoothing: first choice is for VST SAA (VST3 hosts only)
 			if (vstSAAEnabled && piParam->getEnableVSTSampleAccurateAutomation() && piParam->getParameterUpdateQueue())
 			{
 				if (piParam->getParameterUpdateQueue()->getNextValue(value))
 				{
-					piParam->setControlValueNormalized(value, false, true); // false = do not apply taper, true = ignore smoothing (not needed here)
+					piParam->jumpToControlValueNormalized(value); // the host value is normalized like any other (taper applied); no smoothing (not needed here)
 					// --- now update the bound variable
 					if (piParam->updateInBoundVariable())
 					{
@@ -291,6 +411,123 @@ void PluginBase::doSampleAccurateParameterUpdates()
 				}
 				postUpdatePluginParameter(piParam->getControlID(), piParam->getControlValue(), paramSmoothUpdate);
 			}
+			// --- settled: leaves the list until its target changes again
+			else
+				smoothingParameterFlags[word] &= ~(1ull << (i % 64));
+		}
+	}
+}
+
+/**
+\brief parameter smoothing for block processing: each smoother advances by the whole block in one step
+
+NOTE:
+- the parameter is updated with the smoothed value at the last frame of the block; the core ramps its cooked
+  value across the block (ParameterUpdateInfo::isSmoothing tells it which updates came from here)
+- only the parameters in smoothingParameterFlags are visited; a settled smoother leaves the list
+- VST3 sample accurate automation needs doSampleAccurateParameterUpdates() per frame instead
+
+\param numFrames the block size
+*/
+void PluginBase::doBlockParameterSmoothing(uint32_t numFrames)
+{
+	ParameterUpdateInfo paramSmoothUpdate(true, false); /// true = this is called from smoothing operation, false = NOT VST sample accurate update
+	paramSmoothUpdate.isSmoothing = true;
+
+	for (uint32_t word = 0; word < numParameterFlagWords; word++)
+	{
+		uint64_t smoothing = smoothingParameterFlags[word];
+		for (uint32_t i = word * 64; smoothing; i++, smoothing >>= 1)
+		{
+			if (!(smoothing & 1))
+				continue;
+
+			PluginParameter* piParam = pluginParameterArray[i];
+			if (piParam->smoothParameterValueBlock(numFrames))
+			{
+				// --- update bound variable, if there is one
+				paramSmoothUpdate.boundVariableUpdate = piParam->updateInBoundVariable();
+				postUpdatePluginParameter(piParam->getControlID(), piParam->getControlValue(), paramSmoothUpdate);
+			}
+			else
+				smoothingParameterFlags[word] &= ~(1ull << (i % 64));
+		}
+	}
+}
+
+/**
+\brief VST3 sample accurate automation in sub-blocks: the buffer is split after each automation point so the
+       core can run whole sub-blocks, ramping its cooked values between the points
+
+NOTE:
+- a sub-block is never shorter than the VST3 granularity (getVST3SampleAccuracyGranularity()), except at the end
+  of the buffer; points closer than that are merged into the sub-block's end value
+- without any points before sampleOffset + maxFrames the whole maxFrames are returned
+
+\param sampleOffset the first frame of the sub-block
+\param maxFrames the most frames the caller can process at once
+
+\return the number of frames in the sub-block, at least 1
+*/
+uint32_t PluginBase::getSampleAccurateSubBlockFrames(uint32_t sampleOffset, uint32_t maxFrames)
+{
+	uint32_t granularity = getVST3SampleAccuracyGranularity();
+	uint32_t minEnd = sampleOffset + (granularity > 1 ? granularity : 1);
+	uint32_t end = sampleOffset + maxFrames;
+
+	for (uint32_t word = 0; word < numParameterFlagWords; word++)
+	{
+		uint64_t queued = queuedParameterFlags[word];
+		for (uint32_t i = word * 64; queued; i++, queued >>= 1)
+		{
+			if (!(queued & 1))
+				continue;
+
+			PluginParameter* piParam = pluginParameterArray[i];
+			IParameterUpdateQueue* queue = piParam->getParameterUpdateQueue();
+			if (!queue || !piParam->getEnableVSTSampleAccurateAutomation())
+				continue;
+
+			// --- the sub-block ends on the point's frame, so the ramp reaches the point's value there
+			uint32_t pointEnd = queue->getNextPointOffset(sampleOffset) + 1;
+			if (pointEnd < end)
+				end = pointEnd > minEnd ? pointEnd : minEnd;
+		}
+	}
+
+	if (end > sampleOffset + maxFrames)
+		end = sampleOffset + maxFrames;
+	return end - sampleOffset;
+}
+
+/**
+\brief VST3 sample accurate automation in sub-blocks: each automated parameter jumps to its interpolated value at
+       sampleOffset (the last frame of the sub-block) and is flagged as a sample accurate update; the core ramps
+       to it across the sub-block. Smoothing is bypassed, the host's automation is already continuous
+
+\param sampleOffset the last frame of the sub-block
+*/
+void PluginBase::doSampleAccurateSubBlockUpdates(uint32_t sampleOffset)
+{
+	ParameterUpdateInfo vst3Update(false, true); /// false = this is NOT called from smoothing operation, true: this is a VST sample accurate update
+	vst3Update.isVSTSampleAccurateUpdate = true;
+
+	for (uint32_t word = 0; word < numParameterFlagWords; word++)
+	{
+		uint64_t queued = queuedParameterFlags[word];
+		for (uint32_t i = word * 64; queued; i++, queued >>= 1)
+		{
+			if (!(queued & 1))
+				continue;
+
+			PluginParameter* piParam = pluginParameterArray[i];
+			IParameterUpdateQueue* queue = piParam->getParameterUpdateQueue();
+			if (!queue || !piParam->getEnableVSTSampleAccurateAutomation())
+				continue;
+
+			piParam->jumpToControlValueNormalized(queue->getInterpolatedValue(sampleOffset));
+			vst3Update.boundVariableUpdate = piParam->updateInBoundVariable();
+			postUpdatePluginParameter(piParam->getControlID(), piParam->getControlValue(), vst3Update);
 		}
 	}
 }
@@ -308,18 +545,96 @@ NOTE:
 */
 int32_t PluginBase::addPluginParameter(PluginParameter* piParam, double sampleRate)
 {
-	// --- map for controlID-indexing
-	pluginParameterMap.insert(std::make_pair(piParam->getControlID(), piParam));
-
 	// --- vector for fast iteration and 0-indexing
 	pluginParameters.push_back(piParam);
 
+	// --- tables for controlID-indexing
+	buildControlIDTables();
+
 	// --- first intialization, this can change
 	piParam->initParamSmoother(sampleRate);
 
 	return (int32_t)pluginParameters.size() - 1;
 }
 
+/**
+\brief builds the controlID lookup tables from pluginParameters
+
+NOTE:
+- IDs below kMaxDenseControlID index denseControlIDTable directly
+- the rest get a perfect hash: the smallest power of two table, at least twice the number of IDs, for which some
+  odd multiplier puts every ID in its own slot (multiplicative hashing, the top bits of controlID * multiplier)
+- like the map it replaces, the first parameter added with an ID wins
+*/
+void PluginBase::buildControlIDTables()
+{
+	std::vector<uint32_t> sparseIDs;
+	uint32_t denseSize = 0;
+	for (unsigned int i = 0; i < pluginParameters.size(); i++)
+	{
+		uint32_t id = (uint32_t)pluginParameters[i]->getControlID();
+		if (id < kMaxDenseControlID)
+			denseSize = id + 1 > denseSize ? id + 1 : denseSize;
+		else if (std::find(sparseIDs.begin(), sparseIDs.end(), id) == sparseIDs.end())
+			sparseIDs.push_back(id);
+	}
+
+	denseControlIDTable.assign(denseSize, nullptr);
+	for (unsigned int i = 0; i < pluginParameters.size(); i++)
+	{
+		uint32_t id = (uint32_t)pluginParameters[i]->getControlID();
+		if (id < denseSize && !denseControlIDTable[id])
+			denseControlIDTable[id] = pluginParameters[i];
+	}
+
+	sparseControlIDTable.clear();
+	if (sparseIDs.empty())
+		return;
+
+	// --- table sizes from 2 slots (a shift of 31) up; each tries a run of odd multipliers around the golden ratio
+	uint32_t bits = 1;
+	while ((1u << bits) < 2 * sparseIDs.size())
+		bits++;
+
+	for (;; bits++)
+	{
+		uint32_t size = 1u << bits;
+		uint32_t shift = 32 - bits;
+		for (uint32_t attempt = 0; attempt < 256; attempt++)
+		{
+			uint32_t multiplier = 0x9E3779B1u + 2 * attempt;
+			std::vector<bool> used(size, false);
+			bool collision = false;
+			for (unsigned int i = 0; i < sparseIDs.size() && !collision; i++)
+			{
+				uint32_t slot = (sparseIDs[i] * multiplier) >> shift;
+				collision = used[slot];
+				used[slot] = true;
+			}
+			if (collision)
+				continue;
+
+			sparseControlIDMultiplier = multiplier;
+			sparseControlIDShift = shift;
+			sparseControlIDTable.assign(size, SparseControlID());
+			for (unsigned int i = 0; i < pluginParameters.size(); i++)
+			{
+				uint32_t id = (uint32_t)pluginParameters[i]->getControlID();
+				if (id < kMaxDenseControlID)
+					continue;
+
+				SparseControlID& entry = sparseControlIDTable[(id * multiplier) >> shift];
+				if (!entry.parameter)
+				{
+					entry.controlID = id;
+					entry.parameter = pluginParameters[i];
+				}
+			}
+			return;
+		}
+	}
+}
+
 /**
 \brief adds an auxilliary attribute to the plugin parameter; you can have as many auxilliary attributes as you like for each parameter.
 
@@ -854,6 +1169,35 @@ void PluginBase::initPluginParameterArray()
 		}
 	}
 
+	// --- parameter flags; every value is published once so the first syncInBoundVariables visits every parameter
+	delete[] smoothableParameterFlags;
+	delete[] smoothingParameterFlags;
+	delete[] queuedParameterFlags;
+
+	numParameterFlagWords = (numPluginParameters + 63) / 64;
+	smoothableParameterFlags = new uint64_t[numParameterFlagWords]();
+	smoothingParameterFlags = new uint64_t[numParameterFlagWords]();
+	queuedParameterFlags = new uint64_t[numParameterFlagWords]();
+
+	parameterSnapshot.setSize(numPluginParameters);
+	parameterSnapshot.beginWrite();
+
+	for (unsigned int i = 0; i < numPluginParameters; i++)
+	{
+		uint32_t word = i / 64;
+		uint64_t flag = 1ull << (i % 64);
+
+		// --- same test as smoothablePluginParameters
+		if ((pluginParameters[i]->getParameterSmoothing() || pluginParameters[i]->getEnableVSTSampleAccurateAutomation()) &&
+			(pluginParameters[i]->getControlVariableType() == controlVariableType::kDouble ||
+			 pluginParameters[i]->getControlVariableType() == controlVariableType::kFloat))
+			smoothableParameterFlags[word] |= flag;
+
+		pluginParameters[i]->setSnapshot(&parameterSnapshot, i);
+		parameterSnapshot.write(i, (float)pluginParameters[i]->getControlValue(), true);
+	}
+
+	parameterSnapshot.endWrite();
 }
 
 /**
@@ -194,7 +194,9 @@ The AAX plugin shell consists of the following files:
 
 #include "pluginparameter.h"
 
-#include <map>
+#include <algorithm>
+#include <vector>
+#include <atomic>
 
 /**
 \class PluginBase
@@ -256,6 +258,10 @@ public:
 	/** Buffer Proc Cycle: II PluginCore overrides this method to process frames */
 	virtual bool processAudioBuffers(ProcessBufferInfo& processInfo);
 
+	/** Buffer Proc Cycle: II in the wrappers' soft bypass; copies the inputs to the outputs, a plugin with latency
+	    overrides it to delay them by as much */
+	virtual bool processBypassedAudioBuffers(ProcessBufferInfo& processInfo);
+
 	/** Buffer Proc Cycle: III connects meter variables to outbound GUI control changes (part of ASPiK output variable binding option) */
 	bool updateOutBoundVariables();
 
@@ -268,9 +274,51 @@ public:
 	/** ASPiK midi event system: base class implementation is empty */
 	virtual bool processMIDIEvent(midiEvent& event) { return true; }
 
+	/** MIDI: take the buffer's event queue (or nullptr); the buffer is split at getNextMidiEventOffset() */
+	void beginMidiEvents(IMidiEventQueue* queue)
+	{
+		midiEventQueue = queue && queue->getEventCount() > 0 ? queue : nullptr;
+		nextMidiEventOffset = midiEventQueue ? midiEventQueue->getNextEventOffset() : IMidiEventQueue::kNoEvent;
+	}
+
+	/** MIDI: fire the events due by sampleOffset; a single compare while none are */
+	void fireMidiEvents(uint32_t sampleOffset)
+	{
+		if (sampleOffset < nextMidiEventOffset)
+			return;
+
+		midiEventQueue->fireMidiEvents(sampleOffset);
+		nextMidiEventOffset = midiEventQueue->getNextEventOffset();
+	}
+
+	/** MIDI: offset of the next event in this buffer, IMidiEventQueue::kNoEvent when there is none */
+	uint32_t getNextMidiEventOffset() { return nextMidiEventOffset; }
+
+	/** MIDI: after the last frame, fire the events left at or past the end of the buffer, so none are lost */
+	void endMidiEvents()
+	{
+		while (nextMidiEventOffset != IMidiEventQueue::kNoEvent)
+		{
+			midiEventQueue->fireMidiEvents(nextMidiEventOffset);
+			nextMidiEventOffset = midiEventQueue->getNextEventOffset();
+		}
+	}
+
+	/** audio thread: set a parameter from within the buffer (e.g. a MIDI CC); it takes effect from the current frame */
+	bool applyControlValueNormalized(int32_t controlID, double normalizedValue);
+
 	/** perform parameter smoothing or VST3 sample accurate upates */
 	void doSampleAccurateParameterUpdates();
 
+	/** perform parameter smoothing once for a block of frames (not VST3 sample accurate updates) */
+	void doBlockParameterSmoothing(uint32_t numFrames);
+
+	/** VST3 sample accurate sub-blocks: the frames from sampleOffset through the next automation point */
+	uint32_t getSampleAccurateSubBlockFrames(uint32_t sampleOffset, uint32_t maxFrames);
+
+	/** VST3 sample accurate sub-blocks: set the automated parameters to their values at sampleOffset */
+	void doSampleAccurateSubBlockUpdates(uint32_t sampleOffset);
+
 	/** only for a vector joystick control from DAW that implements it (reserved for future use): base class implementation is empty */
 	virtual bool setVectorJoystickParameters(const VectorJoystickData& vectorJoysickData) { return true; }
 
@@ -293,17 +341,34 @@ public:
 	PluginParameter* getPluginParameterByIndex(int32_t index) { return pluginParameters[index]; }
 
 	/**
-	\brief get a parameter by control ID - uses map (slowest)
+	\brief get a parameter by control ID - one table read: IDs below kMaxDenseControlID index a flat table, the
+	       others (e.g. SCALE_GUI_SIZE) a perfect hash built by addPluginParameter
 
 	\param controlID the control ID of the parameter
 
-	\return a naked pointer to the PluginParameter object
+	\return a naked pointer to the PluginParameter object, or nullptr for an unknown ID
 	*/
-	PluginParameter* getPluginParameterByControlID(int32_t controlID) { return pluginParameterMap[controlID]; }
+	PluginParameter* getPluginParameterByControlID(int32_t controlID)
+	{
+		uint32_t id = (uint32_t)controlID;
+		if (id < denseControlIDTable.size())
+			return denseControlIDTable[id];
+		if (sparseControlIDTable.empty())
+			return nullptr;
+
+		const SparseControlID& entry = sparseControlIDTable[(id * sparseControlIDMultiplier) >> sparseControlIDShift];
+		return entry.controlID == id ? entry.parameter : nullptr;
+	}
 
 	/** get a parameter by type - used to find all meter variables for writing to GUI */
 	PluginParameter* getNextParameterOfType(int32_t& startIndex, controlVariableType controlType);
 
+	/** the meter (kMeter) parameters, listed once by initPluginParameterArray; the wrappers send these to the host each buffer */
+	uint32_t getOutboundParameterCount() { return numOutboundPluginParameters; }
+
+	/** an outbound parameter, index < getOutboundParameterCount() */
+	PluginParameter* getOutboundParameter(uint32_t index) { return outboundPluginParameters[index]; }
+
 	/** get a parameter's variable as double */
 	double getPIParamValueDouble(int32_t controlID);
 
@@ -373,6 +438,14 @@ public:
 	/** sest normalized */
 	double setPIParamValueNormalized(uint32_t _controlID, double _normalizedValue, bool applyTaper = true);
 
+	/** group parameter writes (preset, state) so the audio thread takes them in the same buffer; calls nest */
+	void beginParameterUpdates() { parameterSnapshot.beginWrite(); }
+	void endParameterUpdates() { parameterSnapshot.endWrite(); }
+
+	/** wrappers, around the parameter writes they make on the audio thread (host automation) before processing */
+	void beginAudioThreadUpdates() { parameterSnapshot.beginAudioThreadWrites(); }
+	void endAudioThreadUpdates() { parameterSnapshot.endAudioThreadWrites(); }
+
 	/** perform variable binding at parameter level */
 	bool updatePIParamBoundValue(uint32_t _controlID);
 
@@ -445,11 +518,26 @@ public:
 	bool hasCustomGUI() { return pluginDescriptor.hasCustomGUI; }
 
 	/**
-	\brief Description query: latency
+	\brief Description query: latency; the described latency plus the processing latency
 
 	\return latency in samples (as double)
 	*/
-	double getLatencyInSamples() { return pluginDescriptor.latencyInSamples; }
+	double getLatencyInSamples() { return pluginDescriptor.latencyInSamples + processingLatency.load(std::memory_order_relaxed); }
+
+	/**
+	\brief Run-time latency added to the described latency by a processing mode (oversampling, lookahead, etc...);
+	       safe to call from the audio thread. The VST3 shell reports changes with restartComponent(kLatencyChanged)
+
+	\param latency latency in samples
+	*/
+	void setProcessingLatency(uint32_t latency) { processingLatency.store(latency, std::memory_order_relaxed); }
+
+	/**
+	\brief Run-time latency query
+
+	\return the processing latency in samples, without the described latency
+	*/
+	uint32_t getProcessingLatency() { return processingLatency.load(std::memory_order_relaxed); }
 
 	/**
 	\brief Description query: tail time
@@ -563,6 +651,13 @@ public:
 	*/
 	uint32_t getVST3SampleAccuracyGranularity() { return apiSpecificInfo.vst3SampleAccurateGranularity; }
 
+	/**
+	\brief Description query: VST Sample Accurate Automation in sub-blocks split at the automation points
+
+	\return true if plugin wants sub-blocks rather than per-sample updates
+	*/
+	bool wantsVST3SampleAccurateSubBlocks() { return apiSpecificInfo.enableVST3SampleAccurateSubBlocks; }
+
 	/**
 	\brief Description query: VST3 Bundle ID
 
@@ -589,6 +684,7 @@ protected:
     APISpecificInfo apiSpecificInfo;			///< description strings, API specific
 	AudioProcDescriptor audioProcDescriptor;	///< current audio processing description
 	PluginInfo pluginInfo;						///< info about the DLL (component) itself, includes path to DLL
+	std::atomic<uint32_t> processingLatency{ 0 };	///< run-time latency, see setProcessingLatency()
 
     // --- arrays for frame processing
     float inputFrame[MAX_CHANNEL_COUNT];		///< input array for frame processing
@@ -604,12 +700,37 @@ protected:
 	PluginParameter** outboundPluginParameters = nullptr;		///< old-fashioned C-arrays of pointers for outbound (meter) parameters
 	uint32_t numOutboundPluginParameters = 0;					///< total number of outbound (meter) parameters
 
-    // --- vectorized version of pluginParameterMap for fast iteration when key not needed
+	// --- the values written from any thread, taken once per buffer (syncInBoundVariables)
+	ParameterSnapshot parameterSnapshot;						///< indexed like pluginParameterArray
+
+	// --- parameter flags, bit (i % 64) of word (i / 64) for pluginParameterArray[i]; only the raised bits are visited
+	uint64_t* smoothableParameterFlags = nullptr;				///< the members of smoothablePluginParameters
+	uint64_t* smoothingParameterFlags = nullptr;				///< audio thread: smoothers that have not settled yet
+	uint64_t* queuedParameterFlags = nullptr;					///< audio thread: parameters holding a VST3 update queue
+	uint32_t numParameterFlagWords = 0;							///< words in each flag array
+
+	/** audio thread: apply one parameter's new value to the bound variable and the smoothing flags */
+	void applyParameterValue(uint32_t index, double value, bool jump, ParameterUpdateInfo& info);
+
+	// --- MIDI, see beginMidiEvents
+	IMidiEventQueue* midiEventQueue = nullptr;					///< this buffer's queue, nullptr without events
+	uint32_t nextMidiEventOffset = IMidiEventQueue::kNoEvent;	///< offset of the next event not fired yet
+
+    // --- vectorized version of the parameter list for fast iteration when key not needed
     std::vector<PluginParameter*> pluginParameters;				///< vector version of parameter list
 
-    // --- map<controlID , PluginParameter*>
-    typedef std::map<uint32_t, PluginParameter*> pluginParameterControlIDMap;	///< map version of parameter list
-    pluginParameterControlIDMap pluginParameterMap;								///< member map of parameter list
+    // --- controlID lookup, see getPluginParameterByControlID; rebuilt by addPluginParameter, never on lookups
+    enum { kMaxDenseControlID = 1024 };
+    struct SparseControlID
+    {
+        uint32_t controlID = 0;
+        PluginParameter* parameter = nullptr;
+    };
+    void buildControlIDTables();
+    std::vector<PluginParameter*> denseControlIDTable;			///< [controlID], up to the highest ID below kMaxDenseControlID
+    std::vector<SparseControlID> sparseControlIDTable;			///< power of two size, no collisions
+    uint32_t sparseControlIDMultiplier = 0;						///< slot = (controlID * multiplier) >> shift
+    uint32_t sparseControlIDShift = 0;
 
     // --- plugin core -> host (wrap) connector
     IPluginHostConnector* pluginHostConnector = nullptr;						///< created and destroyed on host
@@ -12,6 +12,8 @@
 // -----------------------------------------------------------------------------
 #include "plugincore.h"
 #include "plugindescription.h"
+#include <string.h>
+#include <new>
 
 /**
 \brief PluginCore constructor is launching pad for object initialization
@@ -34,6 +36,12 @@ PluginCore::PluginCore()
 		addSupportedIOCombination({ kCFMono, kCFMono });
 		addSupportedIOCombination({ kCFMono, kCFStereo });
 		addSupportedIOCombination({ kCFStereo, kCFStereo });
+
+		// --- surround, immersive and ambisonic buses, same format in and out (see getChannelGroupLayout)
+		const uint32_t surroundFormats[] = { kCFLCR, kCFLCRS, kCFQuad, kCF5p0, kCF5p1, kCF6p0, kCF6p1, kCF7p0Sony, kCF7p0DTS,
+			kCF7p1Sony, kCF7p1DTS, kCF7p1Proximity, kCF7p1p4, kCFAmbisonic1stOrder, kCFAmbisonic2ndOrder, kCFAmbisonic3rdOrder };
+		for (uint32_t format : surroundFormats)
+			addSupportedIOCombination({ format, format });
 	}
 	else // --- synth plugins have no input, only output
 	{
@@ -45,6 +53,13 @@ PluginCore::PluginCore()
 	addSupportedAuxIOCombination({ kCFMono, kCFNone });
 	addSupportedAuxIOCombination({ kCFStereo, kCFNone });
 
+	// --- no meter view until the GUI registers one
+	for (uint32_t meter = 0; meter < kNumMeters; meter++)
+	{
+		meterValues[meter].store(0.f, std::memory_order_relaxed);
+		meterViews[meter] = nullptr;
+	}
+
 	// --- create the parameters
     initPluginParameters();
 
@@ -52,6 +67,17 @@ PluginCore::PluginCore()
     initPluginPresets();
 }
 
+/**
+\brief PluginCore destructor: deletes the crossovers and channel states
+*/
+PluginCore::~PluginCore()
+{
+	delete monoCrossover;
+	for (LinkwitzRileyStereoCrossover* crossover : stereoCrossovers)
+		delete crossover;
+	freeChannelStates();
+}
+
 /**
 \brief create all of your plugin parameters here
 
@@ -59,7 +85,7 @@ PluginCore::PluginCore()
 */
 bool PluginCore::initPluginParameters()
 {
-	if (pluginParameterMap.size() > 0)
+	if (pluginParameters.size() > 0)
 		return false;
 
     // --- Add your plugin parameter instantiation code bewtween these hex codes
@@ -100,41 +126,221 @@ bool PluginCore::initPluginParameters()
 	addPluginParameter(piParam);
 
 	piParam = new PluginParameter(8, "LowSat", "dB", controlVariableType::kDouble, 0.000000, 24.000000, 0.000000, taper::kLinearTaper);
+	piParam->setParameterSmoothing(true);
+	piParam->setSmoothingTimeMsec(20.00);
 	piParam->setBoundVariable(&LowSat, boundVariableType::kDouble);
 	addPluginParameter(piParam);
 
 	piParam = new PluginParameter(9, "LowMidSat", "dB", controlVariableType::kDouble, 0.000000, 24.000000, 0.000000, taper::kLinearTaper);
+	piParam->setParameterSmoothing(true);
+	piParam->setSmoothingTimeMsec(20.00);
 	piParam->setBoundVariable(&LowMidSat, boundVariableType::kDouble);
 	addPluginParameter(piParam);
 
 	piParam = new PluginParameter(10, "HighMidSat", "dB", controlVariableType::kDouble, 0.000000, 24.000000, 0.000000, taper::kLinearTaper);
+	piParam->setParameterSmoothing(true);
+	piParam->setSmoothingTimeMsec(20.00);
 	piParam->setBoundVariable(&HighMidSat, boundVariableType::kDouble);
 	addPluginParameter(piParam);
 
 	piParam = new PluginParameter(11, "TrebleSat", "dB", controlVariableType::kDouble, 0.000000, 24.000000, 0.000000, taper::kLinearTaper);
+	piParam->setParameterSmoothing(true);
+	piParam->setSmoothingTimeMsec(20.00);
 	piParam->setBoundVariable(&TrebleSat, boundVariableType::kDouble);
 	addPluginParameter(piParam);
 
 	piParam = new PluginParameter(12, "LowMix", "Pct", controlVariableType::kDouble, 0.000000, 100.000000, 50.000000, taper::kLinearTaper);
+	piParam->setParameterSmoothing(true);
+	piParam->setSmoothingTimeMsec(20.00);
 	piParam->setBoundVariable(&LowMix, boundVariableType::kDouble);
 	addPluginParameter(piParam);
 
 	piParam = new PluginParameter(13, "LowMidMix", "Pct", controlVariableType::kDouble, 0.000000, 100.000000, 50.000000, taper::kLinearTaper);
+	piParam->setParameterSmoothing(true);
+	piParam->setSmoothingTimeMsec(20.00);
 	piParam->setBoundVariable(&LowMidMix, boundVariableType::kDouble);
 	addPluginParameter(piParam);
 
 	piParam = new PluginParameter(14, "HighMidMix", "Pct", controlVariableType::kDouble, 0.000000, 100.000000, 50.000000, taper::kLinearTaper);
+	piParam->setParameterSmoothing(true);
+	piParam->setSmoothingTimeMsec(20.00);
 	piParam->setBoundVariable(&HighMidMix, boundVariableType::kDouble);
 	addPluginParameter(piParam);
 
 
 	piParam = new PluginParameter(15, "TrebleMix", "Pct", controlVariableType::kDouble, 0.000000, 100.000000, 50.000000, taper::kLinearTaper);
+	piParam->setParameterSmoothing(true);
+	piParam->setSmoothingTimeMsec(20.00);
 	piParam->setBoundVariable(&TrebleMix, boundVariableType::kDouble);
 	addPluginParameter(piParam);
 
 	piParam = new PluginParameter(16, "MasterVolume", "dB", controlVariableType::kDouble, -60.000000, 12.000000, 0.000000, taper::kLinearTaper);
+	piParam->setParameterSmoothing(true);
+	piParam->setSmoothingTimeMsec(20.00);
 	piParam->setBoundVariable(&MasterVolume, boundVariableType::kDouble);
 	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(17, "SatQuality", "Exact, Rational, Polynomial", "Exact");
+	piParam->setBoundVariable(&SatQuality, boundVariableType::kInt);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(18, "Oversampling", "OFF, ON", "OFF");
+	piParam->setBoundVariable(&Oversampling, boundVariableType::kInt);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(19, "LowOversampling", "1x,2x,4x", "1x");
+	piParam->setBoundVariable(&LowOversampling, boundVariableType::kInt);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(20, "LowMidOversampling", "1x,2x,4x", "1x");
+	piParam->setBoundVariable(&LowMidOversampling, boundVariableType::kInt);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(21, "HighMidOversampling", "1x,2x,4x", "2x");
+	piParam->setBoundVariable(&HighMidOversampling, boundVariableType::kInt);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(22, "TrebleOversampling", "1x,2x,4x", "4x");
+	piParam->setBoundVariable(&TrebleOversampling, boundVariableType::kInt);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(23, "SatAntialiasing", "OFF, ADAA", "OFF");
+	piParam->setBoundVariable(&SatAntialiasing, boundVariableType::kInt);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(24, "LowCrossover", "Hz", controlVariableType::kDouble, 20.000000, 400.000000, 100.000000, taper::kVoltOctaveTaper);
+	piParam->setBoundVariable(&LowCrossover, boundVariableType::kDouble);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(25, "MidCrossover", "Hz", controlVariableType::kDouble, 400.000000, 4000.000000, 1000.000000, taper::kVoltOctaveTaper);
+	piParam->setBoundVariable(&MidCrossover, boundVariableType::kDouble);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(26, "HighCrossover", "Hz", controlVariableType::kDouble, 4000.000000, 18000.000000, 10000.000000, taper::kVoltOctaveTaper);
+	piParam->setBoundVariable(&HighCrossover, boundVariableType::kDouble);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(27, "SurroundLink", "Linked, Unlinked", "Linked");
+	piParam->setBoundVariable(&SurroundLink, boundVariableType::kInt);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(28, "SurroundSat", "dB", controlVariableType::kDouble, -24.000000, 24.000000, 0.000000, taper::kLinearTaper);
+	piParam->setBoundVariable(&SurroundSat, boundVariableType::kDouble);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(29, "SurroundMix", "Pct", controlVariableType::kDouble, 0.000000, 100.000000, 100.000000, taper::kLinearTaper);
+	piParam->setBoundVariable(&SurroundMix, boundVariableType::kDouble);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(30, "HeightLink", "Linked, Unlinked", "Linked");
+	piParam->setBoundVariable(&HeightLink, boundVariableType::kInt);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(31, "HeightSat", "dB", controlVariableType::kDouble, -24.000000, 24.000000, 0.000000, taper::kLinearTaper);
+	piParam->setBoundVariable(&HeightSat, boundVariableType::kDouble);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(32, "HeightMix", "Pct", controlVariableType::kDouble, 0.000000, 100.000000, 100.000000, taper::kLinearTaper);
+	piParam->setBoundVariable(&HeightMix, boundVariableType::kDouble);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(33, "CrossoverMode", "IIR, Linear Phase", "IIR");
+	piParam->setBoundVariable(&CrossoverMode, boundVariableType::kInt);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(34, "LowInPeak", 1.00, 500.00, ENVELOPE_DETECT_MODE_PEAK, meterCal::kLogMeter);
+	piParam->setBoundVariable(&LowInPeak, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(35, "LowInRMS", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&LowInRMS, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(36, "LowOutPeak", 1.00, 500.00, ENVELOPE_DETECT_MODE_PEAK, meterCal::kLogMeter);
+	piParam->setBoundVariable(&LowOutPeak, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(37, "LowOutRMS", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&LowOutRMS, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(38, "LowHarmonics", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&LowHarmonics, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(39, "LowMidInPeak", 1.00, 500.00, ENVELOPE_DETECT_MODE_PEAK, meterCal::kLogMeter);
+	piParam->setBoundVariable(&LowMidInPeak, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(40, "LowMidInRMS", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&LowMidInRMS, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(41, "LowMidOutPeak", 1.00, 500.00, ENVELOPE_DETECT_MODE_PEAK, meterCal::kLogMeter);
+	piParam->setBoundVariable(&LowMidOutPeak, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(42, "LowMidOutRMS", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&LowMidOutRMS, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(43, "LowMidHarmonics", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&LowMidHarmonics, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(44, "HighMidInPeak", 1.00, 500.00, ENVELOPE_DETECT_MODE_PEAK, meterCal::kLogMeter);
+	piParam->setBoundVariable(&HighMidInPeak, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(45, "HighMidInRMS", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&HighMidInRMS, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(46, "HighMidOutPeak", 1.00, 500.00, ENVELOPE_DETECT_MODE_PEAK, meterCal::kLogMeter);
+	piParam->setBoundVariable(&HighMidOutPeak, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(47, "HighMidOutRMS", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&HighMidOutRMS, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(48, "HighMidHarmonics", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&HighMidHarmonics, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(49, "TrebleInPeak", 1.00, 500.00, ENVELOPE_DETECT_MODE_PEAK, meterCal::kLogMeter);
+	piParam->setBoundVariable(&TrebleInPeak, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(50, "TrebleInRMS", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&TrebleInRMS, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(51, "TrebleOutPeak", 1.00, 500.00, ENVELOPE_DETECT_MODE_PEAK, meterCal::kLogMeter);
+	piParam->setBoundVariable(&TrebleOutPeak, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(52, "TrebleOutRMS", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&TrebleOutRMS, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(53, "TrebleHarmonics", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&TrebleHarmonics, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(54, "OutputPeak", 1.00, 500.00, ENVELOPE_DETECT_MODE_PEAK, meterCal::kLogMeter);
+	piParam->setBoundVariable(&OutputPeak, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	piParam = new PluginParameter(55, "OutputRMS", 300.00, 300.00, ENVELOPE_DETECT_MODE_RMS, meterCal::kLogMeter);
+	piParam->setBoundVariable(&OutputRMS, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+#if DSP_PROFILING
+	piParam = new PluginParameter(56, "DSPLoad", 1.00, 500.00, ENVELOPE_DETECT_MODE_PEAK, meterCal::kLinearMeter);
+	piParam->setBoundVariable(&DSPLoad, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+#endif
     
 	// **--0xEDA5--**
    
@@ -143,516 +349,1380 @@ bool PluginCore::initPluginParameters()
     PluginParameter* piParamBonus = new PluginParameter(SCALE_GUI_SIZE, "Scale GUI", "tiny,small,medium,normal,large,giant", "normal");
     addPluginParameter(piParamBonus);
 
-	// --- create the super fast access array
-	initPluginParameterArray();
+	// --- create the super fast access array
+	initPluginParameterArray();
+
+    return true;
+}
+
+/**
+\brief initialize object for a new run of audio; called just before audio streams
+
+Operation:
+- store sample rate and bit depth on audioProcDescriptor - this information is globally available to all core functions
+- reset your member objects here
+
+\param resetInfo structure of information about current audio format
+
+\return true if operation succeeds, false otherwise
+*/
+bool PluginCore::reset(ResetInfo& resetInfo)
+{
+    // --- save for audio processing
+    audioProcDescriptor.sampleRate = resetInfo.sampleRate;
+    audioProcDescriptor.bitDepth = resetInfo.bitDepth;
+
+	// --- allocate the crossover state for the channel I/O the host is about to use; a new rate ends any glide.
+	//     The linear phase FIRs are designed here for the rate, later crossover changes on the crossover's design thread
+	crossoverWarpTable.setRange(kMinCrossoverFc, kMaxCrossoverFcRatio * resetInfo.sampleRate, resetInfo.sampleRate);
+	crossoverGlideCoefficient = 1.0 - exp(-(double)kCrossoverGlideFrames / (kCrossoverGlideTime * resetInfo.sampleRate));
+	setCrossoverTargets();
+	linearPhaseCrossover.setSampleRate(resetInfo.sampleRate);
+	linearPhaseCrossover.setCrossover(crossoverFc[0], crossoverFc[1], crossoverFc[2], false);
+	createChannelStates(resetInfo.channelIOConfig, true);
+	setAndCalcFilters();
+	selectKernels(resetInfo.channelIOConfig);
+
+	// --- the FIR tables depend on the rate; this also sets the latency the wrappers read after reset. Only the
+	//     linear phase mode needs the crossover's design thread
+	linearPhase = CrossoverMode == (int)CrossoverModeEnum::Linear_Phase;
+	linearPhaseCrossover.setBackgroundDesign(linearPhase);
+	setOversampling();
+
+	// --- the new stream starts with all states clear, so a silent one is skipped after the usual hold
+	clearBandStates();
+	silent = false;
+	silentFrames = 0;
+	resetMeters();
+#if DSP_PROFILING
+	dspProfiler.reset();
+#endif
+
+    // --- other reset inits
+    return PluginBase::reset(resetInfo);
+}
+
+/**
+\brief one-time initialize function called after object creation and before the first reset( ) call
+
+Operation:
+- saves structure for the plugin to use; you can also load WAV files or state information here
+*/
+bool PluginCore::initialize(PluginInfo& pluginInfo)
+{
+	// --- add one-time init stuff here
+
+	return true;
+}
+
+/**
+\brief do anything needed prior to arrival of audio buffers
+
+Operation:
+- syncInBoundVariables when preProcessAudioBuffers is called, it is *guaranteed* that all GUI control change information
+  has been applied to plugin parameters; this binds parameter changes to your underlying variables
+- NOTE: postUpdatePluginParameter( ) will be called for all bound variables that are acutally updated; if you need to process
+  them individually, do so in that function
+- use this function to bulk-transfer the bound variable data into your plugin's member object variables
+
+\param processInfo structure of information about *buffer* processing
+
+\return true if operation succeeds, false otherwise
+*/
+bool PluginCore::preProcessAudioBuffers(ProcessBufferInfo& processInfo)
+{
+    // --- sync internal variables to GUI parameters; you can also do this manually if you don't
+    //     want to use the auto-variable-binding
+    syncInBoundVariables();
+
+
+
+
+
+
+    return true;
+}
+
+/**
+\brief recompute the cooked values of the controls flagged since the last call
+
+\param rampSmoothedParameters true in the block path: a smoothed Sat/Mix/MasterVolume change ramps across the
+       next block instead of stepping (see processBandBlock and saturateBandBlock)
+*/
+void PluginCore::cookParameters(bool rampSmoothedParameters) {
+
+	// --- the next block ramps from where the last one ended
+	for (uint32_t group = 0; group < kNumChannelGroups; group++)
+	{
+		for (uint32_t band = 0; band < kNumBands; band++)
+			mixRampStart[group][band] = cooked.mix[group][band];
+	}
+	masterVolumeRampStart = cooked.masterVolume;
+
+	if (dirtyControls == 0)
+		return;
+
+	const double sat[kNumBands] = { LowSat, LowMidSat, HighMidSat, TrebleSat };
+	const double mix[kNumBands] = { LowMix, LowMidMix, HighMidMix, TrebleMix };
+	uint64_t ramped = rampSmoothedParameters ? smoothedControls : 0;
+
+	// --- an unlinked group offsets the band Sat and scales the band Mix; the fronts are never unlinked
+	const bool unlinked[kNumChannelGroups] = { false, SurroundLink == (int)SurroundLinkEnum::Unlinked,
+		HeightLink == (int)HeightLinkEnum::Unlinked };
+	const double satOffset[kNumChannelGroups] = { 0.0, SurroundSat, HeightSat };
+	const double mixScale[kNumChannelGroups] = { 100.0, SurroundMix, HeightMix };
+	const uint64_t groupControls[kNumChannelGroups] = { 0,
+		(1ull << ControlID::SurroundLink) | (1ull << ControlID::SurroundSat) | (1ull << ControlID::SurroundMix),
+		(1ull << ControlID::HeightLink) | (1ull << ControlID::HeightSat) | (1ull << ControlID::HeightMix) };
+
+	for (uint32_t group = 0; group < kNumChannelGroups; group++)
+	{
+		for (uint32_t band = 0; band < kNumBands; band++)
+		{
+			uint64_t satControls = (1ull << (ControlID::LowSat + band)) | groupControls[group];
+			if (dirtyControls & satControls)
+			{
+				cooked.drive[group][band] = pow(10, (sat[band] + (unlinked[group] ? satOffset[group] : 0.0)) / 20);
+
+				// --- a ramped drive is handed to the waveshapers block by block, see saturateBandBlock
+				if (!(ramped & satControls))
+				{
+					for (uint32_t channel = 0; channel < numChannelStates; channel++)
+					{
+						if (channelGroup[channel] == group)
+							channelStates[channel].waveshaper[band].setDrive(cooked.drive[group][band]);
+					}
+				}
+			}
+
+			uint64_t mixControls = (1ull << (ControlID::LowMix + band)) | groupControls[group];
+			if (dirtyControls & mixControls)
+			{
+				cooked.mix[group][band] = mix[band] / 100 * (unlinked[group] ? mixScale[group] / 100 : 1.0);
+				if (!(ramped & mixControls))
+					mixRampStart[group][band] = cooked.mix[group][band];
+			}
+		}
+	}
+
+	if (dirtyControls & (1ull << ControlID::MasterVolume))
+	{
+		cooked.masterVolume = pow(10, MasterVolume / 20);
+		if (!(ramped & (1ull << ControlID::MasterVolume)))
+			masterVolumeRampStart = cooked.masterVolume;
+	}
+
+	if (dirtyControls & (1ull << ControlID::SatQuality))
+	{
+		for (uint32_t band = 0; band < kNumBands; band++)
+		{
+			for (uint32_t channel = 0; channel < numChannelStates; channel++)
+				channelStates[channel].waveshaper[band].setQuality((TanhQuality)SatQuality);
+		}
+	}
+
+	if (dirtyControls & (1ull << ControlID::SatAntialiasing))
+	{
+		for (uint32_t band = 0; band < kNumBands; band++)
+		{
+			for (uint32_t channel = 0; channel < numChannelStates; channel++)
+				channelStates[channel].waveshaper[band].setAntialiasing((TanhAntialiasing)SatAntialiasing);
+		}
+	}
+
+	const uint64_t bandStateControls = (1ull << (ControlID::TrebleSolo + 1)) - 1;
+	if (dirtyControls & bandStateControls)
+		setBandStates();
+
+	const uint64_t oversamplingControls = ((1ull << (ControlID::TrebleOversampling + 1)) - 1) & ~((1ull << ControlID::Oversampling) - 1);
+	if (dirtyControls & oversamplingControls)
+		setOversampling();
+
+	const uint64_t crossoverControls = (1ull << ControlID::LowCrossover) | (1ull << ControlID::MidCrossover) | (1ull << ControlID::HighCrossover);
+	if (dirtyControls & crossoverControls)
+	{
+		setCrossoverTargets();
+		crossoverGliding = true;
+		linearPhaseCrossover.setCrossover(crossoverFc[0], crossoverFc[1], crossoverFc[2], true);
+	}
+
+	// --- the two crossovers' bands differ in delay and polarity, so the band states start again from silence
+	if (dirtyControls & (1ull << ControlID::CrossoverMode))
+	{
+		bool linear = CrossoverMode == (int)CrossoverModeEnum::Linear_Phase;
+		if (linear != linearPhase)
+		{
+			// --- crossover changes made in IIR mode are designed now; without a reset since, there is no design
+			//     thread and later changes are designed here at their handover partition
+			linearPhase = linear;
+			if (linearPhase)
+				linearPhaseCrossover.setCrossover(crossoverFc[0], crossoverFc[1], crossoverFc[2], false);
+			clearBandStates();
+			setLatency();
+		}
+	}
+
+	dirtyControls = 0;
+	smoothedControls = 0;
+}
+
+/**
+\brief set the crossovers exactly to the target frequencies and end any glide
+*/
+void PluginCore::setAndCalcFilters() {
+
+	if (monoCrossover)
+		monoCrossover->setCrossover(crossoverFc[0], crossoverFc[1], crossoverFc[2], PluginCore::getSampleRate());
+	for (LinkwitzRileyStereoCrossover* crossover : stereoCrossovers)
+		crossover->setCrossover(crossoverFc[0], crossoverFc[1], crossoverFc[2], PluginCore::getSampleRate());
+
+	for (uint32_t i = 0; i < kNumCrossovers; i++)
+		crossoverGlide[i] = crossoverTarget[i];
+	crossoverGliding = false;
+	crossoverGlideCountdown = 0;
+
+}
+
+/**
+\brief take the crossover frequencies from the parameters, kept below kMaxCrossoverFcRatio of the rate
+*/
+void PluginCore::setCrossoverTargets() {
+
+	const double frequency[kNumCrossovers] = { LowCrossover, MidCrossover, HighCrossover };
+	double maxFc = kMaxCrossoverFcRatio * PluginCore::getSampleRate();
+
+	for (uint32_t i = 0; i < kNumCrossovers; i++)
+	{
+		crossoverFc[i] = frequency[i] < kMinCrossoverFc ? kMinCrossoverFc : frequency[i] > maxFc ? maxFc : frequency[i];
+		crossoverTarget[i] = log2(crossoverFc[i]);
+	}
+
+}
+
+/**
+\brief step a moving crossover when its current sub-block is used up: the glide moves once per
+       kCrossoverGlideFrames and the sections ramp across the sub-block to coefficients from the warp table
+       (no tan() here)
+
+\param numFrames frames the caller is about to run through the crossover
+\return frames that may run on the current coefficients, <= numFrames
+*/
+uint32_t PluginCore::glideCrossovers(uint32_t numFrames) {
+
+	if (!crossoverGliding)
+		return numFrames;
+
+	if (crossoverGlideCountdown == 0)
+	{
+		bool settled = true;
+		double warp[kNumCrossovers];
+		for (uint32_t i = 0; i < kNumCrossovers; i++)
+		{
+			crossoverGlide[i] += (crossoverTarget[i] - crossoverGlide[i]) * crossoverGlideCoefficient;
+			if (fabs(crossoverTarget[i] - crossoverGlide[i]) > kCrossoverSettledOctaves)
+				settled = false;
+			warp[i] = crossoverWarpTable.getWarp(crossoverGlide[i]);
+		}
+
+		if (settled)
+		{
+			setAndCalcFilters();
+			return numFrames;
+		}
+
+		if (monoCrossover)
+			monoCrossover->setWarpedCrossover(warp[0], warp[1], warp[2], kCrossoverGlideFrames);
+		for (LinkwitzRileyStereoCrossover* crossover : stereoCrossovers)
+			crossover->setWarpedCrossover(warp[0], warp[1], warp[2], kCrossoverGlideFrames);
+		crossoverGlideCountdown = kCrossoverGlideFrames;
+	}
+
+	if (numFrames > crossoverGlideCountdown)
+		numFrames = crossoverGlideCountdown;
+	crossoverGlideCountdown -= numFrames;
+	return numFrames;
+
+}
+
+// --- the channel groups of each supported input format in the VST3/AU channel order (SMPTE: L R C LFE Ls Rs ..
+//     then the heights): F front, S surround, H height, L LFE; nullptr for formats there are no kernels for.
+//     LCRS is L R C S and the 7.1 Proximity pair is with the fronts; ambisonic channels are all alike
+static const char* getChannelGroupLayout(uint32_t format)
+{
+	switch (format)
+	{
+	case kCFMono: return "F";
+	case kCFStereo: return "FF";
+	case kCFLCR: return "FFF";
+	case kCFLCRS: return "FFFS";
+	case kCFQuad: return "FFSS";
+	case kCF5p0: return "FFFSS";
+	case kCF5p1: return "FFFLSS";
+	case kCF6p0: return "FFSSSS";
+	case kCF6p1: return "FFLSSSS";
+	case kCF7p0Sony: return "FFFSSFF";
+	case kCF7p0DTS: return "FFFSSSS";
+	case kCF7p1Sony: return "FFFLSSFF";
+	case kCF7p1DTS: return "FFFLSSSS";
+	case kCF7p1Proximity: return "FFFLSSFF";
+	case kCF7p1p4: return "FFFLSSSSHHHH";
+	case kCFAmbisonic1stOrder: return "FFFF";
+	case kCFAmbisonic2ndOrder: return "FFFFFFFFF";
+	case kCFAmbisonic3rdOrder: return "FFFFFFFFFFFFFFFF";
+	default: return nullptr;
+	}
+}
+
+/**
+\brief set up the channel groups for the input format and allocate what its channels need: a state per channel
+       and the crossovers for the channels that are split
+
+\param channelIOConfig the I/O about to be processed; kCFNone (the API did not say) keeps mono and stereo
+\param deleteUnused false on the audio thread (the host changed the I/O without a reset, and hasChannelStates
+       said nothing is missing): nothing is allocated or shrunk
+*/
+void PluginCore::createChannelStates(const ChannelIOConfig& channelIOConfig, bool deleteUnused) {
+
+	bool known = channelIOConfig.inputChannelFormat != kCFNone;
+	const char* layout = getChannelGroupLayout(known ? channelIOConfig.inputChannelFormat : (uint32_t)kCFStereo);
+	uint32_t numChannels = layout ? (uint32_t)strlen(layout) : 0;
+
+	numCrossoverChannels = 0;
+	for (uint32_t channel = 0; channel < numChannels; channel++)
+	{
+		switch (layout[channel])
+		{
+		case 'S': channelGroup[channel] = kSurroundGroup; break;
+		case 'H': channelGroup[channel] = kHeightGroup; break;
+		case 'L': channelGroup[channel] = kLFEChannel; break;
+		default: channelGroup[channel] = kFrontGroup; break;
+		}
+		if (channelGroup[channel] != kLFEChannel)
+			crossoverChannel[numCrossoverChannels++] = channel;
+	}
+
+	linearPhaseCrossover.setChannels(numCrossoverChannels);
+
+	bool needMono = !known || (numCrossoverChannels & 1);
+	uint32_t numStereoCrossovers = numCrossoverChannels / 2;
+
+	if (needMono && !monoCrossover) {
+		monoCrossover = new LinkwitzRileyCrossover;
+		monoCrossover->setCrossover(crossoverFc[0], crossoverFc[1], crossoverFc[2], PluginCore::getSampleRate());
+	}
+	else if (!needMono && deleteUnused) {
+		delete monoCrossover;
+		monoCrossover = nullptr;
+	}
+
+	while (stereoCrossovers.size() < numStereoCrossovers) {
+		LinkwitzRileyStereoCrossover* crossover = new LinkwitzRileyStereoCrossover;
+		crossover->setCrossover(crossoverFc[0], crossoverFc[1], crossoverFc[2], PluginCore::getSampleRate());
+		stereoCrossovers.push_back(crossover);
+	}
+	while (deleteUnused && stereoCrossovers.size() > numStereoCrossovers) {
+		delete stereoCrossovers.back();
+		stereoCrossovers.pop_back();
+	}
+
+	// --- new states start from the defaults, so everything is cooked into them again
+	if (numChannels > numChannelStates || (deleteUnused && numChannels < numChannelStates))
+	{
+		allocateChannelStates(numChannels);
+		dirtyControls = kAllCookedControls;
+	}
+
+	// --- the LFE and bypass delays cover the oversampling and the linear phase crossover at this rate (only grow)
+	uint32_t maxLatency = Oversampler::kPhaseTaps + LinearPhaseCrossover::getLatency(PluginCore::getSampleRate());
+	for (uint32_t channel = 0; channel < numChannelStates; channel++)
+	{
+		channelStates[channel].lfeDelay.setMaxDelay(maxLatency);
+		channelStates[channel].bypassDelay.setMaxDelay(maxLatency);
+	}
+
+}
+
+/**
+\brief whether everything the I/O needs is already there, so createChannelStates(channelIOConfig, false) can set
+       it up on the audio thread without allocating
+
+\param channelIOConfig the I/O the host sent without a reset
+
+\return true if the states, crossovers and linear phase channels for it exist
+*/
+bool PluginCore::hasChannelStates(const ChannelIOConfig& channelIOConfig) {
+
+	bool known = channelIOConfig.inputChannelFormat != kCFNone;
+	const char* layout = getChannelGroupLayout(known ? channelIOConfig.inputChannelFormat : (uint32_t)kCFStereo);
+	uint32_t numChannels = layout ? (uint32_t)strlen(layout) : 0;
+
+	uint32_t numSplitChannels = 0;
+	for (uint32_t channel = 0; channel < numChannels; channel++)
+	{
+		if (layout[channel] != 'L')
+			numSplitChannels++;
+	}
+
+	bool needMono = !known || (numSplitChannels & 1);
+	return numChannels <= numChannelStates && (!needMono || monoCrossover) &&
+		numSplitChannels / 2 <= stereoCrossovers.size() &&
+		numSplitChannels <= linearPhaseCrossover.getAllocatedChannels();
+
+}
+
+/**
+\brief place count default constructed ChannelStates on a cache line boundary, replacing any there were
+
+\param count number of channels
+*/
+void PluginCore::allocateChannelStates(uint32_t count) {
+
+	freeChannelStates();
+	if (count == 0)
+		return;
+
+	channelStateMemory = new uint8_t[count * sizeof(ChannelState) + kCacheLineBytes];
+	uintptr_t address = ((uintptr_t)channelStateMemory + kCacheLineBytes - 1) & ~(uintptr_t)(kCacheLineBytes - 1);
+	channelStates = (ChannelState*)address;
+	for (uint32_t channel = 0; channel < count; channel++)
+		new (&channelStates[channel]) ChannelState;
+	numChannelStates = count;
+
+}
+
+void PluginCore::freeChannelStates() {
+
+	for (uint32_t channel = 0; channel < numChannelStates; channel++)
+		channelStates[channel].~ChannelState();
+	delete[] channelStateMemory;
+	channelStateMemory = nullptr;
+	channelStates = nullptr;
+	numChannelStates = 0;
+
+}
+
+/**
+\brief resolve the On/Solo switches into the active band mask; any solo overrides the On switches.
+       The bound variables are left alone.
+*/
+void PluginCore::setBandStates() {
+
+	uint32_t onMask = (LowOn ? 1u << kLowBand : 0) | (LowMidOn ? 1u << kLowMidBand : 0) |
+		(HighMidOn ? 1u << kHighMidBand : 0) | (TrebleOn ? 1u << kTrebleBand : 0);
+	uint32_t soloMask = (LowSolo ? 1u << kLowBand : 0) | (LowMidSolo ? 1u << kLowMidBand : 0) |
+		(HighMidSolo ? 1u << kHighMidBand : 0) | (TrebleSolo ? 1u << kTrebleBand : 0);
+
+	uint32_t activeBands = soloMask != 0 ? soloMask : onMask;
+
+	// --- the block path stops a muted band's delay lines, FIR and ADAA histories; start them again from silence
+	//     rather than replaying what they held when it was muted
+	uint32_t activatedBands = activeBands & ~cooked.activeBands;
+	for (uint32_t band = 0; band < kNumBands; band++)
+	{
+		if (activatedBands & (1u << band))
+		{
+			for (uint32_t channel = 0; channel < numChannelStates; channel++)
+			{
+				ChannelState& state = channelStates[channel];
+				state.waveshaper[band].clear();
+				state.oversampler[band].clear();
+				state.dryDelay[band].clear();
+				state.wetDelay[band].clear();
+			}
+		}
+	}
+
+	cooked.activeBands = activeBands;
+	for (uint32_t band = 0; band < kNumBands; band++)
+		cooked.bandOn[band] = (cooked.activeBands >> band) & 1;
+
+}
+
+/**
+\brief set each band's oversampling factor (1x with Oversampling OFF) and delay every band to the largest
+       latency so the bands and their dry signals stay in phase; see setLatency for what is reported
+*/
+void PluginCore::setOversampling() {
+
+	const int factorIndex[kNumBands] = { LowOversampling, LowMidOversampling, HighMidOversampling, TrebleOversampling };
+
+	uint32_t latency = 0;
+	for (uint32_t band = 0; band < kNumBands; band++)
+	{
+		uint32_t factor = Oversampling ? 1u << factorIndex[band] : 1;
+		for (uint32_t channel = 0; channel < numChannelStates; channel++)
+		{
+			channelStates[channel].oversampler[band].setFactor(factor, PluginCore::getSampleRate());
+			channelStates[channel].waveshaper[band].clear();
+		}
+		if (numChannelStates > 0 && channelStates[0].oversampler[band].getLatency() > latency)
+			latency = channelStates[0].oversampler[band].getLatency();
+	}
+
+	// --- 1x bands delay their input (dry and wet alike), oversampled bands pad their output
+	for (uint32_t channel = 0; channel < numChannelStates; channel++)
+	{
+		ChannelState& state = channelStates[channel];
+		for (uint32_t band = 0; band < kNumBands; band++)
+		{
+			state.dryDelay[band].setDelay(latency);
+			state.wetDelay[band].setDelay(state.oversampler[band].getFactor() > 1 ? latency - state.oversampler[band].getLatency() : 0);
+		}
+	}
+
+	oversamplingLatency = latency;
+	setLatency();
+
+}
+
+/**
+\brief the processing latency is the linear phase crossover's (Crossover Mode Linear Phase) plus the oversampling
+       latency, on top of the described kLatencyInSamples; the shells pick it up with getLatencyInSamples.
+       The LFE is only delayed, by the same, and so is the input in the soft bypass
+*/
+void PluginCore::setLatency() {
+
+	crossoverLatency = linearPhase ? linearPhaseCrossover.getLatency() : 0;
+	for (uint32_t channel = 0; channel < numChannelStates; channel++)
+	{
+		channelStates[channel].lfeDelay.setDelay(crossoverLatency + oversamplingLatency);
+		channelStates[channel].bypassDelay.setDelay(crossoverLatency + oversamplingLatency);
+	}
+
+	silenceHoldFrames = kSilenceHoldFrames + crossoverLatency;
+	setProcessingLatency(crossoverLatency + oversamplingLatency);
+
+}
+
+/**
+\brief frame-processing method
+
+Operation:
+- MIDI events are fired before the frame they are due on, so MIDI is tightly synced with audio; frames without
+  an event cost one compare (see PluginBase::fireMidiEvents)
+- doSampleAccurateParameterUpdates will perform per-sample interval smoothing
+- the DSP is processFrameKernel, instantiated for the channel I/O by selectKernels(); there is no per-sample
+  plugin type or format dispatch
+
+\param processFrameInfo structure of information about *frame* processing
+
+\return true if operation succeeds, false otherwise
+*/
+bool PluginCore::processAudioFrame(ProcessFrameInfo& processFrameInfo)
+{
+    // --- fire any MIDI events for this sample interval
+    fireMidiEvents(processFrameInfo.currentFrame);
+
+	// --- do per-frame updates; VST automation and parameter smoothing
+	doSampleAccurateParameterUpdates();
+
+	// --- only the controls that changed are cooked again
+	cookParameters(false);
+
+	if (!frameKernel)
+		return false; /// NOT processed
+
+	return (this->*frameKernel)(processFrameInfo);
+}
+
+/**
+\brief synth plugin frame: output silence; change this with your signal render code
+
+\param processFrameInfo structure of information about *frame* processing
+
+\return true
+*/
+bool PluginCore::processSynthFrame(ProcessFrameInfo& processFrameInfo)
+{
+	for (uint32_t channel = 0; channel < processFrameInfo.numAudioOutChannels; channel++)
+		processFrameInfo.audioOutputFrame[channel] = 0.0;
+
+	return true;	/// processed
+}
+
+// --- the split channels go through the stereo crossovers in pairs and an odd one through the mono crossover
+//     (see createChannelStates), or all at once through the linear phase crossover; the LFE is not split
+template <typename SampleType, uint32_t kChannels>
+void PluginCore::splitFrame(const SampleType* input, double (*bands)[kNumBands])
+{
+	static_assert(kChannels <= kMaxChannels, "there is a channel state per channel");
+
+	if (linearPhase)
+	{
+		const SampleType* channelInputs[kChannels];
+		double* channelBands[kChannels][kNumBands];
+		double* const* bandPointers[kChannels];
+		for (uint32_t k = 0; k < numCrossoverChannels; k++)
+		{
+			uint32_t channel = crossoverChannel[k];
+			channelInputs[k] = &input[channel];
+			for (uint32_t band = 0; band < kNumBands; band++)
+				channelBands[k][band] = &bands[channel][band];
+			bandPointers[k] = channelBands[k];
+		}
+		linearPhaseCrossover.processBlock(channelInputs, bandPointers, 1);
+		return;
+	}
+
+	glideCrossovers(1);
+	for (uint32_t pair = 0; pair < numCrossoverChannels / 2; pair++)
+	{
+		uint32_t left = crossoverChannel[2 * pair];
+		uint32_t right = crossoverChannel[2 * pair + 1];
+		stereoCrossovers[pair]->processFrame(input[left], input[right], bands[left], bands[right]);
+	}
+
+	if (numCrossoverChannels & 1)
+	{
+		uint32_t channel = crossoverChannel[numCrossoverChannels - 1];
+		monoCrossover->processFrame(input[channel], bands[channel]);
+	}
+}
+
+// --- a moving crossover runs in sub-blocks with new coefficients between them (see glideCrossovers); each pair
+//     of channels shares the lanes of a stereo crossover. The linear phase crossover takes the whole chunk and
+//     crossfades to new FIRs itself; the IIR glide waits meanwhile
+template <typename SampleType, uint32_t kChannels>
+void PluginCore::splitBlock(const SampleType* const* inputs, uint32_t offset, uint32_t numFrames)
+{
+	static_assert(kChannels <= kMaxChannels, "there is a channel state per channel");
+
+	if (linearPhase)
+	{
+		const SampleType* channelInputs[kChannels];
+		double* channelBands[kChannels][kNumBands];
+		double* const* bandPointers[kChannels];
+		for (uint32_t k = 0; k < numCrossoverChannels; k++)
+		{
+			uint32_t channel = crossoverChannel[k];
+			channelInputs[k] = &inputs[channel][offset];
+			for (uint32_t band = 0; band < kNumBands; band++)
+				channelBands[k][band] = channelStates[channel].bandDry[band];
+			bandPointers[k] = channelBands[k];
+		}
+		linearPhaseCrossover.processBlock(channelInputs, bandPointers, numFrames);
+		return;
+	}
+
+	for (uint32_t done = 0, n = 0; done < numFrames; done += n)
+	{
+		n = glideCrossovers(numFrames - done);
+		double* bands[kChannels][kNumBands];
+		for (uint32_t channel = 0; channel < kChannels; channel++)
+		{
+			for (uint32_t band = 0; band < kNumBands; band++)
+				bands[channel][band] = &channelStates[channel].bandDry[band][done];
+		}
+
+		for (uint32_t pair = 0; pair < numCrossoverChannels / 2; pair++)
+		{
+			uint32_t left = crossoverChannel[2 * pair];
+			uint32_t right = crossoverChannel[2 * pair + 1];
+			stereoCrossovers[pair]->processBlock(&inputs[left][offset + done], &inputs[right][offset + done],
+				bands[left], bands[right], n);
+		}
+
+		if (numCrossoverChannels & 1)
+		{
+			uint32_t channel = crossoverChannel[numCrossoverChannels - 1];
+			monoCrossover->processBlock(&inputs[channel][offset + done], bands[channel], n);
+		}
+	}
+}
+
+/**
+\brief one frame of kChannels through the crossover, saturation, mix, band sum and master volume; an LFE channel
+       is only delayed and scaled. Outputs past kChannels (mono-in/stereo-out) copy the first one
+
+\param processFrameInfo structure of information about *frame* processing
+
+\return true (processed)
+*/
+template <typename SampleType, uint32_t kChannels, uint32_t kOutputChannels, uint32_t kBands>
+bool PluginCore::processFrameKernel(ProcessFrameInfo& processFrameInfo)
+{
+	static_assert(kBands == LinkwitzRileyCrossover::kNumBands, "the crossovers split into four bands");
+
+	const SampleType* input = processFrameInfo.audioInputFrame;
+	SampleType* output = processFrameInfo.audioOutputFrame;
 
-    return true;
-}
+	//filter each band; adjacent bands come back phase inverted (IIR)
+	double bands[kChannels][kBands];
+	splitFrame<SampleType, kChannels>(input, bands);
 
-/**
-\brief initialize object for a new run of audio; called just before audio streams
+	for (uint32_t channel = 0; channel < kChannels; channel++)
+	{
+		uint32_t group = channelGroup[channel];
+		if (group == kLFEChannel)
+		{
+			output[channel] = channelStates[channel].lfeDelay.processSample(input[channel]) * cooked.masterVolume;
+			meterLevels.output.measureSample(output[channel]);
+			continue;
+		}
 
-Operation:
-- store sample rate and bit depth on audioProcDescriptor - this information is globally available to all core functions
-- reset your member objects here
+		double wet[kBands];
+		for (uint32_t band = 0; band < kBands; band++)
+		{
+			//take dry signal of each band and add harmonic excitation to it
+			double& dry = bands[channel][band];
+			wet[band] = saturateBandSample(channel, band, dry);
+
+			//blend dry signals with distorted signal
+			wet[band] = dry * (1.0f - cooked.mix[group][band]) + wet[band] * cooked.mix[group][band];
+
+			//meters, as the block path measures them
+			meterLevels.in[band].measureSample(dry);
+			if (cooked.bandOn[band])
+			{
+				meterLevels.out[band].measureSample(wet[band]);
+				meterLevels.harmonics[band].measureSample(wet[band] - dry);
+			}
+			else
+			{
+				meterLevels.out[band].addSilence(1);
+				meterLevels.harmonics[band].addSilence(1);
+			}
+		}
 
-\param resetInfo structure of information about current audio format
+		//sum all bands and apply bypass on each band
+		double channelData = wet[0] * cooked.bandOn[0];
+		for (uint32_t band = 1; band < kBands; band++)
+			channelData += wet[band] * cooked.bandOn[band];
 
-\return true if operation succeeds, false otherwise
-*/
-bool PluginCore::reset(ResetInfo& resetInfo)
-{
-    // --- save for audio processing
-    audioProcDescriptor.sampleRate = resetInfo.sampleRate;
-    audioProcDescriptor.bitDepth = resetInfo.bitDepth;
+		//set master volume
+		output[channel] = channelData * cooked.masterVolume;
+		meterLevels.output.measureSample(output[channel]);
+	}
 
-	setAndCalcFilters();
+	for (uint32_t channel = kChannels; channel < kOutputChannels; channel++)
+		output[channel] = output[0];
 
-    // --- other reset inits
-    return PluginBase::reset(resetInfo);
+	return true; /// processed
 }
 
-/**
-\brief one-time initialize function called after object creation and before the first reset( ) call
-
-Operation:
-- saves structure for the plugin to use; you can also load WAV files or state information here
-*/
-bool PluginCore::initialize(PluginInfo& pluginInfo)
+// --- true when every sample is within +/- threshold
+template <typename SampleType>
+static bool isSilentBuffer(const SampleType* buffer, uint32_t numFrames, double threshold)
 {
-	// --- add one-time init stuff here
-
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		if (fabs(buffer[i]) > threshold)
+			return false;
+	}
 	return true;
 }
 
 /**
-\brief do anything needed prior to arrival of audio buffers
+\brief one chunk of kChannels, one stage at a time; the arithmetic mirrors processFrameKernel (the SIMD
+       waveshaper kernels stay within a few double ulps of libm tanh). Outputs past kChannels copy the first one.
+       Silent chunks after the tails have died away are written as zeros without any band processing.
 
-Operation:
-- syncInBoundVariables when preProcessAudioBuffers is called, it is *guaranteed* that all GUI control change information
-  has been applied to plugin parameters; this binds parameter changes to your underlying variables
-- NOTE: postUpdatePluginParameter( ) will be called for all bound variables that are acutally updated; if you need to process
-  them individually, do so in that function
-- use this function to bulk-transfer the bound variable data into your plugin's member object variables
-
-\param processInfo structure of information about *buffer* processing
+\param inputs the host input buffers
+\param outputs the host output buffers
+\param offset first frame of the chunk
+\param numFrames frames to process, <= kBlockFrames
 
-\return true if operation succeeds, false otherwise
+\return true if the chunk was skipped as silence (the outputs are zeros)
 */
-bool PluginCore::preProcessAudioBuffers(ProcessBufferInfo& processInfo)
+template <typename SampleType, uint32_t kChannels, uint32_t kOutputChannels, uint32_t kBands>
+bool PluginCore::processBlockKernel(const SampleType* const* inputs, SampleType* const* outputs, uint32_t offset, uint32_t numFrames)
 {
-    // --- sync internal variables to GUI parameters; you can also do this manually if you don't
-    //     want to use the auto-variable-binding
-    syncInBoundVariables();
-
+	static_assert(kBands == kNumBands, "the band stages are sized for the crossovers' four bands");
 
+	// --- the host may already know the input is silent (VST3 silenceFlags); otherwise look
+	bool inputSilent = true;
+	if (!hostInputSilent)
+	{
+		for (uint32_t channel = 0; channel < kChannels && inputSilent; channel++)
+			inputSilent = isSilentBuffer(&inputs[channel][offset], numFrames, kSilenceThreshold);
+	}
 
+	// --- nothing left ringing: skip everything (a glide just lands, there is nothing to hear it on)
+	if (silent && inputSilent)
+	{
+		if (crossoverGliding)
+			setAndCalcFilters();
+		for (uint32_t channel = 0; channel < kOutputChannels; channel++)
+			memset(&outputs[channel][offset], 0, numFrames * sizeof(SampleType));
 
+		// --- the meters count the zeros
+		for (uint32_t band = 0; band < kNumBands; band++)
+		{
+			meterLevels.in[band].addSilence(numFrames * numCrossoverChannels);
+			meterLevels.out[band].addSilence(numFrames * numCrossoverChannels);
+			meterLevels.harmonics[band].addSilence(numFrames * numCrossoverChannels);
+		}
+		meterLevels.output.addSilence(numFrames * kChannels);
+		return true;
+	}
+	silent = false;
 
+	// --- crossover: split into four bands, adjacent bands come back phase inverted (IIR)
+	splitBlock<SampleType, kChannels>(inputs, offset, numFrames);
 
-    return true;
-}
+	// --- the band tails are checked before the dry delay (Oversampling ON) moves them; silenceHoldFrames
+	//     covers what is still in the delay lines
+	bool tailsSilent = inputSilent;
+	for (uint32_t k = 0; k < numCrossoverChannels && tailsSilent; k++)
+	{
+		for (uint32_t band = 0; band < kNumBands && tailsSilent; band++)
+			tailsSilent = isSilentBuffer(channelStates[crossoverChannel[k]].bandDry[band], numFrames, kSilenceThreshold);
+	}
+	DSP_PROFILER_LAP(dspProfiler, kCrossoverStage);
 
-void PluginCore::updateParameters() {
+	for (uint32_t channel = 0; channel < kChannels; channel++)
+	{
+		if (channelGroup[channel] == kLFEChannel)
+			processLFEBlock(channel, &inputs[channel][offset], &outputs[channel][offset], numFrames);
+		else
+			processBandBlock(channel, &outputs[channel][offset], numFrames);
+	}
 
+	for (uint32_t channel = kChannels; channel < kOutputChannels; channel++)
+		memcpy(&outputs[channel][offset], &outputs[0][offset], numFrames * sizeof(SampleType));
 
-	LowSatRaw = pow(10, LowSat / 20);
-	LowMidSatRaw = pow(10, LowMidSat / 20);
-	HighMidSatRaw = pow(10, HighMidSat / 20);
-	TrebleSatRaw = pow(10, TrebleSat / 20);
+	updateSilence(tailsSilent, numFrames);
+	return false;
+}
 
-	LowMixRaw = LowMix / 100;
-	LowMidMixRaw = LowMidMix / 100;
-	HighMidMixRaw = HighMidMix / 100;
-	TrebleMixRaw = TrebleMix / 100;
+/**
+\brief count the frames since the input and the band tails went quiet; after silenceHoldFrames the band
+       states are cleared and the block kernels output zeros until the input comes back
 
-	MasterVolumeCooked = pow(10, MasterVolume / 20);
+\param tailsSilent the input and every band out of the crossover stayed under kSilenceThreshold
+\param numFrames frames in the chunk
+*/
+void PluginCore::updateSilence(bool tailsSilent, uint32_t numFrames)
+{
+	if (!tailsSilent)
+	{
+		silentFrames = 0;
+		return;
+	}
 
+	silentFrames += numFrames;
+	if (silentFrames >= silenceHoldFrames)
+	{
+		clearBandStates();
+		silent = true;
+		silentFrames = 0;
+	}
 }
 
-void PluginCore::setAndCalcFilters() {
-
-	LFLP_L.setFilter(0, 100.f, PluginCore::getSampleRate());
-	LFHP_L.setFilter(1, 100.f, PluginCore::getSampleRate());
-	MFLP_L.setFilter(0, 1000.f, PluginCore::getSampleRate());
-	MFHP_L.setFilter(1, 1000.f, PluginCore::getSampleRate());
-	HFLP_L.setFilter(0, 10000.f, PluginCore::getSampleRate());
-	HFHP_L.setFilter(1, 10000.f, PluginCore::getSampleRate());
-
-	LFLP_R.setFilter(0, 100.f, PluginCore::getSampleRate());
-	LFHP_R.setFilter(1, 100.f, PluginCore::getSampleRate());
-	MFLP_R.setFilter(0, 1000.f, PluginCore::getSampleRate());
-	MFHP_R.setFilter(1, 1000.f, PluginCore::getSampleRate());
-	HFLP_R.setFilter(0, 10000.f, PluginCore::getSampleRate());
-	HFHP_R.setFilter(1, 10000.f, PluginCore::getSampleRate());
+/**
+\brief clear the crossover, waveshaper, oversampler and delay states, so whatever comes after a silence
+       starts clean (and no tail is left to decay into denormals)
+*/
+void PluginCore::clearBandStates()
+{
+	if (monoCrossover)
+		monoCrossover->clear();
+	for (LinkwitzRileyStereoCrossover* crossover : stereoCrossovers)
+		crossover->clear();
+	linearPhaseCrossover.clear();
 
+	for (uint32_t channel = 0; channel < numChannelStates; channel++)
+	{
+		ChannelState& state = channelStates[channel];
+		for (uint32_t band = 0; band < kNumBands; band++)
+		{
+			state.waveshaper[band].clear();
+			state.oversampler[band].clear();
+			state.dryDelay[band].clear();
+			state.wetDelay[band].clear();
+		}
+		state.lfeDelay.clear();
+	}
 }
 
-void PluginCore::setBandStates() {
+// --- the frame and block kernels (float and double) for one channel count
+template <uint32_t kChannels, uint32_t kOutputChannels>
+void PluginCore::setKernels()
+{
+	frameKernel = &PluginCore::processFrameKernel<float, kChannels, kOutputChannels, kNumBands>;
+	blockKernel = &PluginCore::processBlockKernel<float, kChannels, kOutputChannels, kNumBands>;
+	blockKernel64 = &PluginCore::processBlockKernel<double, kChannels, kOutputChannels, kNumBands>;
+}
 
-	if (LowSolo == true && LowMidSolo == false && HighMidSolo == false && TrebleSolo == false) {
+/**
+\brief pick the frame and block kernels for the channel I/O; the unsupported formats get none and are
+       reported as not processed
 
-		LowOn = 1;
-		LowMidOn = 0;
-		HighMidOn = 0;
-		TrebleOn = 0;
+\param channelIOConfig the I/O about to be processed; its channel states must already exist (createChannelStates)
+*/
+void PluginCore::selectKernels(const ChannelIOConfig& channelIOConfig)
+{
+	kernelIOConfig = channelIOConfig;
+	frameKernel = nullptr;
+	blockKernel = nullptr;
+	blockKernel64 = nullptr;
 
+	// --- Synth Plugin --- remove for FX plugins
+	if (getPluginType() == kSynthPlugin)
+	{
+		frameKernel = &PluginCore::processSynthFrame;
+		return;
 	}
 
-	if (LowSolo == false && LowMidSolo == true && HighMidSolo == false && TrebleSolo == false) {
-
-		LowOn = 0;
-		LowMidOn = 1;
-		HighMidOn = 0;
-		TrebleOn = 0;
+	uint32_t inputFormat = channelIOConfig.inputChannelFormat;
+	uint32_t outputFormat = channelIOConfig.outputChannelFormat;
 
+	// --- Mono-In/Mono-Out and Mono-In/Stereo-Out: one chain, copied to both outputs for stereo
+	if (inputFormat == kCFMono && outputFormat == kCFMono)
+		setKernels<1, 1>();
+	else if (inputFormat == kCFMono && outputFormat == kCFStereo)
+		setKernels<1, 2>();
+	// --- Stereo-In/Stereo-Out and the surround formats: the same format in and out, see getChannelGroupLayout()
+	else if (inputFormat == outputFormat && getChannelGroupLayout(inputFormat))
+	{
+		switch (strlen(getChannelGroupLayout(inputFormat)))
+		{
+		case 2: setKernels<2, 2>(); break;
+		case 3: setKernels<3, 3>(); break;
+		case 4: setKernels<4, 4>(); break;
+		case 5: setKernels<5, 5>(); break;
+		case 6: setKernels<6, 6>(); break;
+		case 7: setKernels<7, 7>(); break;
+		case 8: setKernels<8, 8>(); break;
+		case 9: setKernels<9, 9>(); break;
+		case 12: setKernels<12, 12>(); break;
+		case 16: setKernels<16, 16>(); break;
+		default: break;
+		}
 	}
+}
 
-	if (LowSolo == false && LowMidSolo == false && HighMidSolo == true && TrebleSolo == false) {
+/**
+\brief buffer-processing method
 
-		LowOn = 0;
-		LowMidOn = 0;
-		HighMidOn = 1;
-		TrebleOn = 0;
+Operation:
+- runs each DSP stage (crossover, saturation, mix, sum, master gain) over whole channel buffers taken
+  directly from processBufferInfo.inputs/outputs, in chunks of kBlockFrames; a 64-bit host's inputs64/outputs64
+  go through the double kernel, which never rounds to float (the float kernel rounds between crossover stages)
+- the output matches the processAudioFrame path; the crossover is bit-identical, the exact SIMD waveshaper
+  kernels stay within a few double ulps of libm tanh and the approximate SatQuality tiers are bit-identical
+- parameters are cooked once per chunk, and only those that changed; the smoothers advance once per chunk
+  (doBlockParameterSmoothing) and a smoothed Sat/Mix/MasterVolume is applied as a linear ramp over the chunk
+- with Oversampling ON each band is saturated at its own rate and everything is delayed by the reported
+  latency (see saturateBandBlock)
+- MIDI events are fired between chunks: a chunk ends where the next event is due (see beginMidiEvents), so a
+  MIDI CC mapped to a parameter (getMidiControllerParameter) takes effect on its frame; events timed at or past
+  the end of the buffer are fired after the last chunk (endMidiEvents)
+- with VST3 sample accurate automation the chunks also end on the automation points (see
+  getSampleAccurateSubBlockFrames) and the automated values ramp across each; without sub-blocks
+  (kVST3SAASubBlocks) it needs per-frame updates
+- falls back to the base class frame path when setFrameProcessing(true) is set (A/B checks) or when
+  VST3 sample accurate automation needs per-frame updates
+- runs under a DenormalGuard (flush to zero); once the input and the band tails have gone quiet the chunks are
+  skipped as zeros and outputSilenceFlags tells the host (see updateSilence)
+- DSP_PROFILING builds time the call against the buffer's real time and lap the stages (see DSPProfiler.h)
+
+\param processBufferInfo structure of information about *buffer* processing
 
-	}
+\return true if operation succeeds, false otherwise
+*/
+bool PluginCore::processAudioBuffers(ProcessBufferInfo& processBufferInfo)
+{
+	DSP_PROFILER_BEGIN(dspProfiler, processBufferInfo.numFramesToProcess);
 
-	if (LowSolo == false && LowMidSolo == false && HighMidSolo == false && TrebleSolo == true) {
+	// --- flush to zero for everything below; the host's mode is restored on return
+	DenormalGuard denormalGuard;
 
-		LowOn = 0;
-		LowMidOn = 0;
-		HighMidOn = 0;
-		TrebleOn = 1;
+	// --- can only be enabled in VST3 hosts
+	apiSpecificInfo.enableVST3SampleAccurateAutomation = processBufferInfo.hostInfo->enableVSTSampleAccurateAutomation;
 
+	// --- normally done in reset(). If the host changed the I/O without a reset, the kernels are reselected when
+	//     the states for it exist; otherwise the input passes through, in time, until the reset that allocates them
+	const ChannelIOConfig& channelIOConfig = processBufferInfo.channelIOConfig;
+	if (channelIOConfig.inputChannelFormat != kernelIOConfig.inputChannelFormat ||
+		channelIOConfig.outputChannelFormat != kernelIOConfig.outputChannelFormat)
+	{
+		if (!hasChannelStates(channelIOConfig))
+		{
+			bool processed = processBypassedAudioBuffers(processBufferInfo);
+			DSP_PROFILER_END(dspProfiler, processBufferInfo.numFramesToProcess, audioProcDescriptor.sampleRate);
+			return processed;
+		}
+		createChannelStates(channelIOConfig, false);
+		selectKernels(channelIOConfig);
 	}
 
-	if (LowSolo == true && LowMidSolo == true && HighMidSolo == false && TrebleSolo == false) {
-
-		LowOn = 1;
-		LowMidOn = 1;
-		HighMidOn = 0;
-		TrebleOn = 0;
-
+	// --- out of the soft bypass: the band states still hold the audio from before it
+	if (bypassed)
+	{
+		bypassed = false;
+		clearBandStates();
+		silentFrames = 0;
 	}
 
-	if (LowSolo == true && LowMidSolo == false && HighMidSolo == true && TrebleSolo == false) {
+	if (useFrameProcessing || needsPerFrameParameterUpdates() || getPluginType() == kSynthPlugin)
+	{
+		// --- the frame path always processes; the block path starts counting silence again afterwards
+		silent = false;
+		silentFrames = 0;
+		bool processed = PluginBase::processAudioBuffers(processBufferInfo);
+		DSP_PROFILER_END(dspProfiler, processBufferInfo.numFramesToProcess, audioProcDescriptor.sampleRate);
+		return processed;
+	}
 
-		LowOn = 1;
-		LowMidOn = 0;
-		HighMidOn = 1;
-		TrebleOn = 0;
+	// --- sync internal bound variables
+	preProcessAudioBuffers(processBufferInfo);
+	DSP_PROFILER_LAP(dspProfiler, kParameterStage);
 
-	}
+	// --- MIDI is rare for this FX; without events the chunks are never split for it
+	beginMidiEvents(processBufferInfo.midiEventQueue);
 
-	if (LowSolo == true && LowMidSolo == false && HighMidSolo == false && TrebleSolo == true) {
+	bool sampleAccurate = wantsVST3SampleAccurateAutomation();
+	bool softwareFlush = !DenormalGuard::hasHardwareFlush();
 
-		LowOn = 1;
-		LowMidOn = 0;
-		HighMidOn = 0;
-		TrebleOn = 1;
+	uint32_t numInputs = processBufferInfo.numAudioInChannels;
+	uint64_t inputMask = numInputs >= 64 ? ~0ull : (1ull << numInputs) - 1;
+	hostInputSilent = numInputs > 0 && (processBufferInfo.inputSilenceFlags & inputMask) == inputMask;
+	bool outputSilent = true;
 
-	}
+	uint32_t numFrames = 0;
+	for (uint32_t offset = 0; offset < processBufferInfo.numFramesToProcess; offset += numFrames)
+	{
+		numFrames = processBufferInfo.numFramesToProcess - offset;
+		if (numFrames > kBlockFrames)
+			numFrames = kBlockFrames;
+
+		// --- MIDI: the events due now are fired first and the chunk ends before the next one
+		fireMidiEvents(offset);
+		uint32_t nextMidiEvent = getNextMidiEventOffset();
+		if (nextMidiEvent > offset && nextMidiEvent - offset < numFrames)
+			numFrames = nextMidiEvent - offset;
+		DSP_PROFILER_LAP(dspProfiler, kMidiStage);
+
+		// --- VST3 automation: the chunk ends on the next point, where the automated parameters arrive
+		if (sampleAccurate)
+		{
+			numFrames = getSampleAccurateSubBlockFrames(offset, numFrames);
+			doSampleAccurateSubBlockUpdates(offset + numFrames - 1);
+		}
 
-	if (LowSolo == false && LowMidSolo == true && HighMidSolo == true && TrebleSolo == false) {
+		// --- advance the moving smoothers to the end of the chunk, then cook whatever changed
+		doBlockParameterSmoothing(numFrames);
+		cookParameters(true);
+		DSP_PROFILER_LAP(dspProfiler, kParameterStage);
 
-		LowOn = 0;
-		LowMidOn = 1;
-		HighMidOn = 1;
-		TrebleOn = 0;
+		// --- the kernel for the channel I/O and sample size, see selectKernels()
+		bool skipped = false;
+		if (processBufferInfo.outputs64)
+		{
+			if (blockKernel64)
+				skipped = (this->*blockKernel64)(processBufferInfo.inputs64, processBufferInfo.outputs64, offset, numFrames);
+		}
+		else if (blockKernel)
+			skipped = (this->*blockKernel)(processBufferInfo.inputs, processBufferInfo.outputs, offset, numFrames);
+		outputSilent = outputSilent && skipped;
+		DSP_PROFILER_LAP(dspProfiler, kMixStage);
 
+		// --- no FTZ on this CPU: the recursive crossover states are the ones that decay into denormals
+		if (softwareFlush)
+		{
+			if (monoCrossover)
+				monoCrossover->flushDenormals();
+			for (LinkwitzRileyStereoCrossover* crossover : stereoCrossovers)
+				crossover->flushDenormals();
+			DSP_PROFILER_LAP(dspProfiler, kCrossoverStage);
+		}
 	}
 
-	if (LowSolo == false && LowMidSolo == true && HighMidSolo == false && TrebleSolo == true) {
+	// --- events timed at or past the end of the buffer are fired after its last chunk
+	endMidiEvents();
+	DSP_PROFILER_LAP(dspProfiler, kMidiStage);
 
-		LowOn = 0;
-		LowMidOn = 1;
-		HighMidOn = 0;
-		TrebleOn = 1;
+	uint32_t numOutputs = processBufferInfo.numAudioOutChannels;
+	processBufferInfo.outputSilenceFlags = outputSilent ? (numOutputs >= 64 ? ~0ull : (1ull << numOutputs) - 1) : 0;
 
-	}
+	// --- keep the host timeline in step with the frame path
+	processBufferInfo.hostInfo->uAbsoluteFrameBufferIndex += processBufferInfo.numFramesToProcess;
+	processBufferInfo.hostInfo->dAbsoluteFrameBufferTime += processBufferInfo.numFramesToProcess / audioProcDescriptor.sampleRate;
 
-	if (LowSolo == false && LowMidSolo == false && HighMidSolo == true && TrebleSolo == true) {
+	// --- generally not used
+	postProcessAudioBuffers(processBufferInfo);
+	DSP_PROFILER_LAP(dspProfiler, kParameterStage);
+	DSP_PROFILER_END(dspProfiler, processBufferInfo.numFramesToProcess, audioProcDescriptor.sampleRate);
 
-		LowOn = 0;
-		LowMidOn = 0;
-		HighMidOn = 1;
-		TrebleOn = 1;
+	return (processBufferInfo.outputs64 ? blockKernel64 != nullptr : blockKernel != nullptr);
+}
 
-	}
+/**
+\brief the soft bypass of the API wrappers (VST3 Bypass, AU kAudioUnitProperty_BypassEffect, AAX Master Bypass)
 
-	if (LowSolo == true && LowMidSolo == true && HighMidSolo == true && TrebleSolo == false) {
+Operation:
+- each input is delayed by the latency the host is told (bypassDelay, like the LFE), so the bypassed track stays
+  in time with the processed one and with the other tracks; the delays start empty on entering the bypass
+- channels without a state (the host changed the I/O without a reset) are copied, as the base class does
+- nothing is processed or metered; leaving the bypass clears the band states (see processAudioBuffers)
 
-		LowOn = 1;
-		LowMidOn = 1;
-		HighMidOn = 1;
-		TrebleOn = 0;
+\param processBufferInfo the buffer the wrapper would otherwise have sent to processAudioBuffers
 
+\return true if operation succeeds, false otherwise
+*/
+bool PluginCore::processBypassedAudioBuffers(ProcessBufferInfo& processBufferInfo)
+{
+	if (!bypassed)
+	{
+		bypassed = true;
+		for (uint32_t channel = 0; channel < numChannelStates; channel++)
+			channelStates[channel].bypassDelay.clear();
 	}
 
-	if (LowSolo == true && LowMidSolo == true && HighMidSolo == false && TrebleSolo == true) {
-
-		LowOn = 1;
-		LowMidOn = 1;
-		HighMidOn = 0;
-		TrebleOn = 1;
+	uint32_t latency = crossoverLatency + oversamplingLatency;
+	uint32_t numFrames = processBufferInfo.numFramesToProcess;
+	uint32_t numChannels = processBufferInfo.numAudioInChannels < processBufferInfo.numAudioOutChannels ?
+		processBufferInfo.numAudioInChannels : processBufferInfo.numAudioOutChannels;
+	for (uint32_t channel = 0; channel < numChannels; channel++)
+	{
+		if (channel >= numChannelStates || latency == 0)
+		{
+			if (processBufferInfo.outputs64)
+				memmove(processBufferInfo.outputs64[channel], processBufferInfo.inputs64[channel], numFrames * sizeof(double));
+			else
+				memmove(processBufferInfo.outputs[channel], processBufferInfo.inputs[channel], numFrames * sizeof(float));
+			continue;
+		}
 
+		SampleDelay& bypassDelay = channelStates[channel].bypassDelay;
+		if (processBufferInfo.outputs64)
+			bypassDelay.process(processBufferInfo.inputs64[channel], processBufferInfo.outputs64[channel], numFrames);
+		else
+		{
+			const float* input = processBufferInfo.inputs[channel];
+			float* output = processBufferInfo.outputs[channel];
+			for (uint32_t frame = 0; frame < numFrames; frame++)
+				output[frame] = (float)bypassDelay.processSample(input[frame]);
+		}
 	}
 
-	if (LowSolo == true && LowMidSolo == false && HighMidSolo == true && TrebleSolo == true) {
+	// --- a delayed silence is only known once the latency has passed; report none
+	processBufferInfo.outputSilenceFlags = latency == 0 ? processBufferInfo.inputSilenceFlags : 0;
+	return true;
+}
 
-	LowOn = 1;
-	LowMidOn = 0;
-	HighMidOn = 1;
-	TrebleOn = 1;
+/**
+\brief check whether any parameter must be updated per frame (VST3 sample accurate automation)
 
-	}
+\return true if the frame path is required
+*/
+bool PluginCore::needsPerFrameParameterUpdates()
+{
+	return wantsVST3SampleAccurateAutomation() && !wantsVST3SampleAccurateSubBlocks();
+}
 
-	if (LowSolo == false && LowMidSolo == true && HighMidSolo == true && TrebleSolo == true) {
+/**
+\brief saturate, mix, sum and scale the split bands of one channel
 
-	LowOn = 1;
-	LowMidOn = 0;
-	HighMidOn = 1;
-	TrebleOn = 1;
+\param channel index into channelStates
+\param output channel output buffer
+\param numFrames frames to process, <= kBlockFrames
+*/
+template <typename SampleType>
+void PluginCore::processBandBlock(uint32_t channel, SampleType* output, uint32_t numFrames)
+{
+	uint32_t group = channelGroup[channel];
 
+	// --- muted (or not soloed) bands are skipped from here on; the crossover already advanced their filters
+	uint32_t activeBands[kNumBands];
+	uint32_t numActiveBands = 0;
+	for (uint32_t band = 0; band < kNumBands; band++)
+	{
+		if (cooked.activeBands & (1u << band))
+			activeBands[numActiveBands++] = band;
 	}
 
-	if (LowSolo == true && LowMidSolo == true && HighMidSolo == true && TrebleSolo == true) {
-
-	LowOn = 1;
-	LowMidOn = 1;
-	HighMidOn = 1;
-	TrebleOn = 1;
+	// --- saturation: add harmonic excitation to each band
+	for (uint32_t k = 0; k < numActiveBands; k++)
+		saturateBandBlock(channel, activeBands[k], numFrames);
+	DSP_PROFILER_LAP(dspProfiler, kSaturationStage);
 
+	// --- mix: blend dry signals with distorted signal; a smoothed change ramps to the cooked value by the last frame
+	for (uint32_t k = 0; k < numActiveBands; k++)
+	{
+		uint32_t band = activeBands[k];
+		const double* dry = channelStates[channel].bandDry[band];
+		double* wet = bandWet[band];
+		double mix = cooked.mix[group][band];
+		double mixStart = mixRampStart[group][band];
+		if (mixStart == mix)
+		{
+			double dryGain = 1.0f - mix;
+			for (uint32_t i = 0; i < numFrames; i++)
+				wet[i] = dry[i] * dryGain + wet[i] * mix;
+		}
+		else
+		{
+			double mixStep = (mix - mixStart) / numFrames;
+			for (uint32_t i = 0; i < numFrames; i++)
+			{
+				double mixRamp = mixStart + mixStep * (i + 1);
+				wet[i] = dry[i] * (1.0f - mixRamp) + wet[i] * mixRamp;
+			}
+		}
 	}
 
-	else {
+	// --- meters: a muted band's output counts as zeros, its input is still measured
+	for (uint32_t band = 0; band < kNumBands; band++)
+	{
+		if (cooked.activeBands & (1u << band))
+		{
+			levelMeter.measureBand(channelStates[channel].bandDry[band], bandWet[band], numFrames,
+				meterLevels.in[band], meterLevels.out[band], meterLevels.harmonics[band]);
+		}
+		else
+		{
+			levelMeter.measure(channelStates[channel].bandDry[band], numFrames, meterLevels.in[band]);
+			meterLevels.out[band].addSilence(numFrames);
+			meterLevels.harmonics[band].addSilence(numFrames);
+		}
+	}
 
-		LowOn = LowOn;
-		LowMidOn = LowMidOn;
-		HighMidOn = HighMidOn;
-		TrebleOn = TrebleOn;
+	// --- sum: the active bands, in band order like the frame path
+	if (numActiveBands == 0)
+		memset(bandSum, 0, numFrames * sizeof(double));
+	else
+		memcpy(bandSum, bandWet[activeBands[0]], numFrames * sizeof(double));
 
+	for (uint32_t k = 1; k < numActiveBands; k++)
+	{
+		const double* wet = bandWet[activeBands[k]];
+		for (uint32_t i = 0; i < numFrames; i++)
+			bandSum[i] += wet[i];
 	}
 
+	applyMasterVolume(output, numFrames);
+	DSP_PROFILER_LAP(dspProfiler, kMixStage);
 }
 
 /**
-\brief frame-processing method
+\brief the LFE is not excited: it is delayed with the bands (Oversampling ON) and scaled by the master volume
 
-Operation:
-- decode the plugin type - for synth plugins, fill in the rendering code; for FX plugins, delete the if(synth) portion and add your processing code
-- note that MIDI events are fired for each sample interval so that MIDI is tightly sunk with audio
-- doSampleAccurateParameterUpdates will perform per-sample interval smoothing
+\param channel index into channelStates
+\param input channel input buffer
+\param output channel output buffer
+\param numFrames frames to process, <= kBlockFrames
+*/
+template <typename SampleType>
+void PluginCore::processLFEBlock(uint32_t channel, const SampleType* input, SampleType* output, uint32_t numFrames)
+{
+	for (uint32_t i = 0; i < numFrames; i++)
+		bandSum[i] = input[i];
+	channelStates[channel].lfeDelay.process(bandSum, bandSum, numFrames);
 
-\param processFrameInfo structure of information about *frame* processing
+	applyMasterVolume(output, numFrames);
+	DSP_PROFILER_LAP(dspProfiler, kMixStage);
+}
 
-\return true if operation succeeds, false otherwise
+/**
+\brief bandSum times the master volume into the output; a smoothed change ramps to the cooked value by the
+       last frame. The output meters measure it on the way
+
+\param output channel output buffer
+\param numFrames frames to process, <= kBlockFrames
 */
-bool PluginCore::processAudioFrame(ProcessFrameInfo& processFrameInfo)
+template <typename SampleType>
+void PluginCore::applyMasterVolume(SampleType* output, uint32_t numFrames)
 {
-    // --- fire any MIDI events for this sample interval
-    processFrameInfo.midiEventQueue->fireMidiEvents(processFrameInfo.currentFrame);
+	double masterVolume = cooked.masterVolume;
+	if (masterVolumeRampStart == masterVolume)
+	{
+		for (uint32_t i = 0; i < numFrames; i++)
+			bandSum[i] *= masterVolume;
+	}
+	else
+	{
+		double masterVolumeStep = (masterVolume - masterVolumeRampStart) / numFrames;
+		for (uint32_t i = 0; i < numFrames; i++)
+			bandSum[i] *= masterVolumeRampStart + masterVolumeStep * (i + 1);
+	}
 
-	// --- do per-frame updates; VST automation and parameter smoothing
-	doSampleAccurateParameterUpdates();
+	levelMeter.measure(bandSum, numFrames, meterLevels.output);
+	for (uint32_t i = 0; i < numFrames; i++)
+		output[i] = (SampleType)bandSum[i];
+}
 
-	updateParameters();
-	setBandStates();
 
-	
+/**
+\brief waveshape one band of one channel into bandWet; with Oversampling ON the channel's dry band is delayed
+       in place to line up with it. A smoothed Sat change ramps the drive to the cooked one across the block
 
-    // --- decode the channelIOConfiguration and process accordingly
-    //
-	// --- Synth Plugin:
-	// --- Synth Plugin --- remove for FX plugins
-	if (getPluginType() == kSynthPlugin)
+\param channel index into channelStates
+\param band the band to process
+\param numFrames frames to process, <= kBlockFrames
+*/
+void PluginCore::saturateBandBlock(uint32_t channel, uint32_t band, uint32_t numFrames)
+{
+	ChannelState& state = channelStates[channel];
+	double* dry = state.bandDry[band];
+	double* wet = bandWet[band];
+	double drive = cooked.drive[channelGroup[channel]][band];
+	if (oversamplingLatency == 0)
 	{
-		// --- output silence: change this with your signal render code
-		processFrameInfo.audioOutputFrame[0] = 0.0;
-		if (processFrameInfo.channelIOConfig.outputChannelFormat == kCFStereo)
-			processFrameInfo.audioOutputFrame[1] = 0.0;
-
-		return true;	/// processed
-	}
-
-    // --- FX Plugin:
-    if(processFrameInfo.channelIOConfig.inputChannelFormat == kCFMono &&
-       processFrameInfo.channelIOConfig.outputChannelFormat == kCFMono)
-    {
-		// --- pass through code: change this with your signal processing
-		double channelData = processFrameInfo.audioInputFrame[0];
-		
-		// duplicate signal 4 times for each band
-		double LFB = channelData;
-		double LMFB = channelData;
-		double HMFB = channelData;
-		double TFB = channelData;
-
-		//filter each band
-		LFB = LFLP_L.process(LFB);
-		LMFB = LFHP_L.process(LMFB);
-		LMFB = MFLP_L.process(LMFB);
-		HMFB = MFHP_L.process(HMFB);
-		HMFB = HFLP_L.process(HMFB);
-		TFB = HFHP_L.process(TFB);
-
-		//phase invert each adjacent band
-		LMFB = -1 * LMFB;
-		TFB = -1 * TFB; 
-
-		//take dry signal of each band
-		double LFBdry = LFB;
-		double LMFBdry = LMFB;
-		double HMFBdry = HMFB;
-		double TFBdry = TFB;
-
-		//add harmonic excitation to each band
-		LFB = tanh(LowSatRaw * LFB) / tanh(LowSatRaw);
-		LMFB = tanh(LowMidSatRaw * LMFB) / tanh(LowMidSatRaw);
-		HMFB = tanh(HighMidSatRaw * HMFB) / tanh(HighMidSatRaw);
-		TFB = tanh(TrebleSatRaw * TFB) / tanh(TrebleSatRaw);
-
-		//blend dry signals with distorted signal
-		LFB = LFBdry * (1.0f - LowMixRaw) + LFB * LowMixRaw;
-		LMFB = LMFBdry * (1.0f - LowMidMixRaw) + LMFB * LowMidMixRaw;
-		HMFB = HMFBdry * (1.0f - HighMidMixRaw) + HMFB * HighMidMixRaw;
-		TFB = TFBdry * (1.0f - TrebleMixRaw) + TFB * TrebleMixRaw;
+		state.waveshaper[band].processBlock(dry, wet, numFrames, drive);
+		return;
+	}
 
-		//sum all bands and apply bypass on each band
-		channelData = (LFB * LowOn) + (LMFB * LowMidOn) + (HMFB * HighMidOn) + (TFB * TrebleOn);
+	// --- only the nonlinear stage runs at the higher rate
+	Oversampler& bandOversampler = state.oversampler[band];
+	uint32_t factor = bandOversampler.getFactor();
+	if (factor > 1)
+	{
+		bandOversampler.upsample(dry, bandOversampled, numFrames);
+		state.waveshaper[band].processBlock(bandOversampled, bandOversampled, numFrames * factor, drive);
+		bandOversampler.downsample(bandOversampled, wet, numFrames);
+		state.wetDelay[band].process(wet, wet, numFrames);
+		state.dryDelay[band].process(dry, dry, numFrames);
+	}
+	else
+	{
+		state.dryDelay[band].process(dry, dry, numFrames);
+		state.waveshaper[band].processBlock(dry, wet, numFrames, drive);
+	}
+}
 
-		//set master volume
-		channelData = channelData * MasterVolumeCooked;
-
-		processFrameInfo.audioOutputFrame[0] = channelData;
-
-        return true; /// processed
-    }
-
-    // --- Mono-In/Stereo-Out
-    else if(processFrameInfo.channelIOConfig.inputChannelFormat == kCFMono &&
-       processFrameInfo.channelIOConfig.outputChannelFormat == kCFStereo)
-    {
-		// --- pass through code: change this with your signal processing
-		double channelData_L = processFrameInfo.audioInputFrame[0];
-		double channelData_R = processFrameInfo.audioInputFrame[0];
-
-		double LFB_L = channelData_L;
-		double LMFB_L = channelData_L;
-		double HMFB_L = channelData_L;
-		double TFB_L = channelData_L;
-
-		double LFB_R = channelData_R;
-		double LMFB_R = channelData_R;
-		double HMFB_R = channelData_R;
-		double TFB_R = channelData_R;
-
-		LFB_L = LFLP_L.process(LFB_L);
-		LFB_R = LFLP_R.process(LFB_R);
-		LMFB_L = LFHP_L.process(LMFB_L);
-		LMFB_L = MFLP_L.process(LMFB_L);
-		LMFB_R = LFHP_R.process(LMFB_R);
-		LMFB_R = MFLP_R.process(LMFB_R);
-		HMFB_L = MFHP_L.process(HMFB_L);
-		HMFB_L = HFLP_L.process(HMFB_L);
-		HMFB_R = MFHP_R.process(HMFB_R);
-		HMFB_R = HFLP_R.process(HMFB_R);
-		TFB_L = HFHP_L.process(TFB_L);
-		TFB_R = HFHP_R.process(TFB_R);
-
-		LMFB_L = -1 * LMFB_L;
-		LMFB_R = -1 * LMFB_R;
-		TFB_L = -1 * TFB_L;
-		TFB_R = -1 * TFB_R;
-
-		double LFBdryl = LFB_L;
-		double LMFBdryl = LMFB_L;
-		double HMFBdryl = HMFB_L;
-		double TFBdryl = TFB_L;
-
-		double LFBdryr = LFB_R;
-		double LMFBdryr = LMFB_R;
-		double HMFBdryr = HMFB_R;
-		double TFBdryr = TFB_R;
-
-		LFB_L = tanh(LowSatRaw * LFB_L) / tanh(LowSatRaw);
-		LMFB_L = tanh(LowMidSatRaw * LMFB_L) / tanh(LowMidSatRaw);
-		HMFB_L = tanh(HighMidSatRaw * HMFB_L) / tanh(HighMidSatRaw);
-		TFB_L = tanh(TrebleSatRaw * TFB_L) / tanh(TrebleSatRaw);
-
-		LFB_R = tanh(LowSatRaw * LFB_R) / tanh(LowSatRaw);
-		LMFB_R = tanh(LowMidSatRaw * LMFB_R) / tanh(LowMidSatRaw);
-		HMFB_R = tanh(HighMidSatRaw * HMFB_R) / tanh(HighMidSatRaw);
-		TFB_R = tanh(TrebleSatRaw * TFB_R) / tanh(TrebleSatRaw);
-
-		LFB_L = LFBdryl * (1.0f - LowMixRaw) + LFB_L * LowMixRaw;
-		LMFB_L = LMFBdryl * (1.0f - LowMidMixRaw) + LMFB_L * LowMidMixRaw;
-		HMFB_L = HMFBdryl * (1.0f - HighMidMixRaw) + HMFB_L * HighMidMixRaw;
-		TFB_L = TFBdryl * (1.0f - TrebleMixRaw) + TFB_L * TrebleMixRaw;
-
-		LFB_R = LFBdryr * (1.0f - LowMixRaw) + LFB_R * LowMixRaw;
-		LMFB_R = LMFBdryr * (1.0f - LowMidMixRaw) + LMFB_R * LowMidMixRaw;
-		HMFB_R = HMFBdryr * (1.0f - HighMidMixRaw) + HMFB_R * HighMidMixRaw;
-		TFB_R = TFBdryr * (1.0f - TrebleMixRaw) + TFB_R * TrebleMixRaw;
-
-		channelData_L = (LFB_L * LowOn) + (LMFB_L * LowMidOn) + (HMFB_L * HighMidOn) + (TFB_L * TrebleOn);
-		channelData_R = (LFB_R * LowOn) + (LMFB_R * LowMidOn) + (HMFB_R * HighMidOn) + (TFB_R * TrebleOn);
-
-		channelData_L = channelData_L * MasterVolumeCooked;
-		channelData_R = channelData_R * MasterVolumeCooked;
-
-		processFrameInfo.audioOutputFrame[0] = channelData_L;
-		processFrameInfo.audioOutputFrame[1] = channelData_R;
-        return true; /// processed
-    }
-
-    // --- Stereo-In/Stereo-Out
-    else if(processFrameInfo.channelIOConfig.inputChannelFormat == kCFStereo &&
-       processFrameInfo.channelIOConfig.outputChannelFormat == kCFStereo)
-    {
-		// --- pass through code: change this with your signal processing
-		double channelData_L = processFrameInfo.audioInputFrame[0];
-		double channelData_R = processFrameInfo.audioInputFrame[1];
-
-		double LFB_L = channelData_L;
-		double LMFB_L = channelData_L;
-		double HMFB_L = channelData_L;
-		double TFB_L = channelData_L;
-
-		double LFB_R = channelData_R;
-		double LMFB_R = channelData_R;
-		double HMFB_R = channelData_R;
-		double TFB_R = channelData_R;
-
-		LFB_L = LFLP_L.process(LFB_L);
-		LFB_R = LFLP_R.process(LFB_R);
-		LMFB_L = LFHP_L.process(LMFB_L);
-		LMFB_L = MFLP_L.process(LMFB_L);
-		LMFB_R = LFHP_R.process(LMFB_R);
-		LMFB_R = MFLP_R.process(LMFB_R);
-		HMFB_L = MFHP_L.process(HMFB_L);
-		HMFB_L = HFLP_L.process(HMFB_L);
-		HMFB_R = MFHP_R.process(HMFB_R);
-		HMFB_R = HFLP_R.process(HMFB_R);
-		TFB_L = HFHP_L.process(TFB_L);
-		TFB_R = HFHP_R.process(TFB_R);
-
-		LMFB_L = -1 * LMFB_L;
-		LMFB_R = -1 * LMFB_R;
-		TFB_L = -1 * TFB_L;
-		TFB_R = -1 * TFB_R;
-
-		double LFBdryl = LFB_L;
-		double LMFBdryl = LMFB_L;
-		double HMFBdryl = HMFB_L;
-		double TFBdryl = TFB_L;
-
-		double LFBdryr = LFB_R;
-		double LMFBdryr = LMFB_R;
-		double HMFBdryr = HMFB_R;
-		double TFBdryr = TFB_R;
-
-		LFB_L = tanh(LowSatRaw * LFB_L) / tanh(LowSatRaw);
-		LMFB_L = tanh(LowMidSatRaw * LMFB_L) / tanh(LowMidSatRaw);
-		HMFB_L = tanh(HighMidSatRaw * HMFB_L) / tanh(HighMidSatRaw);
-		TFB_L = tanh(TrebleSatRaw * TFB_L) / tanh(TrebleSatRaw);
-
-		LFB_R = tanh(LowSatRaw * LFB_R) / tanh(LowSatRaw);
-		LMFB_R = tanh(LowMidSatRaw * LMFB_R) / tanh(LowMidSatRaw);
-		HMFB_R = tanh(HighMidSatRaw * HMFB_R) / tanh(HighMidSatRaw);
-		TFB_R = tanh(TrebleSatRaw * TFB_R) / tanh(TrebleSatRaw);
-
-		LFB_L = LFBdryl * (1.0f - LowMixRaw) + LFB_L * LowMixRaw;
-		LMFB_L = LMFBdryl * (1.0f - LowMidMixRaw) + LMFB_L * LowMidMixRaw;
-		HMFB_L = HMFBdryl * (1.0f - HighMidMixRaw) + HMFB_L * HighMidMixRaw;
-		TFB_L = TFBdryl * (1.0f - TrebleMixRaw) + TFB_L * TrebleMixRaw;
-
-		LFB_R = LFBdryr * (1.0f - LowMixRaw) + LFB_R * LowMixRaw;
-		LMFB_R = LMFBdryr * (1.0f - LowMidMixRaw) + LMFB_R * LowMidMixRaw;
-		HMFB_R = HMFBdryr * (1.0f - HighMidMixRaw) + HMFB_R * HighMidMixRaw;
-		TFB_R = TFBdryr * (1.0f - TrebleMixRaw) + TFB_R * TrebleMixRaw;
-
-
-		channelData_L = (LFB_L * LowOn) + (LMFB_L * LowMidOn) + (HMFB_L * HighMidOn) + (TFB_L * TrebleOn);
-		channelData_R = (LFB_R * LowOn) + (LMFB_R * LowMidOn) + (HMFB_R * HighMidOn) + (TFB_R * TrebleOn);
-
-		channelData_L = channelData_L * MasterVolumeCooked;
-		channelData_R = channelData_R * MasterVolumeCooked;
-
-		processFrameInfo.audioOutputFrame[0] = channelData_L;
-		processFrameInfo.audioOutputFrame[1] = channelData_R;
-
-        return true; /// processed
-    }
+/**
+\brief waveshape one band sample for the frame path; the same chain as saturateBandBlock
 
-    return false; /// NOT processed
-}
+\param channel index into channelStates
+\param band the band to process
+\param dry the band sample; delayed in place with Oversampling ON
 
+\return the saturated sample
+*/
+double PluginCore::saturateBandSample(uint32_t channel, uint32_t band, double& dry)
+{
+	if (oversamplingLatency == 0)
+		return channelStates[channel].waveshaper[band].processSample(dry);
+
+	ChannelState& state = channelStates[channel];
+	Oversampler& bandOversampler = state.oversampler[band];
+	uint32_t factor = bandOversampler.getFactor();
+	double wet;
+	if (factor > 1)
+	{
+		double oversampled[Oversampler::kMaxFactor];
+		bandOversampler.upsample(&dry, oversampled, 1);
+		for (uint32_t i = 0; i < factor; i++)
+			oversampled[i] = state.waveshaper[band].processSample(oversampled[i]);
+		bandOversampler.downsample(oversampled, &wet, 1);
+		wet = state.wetDelay[band].processSample(wet);
+		dry = state.dryDelay[band].processSample(dry);
+	}
+	else
+	{
+		dry = state.dryDelay[band].processSample(dry);
+		wet = state.waveshaper[band].processSample(dry);
+	}
+	return wet;
+}
 
 /**
 \brief do anything needed prior to arrival of audio buffers
 
 Operation:
+- publishMeters sets the meter variables from the buffer's levels and raises the values the GUI timer takes
 - updateOutBoundVariables sends metering data to the GUI meters
 
 \param processInfo structure of information about *buffer* processing
@@ -661,6 +1731,12 @@ Operation:
 */
 bool PluginCore::postProcessAudioBuffers(ProcessBufferInfo& processInfo)
 {
+	publishMeters();
+#if DSP_PROFILING
+	double dspLoad = dspProfiler.getMeanLoad() / 100.0;
+	DSPLoad = dspLoad < 1.0 ? (float)dspLoad : 1.0f;
+#endif
+
 	// --- update outbound variables; currently this is meter data only, but could be extended
 	//     in the future
 	updateOutBoundVariables();
@@ -668,6 +1744,63 @@ bool PluginCore::postProcessAudioBuffers(ProcessBufferInfo& processInfo)
     return true;
 }
 
+/**
+\brief the levels of the buffer just processed into the bound meter variables, linear and clamped to 1.0 like
+       the meter parameters take them, and into meterValues where they are higher; then start over for the next
+*/
+void PluginCore::publishMeters()
+{
+	static_assert(ControlID::OutputPeak - ControlID::LowInPeak == kNumBands * kNumBandMeters,
+		"the band meters are kNumBandMeters IDs per band from LowInPeak, the output ones after them");
+
+	static float PluginCore::* const meterVariables[kNumMeters] = {
+		&PluginCore::LowInPeak, &PluginCore::LowInRMS, &PluginCore::LowOutPeak, &PluginCore::LowOutRMS, &PluginCore::LowHarmonics,
+		&PluginCore::LowMidInPeak, &PluginCore::LowMidInRMS, &PluginCore::LowMidOutPeak, &PluginCore::LowMidOutRMS, &PluginCore::LowMidHarmonics,
+		&PluginCore::HighMidInPeak, &PluginCore::HighMidInRMS, &PluginCore::HighMidOutPeak, &PluginCore::HighMidOutRMS, &PluginCore::HighMidHarmonics,
+		&PluginCore::TrebleInPeak, &PluginCore::TrebleInRMS, &PluginCore::TrebleOutPeak, &PluginCore::TrebleOutRMS, &PluginCore::TrebleHarmonics,
+		&PluginCore::OutputPeak, &PluginCore::OutputRMS };
+
+	double levels[kNumMeters];
+	for (uint32_t band = 0; band < kNumBands; band++)
+	{
+		double* bandLevels = &levels[band * kNumBandMeters];
+		bandLevels[kInPeakMeter] = meterLevels.in[band].getPeak();
+		bandLevels[kInRMSMeter] = meterLevels.in[band].getRMS();
+		bandLevels[kOutPeakMeter] = meterLevels.out[band].getPeak();
+		bandLevels[kOutRMSMeter] = meterLevels.out[band].getRMS();
+		bandLevels[kHarmonicsMeter] = meterLevels.harmonics[band].getRMS();
+	}
+	levels[kNumBands * kNumBandMeters] = meterLevels.output.getPeak();
+	levels[kNumBands * kNumBandMeters + 1] = meterLevels.output.getRMS();
+
+	for (uint32_t meter = 0; meter < kNumMeters; meter++)
+	{
+		float value = levels[meter] < 1.0 ? (float)levels[meter] : 1.0f;
+		this->*meterVariables[meter] = value;
+
+		// --- the GUI timer resets it to 0 when it takes it; a buffer it misses still shows if it was the loudest
+		float held = meterValues[meter].load(std::memory_order_relaxed);
+		while (value > held && !meterValues[meter].compare_exchange_weak(held, value, std::memory_order_relaxed))
+			;
+	}
+
+	resetMeters();
+}
+
+/**
+\brief clear the level measurements
+*/
+void PluginCore::resetMeters()
+{
+	for (uint32_t band = 0; band < kNumBands; band++)
+	{
+		meterLevels.in[band].reset();
+		meterLevels.out[band].reset();
+		meterLevels.harmonics[band].reset();
+	}
+	meterLevels.output.reset();
+}
+
 /**
 \brief update the PluginParameter's value based on GUI control, preset, or data smoothing (thread-safe)
 
@@ -734,18 +1867,23 @@ bool PluginCore::postUpdatePluginParameter(int32_t controlID, double controlValu
     // --- now do any post update cooking; be careful with VST Sample Accurate automation
     //     If enabled, then make sure the cooking functions are short and efficient otherwise disable it
     //     for the Parameter involved
-    /*switch(controlID)
-    {
-        case 0:
-        {
-            return true;    /// handled
-        }
+    //
+    // --- the cooking itself is deferred to cookParameters() on the audio thread; syncInBoundVariables() reports
+    //     every bound parameter each buffer, so only flag the controls whose value actually changed
+	if (!paramInfo.boundVariableUpdate || controlID < 0 || controlID >= kNumCookedControls)
+		return false;
 
-        default:
-            return false;   /// not handled
-    }*/
+	if (controlValue != cookedControlValue[controlID])
+	{
+		cookedControlValue[controlID] = controlValue;
+		dirtyControls |= 1ull << controlID;
+
+		// --- smoothed values and VST3 sub-block automation are continuous, the block path ramps to them
+		if (paramInfo.isSmoothing || paramInfo.isVSTSampleAccurateUpdate)
+			smoothedControls |= 1ull << controlID;
+	}
 
-    return false;
+	return true;    /// handled
 }
 
 /**
@@ -808,22 +1946,68 @@ bool PluginCore::processMessage(MessageInfo& messageInfo)
 	// --- NULL pointers so that we don't accidentally use them
 	case PLUGINGUI_WILLCLOSE:
 	{
+		for (uint32_t meter = 0; meter < kNumMeters; meter++)
+			meterViews[meter] = nullptr;
 		return false;
 	}
 
 	// --- update view; this will only be called if the GUI is actually open
 	case PLUGINGUI_TIMERPING:
 	{
+		// --- the meter views take the highest levels since the last ping; this is the GUI thread, so they are set directly
+		for (uint32_t meter = 0; meter < kNumMeters; meter++)
+		{
+			if (!meterViews[meter])
+				continue;
+
+			meterViews[meter]->pushDataValue(meterValues[meter].exchange(0.f, std::memory_order_relaxed));
+			meterViews[meter]->updateView();
+		}
 		return false;
 	}
 
 	// --- register the custom view, grab the ICustomView interface
 	case PLUGINGUI_REGISTER_CUSTOMVIEW:
 	{
-
+		// --- meter views are registered under their meter parameter's name
+		for (uint32_t meter = 0; meter < kNumMeters; meter++)
+		{
+			PluginParameter* piParam = getPluginParameterByControlID(ControlID::LowInPeak + meter);
+			if (piParam && messageInfo.inMessageString == piParam->getControlName())
+			{
+				meterViews[meter] = (ICustomView*)messageInfo.inMessageData;
+				return true;
+			}
+		}
 		return false;
 	}
 
+	case PLUGINGUI_DE_REGISTER_CUSTOMVIEW:
+	{
+		ICustomView* view = (ICustomView*)messageInfo.inMessageData;
+		bool deRegistered = false;
+		for (uint32_t meter = 0; meter < kNumMeters; meter++)
+		{
+			if (view && meterViews[meter] == view)
+			{
+				meterViews[meter] = nullptr;
+				deRegistered = true;
+			}
+		}
+		return deRegistered;
+	}
+
+#if DSP_PROFILING
+	// --- the stage and total loads for a debug panel
+	case PLUGIN_QUERY_DSPLOAD:
+	{
+		if (!messageInfo.outMessageData)
+			return false;
+		dspProfiler.getLoadInfo(*(DSPLoadInfo*)messageInfo.outMessageData);
+		return true;
+	}
+#endif
+
 	case PLUGINGUI_REGISTER_SUBCONTROLLER:
 	case PLUGINGUI_QUERY_HASUSERCUSTOM:
 	case PLUGINGUI_USER_CUSTOMOPEN:
@@ -848,6 +2032,9 @@ bool PluginCore::processMessage(MessageInfo& messageInfo)
 
 NOTES:
 - MIDI events are 100% sample accurate; this function will be called repeatedly for every MIDI message
+- a control change mapped by getMidiControllerParameter sets that parameter from the event's frame on, on any
+  MIDI channel; VST3 hosts send no CC events and turn them into parameter changes instead (see
+  VST3Plugin::getMidiControllerAssignment)
 - see the SDK for examples of use
 
 \param event a structure containing the MIDI event data
@@ -856,9 +2043,41 @@ NOTES:
 */
 bool PluginCore::processMIDIEvent(midiEvent& event)
 {
+	const uint32_t MIDI_CONTROL_CHANGE = 0xB0;
+
+	if ((event.midiMessage & 0xF0) == MIDI_CONTROL_CHANGE)
+	{
+		int32_t controlID = getMidiControllerParameter(event.midiData1);
+		if (controlID >= 0)
+			applyControlValueNormalized(controlID, (event.midiData2 & 0x7F) / 127.0);
+	}
+
 	return true;
 }
 
+/**
+\brief the parameter a MIDI controller is mapped to
+
+NOTES:
+- CC 20-23 are the four Sat controls and CC 24-27 the four Mix controls, low band first; 20-31 are undefined
+  in the MIDI spec, so they do not fight a host's volume, pan or expression
+
+\param controller MIDI CC number, 0-127
+
+\return the control ID, or -1 when the controller is not mapped
+*/
+int32_t PluginCore::getMidiControllerParameter(uint32_t controller)
+{
+	static const int32_t kMidiControllerParameters[] = { ControlID::LowSat, ControlID::LowMidSat, ControlID::HighMidSat,
+		ControlID::TrebleSat, ControlID::LowMix, ControlID::LowMidMix, ControlID::HighMidMix, ControlID::TrebleMix };
+	const uint32_t kFirstController = 20;
+
+	if (controller < kFirstController || controller - kFirstController >= sizeof(kMidiControllerParameters) / sizeof(int32_t))
+		return -1;
+
+	return kMidiControllerParameters[controller - kFirstController];
+}
+
 /**
 \brief (for future use)
 
@@ -929,6 +2148,7 @@ bool PluginCore::initPluginDescriptors()
     apiSpecificInfo.vst3BundleID = kVST3BundleID;/* MacOS only: this MUST match the bundle identifier in your info.plist file */
 	apiSpecificInfo.enableVST3SampleAccurateAutomation = kVSTSAA;
 	apiSpecificInfo.vst3SampleAccurateGranularity = kVST3SAAGranularity;
+	apiSpecificInfo.enableVST3SampleAccurateSubBlocks = kVST3SAASubBlocks;
 
     // --- AU and AAX
     apiSpecificInfo.fourCharCode = PluginCore::getFourCharCode();
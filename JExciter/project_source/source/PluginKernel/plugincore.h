@@ -14,7 +14,15 @@
 #define __pluginCore_h__
 
 #include "pluginbase.h"
-#include "LinkwitzRiley2ndOrder.h"
+#include "LinkwitzRileyCrossover.h"
+#include "LinearPhaseCrossover.h"
+#include "TanhWaveshaper.h"
+#include "Oversampler.h"
+#include "DenormalGuard.h"
+#include "LevelMeter.h"
+#include "DSPProfiler.h"
+#include <vector>
+#include <atomic>
 
 
 // **--0x7F1F--**
@@ -36,7 +44,49 @@ enum ControlID {
 	LowMidMix = 13,
 	HighMidMix = 14,
 	TrebleMix = 15,
-	MasterVolume = 16
+	MasterVolume = 16,
+	SatQuality = 17,
+	Oversampling = 18,
+	LowOversampling = 19,
+	LowMidOversampling = 20,
+	HighMidOversampling = 21,
+	TrebleOversampling = 22,
+	SatAntialiasing = 23,
+	LowCrossover = 24,
+	MidCrossover = 25,
+	HighCrossover = 26,
+	SurroundLink = 27,
+	SurroundSat = 28,
+	SurroundMix = 29,
+	HeightLink = 30,
+	HeightSat = 31,
+	HeightMix = 32,
+	CrossoverMode = 33,
+	LowInPeak = 34,
+	LowInRMS = 35,
+	LowOutPeak = 36,
+	LowOutRMS = 37,
+	LowHarmonics = 38,
+	LowMidInPeak = 39,
+	LowMidInRMS = 40,
+	LowMidOutPeak = 41,
+	LowMidOutRMS = 42,
+	LowMidHarmonics = 43,
+	HighMidInPeak = 44,
+	HighMidInRMS = 45,
+	HighMidOutPeak = 46,
+	HighMidOutRMS = 47,
+	HighMidHarmonics = 48,
+	TrebleInPeak = 49,
+	TrebleInRMS = 50,
+	TrebleOutPeak = 51,
+	TrebleOutRMS = 52,
+	TrebleHarmonics = 53,
+	OutputPeak = 54,
+	OutputRMS = 55,
+#if DSP_PROFILING
+	DSPLoad = 56
+#endif
 
 };
 
@@ -67,8 +117,8 @@ class PluginCore : public PluginBase
 public:
     PluginCore();
 
-	/** Destructor: empty in default version */
-    virtual ~PluginCore(){}
+	/** Destructor: deletes the crossovers and channel states */
+    virtual ~PluginCore();
 
 	// --- PluginBase Overrides ---
 	//
@@ -87,9 +137,11 @@ public:
 	/** process frames of data */
 	virtual bool processAudioFrame(ProcessFrameInfo& processFrameInfo);
 
-	// --- uncomment and override this for buffer processing; see base class implementation for
-	//     help on breaking up buffers and getting info from processBufferInfo
-	//virtual bool processAudioBuffers(ProcessBufferInfo& processBufferInfo); 
+	/** process whole buffers; runs each DSP stage over the channel buffers (see setFrameProcessing) */
+	virtual bool processAudioBuffers(ProcessBufferInfo& processBufferInfo);
+
+	/** the wrappers' soft bypass: the inputs delayed by the reported latency, so bypassing does not shift the track */
+	virtual bool processBypassedAudioBuffers(ProcessBufferInfo& processBufferInfo);
 
 	/** preProcess: do any post-buffer processing required; default operation is to send metering data to GUI  */
 	virtual bool postProcessAudioBuffers(ProcessBufferInfo& processInfo);
@@ -112,6 +164,9 @@ public:
 	/** processMIDIEvent: MIDI event processing */
 	virtual bool processMIDIEvent(midiEvent& event);
 
+	/** the parameter a MIDI CC controls, or -1 */
+	int32_t getMidiControllerParameter(uint32_t controller);
+
 	/** specialized joystick servicing (currently not used) */
 	virtual bool setVectorJoystickParameters(const VectorJoystickData& vectorJoysickData);
 
@@ -122,9 +177,36 @@ public:
 	//	   Add your variables and methods here
 
 	void setAndCalcFilters();
-	void updateParameters();
+	void setCrossoverTargets();
+	uint32_t glideCrossovers(uint32_t numFrames);
+	void createChannelStates(const ChannelIOConfig& channelIOConfig, bool deleteUnused);
+	bool hasChannelStates(const ChannelIOConfig& channelIOConfig);
+	void allocateChannelStates(uint32_t count);
+	void freeChannelStates();
+	void cookParameters(bool rampSmoothedParameters);
 	void setBandStates();
-
+	void setOversampling();
+	void setLatency();
+
+	// --- block processing; set true to run the original processAudioFrame path for A/B checks
+	void setFrameProcessing(bool frameProcessing) { useFrameProcessing = frameProcessing; }
+	bool getFrameProcessing() { return useFrameProcessing; }
+
+	bool needsPerFrameParameterUpdates();
+	void selectKernels(const ChannelIOConfig& channelIOConfig);
+	bool processSynthFrame(ProcessFrameInfo& processFrameInfo);
+	template <typename SampleType>
+	void processBandBlock(uint32_t channel, SampleType* output, uint32_t numFrames);
+	template <typename SampleType>
+	void processLFEBlock(uint32_t channel, const SampleType* input, SampleType* output, uint32_t numFrames);
+	template <typename SampleType>
+	void applyMasterVolume(SampleType* output, uint32_t numFrames);
+	void saturateBandBlock(uint32_t channel, uint32_t band, uint32_t numFrames);
+	double saturateBandSample(uint32_t channel, uint32_t band, double& dry);
+	void updateSilence(bool tailsSilent, uint32_t numFrames);
+	void clearBandStates();
+	void publishMeters();
+	void resetMeters();
 
 
 
@@ -133,8 +215,11 @@ public:
 private:
 	//  **--0x07FD--**
 
-	LinkwitzRiley2ndOrder LFLP_L, LFHP_L, MFLP_L, MFHP_L, HFLP_L, HFHP_L;
-	LinkwitzRiley2ndOrder LFLP_R, LFHP_R, MFLP_R, MFHP_R, HFLP_R, HFHP_R;
+	// --- the crossovers for the current input format: its processed (not LFE) channels go through them in pairs,
+	//     each pair sharing the SIMD lanes of a stereo crossover, and an odd one left over (mono, mono-in/stereo-out)
+	//     through the mono one
+	LinkwitzRileyCrossover* monoCrossover = nullptr;
+	std::vector<LinkwitzRileyStereoCrossover*> stereoCrossovers;
 
 
 	int LowOn = 1;
@@ -171,18 +256,230 @@ private:
 	double HighMidMix = 0.0000000;
 	double TrebleMix = 0.000000;
 
-	double LowSatRaw;
-	double LowMidSatRaw;
-	double HighMidSatRaw;
-	double TrebleSatRaw;
+	double MasterVolume = 0.0000000;
+
+	int SatQuality = 0;
+	enum class SatQualityEnum { Exact, Rational, Polynomial };
 
-	double LowMixRaw;
-	double LowMidMixRaw;
-	double HighMidMixRaw;
-	double TrebleMixRaw;
+	int Oversampling = 0;
+	enum class OversamplingEnum { OFF, ON };
 
-	double MasterVolume = 0.0000000;
-	double MasterVolumeCooked = 0.00000;
+	int LowOversampling = 0;
+	enum class LowOversamplingEnum { x1, x2, x4 };
+
+	int LowMidOversampling = 0;
+	enum class LowMidOversamplingEnum { x1, x2, x4 };
+
+	int HighMidOversampling = 1;
+	enum class HighMidOversamplingEnum { x1, x2, x4 };
+
+	int TrebleOversampling = 2;
+	enum class TrebleOversamplingEnum { x1, x2, x4 };
+
+	int SatAntialiasing = 0;
+	enum class SatAntialiasingEnum { OFF, ADAA };
+
+	double LowCrossover = 100.000000;
+	double MidCrossover = 1000.000000;
+	double HighCrossover = 10000.000000;
+
+	int SurroundLink = 0;
+	enum class SurroundLinkEnum { Linked, Unlinked };
+
+	double SurroundSat = 0.000000;
+	double SurroundMix = 100.000000;
+
+	int HeightLink = 0;
+	enum class HeightLinkEnum { Linked, Unlinked };
+
+	double HeightSat = 0.000000;
+	double HeightMix = 100.000000;
+
+	int CrossoverMode = 0;
+	enum class CrossoverModeEnum { IIR, Linear_Phase };
+
+	float LowInPeak = 0.f;
+	float LowInRMS = 0.f;
+	float LowOutPeak = 0.f;
+	float LowOutRMS = 0.f;
+	float LowHarmonics = 0.f;
+
+	float LowMidInPeak = 0.f;
+	float LowMidInRMS = 0.f;
+	float LowMidOutPeak = 0.f;
+	float LowMidOutRMS = 0.f;
+	float LowMidHarmonics = 0.f;
+
+	float HighMidInPeak = 0.f;
+	float HighMidInRMS = 0.f;
+	float HighMidOutPeak = 0.f;
+	float HighMidOutRMS = 0.f;
+	float HighMidHarmonics = 0.f;
+
+	float TrebleInPeak = 0.f;
+	float TrebleInRMS = 0.f;
+	float TrebleOutPeak = 0.f;
+	float TrebleOutRMS = 0.f;
+	float TrebleHarmonics = 0.f;
+
+	float OutputPeak = 0.f;
+	float OutputRMS = 0.f;
+
+#if DSP_PROFILING
+	float DSPLoad = 0.f;
+#endif
+
+	// --- block processing scratch; buffers are processed in chunks of kBlockFrames
+	static const uint32_t kBlockFrames = 128;
+	enum { kLowBand, kLowMidBand, kHighMidBand, kTrebleBand, kNumBands };
+
+	bool useFrameProcessing = false;
+
+	// --- the frame and block DSP is written once per channel count and sample type; selectKernels() picks the
+	//     instantiations for the channel I/O in reset() (or when the host changes it) and the process calls go
+	//     through these pointers. Frames are always float; buffers are float or double (VST3 kSample64), and the
+	//     double block kernel reads and writes the host buffers with no conversion
+	template <typename SampleType, uint32_t kChannels, uint32_t kOutputChannels, uint32_t kBands>
+	bool processFrameKernel(ProcessFrameInfo& processFrameInfo);
+	template <typename SampleType, uint32_t kChannels, uint32_t kOutputChannels, uint32_t kBands>
+	bool processBlockKernel(const SampleType* const* inputs, SampleType* const* outputs, uint32_t offset, uint32_t numFrames);
+	template <typename SampleType, uint32_t kChannels>
+	void splitFrame(const SampleType* input, double (*bands)[kNumBands]);
+	template <typename SampleType, uint32_t kChannels>
+	void splitBlock(const SampleType* const* inputs, uint32_t offset, uint32_t numFrames);
+
+	template <uint32_t kChannels, uint32_t kOutputChannels>
+	void setKernels();
+
+	typedef bool (PluginCore::*FrameKernel)(ProcessFrameInfo& processFrameInfo);
+	typedef bool (PluginCore::*BlockKernel)(const float* const* inputs, float* const* outputs, uint32_t offset, uint32_t numFrames);
+	typedef bool (PluginCore::*BlockKernel64)(const double* const* inputs, double* const* outputs, uint32_t offset, uint32_t numFrames);
+
+	FrameKernel frameKernel = nullptr;		///< nullptr: the I/O is not supported (or not known yet)
+	BlockKernel blockKernel = nullptr;
+	BlockKernel64 blockKernel64 = nullptr;
+	ChannelIOConfig kernelIOConfig = ChannelIOConfig(kCFNone, kCFNone);	///< the I/O the kernels were picked for
+
+	// --- cooked parameters; the audio loops only read these. postUpdatePluginParameter flags the controls whose
+	//     bound value changed and cookParameters() recomputes just those
+	static const int32_t kNumCookedControls = ControlID::CrossoverMode + 1;
+	static const uint64_t kAllCookedControls = (1ull << kNumCookedControls) - 1;
+
+	// --- channel groups: fronts (mono, stereo and ambisonics are all front) always take the band settings, the
+	//     surround and height groups take them when linked and offset Sat/scale Mix by their own controls when
+	//     unlinked; the LFE is not excited, only delayed with the bands
+	enum { kFrontGroup, kSurroundGroup, kHeightGroup, kNumChannelGroups, kLFEChannel = kNumChannelGroups };
+
+	struct CookedParameters
+	{
+		double drive[kNumChannelGroups][kNumBands];	///< Sat as linear gain
+		double mix[kNumChannelGroups][kNumBands];	///< Mix as 0..1 wet amount
+		uint32_t activeBands;			///< bit per band, On after the solo logic
+		int bandOn[kNumBands];			///< activeBands as 0/1 gains for the frame path
+		double masterVolume;			///< MasterVolume as linear gain
+	};
+
+	CookedParameters cooked = {};
+	double cookedControlValue[kNumCookedControls] = {};
+	uint64_t dirtyControls = kAllCookedControls;
+	uint64_t smoothedControls = 0;
+
+	// --- smoothed Mix/MasterVolume ramp over a block from these values to the cooked ones (a smoothed Sat ramps
+	//     from each waveshaper's current drive)
+	double mixRampStart[kNumChannelGroups][kNumBands] = {};
+	double masterVolumeRampStart = 0.0;
+
+	// --- everything one channel owns, on cache lines of its own so neighbouring channels never share one.
+	//     With Oversampling ON every band's dry and wet paths are delayed to the slowest band's latency, which is
+	//     what the host is told (the LFE too, through lfeDelay)
+	static const uint32_t kCacheLineBytes = 64;
+	struct alignas(kCacheLineBytes) ChannelState
+	{
+		TanhWaveshaper waveshaper[kNumBands];	///< ADAA keeps the previous sample
+		Oversampler oversampler[kNumBands];
+		SampleDelay dryDelay[kNumBands];
+		SampleDelay wetDelay[kNumBands];
+		SampleDelay lfeDelay;
+		SampleDelay bypassDelay;				///< the input by the whole latency, in the wrappers' soft bypass
+		double bandDry[kNumBands][kBlockFrames];
+	};
+
+	// --- one state per channel of the input format (see createChannelStates); C++11 new does not honour
+	//     alignas past the default alignment, so they are placed in channelStateMemory by hand
+	static const uint32_t kMaxChannels = 16;
+	ChannelState* channelStates = nullptr;
+	uint8_t* channelStateMemory = nullptr;
+	uint32_t numChannelStates = 0;
+	uint32_t channelGroup[kMaxChannels] = {};		///< kFrontGroup.. or kLFEChannel
+	uint32_t crossoverChannel[kMaxChannels] = {};	///< the channels that are split, in crossover order
+	uint32_t numCrossoverChannels = 0;
+
+	// --- shared scratch, one channel at a time
+	double bandWet[kNumBands][kBlockFrames];
+	double bandSum[kBlockFrames];
+	double bandOversampled[kBlockFrames * Oversampler::kMaxFactor];
+	uint32_t oversamplingLatency = 0;
+
+	// --- Crossover Mode Linear Phase: every split channel goes through this one FIR crossover instead of the
+	//     IIR ones, and everything (the LFE too) is delayed by its latency on top of the oversampling latency
+	LinearPhaseCrossover linearPhaseCrossover;
+	bool linearPhase = false;
+	uint32_t crossoverLatency = 0;
+
+	// --- silence: once the input and the crossover's band tails have stayed under kSilenceThreshold for
+	//     silenceHoldFrames (the oversampler and delay line memory, plus what the linear phase crossover still
+	//     holds), the band states are cleared and each chunk is zeros with no band processing until the input
+	//     comes back; the host is told (VST3 silenceFlags)
+	static constexpr double kSilenceThreshold = 1.0e-7;		///< about -140 dBFS, under a 24-bit LSB
+	static const uint32_t kSilenceHoldFrames = 3 * Oversampler::kPhaseTaps;
+	uint32_t silenceHoldFrames = kSilenceHoldFrames;
+	bool silent = false;
+	uint32_t silentFrames = 0;
+	bool hostInputSilent = false;	///< the host flagged every input channel of this buffer as silent
+	bool bypassed = false;			///< the last buffer went through processBypassedAudioBuffers
+
+	// --- meters: the band and output levels of a host buffer are measured chunk by chunk (levelMeter, SIMD) and
+	//     published once at its end by publishMeters(), to the bound meter variables that the wrappers send to the
+	//     host and to meterValues, which hold the highest level since the GUI timer last took them; the timer
+	//     pushes them to the meter views the GUI registered, so the audio thread never touches a view. The
+	//     band meters are power averaged over the processed (not LFE) channels, the output ones over all of them
+	enum { kInPeakMeter, kInRMSMeter, kOutPeakMeter, kOutRMSMeter, kHarmonicsMeter, kNumBandMeters };
+	static const uint32_t kNumMeters = ControlID::OutputRMS - ControlID::LowInPeak + 1;
+	struct MeterLevels
+	{
+		LevelMeasurement in[kNumBands];			///< the band out of the crossover
+		LevelMeasurement out[kNumBands];		///< after the mix
+		LevelMeasurement harmonics[kNumBands];	///< out - in, what the band added
+		LevelMeasurement output;				///< after the master volume
+	};
+	LevelMeter levelMeter;
+	MeterLevels meterLevels = {};
+	std::atomic<float> meterValues[kNumMeters];		///< from LowInPeak; raised by the audio thread, taken by the GUI timer
+	ICustomView* meterViews[kNumMeters];				///< from LowInPeak; GUI thread only
+
+#if DSP_PROFILING
+	// --- DSP load: every process call is timed as a whole and the block path laps the stages per chunk and channel
+	//     in randomly spaced buffers (see DSPProfiler.h); the window mean goes to the DSPLoad meter (1.0 = 100 % of the buffer's
+	//     real time), the rest is read with PLUGIN_QUERY_DSPLOAD
+	DSPProfiler dspProfiler;
+#endif
+
+	// --- crossover glide: a frequency change moves in log2(Hz) towards the parameter with a one pole stepped every
+	//     kCrossoverGlideFrames, and the section coefficients ramp per sample to the warp table values for each
+	//     step; once settled they are set exactly again, so a static crossover is unchanged
+	static const uint32_t kCrossoverGlideFrames = 64;
+	static constexpr double kCrossoverGlideTime = 0.02;			///< one pole time constant, seconds
+	static constexpr double kCrossoverSettledOctaves = 1.0e-4;
+	static constexpr double kMinCrossoverFc = 20.0;
+	static constexpr double kMaxCrossoverFcRatio = 0.45;		///< of the sample rate
+	enum { kNumCrossovers = 3 };
+	double crossoverFc[kNumCrossovers] = { 100.0, 1000.0, 10000.0 };	///< targets, Hz
+	double crossoverTarget[kNumCrossovers] = {};	///< targets, log2(Hz)
+	double crossoverGlide[kNumCrossovers] = {};	///< where the sections are, log2(Hz)
+	double crossoverGlideCoefficient = 0.0;
+	uint32_t crossoverGlideCountdown = 0;
+	bool crossoverGliding = false;
+	LinkwitzRileyWarpTable crossoverWarpTable;
 
 
 	// **--0x1A7F--**
@@ -47,6 +47,7 @@ const double kTailTimeMsec = 0;
 const bool kVSTInfiniteTail = false;
 const bool kVSTSAA = false;
 const uint32_t kVST3SAAGranularity = 1;
+const bool kVST3SAASubBlocks = true;
 const uint32_t kAAXCategory = 0;
 
 #endif
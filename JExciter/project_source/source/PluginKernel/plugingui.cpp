@@ -629,8 +629,8 @@ void PluginGUI::writeToPresetFile()
 \brief perform idling operation; called directly from timer thread
 
 Operation:\n
-- send the timer ping message
-- send process loop output data to any output-only receivers (meters)
+- send the timer ping message; meters the plugin feeds update from it
+- send process loop output data to any output-only receivers (other meters)
 - issue the repaint message to the outer frame
 */
 void PluginGUI::idle()
@@ -2373,6 +2373,10 @@ CView* PluginGUI::createView(const UIAttributes& attributes, const IUIDescriptio
                         piParam->getDetectorMode(),
                         piParam->getLogMeter());
         
+        // --- the plugin feeds the meter if it takes the registration, so it is not polled (see checkAddWriteableControl())
+        if (guiPluginConnector && guiPluginConnector->registerCustomView(*tagString, p))
+            p->setPluginFed(true);
+        
         return p;
     }
     
@@ -2437,6 +2441,10 @@ CView* PluginGUI::createView(const UIAttributes& attributes, const IUIDescriptio
                             piParam->getDetectorMode(),
                             piParam->getLogMeter());
             
+            // --- the plugin feeds the meter if it takes the registration, so it is not polled (see checkAddWriteableControl())
+            if (guiPluginConnector && guiPluginConnector->registerCustomView(*tagString, p))
+                p->setPluginFed(true);
+            
             return p;
         }
     }
@@ -769,6 +769,12 @@ public:
             return;
         if(!piParam->getIsWritable())
             return;
+
+        // --- meters the plugin feeds from the timer ping are not polled
+        CVuMeterEx* meter = dynamic_cast<CVuMeterEx*>(control);
+        if(meter && meter->isPluginFed())
+            return;
+
         if(!hasWriteableControl(control))
         {
             writeableControls.push_back(control);
@@ -20,10 +20,12 @@
 #include <map>
 #include <iomanip>
 #include <iostream>
+#include <algorithm>
 
 #include <math.h>
 #include "pluginstructures.h"
 #include "guiconstants.h"
+#include "ParameterSnapshot.h"
 
 
 /**
@@ -178,12 +180,39 @@ public:
 			controlType == controlVariableType::kFloat)
 		{
 			if (useParameterSmoothing && !ignoreSmoothing)
+			{
 				setSmoothedTargetValue(actualParamValue);
-			else
-				setAtomicControlValueDouble(actualParamValue);
+				publishValue(actualParamValue, false);
+				return;
+			}
 		}
-		else
-			setAtomicControlValueDouble(actualParamValue);
+
+		setAtomicControlValueDouble(actualParamValue);
+		publishValue(actualParamValue, true);
+	}
+
+	/**
+	\brief set the underlying atomic double value, the smoothing target and the smoother state at once (no smoothing);
+	       for values that are already continuous, like VST3 sample accurate automation ramps; audio thread only,
+	       the value is not published (see ParameterSnapshot)
+
+	\param normalizedValue parameter value as a regular double
+	\param applyTaper add the control taper during the operation
+	*/
+	inline double jumpToControlValueNormalized(double normalizedValue, bool applyTaper = true)
+	{
+		double actualParamValue = getControlValueWithNormalizedValue(normalizedValue, applyTaper);
+
+		if (controlType == controlVariableType::kDouble ||
+			controlType == controlVariableType::kFloat)
+		{
+			setSmoothedTargetValue(actualParamValue);
+			smoothingTarget = actualParamValue;
+			paramSmoother.setValue(actualParamValue);
+		}
+		setAtomicControlValueDouble(actualParamValue);
+
+		return actualParamValue;
 	}
 
 	/**
@@ -202,16 +231,55 @@ public:
 			controlType == controlVariableType::kFloat)
 		{
 			if (useParameterSmoothing && !ignoreParameterSmoothing)
+			{
 				setSmoothedTargetValue(actualParamValue);
-			else
-				setAtomicControlValueDouble(actualParamValue);
+				publishValue(actualParamValue, false);
+				return actualParamValue;
+			}
 		}
-		else
-			setAtomicControlValueDouble(actualParamValue);
 
+		setAtomicControlValueDouble(actualParamValue);
+		publishValue(actualParamValue, true);
 		return actualParamValue;
 	}
 
+	/**
+	\brief set by PluginBase: every value written by the setters above is also published to the snapshot, which the
+	       audio thread reads once per buffer (see syncInBoundVariables and applySnapshotValue)
+
+	\param _snapshot the plugin's parameter snapshot
+	\param _snapshotIndex this parameter's index in it
+	*/
+	void setSnapshot(ParameterSnapshot* _snapshot, uint32_t _snapshotIndex)
+	{
+		snapshot = _snapshot;
+		snapshotIndex = _snapshotIndex;
+	}
+
+	/** \return this parameter's index in the snapshot, which is also its index in PluginBase::pluginParameterArray */
+	uint32_t getSnapshotIndex() const { return snapshotIndex; }
+
+	/**
+	\brief audio thread: take a value from the snapshot; with smoothing it becomes the smoother's target, otherwise
+	       (or when it was written around the smoother, jump = true) the value itself
+
+	\param value the published value
+	\param jump the value was written without smoothing
+	*/
+	void applySnapshotValue(double value, bool jump)
+	{
+		if ((controlType == controlVariableType::kDouble || controlType == controlVariableType::kFloat) &&
+			useParameterSmoothing && !jump)
+		{
+			smoothingTarget = value;
+			return;
+		}
+
+		setAtomicControlValueDouble(value);
+		smoothingTarget = value;
+		paramSmoother.setValue(value);
+	}
+
 	/**
 	\brief the main function to access the underlying atomic double value as a string
 
@@ -446,7 +514,23 @@ public:
     {
         if(!useParameterSmoothing) return false;
         double smoothedValue = 0.0;
-        bool smoothed = paramSmoother.smoothParameter(getSmoothedTargetValue(), smoothedValue);
+        bool smoothed = paramSmoother.smoothParameter(getSmoothingTarget(), smoothedValue);
+        if(smoothed)
+			setAtomicControlValueDouble(smoothedValue);
+        return smoothed;
+    }
+
+	/**
+	\brief perform the smoothing of a whole block at once; the value is the smoothed value at the last frame
+
+	\param numFrames the block size
+	\return true if data was actually smoothed, false otherwise (data that has reached its terminal value will not be smoothed any further)
+	*/
+	bool smoothParameterValueBlock(uint32_t numFrames)
+    {
+        if(!useParameterSmoothing) return false;
+        double smoothedValue = 0.0;
+        bool smoothed = paramSmoother.smoothParameterBlock(getSmoothingTarget(), numFrames, smoothedValue);
         if(smoothed)
 			setAtomicControlValueDouble(smoothedValue);
         return smoothed;
@@ -521,22 +605,22 @@ public:
 	{
 		if (boundVariableUInt)
 		{
-			setControlValue((double)*boundVariableUInt);
+			setAtomicControlValueDouble((double)*boundVariableUInt);
 			return true;
 		}
 		else if (boundVariableInt)
 		{
-			setControlValue((double)*boundVariableInt);
+			setAtomicControlValueDouble((double)*boundVariableInt);
 			return true;
 		}
 		else if (boundVariableFloat)
 		{
-			setControlValue((double)*boundVariableFloat);
+			setAtomicControlValueDouble((double)*boundVariableFloat);
 			return true;
 		}
 		else if (boundVariableDouble)
 		{
-			setControlValue(*boundVariableDouble);
+			setAtomicControlValueDouble(*boundVariableDouble);
 			return true;
 		}
 		return false;
@@ -650,6 +734,13 @@ protected:
     // --- default is enabled; you can disable this for controls that have a long postUpdate cooking time
     bool enableVSTSampleAccurateAutomation = true;							///< VST3 sample accurate flag
 
+    // --- the audio thread's view, see ParameterSnapshot; without a snapshot the atomic target is used
+    ParameterSnapshot* snapshot = nullptr;									///< owned by PluginBase (not copied)
+    uint32_t snapshotIndex = 0;												///< this parameter's index in the snapshot
+    double smoothingTarget = 0.0;											///< audio thread: the smoother's target
+    void publishValue(double value, bool jump) { if (snapshot) snapshot->write(snapshotIndex, (float)value, jump); }
+    double getSmoothingTarget() const { return snapshot ? smoothingTarget : getSmoothedTargetValue(); }
+
     /**
 	\brief get volt/octave control value from a normalized value
 
@@ -20,6 +20,7 @@
 #include <sstream>
 #include <vector>
 #include <stdint.h>
+#include <string.h>
 
 #include "readerwriterqueue.h"
 #include "atomicops.h"
@@ -142,6 +143,12 @@ enum channelFormat
     kCF13p0,
     kCF13p1,
     kCF22p2,
+
+    /* immersive and ambisonic (ACN order) formats */
+    kCF7p1p4,
+    kCFAmbisonic1stOrder,
+    kCFAmbisonic2ndOrder,
+    kCFAmbisonic3rdOrder,
 };
 
 /**
@@ -166,11 +173,49 @@ enum auxGUIIdentifier
 	guiControlData
 };
 
+/**
+\struct ChannelIOConfig
+\ingroup Structures
+\brief
+Structure of a pair of channel format enumerators that set an input/output channel I/O capability.
+
+\author Will Pirkle http://www.willpirkle.com
+\remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
+\version Revision : 1.0
+\date Date : 2018 / 09 / 7
+*/
+struct ChannelIOConfig
+{
+    ChannelIOConfig ()
+    : inputChannelFormat(kCFStereo)
+    , outputChannelFormat(kCFStereo) {}
+
+    ChannelIOConfig (uint32_t _inputChannelFormat,
+                     uint32_t _outputChannelFormat)
+    : inputChannelFormat(_inputChannelFormat)
+    , outputChannelFormat(_outputChannelFormat){}
+
+	ChannelIOConfig& operator=(const ChannelIOConfig& data)	// need this override for collections to work
+	{
+		if (this == &data)
+			return *this;
+
+		inputChannelFormat = data.inputChannelFormat;
+		outputChannelFormat = data.outputChannelFormat;
+
+		return *this;
+	}
+
+    uint32_t inputChannelFormat = kCFStereo;	///< input format for this I/O pair
+    uint32_t outputChannelFormat = kCFStereo;	///< output format for this I/O pair
+
+};
+
 /**
 \struct ResetInfo
 \ingroup Structures
 \brief
-Sample rate and bit-depth information that is passed during the reset( ) function.
+Sample rate, bit-depth and channel I/O information that is passed during the reset( ) function.
 
 \author Will Pirkle http://www.willpirkle.com
 \remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
@@ -181,15 +226,18 @@ struct ResetInfo
 {
 	ResetInfo()
 		: sampleRate(44100)
-		, bitDepth(16) {}
+		, bitDepth(16)
+		, channelIOConfig(kCFNone, kCFNone) {}
 
 	ResetInfo(double _sampleRate,
 		uint32_t _bitDepth)
 		: sampleRate(_sampleRate)
-		, bitDepth(_bitDepth) {}
+		, bitDepth(_bitDepth)
+		, channelIOConfig(kCFNone, kCFNone) {}
 
 	double sampleRate = 0.0;	///< sample rate
 	uint32_t bitDepth = 0;		///< bit depth (not available in all APIs)
+	ChannelIOConfig channelIOConfig;	///< channel I/O the next buffers will use; kCFNone formats if the API does not know yet
 };
 
 /**
@@ -214,6 +262,7 @@ struct APISpecificInfo
     , vst3FUID("")
     , enableVST3SampleAccurateAutomation(0)
     , vst3SampleAccurateGranularity(1)
+    , enableVST3SampleAccurateSubBlocks(0)
     , vst3BundleID("")
     , auBundleID("")
     {}
@@ -234,6 +283,7 @@ struct APISpecificInfo
 
 		enableVST3SampleAccurateAutomation = data.enableVST3SampleAccurateAutomation;
 		vst3SampleAccurateGranularity = data.vst3SampleAccurateGranularity;
+		enableVST3SampleAccurateSubBlocks = data.enableVST3SampleAccurateSubBlocks;
 		vst3BundleID = data.vst3BundleID;
 		auBundleID = data.auBundleID;
 		auBundleName = data.auBundleName;
@@ -254,6 +304,7 @@ struct APISpecificInfo
     std::string vst3FUID;								///< VST GUID
     bool enableVST3SampleAccurateAutomation = false;	///< flag for sample accurate automation
     uint32_t vst3SampleAccurateGranularity = 1;			///< sample accuracy granularity (update interval)
+    bool enableVST3SampleAccurateSubBlocks = false;		///< split buffers into sub-blocks at the automation points (granularity = shortest sub-block)
     std::string vst3BundleID;							///< VST bundle ID /* MacOS only: this MUST match the bundle identifier in your info.plist file */
 
     // --- AU
@@ -509,44 +560,6 @@ struct HostMessageInfo
 };
 
 
-/**
-\struct ChannelIOConfig
-\ingroup Structures
-\brief
-Structure of a pair of channel format enumerators that set an input/output channel I/O capability.
-
-\author Will Pirkle http://www.willpirkle.com
-\remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
-\version Revision : 1.0
-\date Date : 2018 / 09 / 7
-*/
-struct ChannelIOConfig
-{
-    ChannelIOConfig ()
-    : inputChannelFormat(kCFStereo)
-    , outputChannelFormat(kCFStereo) {}
-
-    ChannelIOConfig (uint32_t _inputChannelFormat,
-                     uint32_t _outputChannelFormat)
-    : inputChannelFormat(_inputChannelFormat)
-    , outputChannelFormat(_outputChannelFormat){}
-
-	ChannelIOConfig& operator=(const ChannelIOConfig& data)	// need this override for collections to work
-	{
-		if (this == &data)
-			return *this;
-
-		inputChannelFormat = data.inputChannelFormat;
-		outputChannelFormat = data.outputChannelFormat;
-
-		return *this;
-	}
-
-    uint32_t inputChannelFormat = kCFStereo;	///< input format for this I/O pair
-    uint32_t outputChannelFormat = kCFStereo;	///< output format for this I/O pair
-
-};
-
 /**
 \struct midiEvent
 \ingroup Structures
@@ -688,6 +701,7 @@ enum messageType {
 	PLUGIN_QUERY_PARAMETER,					/* fill in a Rafx2PluginParameter for host inMessageData = index of parameter*/
 	PLUGIN_QUERY_TRACKPAD_X,
 	PLUGIN_QUERY_TRACKPAD_Y,
+	PLUGIN_QUERY_DSPLOAD,					/* fill in a DSPLoadInfo (DSPProfiler.h) for a debug panel, outMessageData = DSPLoadInfo*; DSP_PROFILING builds only */
 };
 
 
@@ -1077,11 +1091,21 @@ struct ProcessBufferInfo
 	float** outputs = nullptr;		///< audio output buffers
 	float** auxInputs = nullptr;	///< aux (sidechain) input buffers
 	float** auxOutputs = nullptr;	///< aux outputs - for future use
+
+	// --- 64-bit audio (VST3 kSample64); when set these replace the float buffers above, which are then nullptr
+	double** inputs64 = nullptr;	///< 64-bit audio input buffers
+	double** outputs64 = nullptr;	///< 64-bit audio output buffers
+	double** auxInputs64 = nullptr;	///< 64-bit aux (sidechain) input buffers
+
 	uint32_t numAudioInChannels = 0;		///< audio input channel count
 	uint32_t numAudioOutChannels = 0;		///< audio output channel count
 	uint32_t numAuxAudioInChannels = 0;		///< aux input channel count
 	uint32_t numAuxAudioOutChannels = 0;	///< aux output channel count (not used)
 
+	// --- silence (VST3 silenceFlags): one bit per channel that is entirely zero
+	uint64_t inputSilenceFlags = 0;			///< set by the wrapper when the host knows
+	uint64_t outputSilenceFlags = 0;		///< set by the plugin for the host; 0 = not known to be silent
+
 	uint32_t numFramesToProcess = 0;		///< frame count in this buffer
     ChannelIOConfig channelIOConfig;		///< input/output channel I/O configuration pair
     ChannelIOConfig auxChannelIOConfig;		///< aux input/output channel I/O configuration pair
@@ -1239,7 +1263,7 @@ struct PluginDescriptor
             case 3:
                 return kCFLCR;
             case 4:
-                return kCFQuad; // or kCFLCR
+                return kCFQuad; // or kCFLCRS or kCFAmbisonic1stOrder
             case 5:
                 return kCF5p0;
             case 6:
@@ -1249,17 +1273,19 @@ struct PluginDescriptor
             case 8:
                 return kCF7p1DTS; // or kCF7p1Sony or kCF7p1Proximity
             case 9:
-                return kCF8p1; // or kCF9p0
+                return kCF8p1; // or kCF9p0 or kCFAmbisonic2ndOrder
             case 10:
                 return kCF9p1; // or kCF10p0
             case 11:
                 return kCF10p1;
             case 12:
-                return kCF11p1; // or kCF10p2
+                return kCF7p1p4; // or kCF11p1 or kCF10p2
             case 13:
                 return kCF13p0; // or kCF12p2
             case 14:
                 return kCF13p1;
+            case 16:
+                return kCFAmbisonic3rdOrder;
             case 24:
                 return kCF22p2;
 
@@ -1284,6 +1310,7 @@ struct PluginDescriptor
 
             case kCFQuad:
             case kCFLCRS:
+            case kCFAmbisonic1stOrder:
                 return 4;
 
             case kCF5p0:
@@ -1305,6 +1332,7 @@ struct PluginDescriptor
 
             case kCF8p1:
             case kCF9p0:
+            case kCFAmbisonic2ndOrder:
                 return 9;
 
             case kCF9p1:
@@ -1316,6 +1344,7 @@ struct PluginDescriptor
 
             case kCF10p2:
             case kCF11p1:
+            case kCF7p1p4:
                 return 12;
 
             case kCF13p0:
@@ -1325,6 +1354,9 @@ struct PluginDescriptor
             case kCF13p1:
                 return 14;
 
+            case kCFAmbisonic3rdOrder:
+                return 16;
+
             case kCF22p2:
                 return 24;
 
@@ -1554,6 +1586,10 @@ public:
 \brief
 Double buffered queue for MIDI messages.
 
+NOTES:
+- the events of a buffer are in sample offset order, so the plugin can split the buffer at getNextEventOffset()
+  and fire the events between the pieces (see PluginBase::beginMidiEvents)
+
 \author Will Pirkle http://www.willpirkle.com
 \remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
 \version Revision : 1.0
@@ -1562,11 +1598,16 @@ Double buffered queue for MIDI messages.
 class IMidiEventQueue
 {
 public:
+	enum : uint32_t { kNoEvent = 0xFFFFFFFF };
+
 	/** Get the event count (extra, does not really need to be used) */
 	virtual uint32_t getEventCount() = 0;
 
-	/** Fire off the next <IDI event */
+	/** Fire off every MIDI event not fired yet with a sample offset up to and including uSampleOffset */
 	virtual bool fireMidiEvents(uint32_t uSampleOffset) = 0;
+
+	/** Sample offset of the next MIDI event not fired yet, or kNoEvent */
+	virtual uint32_t getNextEventOffset() = 0;
 };
 
 
@@ -1594,6 +1635,14 @@ public:
 	/**    Get the sample-accurate value of the parameter at the next sample offset, determined by an internal counter
 	//     Returns true if dNextValue is different than the previous value */
 	virtual bool getNextValue(double& _nextValue) = 0;
+
+	/**    Sub-block scheduling: get the offset of the first automation point at or after the given sample offset;
+	//     returns the buffer size if there is none. Offsets must not decrease within a buffer */
+	virtual uint32_t getNextPointOffset(uint32_t _sampleOffset) = 0;
+
+	/**    Sub-block scheduling: get the normalized value at the given sample offset, linearly interpolated between
+	//     the automation points. Offsets must not decrease within a buffer */
+	virtual double getInterpolatedValue(uint32_t _sampleOffset) = 0;
 };
 
 // --------------------------------------------------------------------------------------------------------------------------- //
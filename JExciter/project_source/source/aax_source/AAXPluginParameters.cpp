@@ -42,6 +42,8 @@
 #include "AAX_Assert.h"
 #include "AAX_CMutex.h" // --- not currently used
 
+#include <stdio.h>
+
 // --- custom VSTGUI4 derived classes
 #include "customcontrols.h"
 
@@ -204,11 +206,20 @@ AAX_Result AAXPluginParameters::EffectInit()
     Controller()->GetSampleRate(&sampleRate);
 
     // --- report our latency
-	Controller()->SetSignalLatency((int32_t)pluginCore->getLatencyInSamples());
+    reportedLatency = (int32_t)pluginCore->getLatencyInSamples();
+	Controller()->SetSignalLatency(reportedLatency);
 
     ResetInfo info;
     info.sampleRate = sampleRate;
 
+    // --- and the stem formats, so the core can size its channel state
+    AAX_EStemFormat inputStemFormat = AAX_eStemFormat_None;
+    AAX_EStemFormat outputStemFormat = AAX_eStemFormat_None;
+    Controller()->GetInputStemFormat(&inputStemFormat);
+    Controller()->GetOutputStemFormat(&outputStemFormat);
+    info.channelIOConfig.inputChannelFormat = getChannelFormatForAAXStemFormat(inputStemFormat);
+    info.channelIOConfig.outputChannelFormat = getChannelFormatForAAXStemFormat(outputStemFormat);
+
     // --- reset with sample rate
     pluginCore->reset(info);
 
@@ -477,8 +488,10 @@ void AAXPluginParameters::updateHostInfo(AAXAlgorithm* ioRenderInfo, HostInfo* h
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void AAXPluginParameters::ProcessAudio(AAXAlgorithm* ioRenderInfo, const TParamValPair* inSynchronizedParamValues[], int32_t inNumSynchronizedParamValues)
 {
-    // --- global param update for dirty params
+    // --- global param update for dirty params, written on the audio thread
+    pluginCore->beginAudioThreadUpdates();
     UpdatePluginParameters(inSynchronizedParamValues, inNumSynchronizedParamValues);
+    pluginCore->endAudioThreadUpdates();
 
     // --- MIDI input (all plugins can have MIDI in)
     AAX_IMIDINode* const midiInNode = ioRenderInfo->midiInputNode;
@@ -510,26 +523,20 @@ void AAXPluginParameters::ProcessAudio(AAXAlgorithm* ioRenderInfo, const TParamV
     float* const AAX_RESTRICT grMeters = *ioRenderInfo->grMeterPtrs;
 #endif
     
-    // --- implement soft bypass
-    if(softBypass)
-    {
-        for (int ch = 0; ch < numChannelsIn; ch++)
-        {
-            const float* const AAX_RESTRICT pInputBuffer = ioRenderInfo->inputBufferPtrs[ch];
-            float* const AAX_RESTRICT pOutputBuffer = ioRenderInfo->outputBufferPtrs[ch];
-
-            for (int t = 0; t < buffersize; t ++)
-            {
-                pOutputBuffer[t] = pInputBuffer[t];
-            }
-        }
-        return;
-    }
-
     // --- audio processing
     ProcessBufferInfo info;
     info.inputs = &ioRenderInfo->inputBufferPtrs[0];
     info.outputs = &ioRenderInfo->outputBufferPtrs[0];
+
+    // --- implement soft bypass: output = input, delayed by the latency Pro Tools compensates
+    if(softBypass)
+    {
+        info.numAudioInChannels = numChannelsIn;
+        info.numAudioOutChannels = numChannelsOut;
+        info.numFramesToProcess = buffersize;
+        pluginCore->processBypassedAudioBuffers(info);
+        return;
+    }
     if(sidechainChannelIndex)
     {
         info.auxInputs = &ioRenderInfo->inputBufferPtrs[sidechainChannelIndex];
@@ -896,9 +903,10 @@ void AAXPluginParameters::DeleteUsedParameterChanges()
 //	AAXPluginGUAAXPluginParametersI::TimerWakeup()
 //
 /**
- \brief cleans out unneeded parameters
+ \brief cleans out unneeded parameters and reports latency changes
 
  NOTES:
+ - the crossover mode and oversampling change the latency while running; the host is told on the next wakeup
  - see Designing Audio Effects in C++ 2nd Ed. by Will Pirkle for more information and an AAX Programming Guide
  - see AAX SDK for more information on this function and its parameters
  */
@@ -906,6 +914,16 @@ void AAXPluginParameters::DeleteUsedParameterChanges()
 AAX_Result AAXPluginParameters::TimerWakeup()
 {
 	DeleteUsedParameterChanges();
+
+	if (pluginCore)
+	{
+		int32_t latency = (int32_t)pluginCore->getLatencyInSamples();
+		if (latency != reportedLatency)
+		{
+			reportedLatency = latency;
+			Controller()->SetSignalLatency(reportedLatency);
+		}
+	}
 	return AAX_CEffectParameters::TimerWakeup();
 }
 
@@ -960,16 +978,14 @@ void AAXPluginParameters::updateOutboundAAXParameters()
 {
     if(!pluginCore) return;
 
-    int32_t startIndex = 0;
-    while(startIndex >= 0)
+    // --- the core lists its meters once; the AAX ID is the control ID + 1, formatted without a stringstream
+    uint32_t count = pluginCore->getOutboundParameterCount();
+    for(uint32_t i = 0; i < count; i++)
     {
-        PluginParameter* piParam = pluginCore->getNextParameterOfType(startIndex, controlVariableType::kMeter);
-        if(piParam)
-        {
-            std::stringstream str;
-            str << piParam->getControlID() + 1;
-            SetMeterParameterNormalizedValue(str.str().c_str(), piParam->getControlValue());
-        }
+        PluginParameter* piParam = pluginCore->getOutboundParameter(i);
+        char parameterID[16];
+        snprintf(parameterID, sizeof(parameterID), "%u", piParam->getControlID() + 1);
+        SetMeterParameterNormalizedValue(parameterID, piParam->getControlValue());
     }
 }
 
@@ -314,6 +314,9 @@ private:
     // --- soft bypass flag
     bool softBypass = false; ///< bypass
 
+    // --- the latency last sent with SetSignalLatency(), polled in TimerWakeup() for run-time mode changes
+    int32_t reportedLatency = 0; ///< latency in samples
+
     // --- plugin core and interfaces
     PluginCore* pluginCore = nullptr;                   ///< ASPiK core
     GUIPluginConnector* guiPluginConnector = nullptr;   ///< GUI Plugin interface
@@ -887,7 +890,16 @@ public:
         return midiBuffersize;
     }
 
-    /** send MIDI event with this sample offset to the core for processing */
+    /** offset of the next packet to fire (AAX delivers them in timestamp order), kNoEvent when they have all gone */
+    virtual unsigned int getNextEventOffset()
+    {
+        if(midiBuffersize > 0 && NULL != ioPacketPtr)
+            return ioPacketPtr->mTimestamp;
+
+        return kNoEvent;
+    }
+
+    /** send the MIDI events up to and including this sample offset to the core for processing */
     virtual bool fireMidiEvents(unsigned int sampleOffset)
     {
         while( (midiBuffersize > 0) && (NULL != ioPacketPtr) && ((ioPacketPtr->mTimestamp <= sampleOffset)))
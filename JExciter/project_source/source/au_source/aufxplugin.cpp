@@ -115,6 +115,40 @@ AUFXPlugin::AUFXPlugin(AudioUnit component) : AUMIDIEffectBase(component, false)
 
     // --- final init
     initAUParametersWithPluginCore();
+
+    // --- the crossover mode and oversampling change the latency while running; poll it on the main run loop
+    CFRunLoopTimerContext timerContext = { 0, this, NULL, NULL, NULL };
+    latencyTimer = CFRunLoopTimerCreate(kCFAllocatorDefault, CFAbsoluteTimeGetCurrent() + kLatencyTimerMSec / 1000.0,
+                                        kLatencyTimerMSec / 1000.0, 0, 0, latencyTimerCallback, &timerContext);
+    if(latencyTimer)
+        CFRunLoopAddTimer(CFRunLoopGetMain(), latencyTimer, kCFRunLoopCommonModes);
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//	AUFXPlugin::latencyTimerCallback
+//
+/**
+ \brief main run loop timer: report latency changes to the host
+
+ NOTES:
+ - the core's latency follows its processing modes (linear phase crossover, oversampling)
+ - AU takes latency in seconds; GetLatency() returns the recalculated value after PropertyChanged()
+
+*/
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void AUFXPlugin::latencyTimerCallback(CFRunLoopTimerRef timer, void* info)
+{
+    AUFXPlugin* plugin = (AUFXPlugin*)info;
+    if(!plugin || !plugin->pluginCore)
+        return;
+
+    double latencyInSamples = plugin->pluginCore->getLatencyInSamples();
+    if(latencyInSamples == plugin->reportedLatencyInSamples)
+        return;
+
+    plugin->reportedLatencyInSamples = latencyInSamples;
+    plugin->latencyInSeconds = latencyInSamples / plugin->GetOutput(0)->GetStreamFormat().mSampleRate;
+    plugin->PropertyChanged(kAudioUnitProperty_Latency, kAudioUnitScope_Global, 0);
 }
 
 
@@ -132,6 +166,14 @@ AUFXPlugin::AUFXPlugin(AudioUnit component) : AUMIDIEffectBase(component, false)
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 AUFXPlugin::~AUFXPlugin()
 {
+    // --- stop the latency poll before the core goes away
+    if(latencyTimer)
+    {
+        CFRunLoopTimerInvalidate(latencyTimer);
+        CFRelease(latencyTimer);
+        latencyTimer = nullptr;
+    }
+
     // --- fixes reaper bug that destroys AU before closing GUI for final time
     if(pluginGUI)
     {
@@ -209,6 +251,8 @@ ComponentResult	AUFXPlugin::Reset(AudioUnitScope 	 inScope,
         ResetInfo info;
         info.sampleRate = GetOutput(0)->GetStreamFormat().mSampleRate;
         info.bitDepth = GetOutput(0)->GetStreamFormat().SampleWordSize() * 8;
+        info.channelIOConfig.inputChannelFormat = pluginCore->getDefaultChannelIOConfigForChannelCount(GetInput(0)->GetStreamFormat().mChannelsPerFrame);
+        info.channelIOConfig.outputChannelFormat = pluginCore->getDefaultChannelIOConfigForChannelCount(GetOutput(0)->GetStreamFormat().mChannelsPerFrame);
 
         pluginCore->reset(info);
 
@@ -279,6 +323,8 @@ ComponentResult	AUFXPlugin::Initialize()
         ResetInfo info;
         info.sampleRate = GetOutput(0)->GetStreamFormat().mSampleRate;
         info.bitDepth = GetOutput(0)->GetStreamFormat().SampleWordSize() * 8;
+        info.channelIOConfig.inputChannelFormat = pluginCore->getDefaultChannelIOConfigForChannelCount(GetInput(0)->GetStreamFormat().mChannelsPerFrame);
+        info.channelIOConfig.outputChannelFormat = pluginCore->getDefaultChannelIOConfigForChannelCount(GetOutput(0)->GetStreamFormat().mChannelsPerFrame);
 
         pluginCore->reset(info);
 
@@ -418,13 +464,12 @@ void AUFXPlugin::updateAUParametersWithPluginCore() // outbound
 {
     if(!pluginCore) return;
 
-    int32_t startIndex = 0;
-    while(startIndex >= 0)
+    // --- the core lists its meters once
+    uint32_t count = pluginCore->getOutboundParameterCount();
+    for(uint32_t i = 0; i < count; i++)
     {
-        PluginParameter* piParam = pluginCore->getNextParameterOfType(startIndex, controlVariableType::kMeter);
-
-        if(piParam)
-            Globals()->SetParameter(piParam->getControlID(), piParam->getControlValue());
+        PluginParameter* piParam = pluginCore->getOutboundParameter(i);
+        Globals()->SetParameter(piParam->getControlID(), piParam->getControlValue());
     }
 }
 
@@ -510,8 +555,10 @@ OSStatus AUFXPlugin::ProcessBufferLists(AudioUnitRenderActionFlags& ioActionFlag
 {
     if(!pluginCore) return noErr;
 
-    // --- threadsafe sync to globals
+    // --- threadsafe sync to globals, written on the audio thread
+    pluginCore->beginAudioThreadUpdates();
     updatePluginCoreParameters();
+    pluginCore->endAudioThreadUpdates();
 
     // --- switch double-queue
     if(midiEventQueue)
@@ -564,8 +611,11 @@ OSStatus AUFXPlugin::ProcessBufferLists(AudioUnitRenderActionFlags& ioActionFlag
     updateHostInfo(&hostInfo);
     info.hostInfo = &hostInfo;
 
-    // --- process the buffers
-    pluginCore->processAudioBuffers(info);
+    // --- process the buffers; bypassed, output = input delayed by the latency (see ShouldBypassEffect)
+    if(IsBypassEffect())
+        pluginCore->processBypassedAudioBuffers(info);
+    else
+        pluginCore->processAudioBuffers(info);
 
     // --- thread safe update to meters
     updateAUParametersWithPluginCore();
@@ -20,7 +20,7 @@
 #include "plugingui.h"
 #include "plugincore.h"
 #include <math.h>
-#include <queue>
+#include <vector>
 #include <string>
 
 /**
@@ -133,6 +133,9 @@ public:
     /** AU override method */
     virtual Float64	GetLatency() {return latencyInSeconds;}
 
+    /** run loop timer callback: tell the host about latency changes with PropertyChanged(kAudioUnitProperty_Latency) */
+    static void latencyTimerCallback(CFRunLoopTimerRef timer, void* info);
+
 
     /** AU override method */
     virtual ComponentResult SetParameter(AudioUnitParameterID	 inID,
@@ -147,6 +150,10 @@ public:
                             UInt32                              inNumberFrames);
 
 
+    /** AU override method: the bypass is not the base class's copy but processBypassedAudioBuffers in
+        ProcessBufferLists, which delays the input by the latency */
+    virtual bool ShouldBypassEffect() { return false; }
+
     /** AU override method */
     virtual OSStatus ProcessBufferLists(AudioUnitRenderActionFlags& ioActionFlags,
                                         const AudioBufferList&		inBuffer,
@@ -290,6 +297,9 @@ protected:
     // --- NOTE: AU takes latency in seconds, not samples; this is recalculated
     //           during init() and reset() operations
     Float64 latencyInSeconds = 0 ;                      ///< au latency (seconds!)
+    double reportedLatencyInSamples = 0.0;              ///< the latency last reported to the host; see latencyTimerCallback()
+    CFRunLoopTimerRef latencyTimer = nullptr;           ///< polls the core for processing latency changes, on the main run loop
+    enum { kLatencyTimerMSec = 50 };
 
 
     ///< VSTGUI4 Editor NOTE: this is only used to open and close the GUI
@@ -666,7 +676,10 @@ protected:
 
  NOTES:
  - the current version uses a pair of queues and an atomic boolean flag to implement a double-buffer scheme
- - this will be updated later to use a lock-free ring buffer but the operation will remain transparemt
+ - the queues are fixed arrays of kMaxEvents, so adding an event never allocates; events past that in one buffer
+   are dropped and counted (see getDroppedEventCount)
+ - toggleQueue puts the events it hands to the reading side in sample offset order; a read index then walks them
+   as the core asks for the events due (see PluginBase::beginMidiEvents)
 
  \author Will Pirkle http://www.willpirkle.com
  \remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
@@ -682,6 +695,7 @@ public:
     {
         pluginCore = _pluginCore;
         writingQueueA.store(true);
+        droppedEvents.store(0);
     };
 
     /** just clear out the events that may remain */
@@ -700,94 +714,103 @@ public:
     /** clear queue A */
     void clearQueueAEvents()
     {
-        if(midiEventQueueA.size() > 0)
-            fprintf(stderr, "midiEventQueueA.size() > 0: %u", midiEventQueueA.size() > 0);
-
-        while(midiEventQueueA.size() > 0)
-            midiEventQueueA.pop();
+        numEventsA = 0;
     }
 
     /** clear queue B */
     void clearQueueBEvents()
     {
-        if(midiEventQueueB.size() > 0)
-            fprintf(stderr, "midiEventQueueB.size() > 0: %u", midiEventQueueB.size() > 0);
-
-        while(midiEventQueueB.size() > 0)
-            midiEventQueueB.pop();
+        numEventsB = 0;
     }
 
-    /** atomic flag toggle */
+    /** atomic flag toggle; the new reading queue is sorted by sample offset */
     void toggleQueue()
     {
         // --- toggle the atomic bool
         writingQueueA = !writingQueueA;
 
-        // --- clear out write-queue (should never be non-empty)
+        // --- clear out write-queue (the events the last buffer did not reach)
         if(writingQueueA)
             clearQueueAEvents();
         else
             clearQueueBEvents();
+
+        // --- insertion sort: the events nearly always arrive in order, which costs one compare per event
+        midiEvent* readingQueue = writingQueueA ? midiEventQueueB : midiEventQueueA;
+        uint32_t numEvents = writingQueueA ? numEventsB : numEventsA;
+        for(uint32_t i = 1; i < numEvents; i++)
+        {
+            for(uint32_t j = i; j > 0 && readingQueue[j - 1].midiSampleOffset > readingQueue[j].midiSampleOffset; j--)
+                std::swap(readingQueue[j - 1], readingQueue[j]);
+        }
+        readIndex = 0;
     }
 
-    /** add a MIDI event to the currently active writing queue */
+    /** add a MIDI event to the currently active writing queue; a full queue drops it */
     inline void addEvent(midiEvent event)
     {
-        if(writingQueueA)
+        uint32_t& numEvents = writingQueueA ? numEventsA : numEventsB;
+        if(numEvents >= kMaxEvents)
         {
-            midiEventQueueA.push(event);
-           // fprintf(stderr, "QA addEvent: %u", event.midiData1);
-           // fprintf(stderr, "  with offset: %u\n", event.midiSampleOffset);
-
+            droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            return;
         }
-        else
-        {
-            midiEventQueueB.push(event);
-            //fprintf(stderr, "QB addEvent: %u", event.midiData1);
-           // fprintf(stderr, "  with offset: %u\n", event.midiSampleOffset);
 
-        }
+        if(writingQueueA)
+            midiEventQueueA[numEvents++] = event;
+        else
+            midiEventQueueB[numEvents++] = event;
     }
 
-    /** get a MIDI event from the currently active reading queue */
+    /** get the count of events not fired yet in the currently active reading queue */
     virtual unsigned int getEventCount()
     {
-        if(writingQueueA)
-            return midiEventQueueB.size();
-        else
-            return midiEventQueueA.size();
+        uint32_t numEvents = writingQueueA ? numEventsB : numEventsA;
+        return numEvents - readIndex;
     }
 
-    /** send MIDI event with this sample offset to the core for processing */
-    virtual bool fireMidiEvents(unsigned int sampleOffset)
+    /** offset of the next event to fire, kNoEvent when they have all gone */
+    virtual unsigned int getNextEventOffset()
     {
-        std::queue<midiEvent>* readingQueue = writingQueueA ? &midiEventQueueB : &midiEventQueueA;
+        const midiEvent* readingQueue = writingQueueA ? midiEventQueueB : midiEventQueueA;
+        uint32_t numEvents = writingQueueA ? numEventsB : numEventsA;
+        if(readIndex < numEvents)
+            return readingQueue[readIndex].midiSampleOffset;
 
-        if(readingQueue->size() <= 0 || !pluginCore) return false;
+        return kNoEvent;
+    }
 
-        while(readingQueue->size() > 0)
-        {
-            // --- check the current top
-            midiEvent event = readingQueue->front();
-            if(event.midiSampleOffset != sampleOffset) return false;
+    /** send the MIDI events up to and including this sample offset to the core for processing */
+    virtual bool fireMidiEvents(unsigned int sampleOffset)
+    {
+        midiEvent* readingQueue = writingQueueA ? midiEventQueueB : midiEventQueueA;
+        uint32_t numEvents = writingQueueA ? numEventsB : numEventsA;
 
-           // fprintf(stderr, "fired MIDI Event: %u", event.midiData1);
-          //  fprintf(stderr, "  with offset: %u\n", event.midiSampleOffset);
+        if(readIndex >= numEvents || !pluginCore) return false;
 
+        while(readIndex < numEvents && readingQueue[readIndex].midiSampleOffset <= sampleOffset)
+        {
             // --- send to core for processing
-            if(pluginCore)
-                pluginCore->processMIDIEvent(event);
-
-            // --- pop to remove
-            readingQueue->pop();
+            pluginCore->processMIDIEvent(readingQueue[readIndex]);
+            readIndex++;
         }
         return true;
     }
 
+    /** events dropped so far because a buffer brought more than kMaxEvents; any thread */
+    uint32_t getDroppedEventCount() const
+    {
+        return droppedEvents.load(std::memory_order_relaxed);
+    }
 
 protected:
+    enum { kMaxEvents = 1024 };                         ///< events per buffer; the rest are dropped
     PluginCore* pluginCore = nullptr;                   ///< the core object to send MIDI messages to
-    std::queue<midiEvent> midiEventQueueA;              ///< queue A
-    std::queue<midiEvent> midiEventQueueB;              ///< queue B
+    midiEvent midiEventQueueA[kMaxEvents];              ///< queue A
+    midiEvent midiEventQueueB[kMaxEvents];              ///< queue B
+    uint32_t numEventsA = 0;                            ///< events in queue A
+    uint32_t numEventsB = 0;                            ///< events in queue B
     std::atomic<bool> writingQueueA;                    ///< atomic flag for toggling buffers
+    std::atomic<uint32_t> droppedEvents;                ///< events that did not fit, since construction
+    uint32_t readIndex = 0;                             ///< next event to fire in the reading queue
 };
@@ -418,13 +418,12 @@ void AUSynthPlugin::updateAUParametersWithPluginCore() // outbound
 {
     if(!pluginCore) return;
 
-    int32_t startIndex = 0;
-    while(startIndex >= 0)
+    // --- the core lists its meters once
+    uint32_t count = pluginCore->getOutboundParameterCount();
+    for(uint32_t i = 0; i < count; i++)
     {
-        PluginParameter* piParam = pluginCore->getNextParameterOfType(startIndex, controlVariableType::kMeter);
-
-        if(piParam)
-            Globals()->SetParameter(piParam->getControlID(), piParam->getControlValue());
+        PluginParameter* piParam = pluginCore->getOutboundParameter(i);
+        Globals()->SetParameter(piParam->getControlID(), piParam->getControlValue());
     }
 }
 
@@ -0,0 +1,318 @@
+//
+//  OfflineRenderer.cpp
+//
+//  Runs PluginCore over a WAV file without a host, see OfflineRenderer.h.
+
+#include "OfflineRenderer.h"
+
+#include <chrono>
+#include <ctype.h>
+#include <errno.h>
+#include <fstream>
+#include <stdlib.h>
+#include <string.h>
+
+struct ChannelLayout {
+    const char* name;
+    uint32_t channelFormat;
+};
+
+// --- the supported channel I/O (same format in and out); the first entry for a channel count is its default
+static const ChannelLayout channelLayouts[] = {
+    { "mono", kCFMono },
+    { "stereo", kCFStereo },
+    { "lcr", kCFLCR },
+    { "quad", kCFQuad },
+    { "lcrs", kCFLCRS },
+    { "ambisonic1", kCFAmbisonic1stOrder },
+    { "5.0", kCF5p0 },
+    { "5.1", kCF5p1 },
+    { "6.0", kCF6p0 },
+    { "7.0", kCF7p0DTS },
+    { "7.0sdds", kCF7p0Sony },
+    { "6.1", kCF6p1 },
+    { "7.1", kCF7p1DTS },
+    { "7.1sdds", kCF7p1Sony },
+    { "7.1proximity", kCF7p1Proximity },
+    { "ambisonic2", kCFAmbisonic2ndOrder },
+    { "7.1.4", kCF7p1p4 },
+    { "ambisonic3", kCFAmbisonic3rdOrder },
+};
+
+static uint32_t getLayoutChannelCount(const ChannelLayout& layout) {
+    PluginDescriptor descriptor;
+    return descriptor.getChannelCountForChannelIOConfig(layout.channelFormat);
+}
+
+static std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos)
+        return std::string();
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+static bool equalsIgnoreCase(const std::string& a, const std::string& b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i]))
+            return false;
+    }
+    return true;
+}
+
+static std::string formatNumber(double value) {
+    char text[32];
+    snprintf(text, sizeof(text), "%g", value);
+    return text;
+}
+
+// --- the whole string as a number
+static bool parseNumber(const std::string& text, double& value) {
+    if (text.empty())
+        return false;
+    char* end = nullptr;
+    value = strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+
+OfflineRenderer::OfflineRenderer() {
+    PluginInfo pluginInfo;
+    pluginCore.initialize(pluginInfo);
+}
+
+OfflineRenderer::~OfflineRenderer() {
+}
+
+PluginParameter* OfflineRenderer::findParameter(const std::string& name) {
+    double controlID;
+    if (parseNumber(name, controlID)) {
+        PluginParameter* piParam = pluginCore.getPluginParameterByControlID((int32_t)controlID);
+        return piParam && !piParam->isMeterParam() ? piParam : nullptr;
+    }
+
+    for (uint32_t i = 0; i < pluginCore.getPluginParameterCount(); i++) {
+        PluginParameter* piParam = pluginCore.getPluginParameterByIndex(i);
+        if (!piParam->isMeterParam() && equalsIgnoreCase(name, piParam->getControlName()))
+            return piParam;
+    }
+    return nullptr;
+}
+
+bool OfflineRenderer::setParameterValue(PluginParameter* piParam, const std::string& value, std::string& error) {
+    double controlValue;
+    if (piParam->isStringListParam()) {
+        int index = -1;
+        for (uint32_t i = 0; i < piParam->getStringCount() && index < 0; i++) {
+            if (equalsIgnoreCase(value, trim(piParam->getStringByIndex(i))))
+                index = (int)i;
+        }
+        if (index < 0 && parseNumber(value, controlValue) && controlValue == (int)controlValue && controlValue >= 0 &&
+            controlValue < piParam->getStringCount())
+            index = (int)controlValue;
+
+        if (index < 0) {
+            error = std::string(piParam->getControlName()) + ": \"" + value + "\" is not one of " +
+                piParam->getCommaSeparatedStringList();
+            return false;
+        }
+        controlValue = index;
+    }
+    else if (!parseNumber(value, controlValue) || controlValue < piParam->getMinValue() ||
+        controlValue > piParam->getMaxValue()) {
+        error = std::string(piParam->getControlName()) + ": \"" + value + "\" is not a number from " +
+            formatNumber(piParam->getMinValue()) + " to " + formatNumber(piParam->getMaxValue());
+        return false;
+    }
+
+    // --- as a state load: no smoothing, the plugin takes it in the next buffer
+    piParam->setControlValue(controlValue, true);
+    return true;
+}
+
+bool OfflineRenderer::setParameter(const std::string& name, const std::string& value, std::string& error) {
+    PluginParameter* piParam = findParameter(trim(name));
+    if (!piParam) {
+        error = "unknown parameter \"" + trim(name) + "\"";
+        return false;
+    }
+    return setParameterValue(piParam, trim(value), error);
+}
+
+bool OfflineRenderer::loadParameterFile(const char* path, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = std::string(path) + ": " + strerror(errno);
+        return false;
+    }
+
+    // --- published together, like a preset
+    pluginCore.beginParameterUpdates();
+    bool succeeded = true;
+    std::string line;
+    for (uint32_t lineNumber = 1; succeeded && std::getline(file, line); lineNumber++) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            error = "expected Name = value";
+            succeeded = false;
+        }
+        else
+            succeeded = setParameter(line.substr(0, equals), line.substr(equals + 1), error);
+
+        if (!succeeded)
+            error = std::string(path) + ":" + std::to_string(lineNumber) + ": " + error;
+    }
+    pluginCore.endParameterUpdates();
+    return succeeded;
+}
+
+void OfflineRenderer::writeParameterFile(FILE* file) {
+    fprintf(file, "# %s parameters, Name = value\n", pluginCore.getPluginName());
+    for (uint32_t i = 0; i < pluginCore.getPluginParameterCount(); i++) {
+        PluginParameter* piParam = pluginCore.getPluginParameterByIndex(i);
+        if (piParam->isMeterParam())
+            continue;
+
+        if (piParam->isStringListParam()) {
+            uint32_t index = (uint32_t)piParam->getControlValue();
+            fprintf(file, "\n# %s\n", piParam->getCommaSeparatedStringList());
+            fprintf(file, "%s = %s\n", piParam->getControlName(), trim(piParam->getStringByIndex(index)).c_str());
+        }
+        else {
+            fprintf(file, "\n# %g to %g %s\n", piParam->getMinValue(), piParam->getMaxValue(), piParam->getControlUnits());
+            fprintf(file, "%s = %.9g\n", piParam->getControlName(), piParam->getControlValue());
+        }
+    }
+}
+
+void OfflineRenderer::writeLayoutList(FILE* file) {
+    for (const ChannelLayout& layout : channelLayouts) {
+        uint32_t count = getLayoutChannelCount(layout);
+        bool isDefault = true;
+        for (const ChannelLayout* other = channelLayouts; other != &layout && isDefault; other++)
+            isDefault = getLayoutChannelCount(*other) != count;
+
+        fprintf(file, "%-14s %2u channels%s\n", layout.name, count, isDefault ? " (default)" : "");
+    }
+}
+
+bool OfflineRenderer::setup(const WaveFormat& format, const std::string& layout, uint32_t blockSize, std::string& error) {
+    const ChannelLayout* channelLayout = nullptr;
+    for (const ChannelLayout& candidate : channelLayouts) {
+        bool matches = layout.empty() ? getLayoutChannelCount(candidate) == format.numChannels :
+            equalsIgnoreCase(layout, candidate.name);
+        if (matches) {
+            channelLayout = &candidate;
+            break;
+        }
+    }
+
+    if (!channelLayout) {
+        error = layout.empty() ? "no channel layout has " + std::to_string(format.numChannels) + " channels" :
+            "unknown layout \"" + layout + "\"";
+        return false;
+    }
+    if (getLayoutChannelCount(*channelLayout) != format.numChannels) {
+        error = "layout " + layout + " has " + std::to_string(getLayoutChannelCount(*channelLayout)) +
+            " channels, the input " + std::to_string(format.numChannels);
+        return false;
+    }
+
+    layoutName = channelLayout->name;
+    channelIOConfig = ChannelIOConfig(channelLayout->channelFormat, channelLayout->channelFormat);
+    numChannels = format.numChannels;
+    this->blockSize = blockSize;
+
+    inputBuffer.assign((size_t)numChannels * blockSize, 0.0);
+    outputBuffer.assign((size_t)numChannels * blockSize, 0.0);
+    inputs.resize(numChannels);
+    outputs.resize(numChannels);
+    writePointers.resize(numChannels);
+    for (uint32_t channel = 0; channel < numChannels; channel++) {
+        inputs[channel] = &inputBuffer[(size_t)channel * blockSize];
+        outputs[channel] = &outputBuffer[(size_t)channel * blockSize];
+    }
+
+    // --- the parameters first, so reset() sets up the crossovers, oversampling and latency for them
+    pluginCore.syncInBoundVariables();
+
+    ResetInfo resetInfo(format.sampleRate, format.getBitsPerSample());
+    resetInfo.channelIOConfig = channelIOConfig;
+    pluginCore.reset(resetInfo);
+    latency = (uint32_t)pluginCore.getLatencyInSamples();
+    return true;
+}
+
+bool OfflineRenderer::render(WaveReader& reader, WaveWriter& writer, bool compensateLatency,
+    RenderStatistics& statistics, std::string& error) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    statistics = RenderStatistics();
+
+    ProcessBufferInfo processInfo;
+    processInfo.inputs64 = inputs.data();
+    processInfo.outputs64 = outputs.data();
+    processInfo.numAudioInChannels = numChannels;
+    processInfo.numAudioOutChannels = numChannels;
+    processInfo.channelIOConfig = channelIOConfig;
+    processInfo.auxChannelIOConfig = ChannelIOConfig(kCFNone, kCFNone);
+    processInfo.hostInfo = &hostInfo;
+
+    const uint64_t skipFrames = compensateLatency ? latency : 0;
+    uint64_t inputFrames = 0;
+    uint64_t processedFrames = 0;
+    bool endOfInput = false;
+    for (;;) {
+        uint32_t numFrames = 0;
+        if (!endOfInput) {
+            numFrames = reader.read(inputs.data(), blockSize);
+            inputFrames += numFrames;
+            endOfInput = numFrames < blockSize;
+        }
+
+        // --- after the input, zeros push the frames still in the plugin out
+        if (endOfInput) {
+            uint64_t padding = inputFrames + skipFrames - processedFrames - numFrames;
+            if (padding > blockSize - numFrames)
+                padding = blockSize - numFrames;
+            for (uint32_t channel = 0; channel < numChannels; channel++)
+                memset(inputs[channel] + numFrames, 0, (size_t)padding * sizeof(double));
+            numFrames += (uint32_t)padding;
+        }
+        if (numFrames == 0)
+            break;
+
+        processInfo.numFramesToProcess = numFrames;
+        processInfo.inputSilenceFlags = 0;
+        Clock::time_point processStart = Clock::now();
+        bool processed = pluginCore.processAudioBuffers(processInfo);
+        statistics.processSeconds += std::chrono::duration<double>(Clock::now() - processStart).count();
+        if (!processed) {
+            error = std::string("the plugin does not process ") + layoutName;
+            return false;
+        }
+
+        // --- the first skipFrames output frames are the latency
+        uint64_t firstFrame = processedFrames;
+        processedFrames += numFrames;
+        uint32_t offset = 0;
+        if (firstFrame < skipFrames)
+            offset = skipFrames - firstFrame < numFrames ? (uint32_t)(skipFrames - firstFrame) : numFrames;
+
+        for (uint32_t channel = 0; channel < numChannels; channel++)
+            writePointers[channel] = outputs[channel] + offset;
+        if (!writer.write(writePointers.data(), numFrames - offset)) {
+            error = std::string("write failed: ") + strerror(errno);
+            return false;
+        }
+    }
+
+    statistics.numFrames = writer.getNumFrames();
+    statistics.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return true;
+}
@@ -0,0 +1,76 @@
+//
+//  OfflineRenderer.h
+//
+//  Runs PluginCore over a WAV file without a host: the plugin is driven through the PluginBase API the wrappers use
+//  (initialize, reset, processAudioBuffers), with no plugin SDK and no GUI.
+
+// Notes: parameters are set like a VST3 state load (published as one block, not smoothed) before setup(), which
+//        takes them into the bound variables and then resets the plugin, so the render starts on the settings
+//        instead of gliding to them. A parameter file has one "Name = value" per line, '#' starts a comment; the
+//        names are the control names (any case) or control IDs, string list values are the list entries or their
+//        index. writeParameterFile() writes the current values in the same format.
+//        The audio is processed as 64-bit buffers of blockSize frames, the same channel format in and out. With
+//        latency compensation the first getLatency() output frames are dropped and the input is followed by as
+//        many zeros, so the output lines up with the input and has its length.
+//        The channel format comes from the channel count (the first entry in the layout list with that count) or a
+//        layout name; WAV channel masks are not interpreted, they are only copied to the output.
+
+#ifndef __OfflineRenderer_h__
+#define __OfflineRenderer_h__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "plugincore.h"
+#include "WaveFile.h"
+
+struct RenderStatistics {
+    uint64_t numFrames = 0;         ///< written
+    double seconds = 0.0;           ///< wall clock, reading and writing included
+    double processSeconds = 0.0;    ///< in processAudioBuffers
+};
+
+class OfflineRenderer {
+public:
+    enum { kDefaultBlockSize = 512, kMaxBlockSize = 65536 };
+
+    OfflineRenderer();
+    ~OfflineRenderer();
+
+    // --- before setup(); false with a reason in error
+    bool setParameter(const std::string& name, const std::string& value, std::string& error);
+    bool loadParameterFile(const char* path, std::string& error);
+    void writeParameterFile(FILE* file);
+
+    // --- channel I/O for the format (layout empty = by channel count), reset for its rate
+    bool setup(const WaveFormat& format, const std::string& layout, uint32_t blockSize, std::string& error);
+    uint32_t getLatency() const { return latency; }
+    const char* getLayoutName() const { return layoutName; }
+
+    // --- the whole of reader into writer, which must have the reader's channel count
+    bool render(WaveReader& reader, WaveWriter& writer, bool compensateLatency, RenderStatistics& statistics,
+        std::string& error);
+
+    static void writeLayoutList(FILE* file);
+
+protected:
+    PluginParameter* findParameter(const std::string& name);
+    bool setParameterValue(PluginParameter* piParam, const std::string& value, std::string& error);
+
+    PluginCore pluginCore;
+    HostInfo hostInfo;
+    ChannelIOConfig channelIOConfig;
+    const char* layoutName = "";
+    uint32_t numChannels = 0;
+    uint32_t blockSize = kDefaultBlockSize;
+    uint32_t latency = 0;
+
+    std::vector<double> inputBuffer;
+    std::vector<double> outputBuffer;
+    std::vector<double*> inputs;
+    std::vector<double*> outputs;
+    std::vector<const double*> writePointers;
+};
+
+#endif
@@ -0,0 +1,496 @@
+//
+//  WaveFile.cpp
+//
+//  Streaming WAV/RF64 reader and writer for the offline renderer, see WaveFile.h.
+
+#include "WaveFile.h"
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#define fseek64 fseeko
+#define ftell64 ftello
+#define WAVEFILE_MMAP 1
+#endif
+
+static const uint64_t kMapBytes = 16 << 20;
+static const uint16_t kFormatPCM = 0x0001;
+static const uint16_t kFormatFloat = 0x0003;
+static const uint16_t kFormatExtensible = 0xFFFE;
+
+// --- the 14 bytes of the KSDATAFORMAT_SUBTYPE GUIDs after the format tag
+static const uint8_t kSubFormatGUID[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 };
+
+// --- ds64 payload: RIFF size, data size, sample count (all 64 bit), table length
+static const uint32_t kDS64Size = 28;
+
+static inline uint16_t getLE16(const uint8_t* p) { return (uint16_t)(p[0] | p[1] << 8); }
+static inline uint32_t getLE32(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+static inline uint64_t getLE64(const uint8_t* p) { return (uint64_t)getLE32(p) | (uint64_t)getLE32(p + 4) << 32; }
+
+static inline void setLE16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void setLE32(uint8_t* p, uint32_t v) { setLE16(p, (uint16_t)v); setLE16(p + 2, (uint16_t)(v >> 16)); }
+static inline void setLE64(uint8_t* p, uint64_t v) { setLE32(p, (uint32_t)v); setLE32(p + 4, (uint32_t)(v >> 32)); }
+
+uint32_t WaveFormat::getBytesPerSample() const {
+    switch (sampleFormat) {
+    case WaveSampleFormat::kPCM16: return 2;
+    case WaveSampleFormat::kPCM24: return 3;
+    case WaveSampleFormat::kFloat64: return 8;
+    default: return 4;
+    }
+}
+
+const char* getWaveSampleFormatName(WaveSampleFormat sampleFormat) {
+    switch (sampleFormat) {
+    case WaveSampleFormat::kPCM16: return "PCM 16 bit";
+    case WaveSampleFormat::kPCM24: return "PCM 24 bit";
+    case WaveSampleFormat::kPCM32: return "PCM 32 bit";
+    case WaveSampleFormat::kFloat32: return "float 32 bit";
+    case WaveSampleFormat::kFloat64: return "float 64 bit";
+    }
+    return "";
+}
+
+// --- one sample to +/-1.0
+static inline double decodePCM16(const uint8_t* p) { return (int16_t)getLE16(p) * (1.0 / 32768.0); }
+static inline double decodePCM24(const uint8_t* p) { return ((int32_t)((uint32_t)getLE16(p) << 8 | (uint32_t)p[2] << 24) >> 8) * (1.0 / 8388608.0); }
+static inline double decodePCM32(const uint8_t* p) { return (int32_t)getLE32(p) * (1.0 / 2147483648.0); }
+static inline double decodeFloat32(const uint8_t* p) { uint32_t bits = getLE32(p); float x; memcpy(&x, &bits, 4); return x; }
+static inline double decodeFloat64(const uint8_t* p) { uint64_t bits = getLE64(p); double x; memcpy(&x, &bits, 8); return x; }
+
+template <double (*decode)(const uint8_t*), uint32_t kBytes>
+static void deinterleave(const uint8_t* data, uint32_t numChannels, uint32_t frames, double* const* outputs, uint32_t offset) {
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        for (uint32_t channel = 0; channel < numChannels; channel++, data += kBytes)
+            outputs[channel][offset + frame] = decode(data);
+    }
+}
+
+// --- +/-1.0 to integer full scale, rounded, clipped and counted
+template <int kBits>
+static inline int32_t quantize(double x, uint64_t& numClipped) {
+    const double scale = (double)(1ll << (kBits - 1));
+    double scaled = x * scale;
+    if (scaled > scale - 1.0) {
+        scaled = scale - 1.0;
+        numClipped++;
+    }
+    else if (scaled < -scale) {
+        scaled = -scale;
+        numClipped++;
+    }
+    else if (scaled != scaled)
+        scaled = 0.0;
+    return (int32_t)lrint(scaled);
+}
+
+static inline void encodePCM16(uint8_t* p, double x, uint64_t& numClipped) { setLE16(p, (uint16_t)quantize<16>(x, numClipped)); }
+static inline void encodePCM24(uint8_t* p, double x, uint64_t& numClipped) {
+    uint32_t v = (uint32_t)quantize<24>(x, numClipped);
+    setLE16(p, (uint16_t)v);
+    p[2] = (uint8_t)(v >> 16);
+}
+static inline void encodePCM32(uint8_t* p, double x, uint64_t& numClipped) { setLE32(p, (uint32_t)quantize<32>(x, numClipped)); }
+static inline void encodeFloat32(uint8_t* p, double x, uint64_t&) { float f = (float)x; uint32_t bits; memcpy(&bits, &f, 4); setLE32(p, bits); }
+static inline void encodeFloat64(uint8_t* p, double x, uint64_t&) { uint64_t bits; memcpy(&bits, &x, 8); setLE64(p, bits); }
+
+template <void (*encode)(uint8_t*, double, uint64_t&), uint32_t kBytes>
+static void interleave(const double* const* inputs, uint32_t offset, uint32_t numChannels, uint32_t frames, uint8_t* data,
+    uint64_t& numClipped) {
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        for (uint32_t channel = 0; channel < numChannels; channel++, data += kBytes)
+            encode(data, inputs[channel][offset + frame], numClipped);
+    }
+}
+
+WaveReader::WaveReader() {
+}
+
+WaveReader::~WaveReader() {
+    close();
+}
+
+bool WaveReader::open(const char* path, bool useMemoryMap, std::string& error) {
+    close();
+
+    file = fopen(path, "rb");
+    if (!file) {
+        error = std::string(path) + ": " + strerror(errno);
+        return false;
+    }
+
+    fseek64(file, 0, SEEK_END);
+    fileSize = (uint64_t)ftell64(file);
+    fseek64(file, 0, SEEK_SET);
+    if (!readHeader(error)) {
+        error = std::string(path) + ": " + error;
+        close();
+        return false;
+    }
+
+    framesRead = 0;
+    bufferFrames = 0;
+    bufferPosition = 0;
+#if WAVEFILE_MMAP
+    mapping = useMemoryMap && numFrames > 0;
+#endif
+    if (!mapping) {
+        buffer.resize(kBufferFrames * format.getBytesPerFrame());
+        fseek64(file, dataOffset, SEEK_SET);
+    }
+    return true;
+}
+
+void WaveReader::close() {
+    unmapWindow();
+    mapping = false;
+    if (file)
+        fclose(file);
+    file = nullptr;
+    numFrames = 0;
+    framesRead = 0;
+}
+
+bool WaveReader::readHeader(std::string& error) {
+    uint8_t header[12];
+    if (fread(header, 1, 12, file) != 12 || memcmp(header + 8, "WAVE", 4) != 0) {
+        error = "not a WAV file";
+        return false;
+    }
+
+    bool rf64 = memcmp(header, "RF64", 4) == 0;
+    if (!rf64 && memcmp(header, "RIFF", 4) != 0) {
+        error = "not a WAV file";
+        return false;
+    }
+
+    uint64_t ds64DataSize = 0;
+    bool haveFormat = false;
+    uint64_t position = 12;
+    for (;;) {
+        uint8_t chunk[8];
+        if (fseek64(file, position, SEEK_SET) != 0 || fread(chunk, 1, 8, file) != 8) {
+            error = haveFormat ? "no data chunk" : "no fmt chunk";
+            return false;
+        }
+        uint64_t size = getLE32(chunk + 4);
+
+        if (memcmp(chunk, "ds64", 4) == 0) {
+            uint8_t ds64[kDS64Size];
+            if (size < 24 || fread(ds64, 1, 24, file) != 24) {
+                error = "bad ds64 chunk";
+                return false;
+            }
+            ds64DataSize = getLE64(ds64 + 8);
+        }
+        else if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[40];
+            size_t fmtSize = size < 40 ? (size_t)size : 40;
+            if (fmtSize < 16 || fread(fmt, 1, fmtSize, file) != fmtSize) {
+                error = "bad fmt chunk";
+                return false;
+            }
+
+            uint16_t formatTag = getLE16(fmt);
+            format.numChannels = getLE16(fmt + 2);
+            format.sampleRate = getLE32(fmt + 4);
+            uint32_t blockAlign = getLE16(fmt + 12);
+            uint32_t bits = getLE16(fmt + 14);
+            format.channelMask = 0;
+            if (formatTag == kFormatExtensible && fmtSize >= 40) {
+                format.channelMask = getLE32(fmt + 20);
+                formatTag = getLE16(fmt + 24);
+            }
+
+            if (formatTag == kFormatPCM && bits == 16)
+                format.sampleFormat = WaveSampleFormat::kPCM16;
+            else if (formatTag == kFormatPCM && bits == 24)
+                format.sampleFormat = WaveSampleFormat::kPCM24;
+            else if (formatTag == kFormatPCM && bits == 32)
+                format.sampleFormat = WaveSampleFormat::kPCM32;
+            else if (formatTag == kFormatFloat && bits == 32)
+                format.sampleFormat = WaveSampleFormat::kFloat32;
+            else if (formatTag == kFormatFloat && bits == 64)
+                format.sampleFormat = WaveSampleFormat::kFloat64;
+            else {
+                error = "unsupported sample format (format tag " + std::to_string(formatTag) + ", " + std::to_string(bits) +
+                    " bit); PCM 16/24/32 bit and float 32/64 bit are supported";
+                return false;
+            }
+
+            if (format.numChannels == 0 || format.sampleRate == 0 || blockAlign != format.getBytesPerFrame()) {
+                error = "bad fmt chunk";
+                return false;
+            }
+            haveFormat = true;
+        }
+        else if (memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) {
+                error = "no fmt chunk before the data";
+                return false;
+            }
+
+            dataOffset = position + 8;
+            uint64_t dataSize = rf64 && size == 0xFFFFFFFF ? ds64DataSize : size;
+            if (dataSize > fileSize - dataOffset)
+                dataSize = fileSize - dataOffset;
+            numFrames = dataSize / format.getBytesPerFrame();
+            return true;
+        }
+
+        position += 8 + size + (size & 1);
+    }
+}
+
+bool WaveReader::mapWindow(uint64_t fileOffset) {
+#if WAVEFILE_MMAP
+    unmapWindow();
+
+    static const uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    mapOffset = fileOffset - fileOffset % pageSize;
+    mapLength = fileSize - mapOffset < kMapBytes ? fileSize - mapOffset : kMapBytes;
+    void* address = mmap(nullptr, (size_t)mapLength, PROT_READ, MAP_PRIVATE, fileno(file), (off_t)mapOffset);
+    if (address == MAP_FAILED) {
+        mapLength = 0;
+        return false;
+    }
+    map = (uint8_t*)address;
+    madvise(address, (size_t)mapLength, MADV_SEQUENTIAL);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void WaveReader::unmapWindow() {
+#if WAVEFILE_MMAP
+    if (map)
+        munmap(map, (size_t)mapLength);
+#endif
+    map = nullptr;
+    mapOffset = 0;
+    mapLength = 0;
+}
+
+const uint8_t* WaveReader::getFrames(uint32_t& frames) {
+    const uint32_t bytesPerFrame = format.getBytesPerFrame();
+    uint64_t remaining = numFrames - framesRead;
+    if (frames > remaining)
+        frames = (uint32_t)remaining;
+    if (frames == 0)
+        return nullptr;
+
+    // --- the window always ends on a whole frame or the end of the file, so a frame never straddles two
+    if (mapping) {
+        uint64_t fileOffset = dataOffset + framesRead * bytesPerFrame;
+        if (!map || fileOffset + bytesPerFrame > mapOffset + mapLength) {
+            if (!mapWindow(fileOffset)) {
+                frames = 0;
+                return nullptr;
+            }
+        }
+        uint64_t available = (mapOffset + mapLength - fileOffset) / bytesPerFrame;
+        if (frames > available)
+            frames = (uint32_t)available;
+        return map + (fileOffset - mapOffset);
+    }
+
+    if (bufferPosition == bufferFrames) {
+        uint32_t wanted = remaining < kBufferFrames ? (uint32_t)remaining : (uint32_t)kBufferFrames;
+        bufferFrames = (uint32_t)fread(buffer.data(), bytesPerFrame, wanted, file);
+        bufferPosition = 0;
+
+        // --- a read error ends the file where it happened
+        if (bufferFrames < wanted)
+            numFrames = framesRead + bufferFrames;
+        if (bufferFrames == 0) {
+            frames = 0;
+            return nullptr;
+        }
+    }
+    if (frames > bufferFrames - bufferPosition)
+        frames = bufferFrames - bufferPosition;
+    return &buffer[bufferPosition * bytesPerFrame];
+}
+
+uint32_t WaveReader::read(double* const* outputs, uint32_t maxFrames) {
+    const uint32_t numChannels = format.numChannels;
+    uint32_t done = 0;
+    while (done < maxFrames) {
+        uint32_t frames = maxFrames - done;
+        const uint8_t* data = getFrames(frames);
+        if (!data)
+            break;
+
+        switch (format.sampleFormat) {
+        case WaveSampleFormat::kPCM16: deinterleave<decodePCM16, 2>(data, numChannels, frames, outputs, done); break;
+        case WaveSampleFormat::kPCM24: deinterleave<decodePCM24, 3>(data, numChannels, frames, outputs, done); break;
+        case WaveSampleFormat::kPCM32: deinterleave<decodePCM32, 4>(data, numChannels, frames, outputs, done); break;
+        case WaveSampleFormat::kFloat32: deinterleave<decodeFloat32, 4>(data, numChannels, frames, outputs, done); break;
+        case WaveSampleFormat::kFloat64: deinterleave<decodeFloat64, 8>(data, numChannels, frames, outputs, done); break;
+        }
+
+        framesRead += frames;
+        if (!mapping)
+            bufferPosition += frames;
+        done += frames;
+    }
+    return done;
+}
+
+WaveWriter::WaveWriter() {
+}
+
+WaveWriter::~WaveWriter() {
+    close();
+}
+
+bool WaveWriter::open(const char* path, const WaveFormat& format, std::string& error) {
+    close();
+
+    file = fopen(path, "wb");
+    if (!file) {
+        error = std::string(path) + ": " + strerror(errno);
+        return false;
+    }
+
+    this->format = format;
+    numFrames = 0;
+    numClippedSamples = 0;
+    bufferFrames = 0;
+    failed = false;
+    buffer.resize(kBufferFrames * format.getBytesPerFrame());
+
+    if (!writeHeader()) {
+        error = std::string(path) + ": " + strerror(errno);
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool WaveWriter::writeHeader() {
+    const bool extensible = format.numChannels > 2 || format.getBitsPerSample() > 16;
+    const uint32_t fmtSize = extensible ? 40 : 16;
+    const uint16_t formatTag = format.isFloat() ? kFormatFloat : kFormatPCM;
+
+    uint8_t header[12 + 8 + kDS64Size + 8 + 40 + 8] = {};
+    uint8_t* p = header;
+    memcpy(p, "RIFF", 4);
+    memcpy(p + 8, "WAVE", 4);
+    p += 12;
+
+    // --- room for the ds64 chunk, in case the file gets past 4 GB
+    memcpy(p, "JUNK", 4);
+    setLE32(p + 4, kDS64Size);
+    p += 8 + kDS64Size;
+
+    memcpy(p, "fmt ", 4);
+    setLE32(p + 4, fmtSize);
+    setLE16(p + 8, extensible ? kFormatExtensible : formatTag);
+    setLE16(p + 10, (uint16_t)format.numChannels);
+    setLE32(p + 12, format.sampleRate);
+    setLE32(p + 16, format.sampleRate * format.getBytesPerFrame());
+    setLE16(p + 20, (uint16_t)format.getBytesPerFrame());
+    setLE16(p + 22, (uint16_t)format.getBitsPerSample());
+    if (extensible) {
+        setLE16(p + 24, 22);
+        setLE16(p + 26, (uint16_t)format.getBitsPerSample());
+        setLE32(p + 28, format.channelMask);
+        setLE16(p + 32, formatTag);
+        memcpy(p + 34, kSubFormatGUID, 14);
+    }
+    p += 8 + fmtSize;
+
+    memcpy(p, "data", 4);
+    p += 8;
+    dataSizeOffset = (uint64_t)(p - header) - 4;
+
+    size_t headerSize = (size_t)(p - header);
+    return fwrite(header, 1, headerSize, file) == headerSize;
+}
+
+bool WaveWriter::flush() {
+    if (bufferFrames > 0 && fwrite(buffer.data(), format.getBytesPerFrame(), bufferFrames, file) != bufferFrames)
+        failed = true;
+    bufferFrames = 0;
+    return !failed;
+}
+
+bool WaveWriter::write(const double* const* inputs, uint32_t frames) {
+    const uint32_t numChannels = format.numChannels;
+    const uint32_t bytesPerFrame = format.getBytesPerFrame();
+    uint32_t done = 0;
+    while (done < frames) {
+        uint32_t count = frames - done < kBufferFrames - bufferFrames ? frames - done : kBufferFrames - bufferFrames;
+        uint8_t* data = &buffer[bufferFrames * bytesPerFrame];
+
+        switch (format.sampleFormat) {
+        case WaveSampleFormat::kPCM16: interleave<encodePCM16, 2>(inputs, done, numChannels, count, data, numClippedSamples); break;
+        case WaveSampleFormat::kPCM24: interleave<encodePCM24, 3>(inputs, done, numChannels, count, data, numClippedSamples); break;
+        case WaveSampleFormat::kPCM32: interleave<encodePCM32, 4>(inputs, done, numChannels, count, data, numClippedSamples); break;
+        case WaveSampleFormat::kFloat32: interleave<encodeFloat32, 4>(inputs, done, numChannels, count, data, numClippedSamples); break;
+        case WaveSampleFormat::kFloat64: interleave<encodeFloat64, 8>(inputs, done, numChannels, count, data, numClippedSamples); break;
+        }
+
+        bufferFrames += count;
+        done += count;
+        if (bufferFrames == kBufferFrames && !flush())
+            return false;
+    }
+    numFrames += frames;
+    return !failed;
+}
+
+bool WaveWriter::close() {
+    if (!file)
+        return true;
+
+    flush();
+    uint64_t dataSize = numFrames * format.getBytesPerFrame();
+    if (dataSize & 1) {
+        uint8_t pad = 0;
+        if (fwrite(&pad, 1, 1, file) != 1)
+            failed = true;
+    }
+    uint64_t riffSize = (uint64_t)ftell64(file) - 8;
+
+    uint8_t size[4];
+    if (riffSize <= 0xFFFFFFFF) {
+        setLE32(size, (uint32_t)riffSize);
+        fseek64(file, 4, SEEK_SET);
+        fwrite(size, 1, 4, file);
+        setLE32(size, (uint32_t)dataSize);
+    }
+    else {
+        // --- RF64: the 32 bit sizes are all ones and the real ones go in the ds64 chunk over the JUNK
+        uint8_t header[12 + 8 + kDS64Size] = {};
+        memcpy(header, "RF64", 4);
+        setLE32(header + 4, 0xFFFFFFFF);
+        memcpy(header + 8, "WAVE", 4);
+        memcpy(header + 12, "ds64", 4);
+        setLE32(header + 16, kDS64Size);
+        setLE64(header + 20, riffSize);
+        setLE64(header + 28, dataSize);
+        setLE64(header + 36, numFrames);
+        fseek64(file, 0, SEEK_SET);
+        fwrite(header, 1, sizeof(header), file);
+        setLE32(size, 0xFFFFFFFF);
+    }
+    fseek64(file, dataSizeOffset, SEEK_SET);
+    if (fwrite(size, 1, 4, file) != 4)
+        failed = true;
+
+    if (fclose(file) != 0)
+        failed = true;
+    file = nullptr;
+    return !failed;
+}
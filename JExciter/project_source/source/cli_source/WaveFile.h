@@ -0,0 +1,120 @@
+//
+//  WaveFile.h
+//
+//  Streaming WAV/RF64 reader and writer for the offline renderer: frames go in and out as planar double channel
+//  buffers through a fixed-size interleaved buffer, so memory does not grow with the file.
+
+// Notes: the reader takes RIFF/WAVE and RF64 (EBU Tech 3306, sizes in the ds64 chunk), PCM 16/24/32 bit and IEEE
+//        float 32/64 bit, plain or WAVE_FORMAT_EXTENSIBLE. Chunks after the data chunk are not read; a data size
+//        past the end of the file (a capture that was never closed) is cut to what is there.
+//        Where mmap is available the data is read through a 16 MB window slid along the file (the pages it
+//        leaves are unmapped, so they do not add up either); otherwise, or with useMemoryMap false, it is read
+//        with fread into kBufferFrames frames.
+//        The writer reserves room for a ds64 chunk with a JUNK chunk and fills the sizes in at close(): a file
+//        that stays under 4 GB is a plain RIFF/WAVE, a larger one becomes RF64 in place. More than 2 channels or
+//        more than 16 bits are written as WAVE_FORMAT_EXTENSIBLE, with the reader's channel mask when there is one.
+//        Integer output is rounded and clipped to full scale; float output is written as is.
+
+#ifndef __WaveFile_h__
+#define __WaveFile_h__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+enum class WaveSampleFormat { kPCM16, kPCM24, kPCM32, kFloat32, kFloat64 };
+
+struct WaveFormat {
+    uint32_t numChannels = 0;
+    uint32_t sampleRate = 0;
+    WaveSampleFormat sampleFormat = WaveSampleFormat::kPCM16;
+    uint32_t channelMask = 0;       ///< WAVE_FORMAT_EXTENSIBLE speaker mask, 0 = not given
+
+    uint32_t getBytesPerSample() const;
+    uint32_t getBitsPerSample() const { return 8 * getBytesPerSample(); }
+    uint32_t getBytesPerFrame() const { return numChannels * getBytesPerSample(); }
+    bool isFloat() const { return sampleFormat == WaveSampleFormat::kFloat32 || sampleFormat == WaveSampleFormat::kFloat64; }
+};
+
+// --- "PCM 16 bit", "float 32 bit", ...
+const char* getWaveSampleFormatName(WaveSampleFormat sampleFormat);
+
+class WaveReader {
+public:
+    enum { kBufferFrames = 4096 };
+
+    WaveReader();
+    ~WaveReader();
+
+    // --- false with a reason in error
+    bool open(const char* path, bool useMemoryMap, std::string& error);
+    void close();
+
+    const WaveFormat& getFormat() const { return format; }
+    uint64_t getNumFrames() const { return numFrames; }
+    bool isMemoryMapped() const { return mapping; }
+
+    // --- up to maxFrames into the channel buffers, as +/-1.0 full scale; returns the frames read, 0 at the end
+    uint32_t read(double* const* outputs, uint32_t maxFrames);
+
+protected:
+    bool readHeader(std::string& error);
+    const uint8_t* getFrames(uint32_t& frames);
+    bool mapWindow(uint64_t fileOffset);
+    void unmapWindow();
+
+    FILE* file = nullptr;
+    WaveFormat format;
+    uint64_t fileSize = 0;
+    uint64_t dataOffset = 0;        ///< of the first frame in the file
+    uint64_t numFrames = 0;
+    uint64_t framesRead = 0;
+
+    // --- fread
+    std::vector<uint8_t> buffer;
+    uint32_t bufferFrames = 0;      ///< frames in the buffer
+    uint32_t bufferPosition = 0;    ///< next frame in the buffer
+
+    // --- mmap window, [mapOffset, mapOffset + mapLength) of the file
+    bool mapping = false;
+    uint8_t* map = nullptr;
+    uint64_t mapOffset = 0;
+    uint64_t mapLength = 0;
+};
+
+class WaveWriter {
+public:
+    enum { kBufferFrames = 4096 };
+
+    WaveWriter();
+    ~WaveWriter();
+
+    // --- creates or truncates path; false with a reason in error
+    bool open(const char* path, const WaveFormat& format, std::string& error);
+
+    // --- frames from the channel buffers; false on a write error
+    bool write(const double* const* inputs, uint32_t frames);
+
+    // --- flushes and fills in the header sizes; the file is only valid after this
+    bool close();
+
+    uint64_t getNumFrames() const { return numFrames; }
+    uint64_t getNumClippedSamples() const { return numClippedSamples; }
+
+protected:
+    bool writeHeader();
+    bool flush();
+
+    FILE* file = nullptr;
+    WaveFormat format;
+    uint64_t numFrames = 0;
+    uint64_t numClippedSamples = 0;
+    uint64_t dataSizeOffset = 0;    ///< of the data chunk's size field
+    bool failed = false;
+
+    std::vector<uint8_t> buffer;
+    uint32_t bufferFrames = 0;
+};
+
+#endif
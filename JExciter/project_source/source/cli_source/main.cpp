@@ -0,0 +1,197 @@
+//
+//  main.cpp
+//
+//  Command line offline renderer: runs the plugin over a WAV/RF64 file with no host, see OfflineRenderer.h.
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "OfflineRenderer.h"
+#include "WaveFile.h"
+
+static void printUsage(FILE* file, const char* program) {
+    fprintf(file,
+        "usage: %s [options] input.wav output.wav\n"
+        "\n"
+        "  -p, --parameters FILE   set the parameters in FILE (Name = value per line)\n"
+        "  -s, --set NAME=VALUE    set one parameter, after the parameter file\n"
+        "  -l, --layout NAME       channel layout (default: from the channel count)\n"
+        "  -b, --block FRAMES      frames per process call, 1-%d (default %d)\n"
+        "  -f, --format FORMAT     output pcm16, pcm24, pcm32, float32 or float64 (default: the input's)\n"
+        "      --keep-latency      do not compensate the plugin latency\n"
+        "      --no-mmap           read the input with buffered reads instead of memory mapping\n"
+        "  -q, --quiet             no report\n"
+        "      --list-parameters   write the parameters in parameter file format and exit\n"
+        "      --list-layouts      list the channel layouts and exit\n"
+        "  -h, --help\n",
+        program, (int)OfflineRenderer::kMaxBlockSize, (int)OfflineRenderer::kDefaultBlockSize);
+}
+
+static bool parseSampleFormat(const char* name, WaveSampleFormat& sampleFormat) {
+    static const struct { const char* name; WaveSampleFormat sampleFormat; } formats[] = {
+        { "pcm16", WaveSampleFormat::kPCM16 },
+        { "pcm24", WaveSampleFormat::kPCM24 },
+        { "pcm32", WaveSampleFormat::kPCM32 },
+        { "float32", WaveSampleFormat::kFloat32 },
+        { "float64", WaveSampleFormat::kFloat64 },
+    };
+    for (const auto& format : formats) {
+        if (strcmp(name, format.name) == 0) {
+            sampleFormat = format.sampleFormat;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    const char* program = argv[0];
+    const char* parameterFile = nullptr;
+    std::vector<std::string> parameterSettings;
+    std::string layout;
+    uint32_t blockSize = OfflineRenderer::kDefaultBlockSize;
+    bool overrideFormat = false;
+    WaveSampleFormat outputSampleFormat = WaveSampleFormat::kPCM16;
+    bool compensateLatency = true;
+    bool useMemoryMap = true;
+    bool quiet = false;
+    bool listParameters = false;
+    std::vector<const char*> paths;
+
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "-h" || option == "--help") {
+            printUsage(stdout, program);
+            return 0;
+        }
+        else if ((option == "-p" || option == "--parameters") && hasValue)
+            parameterFile = argv[++i];
+        else if ((option == "-s" || option == "--set") && hasValue)
+            parameterSettings.push_back(argv[++i]);
+        else if ((option == "-l" || option == "--layout") && hasValue)
+            layout = argv[++i];
+        else if ((option == "-b" || option == "--block") && hasValue) {
+            long frames = strtol(argv[++i], nullptr, 10);
+            if (frames < 1 || frames > OfflineRenderer::kMaxBlockSize) {
+                fprintf(stderr, "%s: the block size must be 1-%d frames\n", program, (int)OfflineRenderer::kMaxBlockSize);
+                return 2;
+            }
+            blockSize = (uint32_t)frames;
+        }
+        else if ((option == "-f" || option == "--format") && hasValue) {
+            if (!parseSampleFormat(argv[++i], outputSampleFormat)) {
+                fprintf(stderr, "%s: unknown format %s\n", program, argv[i]);
+                return 2;
+            }
+            overrideFormat = true;
+        }
+        else if (option == "--keep-latency")
+            compensateLatency = false;
+        else if (option == "--no-mmap")
+            useMemoryMap = false;
+        else if (option == "-q" || option == "--quiet")
+            quiet = true;
+        else if (option == "--list-parameters")
+            listParameters = true;
+        else if (option == "--list-layouts") {
+            OfflineRenderer::writeLayoutList(stdout);
+            return 0;
+        }
+        else if (option.size() > 1 && option[0] == '-') {
+            fprintf(stderr, "%s: unknown option or missing value: %s\n", program, option.c_str());
+            printUsage(stderr, program);
+            return 2;
+        }
+        else
+            paths.push_back(argv[i]);
+    }
+
+    // --- the plugin is big (FIR tables, channel states), so not on the stack
+    std::unique_ptr<OfflineRenderer> renderer(new OfflineRenderer);
+    std::string error;
+    if (parameterFile && !renderer->loadParameterFile(parameterFile, error)) {
+        fprintf(stderr, "%s: %s\n", program, error.c_str());
+        return 1;
+    }
+    for (const std::string& setting : parameterSettings) {
+        size_t equals = setting.find('=');
+        if (equals == std::string::npos) {
+            fprintf(stderr, "%s: --set takes NAME=VALUE, not %s\n", program, setting.c_str());
+            return 2;
+        }
+        if (!renderer->setParameter(setting.substr(0, equals), setting.substr(equals + 1), error)) {
+            fprintf(stderr, "%s: %s\n", program, error.c_str());
+            return 1;
+        }
+    }
+
+    if (listParameters) {
+        renderer->writeParameterFile(stdout);
+        return 0;
+    }
+
+    if (paths.size() != 2) {
+        printUsage(stderr, program);
+        return 2;
+    }
+    if (strcmp(paths[0], paths[1]) == 0) {
+        fprintf(stderr, "%s: the output must not be the input\n", program);
+        return 2;
+    }
+
+    WaveReader reader;
+    if (!reader.open(paths[0], useMemoryMap, error)) {
+        fprintf(stderr, "%s: %s\n", program, error.c_str());
+        return 1;
+    }
+    const WaveFormat& inputFormat = reader.getFormat();
+    if (!renderer->setup(inputFormat, layout, blockSize, error)) {
+        fprintf(stderr, "%s: %s: %s\n", program, paths[0], error.c_str());
+        return 1;
+    }
+
+    WaveFormat outputFormat = inputFormat;
+    if (overrideFormat)
+        outputFormat.sampleFormat = outputSampleFormat;
+    WaveWriter writer;
+    if (!writer.open(paths[1], outputFormat, error)) {
+        fprintf(stderr, "%s: %s\n", program, error.c_str());
+        return 1;
+    }
+
+    RenderStatistics statistics;
+    bool rendered = renderer->render(reader, writer, compensateLatency, statistics, error);
+    if (!writer.close() && rendered) {
+        rendered = false;
+        error = std::string("write failed: ") + strerror(errno);
+    }
+    if (!rendered) {
+        fprintf(stderr, "%s: %s: %s\n", program, paths[1], error.c_str());
+        remove(paths[1]);
+        return 1;
+    }
+
+    if (!quiet) {
+        double audioSeconds = (double)statistics.numFrames / inputFormat.sampleRate;
+        double samples = (double)statistics.numFrames * inputFormat.numChannels;
+        fprintf(stderr, "%s: %u Hz, %s, %s, %s\n", paths[0], inputFormat.sampleRate, renderer->getLayoutName(),
+            getWaveSampleFormatName(inputFormat.sampleFormat), reader.isMemoryMapped() ? "memory mapped" : "buffered");
+        fprintf(stderr, "%s: %s, latency %u frames%s\n", paths[1], getWaveSampleFormatName(outputFormat.sampleFormat),
+            renderer->getLatency(), compensateLatency ? " (compensated)" : "");
+        fprintf(stderr, "rendered %llu frames (%.2f s) in %.3f s: %.0f samples/s, %.1fx realtime "
+            "(plugin %.3f s: %.0f samples/s, %.1fx realtime)\n",
+            (unsigned long long)statistics.numFrames, audioSeconds, statistics.seconds,
+            statistics.seconds > 0.0 ? samples / statistics.seconds : 0.0,
+            statistics.seconds > 0.0 ? audioSeconds / statistics.seconds : 0.0, statistics.processSeconds,
+            statistics.processSeconds > 0.0 ? samples / statistics.processSeconds : 0.0,
+            statistics.processSeconds > 0.0 ? audioSeconds / statistics.processSeconds : 0.0);
+        if (writer.getNumClippedSamples() > 0)
+            fprintf(stderr, "%llu samples clipped\n", (unsigned long long)writer.getNumClippedSamples());
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+//
+//  AliasingSweepTest.cpp
+//
+//  Aliasing of one saturated band: the plain waveshaper, first order ADAA, and the 2x and 4x Oversampler paths,
+//  measured on a sine sweep; every step up the list must fold less energy back below Nyquist. Their costs are
+//  timed too: ADAA must stay cheaper than 2x oversampling, the next step up in quality.
+
+// Notes: a 0.5 amplitude sine steps from 500 Hz to 18 kHz at 44.1 kHz. Each tone sits on an odd FFT bin so its
+//        harmonics land on multiples of that bin; everything else below Nyquist is folded (aliased) energy, taken
+//        relative to the fundamental. Each step reports the mean and worst figure of the sweep. The limits
+//        leave a few dB on the figures measured when ADAA was added (Sat 12 dB: plain -21.2/-15.3,
+//        ADAA -28.7/-17.9, 2x -39.5/-27.9, 4x -76.2/-63.7 dB).
+//        The costs are the fastest of 7 runs over 10 s of a 0.5 amplitude 1 kHz sine at Sat 12 dB, printed
+//        relative to plain.
+
+#include <math.h>
+#include <algorithm>
+#include <complex>
+#include <vector>
+#include "Oversampler.h"
+#include "TanhWaveshaper.h"
+#include "TestSupport.h"
+
+enum AntialiasingMode { kPlainMode, kADAAMode, kOversample2xMode, kOversample4xMode, kNumAntialiasingModes };
+static const char* kModeNames[] = { "plain", "ADAA", "2x", "4x" };
+
+static const double kSampleRate = 44100.0;
+static const uint32_t kFFTSize = 16384;
+static const uint32_t kBufferFrames = 128;
+static const double kAmplitude = 0.5;
+static const uint32_t kTimedFrames = 441000;           // 10 s
+static const double kTimedDrive = 3.98107170553497;    // +12 dB
+
+// --- mean limits at Sat 12 dB, in dB re the fundamental (plain has none, it is the reference)
+static const double kMaxMeanAliasing12dB[kNumAntialiasingModes] = { 0.0, -26.0, -37.0, -72.0 };
+
+struct SweepResult {
+    double meanDb;
+    double worstDb;
+};
+
+// --- in place radix 2 FFT
+static void fft(std::vector<std::complex<double>>& data) {
+    size_t size = data.size();
+    for (size_t i = 1, j = 0; i < size; i++) {
+        size_t bit = size >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(data[i], data[j]);
+    }
+    for (size_t length = 2; length <= size; length <<= 1) {
+        double angle = -2.0 * M_PI / length;
+        std::complex<double> rotation(cos(angle), sin(angle));
+        for (size_t i = 0; i < size; i += length) {
+            std::complex<double> w(1.0);
+            for (size_t j = 0; j < length / 2; j++) {
+                std::complex<double> u = data[i + j];
+                std::complex<double> v = data[i + j + length / 2] * w;
+                data[i + j] = u + v;
+                data[i + j + length / 2] = u - v;
+                w *= rotation;
+            }
+        }
+    }
+}
+
+// --- one band the way PluginCore runs it: upsample, saturate, downsample, in fixed buffers
+static std::vector<double> processBand(AntialiasingMode mode, double drive, const std::vector<double>& input) {
+    TanhWaveshaper waveshaper;
+    waveshaper.setDrive(drive);
+    if (mode == kADAAMode)
+        waveshaper.setAntialiasing(kFirstOrderADAA);
+    Oversampler oversampler;
+    oversampler.setFactor(mode == kOversample2xMode ? 2 : (mode == kOversample4xMode ? 4 : 1), kSampleRate);
+
+    std::vector<double> oversampled(kBufferFrames * Oversampler::kMaxFactor);
+    std::vector<double> output(input.size());
+    for (size_t offset = 0; offset < input.size(); offset += kBufferFrames) {
+        uint32_t numFrames = (uint32_t)std::min<size_t>(kBufferFrames, input.size() - offset);
+        if (oversampler.getFactor() > 1) {
+            uint32_t numSamples = numFrames * oversampler.getFactor();
+            oversampler.upsample(&input[offset], oversampled.data(), numFrames);
+            waveshaper.processBlock(oversampled.data(), oversampled.data(), numSamples);
+            oversampler.downsample(oversampled.data(), &output[offset], numFrames);
+        }
+        else
+            waveshaper.processBlock(&input[offset], &output[offset], numFrames);
+    }
+    return output;
+}
+
+// --- folded energy re the fundamental over the sweep, from the last FFT frame (the first two settle the filters)
+static void measureSweep(double satDb, SweepResult* results) {
+    double drive = pow(10.0, satDb / 20.0);
+    double sum[kNumAntialiasingModes] = {};
+    uint32_t numTones = 0;
+    for (int mode = 0; mode < kNumAntialiasingModes; mode++)
+        results[mode].worstDb = -1000.0;
+
+    for (double frequency = 500.0; frequency <= 18000.0; frequency *= 1.12) {
+        uint32_t toneBin = (uint32_t)(frequency / kSampleRate * kFFTSize) | 1;
+        std::vector<double> input(3 * kFFTSize);
+        for (size_t i = 0; i < input.size(); i++)
+            input[i] = kAmplitude * sin(2.0 * M_PI * toneBin * i / kFFTSize);
+
+        for (int mode = 0; mode < kNumAntialiasingModes; mode++) {
+            std::vector<double> output = processBand((AntialiasingMode)mode, drive, input);
+            std::vector<std::complex<double>> spectrum(output.end() - kFFTSize, output.end());
+            fft(spectrum);
+
+            double folded = 0.0;
+            for (uint32_t bin = 1; bin < kFFTSize / 2; bin++) {
+                if (bin % toneBin != 0)
+                    folded += std::norm(spectrum[bin]);
+            }
+            double ratio = folded / std::norm(spectrum[toneBin]);
+            sum[mode] += ratio;
+            results[mode].worstDb = fmax(results[mode].worstDb, 10.0 * log10(ratio + 1e-30));
+        }
+        numTones++;
+    }
+    for (int mode = 0; mode < kNumAntialiasingModes; mode++)
+        results[mode].meanDb = 10.0 * log10(sum[mode] / numTones);
+}
+
+int main() {
+    for (double satDb : { 12.0, 24.0 }) {
+        SweepResult results[kNumAntialiasingModes];
+        measureSweep(satDb, results);
+        for (int mode = 0; mode < kNumAntialiasingModes; mode++)
+            printf("note   Sat %.0f dB %-5s mean %6.1f dB  worst %6.1f dB\n", satDb, kModeNames[mode],
+                results[mode].meanDb, results[mode].worstDb);
+
+        for (int mode = kADAAMode; mode < kNumAntialiasingModes; mode++) {
+            check(results[mode].meanDb < results[mode - 1].meanDb && results[mode].worstDb < results[mode - 1].worstDb,
+                "Sat %.0f dB: %s folds less than %s", satDb, kModeNames[mode], kModeNames[mode - 1]);
+            if (satDb == 12.0)
+                check(results[mode].meanDb <= kMaxMeanAliasing12dB[mode], "Sat 12 dB: %s mean %.1f dB <= %.1f dB",
+                    kModeNames[mode], results[mode].meanDb, kMaxMeanAliasing12dB[mode]);
+        }
+    }
+
+    // --- the costs, with the same buffers and setup as the measurements
+    std::vector<double> input(kTimedFrames);
+    for (uint32_t i = 0; i < kTimedFrames; i++)
+        input[i] = kAmplitude * sin(2.0 * M_PI * 1000.0 * i / kSampleRate);
+    double seconds[kNumAntialiasingModes];
+    for (int mode = 0; mode < kNumAntialiasingModes; mode++) {
+        seconds[mode] = getFastestSeconds([&]() { processBand((AntialiasingMode)mode, kTimedDrive, input); }, 7);
+        printf("note   %-5s %.4f s for 10 s, %.2fx plain\n", kModeNames[mode], seconds[mode],
+            seconds[mode] / seconds[kPlainMode]);
+    }
+    checkSpeed(seconds[kADAAMode] < seconds[kOversample2xMode], "ADAA %.2fx cheaper than 2x oversampling",
+        seconds[kOversample2xMode] / seconds[kADAAMode]);
+
+    return getTestResult();
+}
@@ -0,0 +1,240 @@
+//
+//  AutomationBenchmark.cpp
+//
+//  VST3 sample accurate automation, dense points on the band, volume and crossover parameters: the sub-block path
+//  (buffers split at the points, cooked values ramped across each sub-block) must match the per-frame queue path it
+//  replaces and run at least 3x faster with a point every 8 or more frames, or with a granularity of 16.
+
+// Notes: 2 s of stereo noise at 48 kHz in 512 frame buffers, timed as the fastest of 5 runs. The host queue is
+//        modelled by AutomationQueue, which answers both the per-frame getNextValue() and the sub-block queries
+//        from the same points, so the two paths see identical automation. The band switches carry points too
+//        (on, not soloed) so that every parameter's queue is visited, as when a host automates all of them; the
+//        per-frame path only reads the queues of smoothable parameters, so the switches are also set up front.
+//        The outputs are compared after the first buffer, where the block path starts its ramps from the reset
+//        values. The crossover targets move once per sub-block rather than per frame, so the crossover glide
+//        follows up to a sub-block later; that is most of the difference (-46 dB with a point every 32 frames,
+//        about -70 dB without the crossovers automated). A point on every frame with granularity 1 makes 1 frame
+//        sub-blocks, bit identical to the per-frame path; its speed is printed, not limited.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "plugincore.h"
+#include "TestSupport.h"
+
+static const double kSampleRate = 48000.0;
+static const uint32_t kBufferFrames = 512;
+static const uint32_t kNumFrames = 96000;              // 2 s
+static const double kMinSpeedup = 3.0;
+static const double kMaxDifferenceDb = -40.0;
+
+// --- the automated parameters: the 17 of the original plugin and the crossover frequencies
+static const int32_t kAutomatedIDs[] = { ControlID::LowOn, ControlID::LowMidOn, ControlID::HighMidOn,
+    ControlID::TrebleOn, ControlID::LowSolo, ControlID::LowMidSolo, ControlID::HighMidSolo, ControlID::TrebleSolo,
+    ControlID::LowSat, ControlID::LowMidSat, ControlID::HighMidSat, ControlID::TrebleSat, ControlID::LowMix,
+    ControlID::LowMidMix, ControlID::HighMidMix, ControlID::TrebleMix, ControlID::MasterVolume,
+    ControlID::LowCrossover, ControlID::MidCrossover, ControlID::HighCrossover };
+
+enum { kNumAutomated = sizeof(kAutomatedIDs) / sizeof(kAutomatedIDs[0]) };
+
+struct Scenario {
+    uint32_t pointSpacing;
+    uint32_t granularity;
+    bool speedLimit;
+};
+
+static const Scenario kScenarios[] = { { 32, 1, true }, { 8, 1, true }, { 1, 16, true }, { 1, 1, false } };
+
+// --- the normalized automation curve of a parameter at a time in seconds
+static double getAutomationValue(int32_t controlID, double seconds) {
+    if (controlID <= ControlID::TrebleOn)
+        return 1.0;
+    if (controlID <= ControlID::TrebleSolo)
+        return 0.0;
+    return 0.5 + 0.45 * sin(2.0 * M_PI * (0.3 + 0.07 * controlID) * seconds + controlID);
+}
+
+// --- one buffer of host automation points; values are linear between the points, as VST3 defines them, starting
+//     from the parameter's value at the end of the previous buffer
+class AutomationQueue : public IParameterUpdateQueue {
+public:
+    void setPoints(uint32_t _parameterIndex, uint32_t _granularity, double _startValue,
+        const std::vector<uint32_t>& _offsets, const std::vector<double>& _values) {
+        parameterIndex = _parameterIndex;
+        granularity = _granularity;
+        previousValue = _startValue;
+        offsets = _offsets;
+        values = _values;
+        frame = 0;
+        pointIndex = 0;
+        previousPointOffset = -1;
+        previousPointValue = _startValue;
+    }
+
+    virtual uint32_t getParameterIndex() { return parameterIndex; }
+
+    virtual bool getValueAtOffset(long int _sampleOffset, double _previousValue, double& _nextValue) {
+        _nextValue = getInterpolatedValue((uint32_t)_sampleOffset);
+        return _nextValue != _previousValue;
+    }
+
+    // --- the per-frame path: one call per frame, the value only on the granularity and the points, when it changed
+    virtual bool getNextValue(double& _nextValue) {
+        uint32_t sampleOffset = frame++;
+        if (sampleOffset % granularity != 0 && getNextPointOffset(sampleOffset) != sampleOffset)
+            return false;
+        double value = getInterpolatedValue(sampleOffset);
+        if (value == previousValue)
+            return false;
+        _nextValue = previousValue = value;
+        return true;
+    }
+
+    virtual uint32_t getNextPointOffset(uint32_t _sampleOffset) {
+        seekPoint(_sampleOffset);
+        return pointIndex < offsets.size() ? offsets[pointIndex] : kBufferFrames;
+    }
+
+    virtual double getInterpolatedValue(uint32_t _sampleOffset) {
+        seekPoint(_sampleOffset);
+        if (pointIndex >= offsets.size())
+            return previousPointValue;
+        return previousPointValue + (values[pointIndex] - previousPointValue) *
+            ((int32_t)_sampleOffset - previousPointOffset) / (double)((int32_t)offsets[pointIndex] - previousPointOffset);
+    }
+
+private:
+    uint32_t parameterIndex = 0;
+    uint32_t granularity = 1;
+    double previousValue = 0.0;
+    std::vector<uint32_t> offsets;
+    std::vector<double> values;
+    uint32_t frame = 0;
+
+    // --- the first point at or after the last query and the one before it; queries only move forward in a buffer
+    size_t pointIndex = 0;
+    int32_t previousPointOffset = -1;
+    double previousPointValue = 0.0;
+
+    void seekPoint(uint32_t _sampleOffset) {
+        for (; pointIndex < offsets.size() && offsets[pointIndex] < _sampleOffset; pointIndex++) {
+            previousPointOffset = (int32_t)offsets[pointIndex];
+            previousPointValue = values[pointIndex];
+        }
+    }
+};
+
+// --- the VST3 description settings are protected; a host would get them from plugindescription.h
+class AutomationCore : public PluginCore {
+public:
+    void setSampleAccurateAutomation(bool subBlocks, uint32_t granularity) {
+        apiSpecificInfo.enableVST3SampleAccurateSubBlocks = subBlocks;
+        apiSpecificInfo.vst3SampleAccurateGranularity = granularity;
+    }
+};
+
+static std::vector<float> makeNoise(uint32_t numFrames, unsigned seed) {
+    srand(seed);
+    std::vector<float> noise(numFrames);
+    for (uint32_t i = 0; i < numFrames; i++)
+        noise[i] = (float)(0.5 * (2.0 * rand() / RAND_MAX - 1.0));
+    return noise;
+}
+
+// --- renders the input with automation on every parameter; returns the seconds spent in processAudioBuffers
+static double render(const Scenario& scenario, bool subBlocks, std::vector<float>* input, std::vector<float>* output) {
+    AutomationCore* pluginCore = new AutomationCore();
+    PluginInfo pluginInfo;
+    pluginCore->initialize(pluginInfo);
+    pluginCore->setSampleAccurateAutomation(subBlocks, scenario.granularity);
+    for (int32_t band = 0; band < 4; band++)
+        pluginCore->getPluginParameterByControlID(ControlID::LowOn + band)->setControlValue(1.0, true);
+    ResetInfo resetInfo(kSampleRate, 32);
+    resetInfo.channelIOConfig = ChannelIOConfig(kCFStereo, kCFStereo);
+    pluginCore->reset(resetInfo);
+
+    HostInfo hostInfo;
+    hostInfo.enableVSTSampleAccurateAutomation = true;
+    ProcessBufferInfo processInfo;
+    processInfo.numAudioInChannels = 2;
+    processInfo.numAudioOutChannels = 2;
+    processInfo.channelIOConfig = ChannelIOConfig(kCFStereo, kCFStereo);
+    processInfo.auxChannelIOConfig = ChannelIOConfig(kCFNone, kCFNone);
+    processInfo.hostInfo = &hostInfo;
+    processInfo.numFramesToProcess = kBufferFrames;
+
+    AutomationQueue queues[kNumAutomated];
+    std::vector<uint32_t> offsets;
+    for (uint32_t offset = scenario.pointSpacing - 1; offset < kBufferFrames; offset += scenario.pointSpacing)
+        offsets.push_back(offset);
+    std::vector<double> values(offsets.size());
+
+    typedef std::chrono::steady_clock Clock;
+    double seconds = 0.0;
+    for (uint32_t frame = 0; frame + kBufferFrames <= kNumFrames; frame += kBufferFrames) {
+        for (uint32_t i = 0; i < kNumAutomated; i++) {
+            PluginParameter* piParam = pluginCore->getPluginParameterByControlID(kAutomatedIDs[i]);
+            for (size_t point = 0; point < offsets.size(); point++)
+                values[point] = getAutomationValue(kAutomatedIDs[i], (frame + offsets[point]) / kSampleRate);
+            queues[i].setPoints(kAutomatedIDs[i], scenario.granularity, piParam->getControlValueNormalized(), offsets,
+                values);
+            piParam->setParameterUpdateQueue(&queues[i]);
+        }
+
+        float* inputs[2] = { &input[0][frame], &input[1][frame] };
+        float* outputs[2] = { &output[0][frame], &output[1][frame] };
+        processInfo.inputs = inputs;
+        processInfo.outputs = outputs;
+
+        Clock::time_point start = Clock::now();
+        pluginCore->processAudioBuffers(processInfo);
+        seconds += std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    delete pluginCore;
+    return seconds;
+}
+
+int main() {
+    std::vector<float> input[2] = { makeNoise(kNumFrames, 1), makeNoise(kNumFrames, 2) };
+    std::vector<float> frameOutput[2] = { std::vector<float>(kNumFrames), std::vector<float>(kNumFrames) };
+    std::vector<float> subBlockOutput[2] = { std::vector<float>(kNumFrames), std::vector<float>(kNumFrames) };
+    double audioSeconds = kNumFrames / kSampleRate;
+
+    for (const Scenario& scenario : kScenarios) {
+        double frameSeconds = 0.0;
+        double subBlockSeconds = 0.0;
+        for (int run = 0; run < 5; run++) {
+            double seconds = render(scenario, false, input, frameOutput);
+            frameSeconds = run == 0 ? seconds : fmin(frameSeconds, seconds);
+            seconds = render(scenario, true, input, subBlockOutput);
+            subBlockSeconds = run == 0 ? seconds : fmin(subBlockSeconds, seconds);
+        }
+
+        double signal = 0.0;
+        double difference = 0.0;
+        for (uint32_t channel = 0; channel < 2; channel++) {
+            for (uint32_t i = kBufferFrames; i < kNumFrames; i++) {
+                double error = (double)subBlockOutput[channel][i] - frameOutput[channel][i];
+                signal += (double)frameOutput[channel][i] * frameOutput[channel][i];
+                difference += error * error;
+            }
+        }
+        double differenceDb = 10.0 * log10(difference / signal + 1e-30);
+
+        char name[64];
+        snprintf(name, sizeof(name), "a point every %u frame%s, granularity %u", scenario.pointSpacing,
+            scenario.pointSpacing > 1 ? "s" : "", scenario.granularity);
+        double speedup = frameSeconds / subBlockSeconds;
+        printf("note   %s: per frame %.1f ms, sub-blocks %.1f ms per second of audio, %.2fx\n", name,
+            1000.0 * frameSeconds / audioSeconds, 1000.0 * subBlockSeconds / audioSeconds, speedup);
+
+        check(differenceDb <= kMaxDifferenceDb, "%s: sub-blocks within %.1f dB of the per frame path (<= %.0f dB)",
+            name, differenceDb, kMaxDifferenceDb);
+        if (scenario.speedLimit)
+            checkSpeed(speedup >= kMinSpeedup, "%s: sub-blocks %.2fx faster >= %.1fx", name, speedup, kMinSpeedup);
+    }
+
+    return getTestResult();
+}
@@ -0,0 +1,110 @@
+//
+//  DSPLoadTest.cpp
+//
+//  The DSP load PluginCore reports (PLUGIN_QUERY_DSPLOAD) against the wall clock time of the same process calls,
+//  in linear phase mode at 64 and 128 frame buffers, where the FFT partition runs in one buffer of four or two.
+
+// Notes: only DSP_PROFILING builds have a profiler; other builds skip. The profiler's window is exactly the
+//        buffers timed here, so the two figures measure the same calls and may only differ by the call overhead
+//        and the counter calibration: a profiler that sampled the buffers in step with the partition reported
+//        three times the wall clock load at 64 frames.
+
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include "plugincore.h"
+#include "TestSupport.h"
+
+#if DSP_PROFILING
+
+static const double kSampleRate = 48000.0;
+static const double kMaxLoadError = 0.25;           // relative to the wall clock load
+static const double kMinLoadError = 0.05;           // % of the budget, for loads too small to compare relatively
+static const uint32_t kWarmUpBuffers = 2048;
+
+static PluginCore* createPluginCore() {
+    PluginCore* pluginCore = new PluginCore();
+    PluginInfo pluginInfo;
+    pluginCore->initialize(pluginInfo);
+    return pluginCore;
+}
+
+static void setParameter(PluginCore& pluginCore, int32_t controlID, double value) {
+    pluginCore.getPluginParameterByControlID(controlID)->setControlValue(value, true);
+}
+
+static void checkLoad(uint32_t bufferFrames) {
+    PluginCore* pluginCore = createPluginCore();
+    setParameter(*pluginCore, ControlID::CrossoverMode, 1.0);
+    for (int32_t band = 0; band < 4; band++) {
+        setParameter(*pluginCore, ControlID::LowOn + band, 1.0);
+        setParameter(*pluginCore, ControlID::LowSat + band, 12.0);
+    }
+    pluginCore->syncInBoundVariables();
+    ResetInfo resetInfo(kSampleRate, 32);
+    resetInfo.channelIOConfig = ChannelIOConfig(kCFStereo, kCFStereo);
+    pluginCore->reset(resetInfo);
+
+    // --- noise, so no chunk is skipped as silence
+    uint32_t numWindowFrames = DSPProfiler::kWindowBuffers * bufferFrames;
+    std::vector<double> input[2] = { std::vector<double>(numWindowFrames), std::vector<double>(numWindowFrames) };
+    std::vector<double> output[2] = { std::vector<double>(bufferFrames), std::vector<double>(bufferFrames) };
+    srand(1);
+    for (uint32_t i = 0; i < numWindowFrames; i++) {
+        input[0][i] = 0.5 * (2.0 * rand() / RAND_MAX - 1.0);
+        input[1][i] = 0.5 * (2.0 * rand() / RAND_MAX - 1.0);
+    }
+
+    HostInfo hostInfo;
+    double* inputs[2];
+    double* outputs[2] = { output[0].data(), output[1].data() };
+    ProcessBufferInfo processInfo;
+    processInfo.inputs64 = inputs;
+    processInfo.outputs64 = outputs;
+    processInfo.numAudioInChannels = 2;
+    processInfo.numAudioOutChannels = 2;
+    processInfo.channelIOConfig = ChannelIOConfig(kCFStereo, kCFStereo);
+    processInfo.auxChannelIOConfig = ChannelIOConfig(kCFNone, kCFNone);
+    processInfo.hostInfo = &hostInfo;
+    processInfo.numFramesToProcess = bufferFrames;
+
+    // --- the timed stretch replaces the whole window
+    auto processWindow = [&](uint32_t numBuffers) {
+        for (uint32_t buffer = 0; buffer < numBuffers; buffer++) {
+            uint32_t offset = (buffer % DSPProfiler::kWindowBuffers) * bufferFrames;
+            inputs[0] = &input[0][offset];
+            inputs[1] = &input[1][offset];
+            pluginCore->processAudioBuffers(processInfo);
+        }
+    };
+    processWindow(kWarmUpBuffers);
+    double seconds = getFastestSeconds([&]() { processWindow(DSPProfiler::kWindowBuffers); }, 1);
+    double wallClockLoad = 100.0 * seconds * kSampleRate / numWindowFrames;
+
+    DSPLoadInfo loadInfo;
+    MessageInfo messageInfo(PLUGIN_QUERY_DSPLOAD);
+    messageInfo.outMessageData = &loadInfo;
+    bool queried = pluginCore->processMessage(messageInfo);
+    double error = fabs(loadInfo.total.mean - wallClockLoad);
+    check(queried && loadInfo.numBuffers == DSPProfiler::kWindowBuffers &&
+        error <= kMaxLoadError * wallClockLoad + kMinLoadError,
+        "linear phase, %u frame buffers: mean load %.2f %% over %u buffers, %.2f %% by the wall clock",
+        bufferFrames, loadInfo.total.mean, loadInfo.numBuffers, wallClockLoad);
+    delete pluginCore;
+}
+
+int main() {
+    for (uint32_t bufferFrames : { 64u, 128u })
+        checkLoad(bufferFrames);
+
+    return getTestResult();
+}
+
+#else
+
+int main() {
+    printf("skipped: the DSP load profiler is only built with DSP_PROFILING\n");
+    return kSkipTest;
+}
+
+#endif
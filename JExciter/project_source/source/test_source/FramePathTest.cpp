@@ -0,0 +1,129 @@
+//
+//  FramePathTest.cpp
+//
+//  The block path (processAudioBuffers in chunks) against the frame path it replaced (setFrameProcessing): with the
+//  parameters held still the two must render bit identical output, in every saturation and crossover mode, mono
+//  and stereo, at 64 and 500 frame buffers.
+
+// Notes: the frame path runs on float frames, so both paths get float buffers. 1 s of noise at 48 kHz, with the
+//        last 0.25 s silent so the block path's silence skipping is covered too: once the band tails are under
+//        its threshold (-140 dB) it outputs zeros, where the frame path still renders the decaying tails, so there
+//        the block path must be 0 and the frame path under the threshold. Every band is on with +12 dB of Sat at
+//        60 % Mix and -3 dB Master Volume, so each stage of the kernels shows in the output.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "plugincore.h"
+#include "TestSupport.h"
+
+static const double kSampleRate = 48000.0;
+static const uint32_t kNumFrames = 48000;
+static const uint32_t kSilentFrames = 12000;
+static const double kSilenceThreshold = 1.0e-7;     // PluginCore::kSilenceThreshold
+
+struct Mode {
+    const char* name;
+    double satQuality;
+    double antialiasing;
+    double oversampling;
+    double crossoverMode;
+};
+
+static const Mode kModes[] = { { "plain", 0.0, 0.0, 0.0, 0.0 }, { "ADAA", 0.0, 1.0, 0.0, 0.0 },
+                               { "oversampling", 0.0, 0.0, 1.0, 0.0 }, { "linear phase", 0.0, 0.0, 0.0, 1.0 },
+                               { "rational", 1.0, 0.0, 0.0, 0.0 } };
+
+// --- per band oversampling with Oversampling ON (1x, 2x, 4x index)
+static const int kBandFactors[4] = { 0, 1, 2, 1 };
+
+static void setParameter(PluginCore& pluginCore, int32_t controlID, double value) {
+    pluginCore.getPluginParameterByControlID(controlID)->setControlValue(value, true);
+}
+
+static std::vector<float> render(const Mode& mode, uint32_t numChannels, uint32_t bufferFrames, bool frameProcessing,
+    const std::vector<float>* input) {
+    PluginCore* pluginCore = new PluginCore();
+    PluginInfo pluginInfo;
+    pluginCore->initialize(pluginInfo);
+    pluginCore->setFrameProcessing(frameProcessing);
+
+    for (int32_t band = 0; band < 4; band++) {
+        setParameter(*pluginCore, ControlID::LowOn + band, 1.0);
+        setParameter(*pluginCore, ControlID::LowSat + band, 12.0);
+        setParameter(*pluginCore, ControlID::LowMix + band, 60.0);
+        setParameter(*pluginCore, ControlID::LowOversampling + band, kBandFactors[band]);
+    }
+    setParameter(*pluginCore, ControlID::MasterVolume, -3.0);
+    setParameter(*pluginCore, ControlID::SatQuality, mode.satQuality);
+    setParameter(*pluginCore, ControlID::SatAntialiasing, mode.antialiasing);
+    setParameter(*pluginCore, ControlID::Oversampling, mode.oversampling);
+    setParameter(*pluginCore, ControlID::CrossoverMode, mode.crossoverMode);
+
+    uint32_t channelFormat = numChannels == 1 ? kCFMono : kCFStereo;
+    pluginCore->syncInBoundVariables();
+    ResetInfo resetInfo(kSampleRate, 32);
+    resetInfo.channelIOConfig = ChannelIOConfig(channelFormat, channelFormat);
+    pluginCore->reset(resetInfo);
+
+    std::vector<float> output[2] = { std::vector<float>(kNumFrames), std::vector<float>(kNumFrames) };
+    HostInfo hostInfo;
+    float* inputs[2];
+    float* outputs[2];
+    ProcessBufferInfo processInfo;
+    processInfo.inputs = inputs;
+    processInfo.outputs = outputs;
+    processInfo.numAudioInChannels = numChannels;
+    processInfo.numAudioOutChannels = numChannels;
+    processInfo.channelIOConfig = ChannelIOConfig(channelFormat, channelFormat);
+    processInfo.auxChannelIOConfig = ChannelIOConfig(kCFNone, kCFNone);
+    processInfo.hostInfo = &hostInfo;
+
+    for (uint32_t offset = 0; offset < kNumFrames; offset += bufferFrames) {
+        for (uint32_t channel = 0; channel < 2; channel++) {
+            inputs[channel] = const_cast<float*>(&input[channel][offset]);
+            outputs[channel] = &output[channel][offset];
+        }
+        processInfo.numFramesToProcess = std::min(bufferFrames, kNumFrames - offset);
+        pluginCore->processAudioBuffers(processInfo);
+    }
+    delete pluginCore;
+
+    output[0].insert(output[0].end(), output[1].begin(), output[1].begin() + (numChannels > 1 ? kNumFrames : 0));
+    return output[0];
+}
+
+int main() {
+    std::vector<float> input[2] = { std::vector<float>(kNumFrames), std::vector<float>(kNumFrames) };
+    srand(1);
+    for (uint32_t channel = 0; channel < 2; channel++) {
+        for (uint32_t i = 0; i < kNumFrames - kSilentFrames; i++)
+            input[channel][i] = (float)(0.5 * (2.0 * rand() / RAND_MAX - 1.0));
+    }
+
+    for (const Mode& mode : kModes) {
+        for (uint32_t numChannels : { 1u, 2u }) {
+            for (uint32_t bufferFrames : { 64u, 500u }) {
+                std::vector<float> framePath = render(mode, numChannels, bufferFrames, true, input);
+                std::vector<float> blockPath = render(mode, numChannels, bufferFrames, false, input);
+                uint32_t numDiffering = 0;
+                uint32_t numSkipped = 0;
+                for (size_t i = 0; i < framePath.size(); i++) {
+                    if (memcmp(&framePath[i], &blockPath[i], sizeof(float)) == 0)
+                        continue;
+                    bool inSilence = i % kNumFrames >= kNumFrames - kSilentFrames;
+                    if (inSilence && blockPath[i] == 0.0f && fabs(framePath[i]) < kSilenceThreshold)
+                        numSkipped++;
+                    else
+                        numDiffering++;
+                }
+                check(numDiffering == 0, "%s, %s, %u frame buffers: block path bit identical to the frame path "
+                    "(%u samples differ, %u skipped as silence)", mode.name, numChannels == 1 ? "mono" : "stereo",
+                    bufferFrames, numDiffering, numSkipped);
+            }
+        }
+    }
+
+    return getTestResult();
+}
@@ -0,0 +1,189 @@
+//
+//  LatencyTest.cpp
+//
+//  The latency PluginCore reports against the delay of an impulse through it, in every crossover mode and
+//  oversampling setting at 44.1k and 96k, after a mode change while running, and in the wrappers' soft bypass.
+
+// Notes: the impulse is small, so even saturated bands are linear. With every Mix at 0 the output is the band sum,
+//        which in linear phase mode is the input delayed by exactly the latency; the Linkwitz-Riley sum is an
+//        allpass whose impulse response peaks one sample in, so IIR peaks land one sample after the latency.
+//        With every Mix at 100 the wet bands must peak at the same place: the 1x bands are delayed to line up
+//        with the oversampled ones.
+
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "plugincore.h"
+#include "TestSupport.h"
+
+static const uint32_t kBlockFrames = 64;
+static const double kImpulse = 0.01;
+
+enum { kNumFactorSets = 5 };
+
+// --- per band oversampling (1x, 2x, 4x index); the first set runs with Oversampling OFF
+static const int kFactorSets[kNumFactorSets][4] = { { 0, 0, 2, 2 }, { 0, 0, 0, 0 }, { 0, 0, 1, 2 }, { 1, 1, 1, 1 },
+                                                    { 2, 0, 2, 0 } };
+
+static PluginCore* createPluginCore() {
+    PluginCore* pluginCore = new PluginCore();
+    PluginInfo pluginInfo;
+    pluginCore->initialize(pluginInfo);
+    return pluginCore;
+}
+
+static void setParameter(PluginCore& pluginCore, int32_t controlID, double value) {
+    pluginCore.getPluginParameterByControlID(controlID)->setControlValue(value, true);
+}
+
+// --- every band on (the On switches default to OFF: " ON" in "OFF, ON" does not match the default "ON")
+static void setBands(PluginCore& pluginCore, double mix) {
+    for (int32_t band = 0; band < 4; band++) {
+        setParameter(pluginCore, ControlID::LowOn + band, 1.0);
+        setParameter(pluginCore, ControlID::LowSat + band, 12.0);
+        setParameter(pluginCore, ControlID::LowMix + band, mix);
+    }
+}
+
+static void startStream(PluginCore& pluginCore, double sampleRate) {
+    pluginCore.syncInBoundVariables();
+    ResetInfo resetInfo(sampleRate, 32);
+    resetInfo.channelIOConfig = ChannelIOConfig(kCFStereo, kCFStereo);
+    pluginCore.reset(resetInfo);
+}
+
+// --- the output of one channel for an impulse at frame 0, numFrames long
+static std::vector<double> processImpulse(PluginCore& pluginCore, uint32_t numFrames, bool bypassed = false) {
+    HostInfo hostInfo;
+    std::vector<double> input[2] = { std::vector<double>(kBlockFrames), std::vector<double>(kBlockFrames) };
+    std::vector<double> output[2] = { std::vector<double>(kBlockFrames), std::vector<double>(kBlockFrames) };
+    double* inputs[2] = { input[0].data(), input[1].data() };
+    double* outputs[2] = { output[0].data(), output[1].data() };
+
+    ProcessBufferInfo processInfo;
+    processInfo.inputs64 = inputs;
+    processInfo.outputs64 = outputs;
+    processInfo.numAudioInChannels = 2;
+    processInfo.numAudioOutChannels = 2;
+    processInfo.channelIOConfig = ChannelIOConfig(kCFStereo, kCFStereo);
+    processInfo.auxChannelIOConfig = ChannelIOConfig(kCFNone, kCFNone);
+    processInfo.hostInfo = &hostInfo;
+    processInfo.numFramesToProcess = kBlockFrames;
+
+    std::vector<double> response;
+    for (uint32_t frame = 0; frame < numFrames; frame += kBlockFrames) {
+        input[0][0] = input[1][0] = frame == 0 ? kImpulse : 0.0;
+        if (bypassed)
+            pluginCore.processBypassedAudioBuffers(processInfo);
+        else
+            pluginCore.processAudioBuffers(processInfo);
+        response.insert(response.end(), output[0].begin(), output[0].end());
+    }
+    return response;
+}
+
+static uint32_t getPeakFrame(const std::vector<double>& response) {
+    uint32_t peak = 0;
+    for (uint32_t i = 1; i < response.size(); i++) {
+        if (fabs(response[i]) > fabs(response[peak]))
+            peak = i;
+    }
+    return peak;
+}
+
+static void checkImpulse(PluginCore& pluginCore, bool linearPhase, const char* name) {
+    uint32_t latency = (uint32_t)pluginCore.getLatencyInSamples();
+    uint32_t expected = latency + (linearPhase ? 0 : 1);
+    std::vector<double> response = processImpulse(pluginCore, latency + 4096);
+    uint32_t peak = getPeakFrame(response);
+    check(peak == expected, "%s: latency %u, impulse peak at %u (%u expected)", name, latency, peak, expected);
+}
+
+static void checkMode(double sampleRate, bool linearPhase, int factorSet) {
+    char name[128];
+    int length = snprintf(name, sizeof(name), "%.1fk %s, oversampling ", sampleRate / 1000.0,
+        linearPhase ? "linear phase" : "IIR");
+    if (factorSet == 0)
+        snprintf(name + length, sizeof(name) - length, "OFF");
+    else
+        snprintf(name + length, sizeof(name) - length, "%dx %dx %dx %dx", 1 << kFactorSets[factorSet][0],
+            1 << kFactorSets[factorSet][1], 1 << kFactorSets[factorSet][2], 1 << kFactorSets[factorSet][3]);
+
+    for (double mix : { 0.0, 100.0 }) {
+        PluginCore* pluginCore = createPluginCore();
+        setParameter(*pluginCore, ControlID::CrossoverMode, linearPhase ? 1.0 : 0.0);
+        setParameter(*pluginCore, ControlID::Oversampling, factorSet ? 1.0 : 0.0);
+        for (int32_t band = 0; band < 4; band++)
+            setParameter(*pluginCore, ControlID::LowOversampling + band, kFactorSets[factorSet][band]);
+        setBands(*pluginCore, mix);
+        startStream(*pluginCore, sampleRate);
+
+        std::string mixName = std::string(name) + (mix == 0.0 ? ", dry" : ", wet");
+        checkImpulse(*pluginCore, linearPhase, mixName.c_str());
+        delete pluginCore;
+    }
+}
+
+// --- switching modes while running: the reported latency follows at once, and the impulses match it
+static void checkModeChanges(double sampleRate) {
+    PluginCore* pluginCore = createPluginCore();
+    setBands(*pluginCore, 100.0);
+    startStream(*pluginCore, sampleRate);
+    check(pluginCore->getLatencyInSamples() == 0.0, "%.1fk IIR without oversampling reports no latency",
+        sampleRate / 1000.0);
+
+    struct Change { int32_t controlID; double value; bool linearPhase; const char* name; };
+    const Change changes[] = { { ControlID::CrossoverMode, 1.0, true, "to linear phase" },
+                               { ControlID::Oversampling, 1.0, true, "oversampling on" },
+                               { ControlID::CrossoverMode, 0.0, false, "back to IIR" },
+                               { ControlID::Oversampling, 0.0, false, "oversampling off" } };
+    for (const Change& change : changes) {
+        pluginCore->getPluginParameterByControlID(change.controlID)->setControlValue(change.value, false);
+        processImpulse(*pluginCore, 16384);
+
+        char name[64];
+        snprintf(name, sizeof(name), "%.1fk run time change %s", sampleRate / 1000.0, change.name);
+        checkImpulse(*pluginCore, change.linearPhase, name);
+    }
+    delete pluginCore;
+}
+
+// --- bypassed, the impulse comes out untouched at the latency; processing afterwards is in time again
+static void checkBypass(double sampleRate, bool linearPhase, int factorSet) {
+    PluginCore* pluginCore = createPluginCore();
+    setParameter(*pluginCore, ControlID::CrossoverMode, linearPhase ? 1.0 : 0.0);
+    setParameter(*pluginCore, ControlID::Oversampling, factorSet ? 1.0 : 0.0);
+    for (int32_t band = 0; band < 4; band++)
+        setParameter(*pluginCore, ControlID::LowOversampling + band, kFactorSets[factorSet][band]);
+    setBands(*pluginCore, 100.0);
+    startStream(*pluginCore, sampleRate);
+    processImpulse(*pluginCore, 8192);
+
+    uint32_t latency = (uint32_t)pluginCore->getLatencyInSamples();
+    std::vector<double> response = processImpulse(*pluginCore, latency + 4096, true);
+    uint32_t peak = getPeakFrame(response);
+    char name[64];
+    snprintf(name, sizeof(name), "%.1fk %s bypassed", sampleRate / 1000.0, linearPhase ? "linear phase" : "IIR");
+    check(peak == latency && response[peak] == kImpulse, "%s: latency %u, impulse of %g at %u", name, latency,
+        response[peak], peak);
+
+    snprintf(name, sizeof(name), "%.1fk %s after the bypass", sampleRate / 1000.0,
+        linearPhase ? "linear phase" : "IIR");
+    checkImpulse(*pluginCore, linearPhase, name);
+    delete pluginCore;
+}
+
+int main() {
+    for (double sampleRate : { 44100.0, 96000.0 }) {
+        for (bool linearPhase : { false, true }) {
+            for (int factorSet = 0; factorSet < kNumFactorSets; factorSet++)
+                checkMode(sampleRate, linearPhase, factorSet);
+        }
+        checkModeChanges(sampleRate);
+        checkBypass(sampleRate, true, 0);
+        checkBypass(sampleRate, false, 3);
+    }
+
+    return getTestResult();
+}
@@ -0,0 +1,79 @@
+//
+//  ParameterSnapshotTest.cpp
+//
+//  Presets through the ParameterSnapshot: a writer thread publishes one preset after another between beginWrite
+//  and endWrite while the reader (the audio thread) reads as fast as it can; every read must apply a whole
+//  preset or none of it, never a mix of two.
+
+// Notes: 150 parameters, so a preset spans three flag words. Parameter i of preset p holds p * 1000 + i, with p
+//        counting 1..1000 and round again, so every value tells which preset it came from. Until the reader has
+//        seen its first change the values are the initial zeros, which are not checked. The writer rests 20 us
+//        between presets (still thousands of recalls a second): a group that starts during a read undoes it, so
+//        a writer that never rests would starve the reader, and the test checks that presets do get applied.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "ParameterSnapshot.h"
+#include "TestSupport.h"
+
+static const uint32_t kNumParameters = 150;
+static const uint32_t kNumPresets = 1000;
+static const uint32_t kPresetGapMicroseconds = 20;
+static const double kRunSeconds = 0.5;
+
+int main() {
+    ParameterSnapshot snapshot;
+    snapshot.setSize(kNumParameters);
+
+    std::atomic<bool> running(true);
+    std::thread writer([&]() {
+        for (uint32_t preset = 1; running.load(); preset = preset % kNumPresets + 1) {
+            snapshot.beginWrite();
+            for (uint32_t i = 0; i < kNumParameters; i++)
+                snapshot.write(i, (float)(preset * 1000 + i), false);
+            snapshot.endWrite();
+            std::this_thread::sleep_for(std::chrono::microseconds(kPresetGapMicroseconds));
+        }
+    });
+
+    uint32_t numReads = 0;
+    uint32_t numApplied = 0;
+    uint32_t numPartial = 0;
+    uint32_t numTorn = 0;
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    while (std::chrono::duration<double>(Clock::now() - start).count() < kRunSeconds) {
+        snapshot.read();
+        numReads++;
+
+        // --- the changed bits: all of the preset or none
+        uint32_t numChanged = 0;
+        for (uint32_t i = 0; i < kNumParameters; i++)
+            numChanged += (snapshot.getChangedFlags()[i / 64] >> (i % 64)) & 1;
+        if (numChanged == kNumParameters)
+            numApplied++;
+        else if (numChanged != 0)
+            numPartial++;
+        if (numApplied == 0)
+            continue;
+
+        // --- the values: all from one preset
+        uint32_t preset = (uint32_t)snapshot.getValue(0) / 1000;
+        for (uint32_t i = 0; i < kNumParameters; i++) {
+            if (snapshot.getValue(i) != (float)(preset * 1000 + i)) {
+                numTorn++;
+                break;
+            }
+        }
+    }
+    running.store(false);
+    writer.join();
+
+    printf("note   %u reads in %.1f s, %u applied a preset\n", numReads, kRunSeconds, numApplied);
+    check(numTorn == 0, "every read holds one whole preset (%u torn)", numTorn);
+    check(numPartial == 0, "every read changes all of a preset or none of it (%u partial)", numPartial);
+    check(numApplied > 0, "presets are applied while the reader races the writer");
+
+    return getTestResult();
+}
@@ -0,0 +1,190 @@
+//
+//  StereoCrossoverBenchmark.cpp
+//
+//  Stereo pairs in shared SIMD lanes: LinkwitzRileyStereoCrossover must match two LinkwitzRileyCrossover instances
+//  bit for bit on every kernel, and its block path with the vector waveshaper must run at least 2.5x faster than
+//  the per channel path it replaced (two 4 lane crossovers and libm tanh per sample).
+
+// Notes: the work per 64 frame buffer is the band split, the saturation of every band and the band sum, at 96 kHz
+//        with +12 dB drive, timed over 10 s of noise as the fastest of 7 runs. The speed limit needs AVX2, where
+//        a stereo frame is one 8 lane pass; other CPUs run the equality checks and print the figures.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "LinkwitzRileyCrossover.h"
+#include "TanhWaveshaper.h"
+#include "TestSupport.h"
+
+static const char* kKernelNames[] = { "scalar", "SSE2", "AVX2" };
+
+static const double kSampleRate = 96000.0;
+static const uint32_t kBufferFrames = 64;
+static const uint32_t kNumFrames = 960000;             // 10 s
+static const double kDrive = 3.98107170553497;          // +12 dB
+static const double kMinSpeedup = 2.5;
+
+enum { kNumBands = LinkwitzRileyCrossover::kNumBands };
+
+struct BandBuffers {
+    double data[kNumBands][kBufferFrames];
+    double* bands[kNumBands];
+
+    BandBuffers() {
+        for (uint32_t band = 0; band < kNumBands; band++)
+            bands[band] = data[band];
+    }
+};
+
+static std::vector<double> makeNoise(uint32_t numFrames, unsigned seed) {
+    srand(seed);
+    std::vector<double> noise(numFrames);
+    for (uint32_t i = 0; i < numFrames; i++)
+        noise[i] = 0.5 * (2.0 * rand() / RAND_MAX - 1.0);
+    return noise;
+}
+
+static void sumBands(double* const* bands, TanhWaveshaper* waveshapers, double* output) {
+    for (uint32_t band = 0; band < kNumBands; band++)
+        waveshapers[band].processBlock(bands[band], bands[band], kBufferFrames);
+    for (uint32_t i = 0; i < kBufferFrames; i++)
+        output[i] = bands[0][i] - bands[1][i] + bands[2][i] - bands[3][i];
+}
+
+// --- the path before the stereo lanes: one crossover per channel, the scalar (libm) waveshaper
+struct ChannelPath {
+    LinkwitzRileyCrossover crossover[2];
+    TanhWaveshaper waveshapers[2][kNumBands];
+    BandBuffers buffers[2];
+
+    ChannelPath(SIMDKernel kernel) {
+        for (uint32_t channel = 0; channel < 2; channel++) {
+            crossover[channel].setKernel(kernel);
+            crossover[channel].setCrossover(120.0, 1000.0, 6000.0, kSampleRate);
+            for (uint32_t band = 0; band < kNumBands; band++) {
+                waveshapers[channel][band].setKernel(kScalarKernel);
+                waveshapers[channel][band].setDrive(kDrive);
+            }
+        }
+    }
+
+    void process(const double* const* input, double* const* output, uint32_t numFrames) {
+        for (uint32_t offset = 0; offset < numFrames; offset += kBufferFrames) {
+            for (uint32_t channel = 0; channel < 2; channel++) {
+                crossover[channel].processBlock(input[channel] + offset, buffers[channel].bands, kBufferFrames);
+                sumBands(buffers[channel].bands, waveshapers[channel], output[channel] + offset);
+            }
+        }
+    }
+};
+
+// --- the stereo lane path: one 8 lane crossover for the pair, the vector waveshaper
+struct StereoPath {
+    LinkwitzRileyStereoCrossover crossover;
+    TanhWaveshaper waveshapers[2][kNumBands];
+    BandBuffers buffers[2];
+
+    StereoPath(SIMDKernel kernel) {
+        crossover.setKernel(kernel);
+        crossover.setCrossover(120.0, 1000.0, 6000.0, kSampleRate);
+        for (uint32_t channel = 0; channel < 2; channel++) {
+            for (uint32_t band = 0; band < kNumBands; band++) {
+                waveshapers[channel][band].setKernel(kernel);
+                waveshapers[channel][band].setDrive(kDrive);
+            }
+        }
+    }
+
+    void process(const double* const* input, double* const* output, uint32_t numFrames) {
+        for (uint32_t offset = 0; offset < numFrames; offset += kBufferFrames) {
+            crossover.processBlock(input[0] + offset, input[1] + offset, buffers[0].bands, buffers[1].bands,
+                kBufferFrames);
+            for (uint32_t channel = 0; channel < 2; channel++)
+                sumBands(buffers[channel].bands, waveshapers[channel], output[channel] + offset);
+        }
+    }
+};
+
+// --- the bands of a stereo crossover against two mono ones, float and double input, in odd block lengths
+static void checkStereoMatchesMono(SIMDKernel kernel, const std::vector<double>& left, const std::vector<double>& right) {
+    LinkwitzRileyCrossover mono[2];
+    LinkwitzRileyStereoCrossover stereo;
+    stereo.setKernel(kernel);
+    stereo.setCrossover(120.0, 1000.0, 6000.0, 44100.0);
+    for (uint32_t channel = 0; channel < 2; channel++) {
+        mono[channel].setKernel(kScalarKernel);
+        mono[channel].setCrossover(120.0, 1000.0, 6000.0, 44100.0);
+    }
+
+    std::vector<float> leftFloat(left.begin(), left.end());
+    std::vector<float> rightFloat(right.begin(), right.end());
+    BandBuffers monoBands[2];
+    BandBuffers stereoBands[2];
+    bool identical = true;
+    uint32_t blockSizes[] = { 1, 13, 64, 31 };
+    uint32_t offset = 0;
+    for (uint32_t block = 0; offset + kBufferFrames <= 100000; block++) {
+        uint32_t numFrames = blockSizes[block % 4];
+        if (block % 2) {
+            mono[0].processBlock(&leftFloat[offset], monoBands[0].bands, numFrames);
+            mono[1].processBlock(&rightFloat[offset], monoBands[1].bands, numFrames);
+            stereo.processBlock(&leftFloat[offset], &rightFloat[offset], stereoBands[0].bands, stereoBands[1].bands,
+                numFrames);
+        }
+        else {
+            mono[0].processBlock(&left[offset], monoBands[0].bands, numFrames);
+            mono[1].processBlock(&right[offset], monoBands[1].bands, numFrames);
+            stereo.processBlock(&left[offset], &right[offset], stereoBands[0].bands, stereoBands[1].bands, numFrames);
+        }
+        for (uint32_t channel = 0; channel < 2; channel++) {
+            for (uint32_t band = 0; band < kNumBands; band++)
+                identical = identical && memcmp(monoBands[channel].bands[band], stereoBands[channel].bands[band],
+                    numFrames * sizeof(double)) == 0;
+        }
+        offset += numFrames;
+    }
+    check(identical, "%s stereo crossover bit identical to two scalar mono crossovers", kKernelNames[kernel]);
+}
+
+int main() {
+    std::vector<double> left = makeNoise(kNumFrames, 1);
+    std::vector<double> right = makeNoise(kNumFrames, 2);
+    const double* input[2] = { left.data(), right.data() };
+
+    for (SIMDKernel kernel : { kScalarKernel, kSSE2Kernel, kAVX2Kernel }) {
+        if (isSIMDKernelSupported(kernel))
+            checkStereoMatchesMono(kernel, left, right);
+    }
+
+    SIMDKernel kernel = getBestSIMDKernel();
+    std::vector<double> channelOutput[2] = { std::vector<double>(kNumFrames), std::vector<double>(kNumFrames) };
+    std::vector<double> stereoOutput[2] = { std::vector<double>(kNumFrames), std::vector<double>(kNumFrames) };
+    double* channelOutputs[2] = { channelOutput[0].data(), channelOutput[1].data() };
+    double* stereoOutputs[2] = { stereoOutput[0].data(), stereoOutput[1].data() };
+
+    ChannelPath* channelPath = new ChannelPath(kernel);
+    StereoPath* stereoPath = new StereoPath(kernel);
+    double channelSeconds = getFastestSeconds([&]() { channelPath->process(input, channelOutputs, kNumFrames); }, 7);
+    double stereoSeconds = getFastestSeconds([&]() { stereoPath->process(input, stereoOutputs, kNumFrames); }, 7);
+    delete channelPath;
+    delete stereoPath;
+
+    // --- the vector tanh is a few ulps off libm, far below the float output
+    double maxDifference = 0.0;
+    for (uint32_t channel = 0; channel < 2; channel++) {
+        for (uint32_t i = 0; i < kNumFrames; i++)
+            maxDifference = fmax(maxDifference, fabs(stereoOutput[channel][i] - channelOutput[channel][i]));
+    }
+    check(maxDifference < 1e-13, "stereo path within %.3g of the per channel path", maxDifference);
+
+    double speedup = channelSeconds / stereoSeconds;
+    printf("note   %s, 10 s of 96 kHz stereo in 64 frame buffers: per channel %.4f s, stereo lanes %.4f s, %.2fx\n",
+        kKernelNames[kernel], channelSeconds, stereoSeconds, speedup);
+    if (kernel == kAVX2Kernel)
+        checkSpeed(speedup >= kMinSpeedup, "AVX2 stereo lanes %.2fx faster >= %.1fx", speedup, kMinSpeedup);
+    else
+        printf("skip   the %.1fx limit is for AVX2, not supported by this CPU\n", kMinSpeedup);
+
+    return getTestResult();
+}
@@ -0,0 +1,202 @@
+//
+//  TanhWaveshaperTest.cpp
+//
+//  Accuracy of the TanhWaveshaper quality tiers against libm tanh, and agreement of the scalar, SSE2 and AVX2
+//  kernels (see TanhWaveshaper.h for the bounds checked here).
+
+// Notes: the tier bounds are on tanh itself, so they are checked at drive 1 over x in [-30, 30], where the output
+//        times tanh(1) is tanh(x) up to one rounding. At the other drives the output is checked against
+//        tanh(drive x) / tanh(drive) for inputs up to +/-4 (+12 dBFS, more than a band ever carries); at the
+//        -24 dB surround/height minimum the normalizer is about 16, which the last block reports.
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "TanhWaveshaper.h"
+#include "TestSupport.h"
+
+static const char* kKernelNames[] = { "scalar", "SSE2", "AVX2" };
+static const char* kQualityNames[] = { "exact", "rational", "polynomial" };
+
+// --- max abs error of tanh per tier (TanhQuality order); the exact tier is allowed a few double ulps
+static const double kTanhErrorBounds[kNumTanhQualities] = { 1e-15, 7.1e-5, 5e-8 };
+
+// --- the drive range of the plugin: Sat 0..24 dB plus a surround/height offset of -24..24 dB
+static const double kMinDrive = 0.0630957344480193;     // -24 dB
+static const double kMaxDrive = 251.188643150958;       // +48 dB
+static const double kDrives[] = { kMinDrive, 0.5, 1.0, 3.98107170553497, 15.8489319246111, kMaxDrive };
+
+static std::vector<double> makeSweep(double from, double to, double step) {
+    std::vector<double> sweep;
+    for (double x = from; x <= to; x += step)
+        sweep.push_back(x);
+    return sweep;
+}
+
+static std::vector<double> processBlock(TanhWaveshaper& waveshaper, const std::vector<double>& input) {
+    std::vector<double> output(input.size());
+    waveshaper.processBlock(input.data(), output.data(), (uint32_t)input.size());
+    return output;
+}
+
+// --- odd block lengths so every kernel runs its vector loop and its tail
+static std::vector<double> processOddBlocks(TanhWaveshaper& waveshaper, const std::vector<double>& input) {
+    std::vector<double> output(input.size());
+    uint32_t blockSizes[] = { 1, 7, 64, 333, 1023 };
+    size_t offset = 0;
+    for (uint32_t i = 0; offset < input.size(); i++) {
+        uint32_t numFrames = blockSizes[i % 5];
+        if (numFrames > input.size() - offset)
+            numFrames = (uint32_t)(input.size() - offset);
+        waveshaper.processBlock(&input[offset], &output[offset], numFrames);
+        offset += numFrames;
+    }
+    return output;
+}
+
+static bool isBitIdentical(const std::vector<double>& a, const std::vector<double>& b) {
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+}
+
+static double getMaxRelativeDifference(const std::vector<double>& a, const std::vector<double>& b) {
+    double maxDifference = 0.0;
+    for (size_t i = 0; i < a.size(); i++) {
+        double difference = fabs(a[i] - b[i]) / (fabs(b[i]) > 1.0 ? fabs(b[i]) : 1.0);
+        if (difference > maxDifference)
+            maxDifference = difference;
+    }
+    return maxDifference;
+}
+
+static void checkTierAccuracy(SIMDKernel kernel, TanhQuality quality, const std::vector<double>& sweep) {
+    TanhWaveshaper waveshaper;
+    waveshaper.setKernel(kernel);
+    waveshaper.setQuality(quality);
+    std::vector<double> output = processBlock(waveshaper, sweep);
+
+    double normalizer = tanh(1.0);
+    double maxError = 0.0;
+    bool odd = true;
+    for (size_t i = 0; i < sweep.size(); i++) {
+        double error = fabs(output[i] * normalizer - tanh(sweep[i]));
+        if (error > maxError)
+            maxError = error;
+        odd = odd && waveshaper.processSample(-sweep[i]) == -waveshaper.processSample(sweep[i]);
+    }
+    check(maxError <= kTanhErrorBounds[quality], "%s %s: max tanh error %.3g <= %.3g", kKernelNames[kernel],
+        kQualityNames[quality], maxError, kTanhErrorBounds[quality]);
+    check(odd, "%s %s: odd symmetric", kKernelNames[kernel], kQualityNames[quality]);
+}
+
+static double checkDriveAccuracy(SIMDKernel kernel, TanhQuality quality, double drive, const std::vector<double>& input) {
+    TanhWaveshaper waveshaper;
+    waveshaper.setKernel(kernel);
+    waveshaper.setQuality(quality);
+    waveshaper.setDrive(drive);
+    std::vector<double> output = processBlock(waveshaper, input);
+
+    double normalizer = tanh(drive);
+    double maxError = 0.0;
+    for (size_t i = 0; i < input.size(); i++) {
+        double error = fabs(output[i] - tanh(drive * input[i]) / normalizer);
+        if (error > maxError)
+            maxError = error;
+    }
+    double bound = kTanhErrorBounds[quality] / normalizer + 4e-16 / normalizer;
+    check(maxError <= bound, "%s %s drive %g: max output error %.3g <= %.3g", kKernelNames[kernel],
+        kQualityNames[quality], drive, maxError, bound);
+    return maxError;
+}
+
+int main() {
+    std::vector<SIMDKernel> kernels;
+    for (SIMDKernel kernel : { kScalarKernel, kSSE2Kernel, kAVX2Kernel }) {
+        if (isSIMDKernelSupported(kernel))
+            kernels.push_back(kernel);
+        else
+            printf("skip   %s kernel: not supported by this CPU\n", kKernelNames[kernel]);
+    }
+
+    // --- the tier bounds against libm
+    std::vector<double> sweep = makeSweep(-30.0, 30.0, 1.5e-5);
+    for (SIMDKernel kernel : kernels) {
+        for (int quality = 0; quality < kNumTanhQualities; quality++)
+            checkTierAccuracy(kernel, (TanhQuality)quality, sweep);
+    }
+
+    // --- the output over the drive range, scaled by 1 / tanh(drive)
+    std::vector<double> bandInput = makeSweep(-4.0, 4.0, 1e-4);
+    double minDriveError[kNumTanhQualities] = {};
+    for (SIMDKernel kernel : kernels) {
+        for (int quality = 0; quality < kNumTanhQualities; quality++) {
+            for (double drive : kDrives) {
+                double error = checkDriveAccuracy(kernel, (TanhQuality)quality, drive, bandInput);
+                if (drive == kMinDrive && error > minDriveError[quality])
+                    minDriveError[quality] = error;
+            }
+        }
+    }
+    for (int quality = 1; quality < kNumTanhQualities; quality++)
+        printf("note   %s at the minimum drive %g (1 / tanh = %.1f): max output error %.3g\n", kQualityNames[quality],
+            kMinDrive, 1.0 / tanh(kMinDrive), minDriveError[quality]);
+
+    // --- the approximate tiers are bit identical on every kernel, in processBlock, processSample and drive ramps
+    std::vector<double> driven = makeSweep(-8.0, 8.0, 3.7e-5);
+    for (int quality = kRationalTanh; quality < kNumTanhQualities; quality++) {
+        std::vector<double> reference;
+        std::vector<double> rampReference;
+        for (SIMDKernel kernel : kernels) {
+            TanhWaveshaper waveshaper;
+            waveshaper.setKernel(kernel);
+            waveshaper.setQuality((TanhQuality)quality);
+            waveshaper.setDrive(2.5);
+            std::vector<double> output = processOddBlocks(waveshaper, driven);
+
+            std::vector<double> samples(driven.size());
+            for (size_t i = 0; i < driven.size(); i++)
+                samples[i] = waveshaper.processSample(driven[i]);
+
+            std::vector<double> ramp(driven.size());
+            waveshaper.processBlock(driven.data(), ramp.data(), (uint32_t)driven.size(), 40.0);
+
+            if (kernel == kScalarKernel) {
+                reference = output;
+                rampReference = ramp;
+            }
+            check(isBitIdentical(output, reference), "%s %s: processBlock bit identical to scalar",
+                kKernelNames[kernel], kQualityNames[quality]);
+            check(isBitIdentical(samples, reference), "%s %s: processSample bit identical to processBlock",
+                kKernelNames[kernel], kQualityNames[quality]);
+            check(isBitIdentical(ramp, rampReference), "%s %s: drive ramp bit identical to scalar",
+                kKernelNames[kernel], kQualityNames[quality]);
+        }
+    }
+
+    // --- the exact tier and ADAA: the SIMD kernels stay within a few ulps of the scalar kernel, and processSample
+    //     matches processBlock on each
+    for (int antialiasing = 0; antialiasing < kNumTanhAntialiasings; antialiasing++) {
+        std::vector<double> reference;
+        const char* mode = antialiasing == kFirstOrderADAA ? "ADAA" : "exact";
+        for (SIMDKernel kernel : kernels) {
+            TanhWaveshaper waveshaper;
+            waveshaper.setKernel(kernel);
+            waveshaper.setAntialiasing((TanhAntialiasing)antialiasing);
+            waveshaper.setDrive(2.5);
+            std::vector<double> output = processOddBlocks(waveshaper, driven);
+            if (kernel == kScalarKernel)
+                reference = output;
+            double difference = getMaxRelativeDifference(output, reference);
+            check(difference <= 4.0 * 2.2e-16, "%s %s: within 4 ulps of scalar (%.3g)", kKernelNames[kernel], mode,
+                difference);
+
+            waveshaper.clear();
+            std::vector<double> samples(driven.size());
+            for (size_t i = 0; i < driven.size(); i++)
+                samples[i] = waveshaper.processSample(driven[i]);
+            check(isBitIdentical(samples, output), "%s %s: processSample bit identical to processBlock",
+                kKernelNames[kernel], mode);
+        }
+    }
+
+    return getTestResult();
+}
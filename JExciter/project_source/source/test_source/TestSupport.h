@@ -0,0 +1,74 @@
+//
+//  TestSupport.h
+//
+//  Small shared helpers for the kernel tests and benchmarks: check reporting, skipping and best-of-N timing.
+
+// Notes: a test program returns getTestResult(): 0 when every check passed, 1 when one failed, kSkipTest when it
+//        had nothing to run on this machine (ctest reports it as skipped).
+//        Benchmarks time the fastest of several runs, which stays steady on a loaded machine where the mean does
+//        not. Their speed limits are only enforced in optimized builds (NDEBUG); an unoptimized build prints the
+//        figures and passes, since -O0 intrinsics say nothing about the release kernels.
+
+#ifndef __TestSupport_h__
+#define __TestSupport_h__
+
+#include <chrono>
+#include <stdarg.h>
+#include <stdio.h>
+
+enum { kSkipTest = 77 };
+
+#ifdef NDEBUG
+static const bool kEnforceSpeedLimits = true;
+#else
+static const bool kEnforceSpeedLimits = false;
+#endif
+
+static int numFailedChecks = 0;
+
+// --- prints "ok" or "FAILED" and the message; returns the condition
+static inline bool check(bool condition, const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    printf("%s ", condition ? "ok    " : "FAILED");
+    vprintf(format, arguments);
+    printf("\n");
+    va_end(arguments);
+    if (!condition)
+        numFailedChecks++;
+    return condition;
+}
+
+// --- a speed limit: a failure in optimized builds, a note otherwise
+static inline bool checkSpeed(bool condition, const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    printf("%s ", condition ? "ok    " : (kEnforceSpeedLimits ? "FAILED" : "slow  "));
+    vprintf(format, arguments);
+    printf("\n");
+    va_end(arguments);
+    if (!condition && kEnforceSpeedLimits)
+        numFailedChecks++;
+    return condition;
+}
+
+static inline int getTestResult() {
+    return numFailedChecks == 0 ? 0 : 1;
+}
+
+// --- seconds of the fastest of numRuns calls of function
+template <typename Function>
+double getFastestSeconds(Function function, int numRuns) {
+    typedef std::chrono::steady_clock Clock;
+    double fastest = 0.0;
+    for (int run = 0; run < numRuns; run++) {
+        Clock::time_point start = Clock::now();
+        function();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (run == 0 || seconds < fastest)
+            fastest = seconds;
+    }
+    return fastest;
+}
+
+#endif
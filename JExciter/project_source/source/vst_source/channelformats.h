@@ -27,24 +27,42 @@
 
 @brief number of supported channel I/O combinations
 */
-const unsigned int NUM_SUPPORTED_CHANNEL_FORMATS = 15;
+const unsigned int NUM_SUPPORTED_CHANNEL_FORMATS = 19;
 
 namespace Steinberg {
 namespace Vst {
 namespace ASPiK {
 
 /**
-	@speakerArrangements
+	@SupportedChannelFormat
+	\ingroup VST-Shell
+
+	@brief one supported ASPiK channel format (channelFormat enum) and its VST3 speaker arrangement
+*/
+struct SupportedChannelFormat
+{
+    uint32_t channelFormat;
+    SpeakerArrangement speakerArrangement;
+};
+
+/**
+	@supportedChannelFormats
 	\ingroup VST-Shell
 
 	@brief fixed array of supported VST3 speaker arrangements you can add more here if you want to support more channel arrangements;
+	keyed by channel format since the enum has unsupported formats (kCF8p1 ... kCF22p2) before the immersive ones.
 	NOTE: these were chosen to match with AU and AAX channal I/O support.
 */
-SpeakerArrangement speakerArrangements[NUM_SUPPORTED_CHANNEL_FORMATS] =
-{SpeakerArr::kEmpty, SpeakerArr::kMono, SpeakerArr::kStereo, SpeakerArr::k30Cine,
-    SpeakerArr::k31Cine, SpeakerArr::k40Music, SpeakerArr::k50, SpeakerArr::k51,
-    SpeakerArr::k60Music, SpeakerArr::k61Music, SpeakerArr::k70Cine, SpeakerArr::k70Music,
-    SpeakerArr::k71Cine, SpeakerArr::k71Music, SpeakerArr::k71Proximity};
+SupportedChannelFormat supportedChannelFormats[NUM_SUPPORTED_CHANNEL_FORMATS] =
+{
+    {kCFNone, SpeakerArr::kEmpty}, {kCFMono, SpeakerArr::kMono}, {kCFStereo, SpeakerArr::kStereo},
+    {kCFLCR, SpeakerArr::k30Cine}, {kCFLCRS, SpeakerArr::k40Cine}, {kCFQuad, SpeakerArr::k40Music},
+    {kCF5p0, SpeakerArr::k50}, {kCF5p1, SpeakerArr::k51}, {kCF6p0, SpeakerArr::k60Music},
+    {kCF6p1, SpeakerArr::k61Music}, {kCF7p0Sony, SpeakerArr::k70Cine}, {kCF7p0DTS, SpeakerArr::k70Music},
+    {kCF7p1Sony, SpeakerArr::k71Cine}, {kCF7p1DTS, SpeakerArr::k71Music}, {kCF7p1Proximity, SpeakerArr::k71Proximity},
+    {kCF7p1p4, SpeakerArr::k71_4}, {kCFAmbisonic1stOrder, SpeakerArr::kAmbi1stOrderACN},
+    {kCFAmbisonic2ndOrder, SpeakerArr::kAmbi2cdOrderACN}, {kCFAmbisonic3rdOrder, SpeakerArr::kAmbi3rdOrderACN}
+};
 
 /**
 @getNumSupportedChannelFormats
@@ -58,18 +76,38 @@ uint32_t getNumSupportedChannelFormats(){ return NUM_SUPPORTED_CHANNEL_FORMATS;
 @getSupportedSpeakerArrangement
 \ingroup FX-Functions
 
-@brief implements n-order Lagrange Interpolation
+@brief returns the speaker arrangement of one entry of the supported list
 
-\param index index of channel I/O struct
+\param index index into the supported list (0 to getNumSupportedChannelFormats() - 1), NOT a channelFormat
 
 \return the VST SpeakerArrangement version of ASPiK channel I/O combi
 */
 SpeakerArrangement getSupportedSpeakerArrangement(uint32_t index)
 {
     if(index >= NUM_SUPPORTED_CHANNEL_FORMATS)
-        return speakerArrangements[0];
+        return supportedChannelFormats[0].speakerArrangement;
 
-    return speakerArrangements[index];
+    return supportedChannelFormats[index].speakerArrangement;
+}
+
+/**
+@getSpkrArrangementForChannelFormat
+\ingroup FX-Functions
+
+@brief looks a channel format up in the supported list
+
+\param channelFormat the ASPiK channel I/O combination enum
+
+\return the VST SpeakerArrangement, or kEmpty for unsupported formats
+*/
+SpeakerArrangement getSpkrArrangementForChannelFormat(uint32_t channelFormat)
+{
+    for(uint32_t i = 0; i < NUM_SUPPORTED_CHANNEL_FORMATS; i++)
+    {
+        if(supportedChannelFormats[i].channelFormat == channelFormat)
+            return supportedChannelFormats[i].speakerArrangement;
+    }
+    return SpeakerArr::kEmpty;
 }
 
 /**
@@ -98,7 +136,7 @@ uint32_t getChannelFormatForSpkrArrangement(SpeakerArrangement arr)
         case SpeakerArr::k30Cine: {
             return kCFLCR; }
 
-        case SpeakerArr::k31Cine: {
+        case SpeakerArr::k40Cine: {
             return kCFLCRS; }
 
         case SpeakerArr::k40Music: {
@@ -131,6 +169,18 @@ uint32_t getChannelFormatForSpkrArrangement(SpeakerArrangement arr)
         case SpeakerArr::k71Proximity: {
             return kCF7p1Proximity; }
 
+        case SpeakerArr::k71_4: {
+            return kCF7p1p4; }
+
+        case SpeakerArr::kAmbi1stOrderACN: {
+            return kCFAmbisonic1stOrder; }
+
+        case SpeakerArr::kAmbi2cdOrderACN: {
+            return kCFAmbisonic2ndOrder; }
+
+        case SpeakerArr::kAmbi3rdOrderACN: {
+            return kCFAmbisonic3rdOrder; }
+
         default: {
             return kCFNone; }
     }
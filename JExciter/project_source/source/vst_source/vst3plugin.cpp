@@ -330,6 +330,9 @@ tresult PLUGIN_API VST3Plugin::initialize(FUnknown* context)
                 parameters.addParameter(presetParam);
           //  }
         }
+
+        // --- latency changes are set by the core on the audio thread and reported from the UI thread
+        latencyTimer = Timer::create(this, kLatencyTimerMSec);
     }
 
     return result;
@@ -348,6 +351,13 @@ NOTES:
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 tresult PLUGIN_API VST3Plugin::terminate()
 {
+    if(latencyTimer)
+    {
+        latencyTimer->stop();
+        latencyTimer->release();
+        latencyTimer = nullptr;
+    }
+
     if(VST3PluginCID)
     {
         delete VST3PluginCID;
@@ -467,8 +477,8 @@ NOTES:
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 tresult PLUGIN_API VST3Plugin::canProcessSampleSize(int32 symbolicSampleSize)
 {
-	// --- we support 32 bit audio
-	if (symbolicSampleSize == kSample32)
+	// --- we support 32 and 64 bit audio; 64 bit buffers go to the core as ProcessBufferInfo::inputs64/outputs64
+	if (symbolicSampleSize == kSample32 || symbolicSampleSize == kSample64)
 	{
 		return kResultTrue;
 	}
@@ -494,6 +504,7 @@ tresult PLUGIN_API VST3Plugin::setupProcessing(ProcessSetup& newSetup)
         ResetInfo info;
         info.sampleRate = processSetup.sampleRate;
         info.bitDepth = processSetup.symbolicSampleSize;
+        setResetChannelIOConfig(info);
         pluginCore->reset(info);
     }
 
@@ -527,6 +538,32 @@ uint32 PLUGIN_API VST3Plugin::getTailSamples()
         return 0;
 }
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//	VST3Plugin::onTimer
+//
+/**
+\brief Reports latency changes to the host; the core changes its processing latency (PluginBase::setProcessingLatency)
+       from reset() or from process() when a parameter switches a processing mode, so this polls it on the UI
+       thread, where restartComponent must be called. The host then re-reads getLatencySamples()
+
+NOTES:
+- see VST3 SDK Documentation for more information on IComponentHandler::restartComponent and kLatencyChanged
+*/
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void VST3Plugin::onTimer(Timer* timer)
+{
+	if (!pluginCore)
+		return;
+
+	uint32 latency = (uint32)pluginCore->getLatencyInSamples();
+	if (latency == m_uLatencyInSamples)
+		return;
+
+	m_uLatencyInSamples = latency;
+	if (componentHandler)
+		componentHandler->restartComponent(kLatencyChanged);
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //	VST3Plugin::setActive
 //
@@ -551,6 +588,7 @@ tresult PLUGIN_API VST3Plugin::setActive(TBool state)
             ResetInfo info;
             info.sampleRate = processSetup.sampleRate;
             info.bitDepth = processSetup.symbolicSampleSize;
+            setResetChannelIOConfig(info);
             pluginCore->reset(info);
         }
 	}
@@ -563,6 +601,31 @@ tresult PLUGIN_API VST3Plugin::setActive(TBool state)
 	return SingleComponentEffect::setActive (state);
 }
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//	VST3Plugin::setResetChannelIOConfig
+//
+/**
+\brief Sets the channel formats of the ResetInfo from the current bus arrangements so the core
+	can allocate per-channel state in reset() instead of on the audio thread
+
+NOTES:
+- busses can only change while the plugin is inactive, so the arrangement is final in setActive(true)
+*/
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void VST3Plugin::setResetChannelIOConfig(ResetInfo& info)
+{
+    SpeakerArrangement inputArr = SpeakerArr::kEmpty;
+    SpeakerArrangement outputArr = SpeakerArr::kEmpty;
+
+    if(pluginCore->getPluginType() == kSynthPlugin)
+        info.channelIOConfig.inputChannelFormat = kCFNone;
+    else if(getBusArrangement(kInput, 0, inputArr) == kResultTrue)
+        info.channelIOConfig.inputChannelFormat = getChannelFormatForSpkrArrangement(inputArr);
+
+    if(getBusArrangement(kOutput, 0, outputArr) == kResultTrue)
+        info.channelIOConfig.outputChannelFormat = getChannelFormatForSpkrArrangement(outputArr);
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //	VST3Plugin::setState
 //
@@ -585,7 +648,8 @@ tresult PLUGIN_API VST3Plugin::setState(IBStream* fileStream)
 	// --- read the version
 	if(!s.readInt64u(version)) return kResultFalse;
 
-    // --- serialize
+    // --- serialize; the audio thread takes the whole state in one buffer
+    pluginCore->beginParameterUpdates();
 	for (unsigned int i = 0; i < pluginCore->getPluginParameterCount(); i++)
     {
         PluginParameter* piParam = pluginCore->getPluginParameterByIndex(i);
@@ -593,21 +657,18 @@ tresult PLUGIN_API VST3Plugin::setState(IBStream* fileStream)
         if(piParam)
         {
             if(!s.readDouble(data))
+            {
+                pluginCore->endParameterUpdates();
                 return kResultFalse;
+            }
             else
             {
-                // --- temp disable smoothing
-                bool smooth = piParam->getParameterSmoothing();
-                piParam->setParameterSmoothing(false);
-
                 // --- init actual, no smooth
-                piParam->setControlValue(data);
-                
-                // --- reset
-                piParam->setParameterSmoothing(smooth);
+                piParam->setControlValue(data, true);
             }
         }
     }
+    pluginCore->endParameterUpdates();
     
     // --- add plugin side bypassing
     if(!s.readBool(plugInSideBypass)) return kResultFalse;
@@ -686,6 +747,13 @@ bool VST3Plugin::doControlUpdate(ProcessData& data)
 {
 	bool paramChange = false;
 
+	// --- the host's queues only live for this buffer; unautomated parameters drop the last buffer's
+	if (enableSAAVST3 && pluginCore)
+	{
+		for (unsigned int i = 0; i < pluginCore->getPluginParameterCount(); i++)
+			pluginCore->getPluginParameterByIndex(i)->setParameterUpdateQueue(nullptr);
+	}
+
 	// --- check
     IParameterChanges* paramChanges = data.inputParameterChanges;
 	if(!paramChanges)
@@ -730,7 +798,7 @@ bool VST3Plugin::doControlUpdate(ProcessData& data)
                     // --- add the sample accurate queue
                     if (enableSAAVST3)
                     {
-                        m_pParamUpdateQueueArray[i]->setParamValueQueue(queue, data.numSamples);
+                        m_pParamUpdateQueueArray[i]->setParamValueQueue(queue, data.numSamples, piParam->getControlValueNormalized());
                         piParam->setParameterUpdateQueue(m_pParamUpdateQueueArray[i]);
                     }
                     else
@@ -794,8 +862,10 @@ tresult PLUGIN_API VST3Plugin::process(ProcessData& data)
 {
     // --- check for control chages and update if needed
     //     Changed for 3.6.14: this is moved to top of function for bypass persistence
-    //     during testing
+    //     during testing; the host's values are written on the audio thread
+    if (pluginCore) pluginCore->beginAudioThreadUpdates();
     doControlUpdate(data);
+    if (pluginCore) pluginCore->endAudioThreadUpdates();
 
 	if (!pluginCore) return kResultFalse;
     
@@ -808,11 +878,20 @@ tresult PLUGIN_API VST3Plugin::process(ProcessData& data)
     else if (pluginCore->getPluginType() == kFXPlugin && (!data.inputs || !data.outputs))
         return kResultTrue;
 
-    // --- setup buffer processing
+    // --- setup buffer processing; 64 bit hosts are passed straight through, no conversion
     ProcessBufferInfo info;
- 
-    info.inputs = isSynth ? nullptr : &data.inputs[0].channelBuffers32[0];
-    info.outputs = &data.outputs[0].channelBuffers32[0];
+    bool is64Bit = data.symbolicSampleSize == kSample64;
+
+    if (is64Bit)
+    {
+        info.inputs64 = isSynth ? nullptr : &data.inputs[0].channelBuffers64[0];
+        info.outputs64 = &data.outputs[0].channelBuffers64[0];
+    }
+    else
+    {
+        info.inputs = isSynth ? nullptr : &data.inputs[0].channelBuffers32[0];
+        info.outputs = &data.outputs[0].channelBuffers32[0];
+    }
     
     // --- setup channel formats
     SpeakerArrangement inputArr;
@@ -834,17 +913,13 @@ tresult PLUGIN_API VST3Plugin::process(ProcessData& data)
     // --- output (always)
     info.channelIOConfig.outputChannelFormat = getChannelFormatForSpkrArrangement(outputArr);
 
-    // --- soft bypass for FX plugins
+    // --- soft bypass for FX plugins: output = input, delayed by the latency the host compensates
     if (plugInSideBypass && !isSynth)
     {
-        for (int32 sample = 0; sample < data.numSamples; sample++)
-        {
-            // --- output = input
-			for (unsigned int i = 0; i<info.numAuxAudioOutChannels; i++)
-            {
-                (data.outputs[0].channelBuffers32[i])[sample] = (data.inputs[0].channelBuffers32[i])[sample];
-            }
-        }
+        info.numFramesToProcess = data.numSamples;
+        info.inputSilenceFlags = data.inputs[0].silenceFlags;
+        pluginCore->processBypassedAudioBuffers(info);
+        data.outputs[0].silenceFlags = info.outputSilenceFlags;
 
         // --- update the meters, force OFF
         updateMeters(data, true);
@@ -860,7 +935,10 @@ tresult PLUGIN_API VST3Plugin::process(ProcessData& data)
         if (bus && bus->isActive())
         {
             info.numAuxAudioInChannels = data.inputs[1].numChannels;
-            info.auxInputs = &data.inputs[1].channelBuffers32[0]; //** to sidechain
+            if (is64Bit)
+                info.auxInputs64 = &data.inputs[1].channelBuffers64[0]; //** to sidechain
+            else
+                info.auxInputs = &data.inputs[1].channelBuffers32[0]; //** to sidechain
         }
     }
     
@@ -868,6 +946,9 @@ tresult PLUGIN_API VST3Plugin::process(ProcessData& data)
     info.numAuxAudioOutChannels = 0; // --- for future use
 
     info.numFramesToProcess = data.numSamples;
+
+    // --- silence flags: the host's tell the core it can skip the scan, the core's let the host skip downstream work
+    info.inputSilenceFlags = isSynth ? 0 : data.inputs[0].silenceFlags;
     
     // --- sidechain channel config
     info.auxChannelIOConfig.inputChannelFormat = pluginCore->getDefaultChannelIOConfigForChannelCount(info.numAuxAudioInChannels);
@@ -887,6 +968,7 @@ tresult PLUGIN_API VST3Plugin::process(ProcessData& data)
     
     // --- process the buffers
     pluginCore->processAudioBuffers(info);
+    data.outputs[0].silenceFlags = info.outputSilenceFlags;
    
     // --- update the meters
     updateMeters(data);
@@ -913,21 +995,18 @@ void VST3Plugin::updateMeters(ProcessData& data, bool forceOff)
     
     if(data.outputParameterChanges)
     {
-        int32_t startIndex = 0;
-        int32_t indexer = 0;
-        while(startIndex >= 0)
+        // --- the core lists its meters once; one point per meter at the top of the buffer
+        uint32_t count = pluginCore->getOutboundParameterCount();
+        for(uint32_t i = 0; i < count; i++)
         {
-            PluginParameter* piParam = pluginCore->getNextParameterOfType(startIndex, controlVariableType::kMeter);
-            if(piParam)
+            PluginParameter* piParam = pluginCore->getOutboundParameter(i);
+            int32 queueIndex = 0;
+            IParamValueQueue* queue = data.outputParameterChanges->addParameterData(piParam->getControlID(), queueIndex);
+
+            if(queue)
             {
-                int32 queueIndex = 0;
-                IParamValueQueue* queue = data.outputParameterChanges->addParameterData(piParam->getControlID(), queueIndex);
-                
-                if(queue)
-                {
-                    double meterValue = forceOff ? 0.0 : piParam->getControlValue();
-                    queue->addPoint(indexer++, meterValue, queueIndex);
-                }
+                double meterValue = forceOff ? 0.0 : piParam->getControlValue();
+                queue->addPoint(0, meterValue, queueIndex);
             }
         }
     }
@@ -968,6 +1047,15 @@ tresult PLUGIN_API VST3Plugin::getMidiControllerAssignment(int32 busIndex, int16
 			case kCtrlSustainOnOff:
 			case kCtrlAllNotesOff:
                 break;
+
+			// --- the core's CC mappings (Sat/Mix) become parameter changes, sample accurate like automation
+			default:
+			{
+				int32_t controlID = pluginCore->getMidiControllerParameter(midiControllerNumber);
+				if (controlID >= 0)
+					id = controlID;
+				break;
+			}
 		}
 
 		if(id == -1)
@@ -1152,6 +1240,8 @@ tresult PLUGIN_API VST3Plugin::setParamNormalized(ParamID tag, ParamValue value)
         PresetInfo* preset = pluginCore->getPreset(program);
         if(preset)
         {
+            // --- the audio thread takes the whole preset in one buffer
+            pluginCore->beginParameterUpdates();
 			for (unsigned int j = 0; j<preset->presetParameters.size(); j++)
             {
                 PresetParameter preParam = preset->presetParameters[j];
@@ -1165,6 +1255,7 @@ tresult PLUGIN_API VST3Plugin::setParamNormalized(ParamID tag, ParamValue value)
                 //     this will call the update handler to modify the GUI controls (safe)
                 res = SingleComponentEffect::setParamNormalized(preParam.controlID, normalizedValue);
             }
+            pluginCore->endParameterUpdates();
         }
         return res;
 	}
@@ -1600,13 +1691,21 @@ NOTES:
 - see VST3 SDK Documentation for more information on this function and its parameters
 */
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-void VSTParamUpdateQueue::setParamValueQueue(IParamValueQueue* _paramValueQueue, unsigned int _bufferSize)
+void VSTParamUpdateQueue::setParamValueQueue(IParamValueQueue* _paramValueQueue, unsigned int _bufferSize, ParamValue _startValue)
 {
 	bufferSize = _bufferSize;
 	parameterQueue = _paramValueQueue;
 	queueSize = parameterQueue->getPointCount();
 	queueIndex = 0;
 	sampleOffset = 0;
+
+	// --- sub-block scheduling: the value ramps from the last frame of the previous buffer to the first point
+	startValue = _startValue;
+	pointIndex = 0;
+	previousPointOffset = -1;
+	previousPointValue = startValue;
+	if (queueSize <= 0 || parameterQueue->getPoint(0, pointOffset, pointValue) != Steinberg::kResultTrue)
+		pointIndex = queueSize;
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -1808,6 +1907,58 @@ bool VSTParamUpdateQueue::getNextValue(double& _nextValue)
 	return false;
 }
  
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//	VSTParamUpdateQueue::seekPoint
+//
+/**
+\brief sub-block scheduling: step past the points before _sampleOffset; the queries only move forward in a
+       buffer, so each point is read from the host queue once
+*/
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void VSTParamUpdateQueue::seekPoint(uint32_t _sampleOffset)
+{
+	while (pointIndex < queueSize && pointOffset < (int32)_sampleOffset)
+	{
+		previousPointOffset = pointOffset;
+		previousPointValue = pointValue;
+		if (++pointIndex < queueSize && parameterQueue->getPoint(pointIndex, pointOffset, pointValue) != Steinberg::kResultTrue)
+			pointIndex = queueSize;
+	}
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//	VSTParamUpdateQueue::getNextPointOffset
+//
+/**
+\brief sub-block scheduling: the offset of the first point at or after _sampleOffset, or the buffer size
+*/
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+uint32_t VSTParamUpdateQueue::getNextPointOffset(uint32_t _sampleOffset)
+{
+	seekPoint(_sampleOffset);
+	return pointIndex < queueSize ? (uint32_t)pointOffset : bufferSize;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//	VSTParamUpdateQueue::getInterpolatedValue
+//
+/**
+\brief sub-block scheduling: the normalized value at _sampleOffset, linear between the points as the VST3 SDK
+       defines it; after the last point the value holds
+*/
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+double VSTParamUpdateQueue::getInterpolatedValue(uint32_t _sampleOffset)
+{
+	seekPoint(_sampleOffset);
+	if (pointIndex >= queueSize)
+		return previousPointValue;
+	if (pointOffset == (int32)_sampleOffset)
+		return pointValue;
+
+	return previousPointValue + (pointValue - previousPointValue) *
+		((int32)_sampleOffset - previousPointOffset) / (double)(pointOffset - previousPointOffset);
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //	PluginEditor::PluginEditor
 //
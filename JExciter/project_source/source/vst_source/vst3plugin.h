@@ -8,6 +8,9 @@
 #include "public.sdk/source/vst/vstsinglecomponenteffect.h"
 #include "pluginterfaces/vst/ivstparameterchanges.h"
 
+// --- UI thread timer for latency changes
+#include "base/source/timer.h"
+
 // --- MIDI EVENTS
 #include "pluginterfaces/vst/ivstevents.h"
 
@@ -59,7 +62,7 @@ The VST3Plugin object is the ASPiK plugin shell for the VST3 API
 \version Revision : 1.0
 \date Date : 2018 / 09 / 7
 */
-class VST3Plugin : public SingleComponentEffect, public IMidiMapping 
+class VST3Plugin : public SingleComponentEffect, public IMidiMapping, public ITimerCallback
 {
 public:
 	// --- constructor
@@ -84,6 +87,9 @@ public:
     /**  Turn on/off */
     tresult PLUGIN_API setActive(TBool state) override;
 
+    /**  fill in the ResetInfo channel I/O from the current bus arrangements */
+    void setResetChannelIOConfig(ResetInfo& info);
+
     /**  Serialization: Save and load presets from a file stream */
     //					  These get/set the plugin variables
     tresult PLUGIN_API setState(IBStream* fileStream) override;
@@ -141,11 +147,16 @@ public:
     virtual void PLUGIN_API update(FUnknown* changedUnknown, int32 message) override ;
 
 	// --- latency support
-	uint32 m_uLatencyInSamples = 0;		///< set in constructor with plugin
-	
-	/** base class override */
+	uint32 m_uLatencyInSamples = 0;		///< the latency last reported to the host; see onTimer()
+	Timer* latencyTimer = nullptr;		///< polls the core for processing latency changes, on the UI thread
+	enum { kLatencyTimerMSec = 50 };
+
+	/** base class override; the core's current latency, which changes with its processing modes */
 	virtual uint32 PLUGIN_API getLatencySamples() override {
-		return m_uLatencyInSamples; }
+		return pluginCore ? (uint32)pluginCore->getLatencyInSamples() : m_uLatencyInSamples; }
+
+	/** ITimerCallback: tell the host about latency changes with restartComponent(kLatencyChanged) */
+	virtual void onTimer(Timer* timer) override;
 
 	/** base class override for tailtime */
 	virtual uint32 PLUGIN_API getTailSamples() override ;
@@ -308,11 +319,20 @@ protected:
 	bool dirtyBit = false;
 	int sampleOffset = 0;
 
+	// --- sub-block scheduling: the first point not yet passed and the one before it (or the start value)
+	ParamValue startValue = 0.0;
+	int32 pointIndex = 0;
+	int32 pointOffset = 0;
+	ParamValue pointValue = 0.0;
+	int32 previousPointOffset = -1;
+	ParamValue previousPointValue = 0.0;
+	void seekPoint(uint32_t _sampleOffset);
+
 public:
     VSTParamUpdateQueue(void);
     virtual ~VSTParamUpdateQueue(void){}
 	void initialize(ParamValue _initialValue, ParamValue _minValue, ParamValue _maxValue, unsigned int* _sampleAccuracy);
-	void setParamValueQueue(IParamValueQueue* _paramValueQueue, unsigned int _bufferSize);
+	void setParamValueQueue(IParamValueQueue* _paramValueQueue, unsigned int _bufferSize, ParamValue _startValue = 0.0);
 	void setSlope();
 	ParamValue interpolate(int x1, int x2, ParamValue y1, ParamValue y2, int x);
 	int needsUpdate(int x, ParamValue  &value);
@@ -321,6 +341,8 @@ public:
 	unsigned int getParameterIndex();
 	bool getValueAtOffset(long int _sampleOffset, double _previousValue, double& _nextValue);
 	bool getNextValue(double& _nextValue);
+	uint32_t getNextPointOffset(uint32_t _sampleOffset);
+	double getInterpolatedValue(uint32_t _sampleOffset);
 };
 
 
@@ -713,6 +735,10 @@ The VSTMIDIEventQueue interface queues incoming MIDI messages and blasts them ou
 NOTES:
 - this is a simple object because the VST spec automatically delivers queues of MIDI messages
 - so this provides a kind of thin wrapper around those messages to deliver to the core
+- the host's list is copied in sample offset order when it arrives; a cursor then walks it as the core asks for
+  the events due (see PluginBase::beginMidiEvents)
+- the copy is a fixed array of kMaxEvents, so a buffer never allocates; events past that are dropped and counted
+  (see getDroppedEventCount)
 
 \author Will Pirkle http://www.willpirkle.com
 \remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
@@ -725,133 +751,146 @@ public:
     VSTMIDIEventQueue(PluginCore* _pluginCore)
     {
         pluginCore = _pluginCore;
+        droppedEvents.store(0);
     };
 
     virtual ~VSTMIDIEventQueue(){}
 
 public:
-    /** set a new list from VST host*/
+    /** set a new list from VST host; the events are copied in sample offset order */
     void setEventList(IEventList* _inputEvents)
     {
         inputEvents = _inputEvents;
         currentEventIndex = 0;
+        numEvents = 0;
+
+        if (!inputEvents)
+            return;
+
+        Event e = { 0 };
+        int32 count = inputEvents->getEventCount();
+        for (int32 i = 0; i < count; i++)
+        {
+            if (inputEvents->getEvent(i, e) != kResultTrue)
+                continue;
+
+            if (numEvents >= kMaxEvents)
+            {
+                droppedEvents.fetch_add(count - i, std::memory_order_relaxed);
+                break;
+            }
+
+            // --- insertion sort: hosts nearly always send them in order, which costs one compare per event
+            events[numEvents++] = e;
+            for (uint32 j = numEvents - 1; j > 0 && events[j - 1].sampleOffset > e.sampleOffset; j--)
+                std::swap(events[j - 1], events[j]);
+        }
     }
 
 	/** get count of messages in current list */
 	virtual unsigned int getEventCount()
     {
-        if (inputEvents)
-            return inputEvents->getEventCount();
+        return numEvents;
+    }
 
-        return 0;
+    /** offset of the next event to fire, kNoEvent when they have all gone */
+    virtual unsigned int getNextEventOffset()
+    {
+        if (currentEventIndex < numEvents)
+            return (unsigned int)events[currentEventIndex].sampleOffset;
+
+        return kNoEvent;
     }
 
-    /** send MIDI event at this sample offset to core */
+    /** send the MIDI events up to and including this sample offset to core */
     virtual bool fireMidiEvents(unsigned int sampleOffset)
     {
-        if (!inputEvents)
-           return false;
-
-        Event e = { 0 };
         bool eventOccurred = false;
-        bool haveEvents = false;
-        if (inputEvents->getEvent(currentEventIndex, e) == kResultTrue)
-            haveEvents = true;
-        else
-            return false;
 
         const unsigned char MIDI_NOTE_OFF = 0x80;
         const unsigned char MIDI_NOTE_ON = 0x90;
         const unsigned char MIDI_POLY_PRESSURE = 0xA0;
 
-        while (haveEvents)
+        while (currentEventIndex < numEvents && (unsigned int)events[currentEventIndex].sampleOffset <= sampleOffset)
         {
-            if (inputEvents->getEvent(currentEventIndex, e) == kResultTrue)
-            {
-                if (e.sampleOffset != sampleOffset)
-                    return false;
+            const Event& e = events[currentEventIndex++];
 
-                // --- process Note On or Note Off messages
-                switch (e.type)
+            // --- process Note On or Note Off messages
+            switch (e.type)
+            {
+                // --- NOTE ON
+                case Event::kNoteOnEvent:
                 {
-                    // --- NOTE ON
-                    case Event::kNoteOnEvent:
-                    {
-                        midiEvent event;
-                        event.midiMessage = (unsigned int)MIDI_NOTE_ON;
-                        event.midiChannel = (unsigned int)e.noteOn.channel;
-                        event.midiData1 = (unsigned int)e.noteOn.pitch;
-                        event.midiData2 = (unsigned int)(127.0*e.noteOn.velocity);
-                        event.midiSampleOffset = e.sampleOffset;
-                        eventOccurred = true;
-
-                        // --- send to core for processing
-                        if(pluginCore)
-                            pluginCore->processMIDIEvent(event);
-                        break;
-                    }
-
-                    // --- NOTE OFF
-                    case Event::kNoteOffEvent:
-                    {
-                        // --- get the channel/note/vel
-                        midiEvent event;
-                        event.midiMessage = (unsigned int)MIDI_NOTE_OFF;
-                        event.midiChannel = (unsigned int)e.noteOff.channel;
-                        event.midiData1 = (unsigned int)e.noteOff.pitch;
-                        event.midiData2 = (unsigned int)(127.0*e.noteOff.velocity);
-                        event.midiSampleOffset = e.sampleOffset;
-                        eventOccurred = true;
-
-                        // --- send to core for processing
-                        if(pluginCore)
-                            pluginCore->processMIDIEvent(event);
-
-                        break;
-                    }
+                    midiEvent event;
+                    event.midiMessage = (unsigned int)MIDI_NOTE_ON;
+                    event.midiChannel = (unsigned int)e.noteOn.channel;
+                    event.midiData1 = (unsigned int)e.noteOn.pitch;
+                    event.midiData2 = (unsigned int)(127.0*e.noteOn.velocity);
+                    event.midiSampleOffset = e.sampleOffset;
+                    eventOccurred = true;
+
+                    // --- send to core for processing
+                    if(pluginCore)
+                        pluginCore->processMIDIEvent(event);
+                    break;
+                }
 
-                    // --- polyphonic aftertouch 0xAn
-                    case Event::kPolyPressureEvent:
-                    {
-                        midiEvent event;
-                        event.midiMessage = (unsigned int)MIDI_POLY_PRESSURE;
-                        event.midiChannel = (unsigned int)e.polyPressure.channel;
-                        event.midiData1 = (unsigned int)e.polyPressure.pitch;
-                        event.midiData2 = (unsigned int)(127.0*e.polyPressure.pressure);
-                        event.midiSampleOffset = e.sampleOffset;
-                        eventOccurred = true;
-
-                        // --- send to core for processing
-                        if(pluginCore)
-                            pluginCore->processMIDIEvent(event);
-
-                        break;
-                    }
-                } // switch
+                // --- NOTE OFF
+                case Event::kNoteOffEvent:
+                {
+                    // --- get the channel/note/vel
+                    midiEvent event;
+                    event.midiMessage = (unsigned int)MIDI_NOTE_OFF;
+                    event.midiChannel = (unsigned int)e.noteOff.channel;
+                    event.midiData1 = (unsigned int)e.noteOff.pitch;
+                    event.midiData2 = (unsigned int)(127.0*e.noteOff.velocity);
+                    event.midiSampleOffset = e.sampleOffset;
+                    eventOccurred = true;
+
+                    // --- send to core for processing
+                    if(pluginCore)
+                        pluginCore->processMIDIEvent(event);
+
+                    break;
+                }
 
-                // --- have next event?
-                if (inputEvents->getEvent(currentEventIndex + 1, e) == kResultTrue)
+                // --- polyphonic aftertouch 0xAn
+                case Event::kPolyPressureEvent:
                 {
-                    if (e.sampleOffset == sampleOffset)
-                    {
-                        // --- avance current index
-                        currentEventIndex++;
-                    }
-                    else
-                        haveEvents = false;
+                    midiEvent event;
+                    event.midiMessage = (unsigned int)MIDI_POLY_PRESSURE;
+                    event.midiChannel = (unsigned int)e.polyPressure.channel;
+                    event.midiData1 = (unsigned int)e.polyPressure.pitch;
+                    event.midiData2 = (unsigned int)(127.0*e.polyPressure.pressure);
+                    event.midiSampleOffset = e.sampleOffset;
+                    eventOccurred = true;
+
+                    // --- send to core for processing
+                    if(pluginCore)
+                        pluginCore->processMIDIEvent(event);
+
+                    break;
                 }
-                else
-                    haveEvents = false;
-            }
+            } // switch
         }
 
         return eventOccurred;
     }
 
+    /** events dropped so far because a buffer brought more than kMaxEvents; any thread */
+    uint32 getDroppedEventCount() const
+    {
+        return droppedEvents.load(std::memory_order_relaxed);
+    }
+
 protected:
+    enum { kMaxEvents = 1024 };			///< events per buffer; the rest are dropped
     PluginCore* pluginCore = nullptr; ///< the core object
     IEventList* inputEvents = nullptr;	///< the current event list for this buffer cycle
-    unsigned int currentEventIndex = 0;	///< index of current event
+    Event events[kMaxEvents];			///< this buffer's events in sample offset order
+    uint32 numEvents = 0;				///< events in this buffer
+    uint32 currentEventIndex = 0;		///< index of the next event to fire
+    std::atomic<uint32> droppedEvents;	///< events that did not fit, since construction
 };
 
 /**